@@ -316,6 +316,10 @@ class GPCatalog():
         # pg_database: datfrozenxid and datminmxid are vacuum related
         self._tables['pg_database']._setKnownDifferences("datfrozenxid datminmxid")
 
+        # pg_appendonly: analyzemodcount is only maintained by ANALYZE on
+        # the master
+        self._tables['pg_appendonly']._setKnownDifferences("analyzemodcount")
+
         # -------------
         # Issues still present in the product
         # -------------
@@ -0,0 +1,35 @@
+import imp
+import os
+import re
+from gppylib.test.unit.gp_unittest import GpTestCase, run_tests
+
+
+class GpCostCalibrateTestCase(GpTestCase):
+    def setUp(self):
+        gpcostcalibrate_file = os.path.abspath(os.path.dirname(__file__) + "/../../../gpcostcalibrate")
+        self.subject = imp.load_source('gpcostcalibrate', gpcostcalibrate_file)
+
+    def builtin_params(self):
+        params_file = os.path.abspath(os.path.dirname(__file__) +
+                                      "/../../../../../src/backend/gporca/libgpdbcost/src/CCostModelParamsGPDB.cpp")
+        with open(params_file) as f:
+            source = f.read()
+        pattern = re.compile(r'const CDouble CCostModelParamsGPDB::D(\w+)Val\s*=\s*([0-9.eE+-]+);')
+        return dict((name, float(value)) for (name, value) in pattern.findall(source))
+
+    def test_default_params_match_builtin_values(self):
+        builtin = self.builtin_params()
+        for (name, value) in self.subject.DEFAULT_PARAMS.items():
+            self.assertIn(name, builtin)
+            self.assertEqual(value, builtin[name], name)
+
+    def test_fitted_params_keep_heap_scan_cost(self):
+        slopes = {'scan_heap': [2.0], 'sort': [4.0]}
+        params = self.subject.fitted_params(slopes, 'heap', 4)
+        scan_unit = self.subject.DEFAULT_PARAMS['TableScanCostUnit']
+        self.assertAlmostEqual(params['TableScanCostUnit'] / scan_unit, 1.0)
+        self.assertAlmostEqual(params['SortTupWidthCostUnit'] / scan_unit, 2.0)
+
+
+if __name__ == '__main__':
+    run_tests()
@@ -142,12 +142,15 @@ static void printTemplate() {
         "accessid = \"aws access id\"\n"
         "threadnum = 4\n"
         "chunksize = 67108864\n"
+        "min_chunksize = 67108864\n"
+        "prefetch_keys = 0\n"
         "low_speed_limit = 10240\n"
         "low_speed_time = 60\n"
         "encryption = true\n"
         "version = 1\n"
         "proxy = \"\"\n"
         "autocompress = true\n"
+        "compress_threadnum = 1\n"
         "verifycert = true\n"
         "server_side_encryption = \"\"\n"
         "# gpcheckcloud config\n"
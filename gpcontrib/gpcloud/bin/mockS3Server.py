@@ -0,0 +1,385 @@
+#!/usr/bin/env python
+
+"""
+Mock S3 server, to measure the throughput of gpcloud without a cloud service.
+
+Every directory under the root directory is served as a bucket, and the files
+below it as its keys. Only the requests gpcloud makes to read a bucket are
+supported: listing the keys (GET /bucket/?prefix=...) and ranged GETs of a
+key, and the multipart upload gpcloud uses to write a key. Requests are not authenticated, any credentials do.
+
+To mimic a remote service, every request can be delayed by a latency, and
+every connection limited to a bandwidth.
+
+Keys can be written with the multipart upload requests gpcloud makes: the
+parts are kept in <root>/.uploads until the upload is completed into the key.
+
+Usage::
+    ./mockS3Server.py -r <root> [-p <port>] [-l <latency ms>] [-b <MB/s>]
+Point gpcloud to it with a version 2 URL and encryption turned off::
+    s3://127.0.0.1:<port>/<bucket>/<prefix> region=mock config=<config>
+"""
+
+import getopt
+import os
+import re
+import shutil
+import signal
+import sys
+import threading
+import time
+from xml.sax.saxutils import escape
+
+try:
+    from BaseHTTPServer import BaseHTTPRequestHandler, HTTPServer
+    from SocketServer import ThreadingMixIn
+    from urllib import unquote
+    from urlparse import urlparse, parse_qs
+except ImportError:
+    from http.server import BaseHTTPRequestHandler, HTTPServer
+    from socketserver import ThreadingMixIn
+    from urllib.parse import unquote, urlparse, parse_qs
+
+help_msg = '''./mockS3Server.py
+[-h] | -r (--root=) <root> [-p (--port=) <port>] [-l (--latency=) <ms>] [-b (--bandwidth=) <MB/s>] [-v]
+Options:
+    -h : print this help info
+    -r --root=: directory holding the buckets
+    -p --port=: http listen port, 8555 by default
+    -l --latency=: delay of every request in milliseconds, 0 by default
+    -b --bandwidth=: bandwidth of every connection in MB/s, unlimited by default
+    -v : log every request
+    '''
+
+MAX_KEYS = 1000
+WRITE_SIZE = 64 * 1024
+READ_SIZE = 64 * 1024
+UPLOADS_DIR = '.uploads'
+
+root = None
+latency = 0.0
+bandwidth = 0
+verbose = False
+
+stats_lock = threading.Lock()
+stats = {'requests': 0, 'bytes': 0, 'uploaded': 0}
+upload_count = [0]
+
+
+class MockS3Handler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, format, *args):
+        if verbose:
+            BaseHTTPRequestHandler.log_message(self, format, *args)
+
+    def _split_path(self):
+        url = urlparse(self.path)
+        parts = url.path.lstrip('/').split('/', 1)
+        bucket = unquote(parts[0])
+        key = unquote(parts[1]) if len(parts) > 1 else ''
+        return bucket, key, parse_qs(url.query, keep_blank_values=True)
+
+    def _send(self, code, body, headers=None):
+        self.send_response(code)
+        self.send_header('Content-Length', str(len(body)))
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
+        self.end_headers()
+        if self.command != 'HEAD':
+            self._write(body)
+
+    def _send_error(self, code, s3code, message):
+        body = ('<?xml version="1.0" encoding="UTF-8"?>\n'
+                '<Error><Code>%s</Code><Message>%s</Message></Error>' %
+                (s3code, escape(message))).encode('utf-8')
+        self._send(code, body, {'Content-Type': 'application/xml'})
+
+    def _throttle(self, start, transferred):
+        # Throttle the connection to the bandwidth, if any.
+        if bandwidth > 0:
+            ahead = float(transferred) / bandwidth - (time.time() - start)
+            if ahead > 0:
+                time.sleep(ahead)
+
+    def _write(self, data):
+        start = time.time()
+        sent = 0
+        while sent < len(data):
+            chunk = data[sent:sent + WRITE_SIZE]
+            self.wfile.write(chunk)
+            sent += len(chunk)
+            self._throttle(start, sent)
+
+        with stats_lock:
+            stats['bytes'] += sent
+
+    def _read_body(self):
+        start = time.time()
+        chunks = []
+        received = 0
+        if self.headers.get('Transfer-Encoding', '').lower() == 'chunked':
+            while True:
+                size = int(self.rfile.readline().split(b';')[0].strip(), 16)
+                if size == 0:
+                    # trailer, up to the empty line
+                    while self.rfile.readline().strip():
+                        pass
+                    break
+                chunks.append(self.rfile.read(size))
+                self.rfile.readline()
+                received += size
+                self._throttle(start, received)
+        else:
+            length = int(self.headers.get('Content-Length', 0))
+            while received < length:
+                chunk = self.rfile.read(min(READ_SIZE, length - received))
+                if not chunk:
+                    break
+                chunks.append(chunk)
+                received += len(chunk)
+                self._throttle(start, received)
+
+        with stats_lock:
+            stats['uploaded'] += received
+        return b''.join(chunks)
+
+    def _upload_dir(self, upload_id):
+        # upload ids are made up here, don't let a request point elsewhere
+        if not re.match(r'^[0-9]+$', upload_id):
+            return None
+        path = os.path.join(root, UPLOADS_DIR, upload_id)
+        return path if os.path.isdir(path) else None
+
+    def _list_keys(self, bucket):
+        bucket_dir = os.path.join(root, bucket)
+        keys = []
+        for dirpath, dirnames, filenames in os.walk(bucket_dir):
+            for name in filenames:
+                path = os.path.join(dirpath, name)
+                key = os.path.relpath(path, bucket_dir).replace(os.sep, '/')
+                keys.append((key, os.path.getsize(path)))
+        return sorted(keys)
+
+    def _list_bucket(self, bucket, query):
+        prefix = query.get('prefix', [''])[0]
+        marker = query.get('marker', [''])[0]
+
+        keys = [k for k in self._list_keys(bucket)
+                if k[0].startswith(prefix) and k[0] > marker]
+        truncated = len(keys) > MAX_KEYS
+        keys = keys[:MAX_KEYS]
+
+        body = ['<?xml version="1.0" encoding="UTF-8"?>\n'
+                '<ListBucketResult xmlns="http://s3.amazonaws.com/doc/2006-03-01/">',
+                '<Name>%s</Name>' % escape(bucket),
+                '<Prefix>%s</Prefix>' % escape(prefix),
+                '<Marker>%s</Marker>' % escape(marker),
+                '<MaxKeys>%d</MaxKeys>' % MAX_KEYS,
+                '<IsTruncated>%s</IsTruncated>' % ('true' if truncated else 'false')]
+        if truncated:
+            body.append('<NextMarker>%s</NextMarker>' % escape(keys[-1][0]))
+        for key, size in keys:
+            body.append('<Contents><Key>%s</Key><Size>%d</Size></Contents>' %
+                        (escape(key), size))
+        body.append('</ListBucketResult>')
+
+        self._send(200, ''.join(body).encode('utf-8'),
+                   {'Content-Type': 'application/xml'})
+
+    def _get_key(self, bucket, key):
+        path = os.path.join(root, bucket, *key.split('/'))
+        if not os.path.isfile(path):
+            self._send_error(404, 'NoSuchKey', 'The specified key does not exist.')
+            return
+
+        size = os.path.getsize(path)
+        first, last = 0, size - 1
+
+        code = 200
+        headers = {'Content-Type': 'application/octet-stream'}
+        byte_range = self.headers.get('Range')
+        if byte_range and byte_range.startswith('bytes='):
+            start, end = byte_range[len('bytes='):].split('-', 1)
+            first = int(start)
+            last = min(int(end), size - 1) if end else size - 1
+            if first > last:
+                self._send_error(416, 'InvalidRange',
+                                 'The requested range is not satisfiable')
+                return
+            code = 206
+            headers['Content-Range'] = 'bytes %d-%d/%d' % (first, last, size)
+
+        with open(path, 'rb') as f:
+            f.seek(first)
+            data = f.read(last - first + 1)
+
+        self._send(code, data, headers)
+
+    def _initiate_upload(self, bucket, key):
+        with stats_lock:
+            upload_count[0] += 1
+            upload_id = '%d%06d' % (int(time.time()), upload_count[0])
+        upload_dir = os.path.join(root, UPLOADS_DIR, upload_id)
+        os.makedirs(upload_dir)
+        with open(os.path.join(upload_dir, 'key'), 'w') as f:
+            f.write(key)
+
+        body = ('<?xml version="1.0" encoding="UTF-8"?>\n'
+                '<InitiateMultipartUploadResult xmlns="http://s3.amazonaws.com/doc/2006-03-01/">'
+                '<Bucket>%s</Bucket><Key>%s</Key><UploadId>%s</UploadId>'
+                '</InitiateMultipartUploadResult>' %
+                (escape(bucket), escape(key), upload_id)).encode('utf-8')
+        self._send(200, body, {'Content-Type': 'application/xml'})
+
+    def _upload_part(self, upload_id, part_number):
+        data = self._read_body()
+        upload_dir = self._upload_dir(upload_id)
+        if upload_dir is None:
+            self._send_error(404, 'NoSuchUpload', 'The specified upload does not exist.')
+            return
+
+        with open(os.path.join(upload_dir, 'part.%d' % part_number), 'wb') as f:
+            f.write(data)
+        self._send(200, b'', {'ETag': '"%d-%d"' % (part_number, len(data))})
+
+    def _complete_upload(self, bucket, upload_id):
+        body = self._read_body().decode('utf-8')
+        upload_dir = self._upload_dir(upload_id)
+        if upload_dir is None:
+            self._send_error(404, 'NoSuchUpload', 'The specified upload does not exist.')
+            return
+
+        with open(os.path.join(upload_dir, 'key')) as f:
+            key = f.read()
+        path = os.path.join(root, bucket, *key.split('/'))
+        if not os.path.isdir(os.path.dirname(path)):
+            os.makedirs(os.path.dirname(path))
+
+        # the parts listed, in the order listed
+        with open(path, 'wb') as out:
+            for part_number in re.findall(r'<PartNumber>([0-9]+)</PartNumber>', body):
+                part = os.path.join(upload_dir, 'part.%d' % int(part_number))
+                if not os.path.isfile(part):
+                    out.close()
+                    os.remove(path)
+                    self._send_error(400, 'InvalidPart', 'Part %s was not uploaded.' % part_number)
+                    return
+                with open(part, 'rb') as f:
+                    shutil.copyfileobj(f, out)
+        shutil.rmtree(upload_dir)
+
+        body = ('<?xml version="1.0" encoding="UTF-8"?>\n'
+                '<CompleteMultipartUploadResult xmlns="http://s3.amazonaws.com/doc/2006-03-01/">'
+                '<Bucket>%s</Bucket><Key>%s</Key></CompleteMultipartUploadResult>' %
+                (escape(bucket), escape(key))).encode('utf-8')
+        self._send(200, body, {'Content-Type': 'application/xml'})
+
+    def _abort_upload(self, upload_id):
+        upload_dir = self._upload_dir(upload_id)
+        if upload_dir is None:
+            self._send_error(404, 'NoSuchUpload', 'The specified upload does not exist.')
+            return
+
+        shutil.rmtree(upload_dir)
+        self._send(204, b'')
+
+    def _handle(self):
+        with stats_lock:
+            stats['requests'] += 1
+
+        if latency > 0:
+            time.sleep(latency)
+
+        bucket, key, query = self._split_path()
+        if not bucket or bucket == UPLOADS_DIR or not os.path.isdir(os.path.join(root, bucket)):
+            if self.command in ('PUT', 'POST'):
+                self._read_body()
+            self._send_error(404, 'NoSuchBucket', 'The specified bucket does not exist.')
+        elif self.command == 'POST' and key and 'uploads' in query:
+            self._read_body()
+            self._initiate_upload(bucket, key)
+        elif self.command == 'PUT' and key and 'uploadId' in query:
+            self._upload_part(query['uploadId'][0], int(query.get('partNumber', ['0'])[0]))
+        elif self.command == 'POST' and key and 'uploadId' in query:
+            self._complete_upload(bucket, query['uploadId'][0])
+        elif self.command == 'DELETE' and key and 'uploadId' in query:
+            self._abort_upload(query['uploadId'][0])
+        elif self.command in ('PUT', 'POST', 'DELETE'):
+            if self.command != 'DELETE':
+                self._read_body()
+            self._send_error(501, 'NotImplemented',
+                             'Only multipart uploads are supported for writing.')
+        elif not key:
+            self._list_bucket(bucket, query)
+        else:
+            self._get_key(bucket, key)
+
+    def do_GET(self):
+        self._handle()
+
+    def do_HEAD(self):
+        self._handle()
+
+    def do_PUT(self):
+        self._handle()
+
+    def do_POST(self):
+        self._handle()
+
+    def do_DELETE(self):
+        self._handle()
+
+
+class ThreadedHTTPServer(ThreadingMixIn, HTTPServer):
+    daemon_threads = True
+    # the default backlog of 5 delays the connects of the download threads
+    request_queue_size = 128
+
+
+def stop(signum, frame):
+    raise KeyboardInterrupt
+
+
+def run(port):
+    # background jobs of a shell ignore SIGINT, let SIGTERM stop it as well.
+    signal.signal(signal.SIGINT, stop)
+    signal.signal(signal.SIGTERM, stop)
+
+    httpd = ThreadedHTTPServer(('', port), MockS3Handler)
+    print('Starting mock S3 server on port %d, serving %s' % (port, root))
+    sys.stdout.flush()
+    try:
+        httpd.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    print('Served %d requests, %d bytes, received %d bytes' %
+          (stats['requests'], stats['bytes'], stats['uploaded']))
+
+
+if __name__ == "__main__":
+    port = 8555
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], "hvr:p:l:b:",
+                                   ["root=", "port=", "latency=", "bandwidth="])
+    except getopt.GetoptError:
+        print(help_msg)
+        sys.exit(2)
+    for opt, arg in opts:
+        if opt == '-h':
+            print(help_msg)
+            sys.exit(0)
+        elif opt == '-v':
+            verbose = True
+        elif opt in ("-r", "--root"):
+            root = arg
+        elif opt in ("-p", "--port"):
+            port = int(arg)
+        elif opt in ("-l", "--latency"):
+            latency = float(arg) / 1000
+        elif opt in ("-b", "--bandwidth"):
+            bandwidth = float(arg) * 1024 * 1024
+    if root is None or not os.path.isdir(root):
+        print(help_msg)
+        sys.exit(2)
+    run(port)
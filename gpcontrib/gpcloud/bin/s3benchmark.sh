@@ -0,0 +1,146 @@
+#!/bin/bash
+# Measure how fast gpcheckcloud downloads a bucket from, and uploads a file to
+# the mock S3 server, with different settings. Nothing but gpcheckcloud and
+# python is needed, see mockS3Server.py.
+#
+# usage: ./s3benchmark.sh [path to gpcheckcloud]
+#
+# KEYS files of KEY_SIZE bytes are downloaded, and a file of UPLOAD_SIZE
+# bytes is uploaded, every request to the mock server waits LATENCY
+# milliseconds and every connection is limited to BANDWIDTH MB/s.
+
+GPCHECKCLOUD=${1:-gpcheckcloud}
+PYTHON=${PYTHON:-python}
+PORT=${PORT:-8555}
+
+KEYS=${KEYS:-100}
+KEY_SIZE=${KEY_SIZE:-1048576}
+UPLOAD_SIZE=${UPLOAD_SIZE:-268435456}
+LATENCY=${LATENCY:-20}
+BANDWIDTH=${BANDWIDTH:-50}
+
+BUCKET="bench"
+BIN_DIR=$(cd $(dirname $0) && pwd)
+WORK_DIR=$(mktemp -d)
+
+# lines of 64 bytes, the last one cut short and completed by a newline
+function generate_file() {
+  awk -v size=$1 'BEGIN {
+      srand(1)
+      for (n = 0; n + 64 <= size; n += 64)
+          printf "%020d,%042d\n", n, int(rand() * 1000000)
+      if (n < size)
+          printf "%s\n", substr(sprintf("%020d,%042d", n, 0), 1, size - n - 1)
+  }' > $2
+}
+
+function create_data() {
+  echo "generating $KEYS keys of $KEY_SIZE bytes"
+  mkdir -p $WORK_DIR/$BUCKET/data
+  generate_file $KEY_SIZE $WORK_DIR/key
+
+  for i in `seq $KEYS`
+  do
+    cp $WORK_DIR/key $WORK_DIR/$BUCKET/data/key.$i
+  done
+  rm $WORK_DIR/key
+
+  echo "generating a file of $UPLOAD_SIZE bytes to upload"
+  generate_file $UPLOAD_SIZE $WORK_DIR/upload
+}
+
+server_Pid=
+function run_server() {
+  $PYTHON $BIN_DIR/mockS3Server.py -r $WORK_DIR -p $PORT -l $LATENCY -b $BANDWIDTH \
+      > $WORK_DIR/server.log &
+  server_Pid=$!
+  sleep 1
+}
+
+function write_config() {
+  cat > $WORK_DIR/s3.conf <<EOF
+[default]
+accessid = "mock"
+secret = "mock"
+encryption = false
+version = 2
+loglevel = ERROR
+EOF
+  for option in "$@"
+  do
+    echo "$option" >> $WORK_DIR/s3.conf
+  done
+}
+
+function report() {
+  echo "$3 $2 $4" | \
+      awk -v label="$1" '{ printf "%-55s %8.2f sec %8.2f MB/s\n", label, $1 - $2, $3 / ($1 - $2) / 1048576 }'
+}
+
+function bench() {
+  local label=$1
+  shift
+
+  write_config "$@"
+
+  local url="s3://127.0.0.1:$PORT/$BUCKET/data/ region=mock config=$WORK_DIR/s3.conf"
+  local start=`date +%s.%N`
+  local bytes=`$GPCHECKCLOUD -d "$url" | wc -c`
+  local end=`date +%s.%N`
+
+  if [ "$bytes" -ne $((KEYS * KEY_SIZE)) ]; then
+    echo "$label: downloaded $bytes bytes, expected $((KEYS * KEY_SIZE))"
+    return
+  fi
+
+  report "$label" $start $end $bytes
+}
+
+# The throughput is of the data before compression, as a writable external
+# table sees it.
+function bench_upload() {
+  local label=$1
+  shift
+
+  write_config "$@"
+  rm -rf "${WORK_DIR:?}/$BUCKET/upload"
+
+  local url="s3://127.0.0.1:$PORT/$BUCKET/upload/ region=mock config=$WORK_DIR/s3.conf"
+  local start=`date +%s.%N`
+  $GPCHECKCLOUD -u $WORK_DIR/upload "$url" > /dev/null
+  local end=`date +%s.%N`
+
+  local key=`find $WORK_DIR/$BUCKET/upload -type f 2> /dev/null`
+  local bytes=0
+  if [ -n "$key" ]; then
+    bytes=`gzip -dcf $key | wc -c`
+  fi
+  if [ "$bytes" -ne $UPLOAD_SIZE ]; then
+    echo "$label: uploaded $bytes bytes, expected $UPLOAD_SIZE"
+    return
+  fi
+
+  report "$label" $start $end $bytes
+}
+
+function _main() {
+  create_data
+  run_server
+
+  bench "threadnum = 4" "threadnum = 4" "chunksize = 8388608"
+  bench "threadnum = 8" "threadnum = 8" "chunksize = 8388608"
+  bench "threadnum = 8, prefetch_keys = 7" "threadnum = 8" "chunksize = 8388608" "prefetch_keys = 7"
+  bench "threadnum = 8, min_chunksize = 1MB" "threadnum = 8" "chunksize = 8388608" "min_chunksize = 1048576"
+  bench "threadnum = 8, prefetch_keys = 7, min_chunksize = 1MB" "threadnum = 8" "chunksize = 8388608" "prefetch_keys = 7" "min_chunksize = 1048576"
+
+  bench_upload "upload, autocompress = false" "threadnum = 4" "chunksize = 8388608" "autocompress = false"
+  bench_upload "upload, compress_threadnum = 1" "threadnum = 4" "chunksize = 8388608"
+  bench_upload "upload, compress_threadnum = 4" "threadnum = 4" "chunksize = 8388608" "compress_threadnum = 4"
+  bench_upload "upload, threadnum = 8, compress_threadnum = 4" "threadnum = 8" "chunksize = 8388608" "compress_threadnum = 4"
+
+  kill -15 $server_Pid
+  wait $server_Pid
+  rm -rf $WORK_DIR
+}
+
+_main
@@ -1,6 +1,8 @@
 #ifndef INCLUDE_COMPRESS_WRITER_H_
 #define INCLUDE_COMPRESS_WRITER_H_
 
+#include <deque>
+
 #include "s3common_headers.h"
 #include "s3exception.h"
 #include "s3macros.h"
@@ -9,6 +11,24 @@
 // 2MB by default
 extern uint64_t S3_ZIP_COMPRESS_CHUNKSIZE;
 
+// Size of the deflate window, a block compressed in parallel is primed with
+// the last this many bytes of the block before it.
+#define S3_DEFLATE_DICTIONARY_SIZE (32 * 1024)
+
+// A block of input compressed by one of the compress threads.
+struct CompressBlock {
+    CompressBlock() : crc(0), last(false), done(false) {
+    }
+
+    vector<Byte> in;
+    vector<Byte> dictionary;
+    vector<Byte> out;
+    uLong crc;  // crc32 of 'in'
+    bool last;  // the last block of the stream
+    bool done;
+    string error;
+};
+
 class CompressWriter : public Writer {
    public:
     CompressWriter();
@@ -30,6 +50,18 @@ class CompressWriter : public Writer {
     void flush();
     uint64_t writeOneChunk(const char *buf, uint64_t count);
 
+    // With more than one compress thread, the input is cut into blocks of
+    // S3_ZIP_COMPRESS_CHUNKSIZE bytes that are deflated in parallel, and
+    // written out in order as one gzip stream, like pigz does.
+    static void *CompressThreadFunc(void *p);
+    static void compressBlock(CompressBlock *block);
+
+    void startThreads();
+    void stopThreads();
+    void submitBlock(bool last);
+    void writeBlocks(uint64_t maxPending);
+    void closeParallel();
+
     Writer *writer;
 
     // zlib related variables.
@@ -38,6 +70,20 @@ class CompressWriter : public Writer {
 
     // add this flag to make close() reentrant
     bool isClosed;
+
+    uint64_t compressThreadNum;
+    vector<pthread_t> threadList;
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;  // signaled when a block is queued or compressed
+    bool stopping;
+
+    CompressBlock *curBlock;             // block being filled by write()
+    std::deque<CompressBlock *> queue;   // blocks waiting for a compress thread
+    std::deque<CompressBlock *> blocks;  // blocks submitted and not written yet, in order
+    vector<Byte> dictionary;             // tail of the last block submitted
+
+    uLong crc;         // crc32 of the input written out so far
+    uint64_t inTotal;  // length of the input written out so far
 };
 
 #endif
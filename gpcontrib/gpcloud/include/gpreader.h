@@ -38,6 +38,7 @@ class GPReader : public Reader {
     S3Params params;
     S3BucketReader bucketReader;
     S3CommonReader commonReader;
+    vector<std::unique_ptr<S3CommonReader>> prefetchReaders;
     S3RESTfulService restfulService;
 
     S3InterfaceService s3InterfaceService;
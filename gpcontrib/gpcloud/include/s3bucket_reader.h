@@ -1,6 +1,8 @@
 #ifndef __S3_BUCKET_READER__
 #define __S3_BUCKET_READER__
 
+#include <deque>
+
 #include "reader.h"
 #include "s3common_headers.h"
 #include "s3exception.h"
@@ -24,6 +26,11 @@ class S3BucketReader : public Reader {
         this->upstreamReader = reader;
     }
 
+    // Spare readers to open the keys following the current one with, one per key.
+    void setPrefetchReaders(const vector<Reader *> &readers) {
+        this->idleReaders = readers;
+    }
+
     const ListBucketResult &getKeyList() {
         return keyList;
     }
@@ -48,8 +55,26 @@ class S3BucketReader : public Reader {
     ListBucketResult keyList;  // List of matched keys/files.
     uint64_t keyIndex;         // BucketContent index of keylist->contents.
 
+    // A key opened ahead of the one being read.
+    struct PrefetchedKey {
+        PrefetchedKey(Reader *reader, uint64_t numOfChunks)
+            : reader(reader), numOfChunks(numOfChunks) {
+        }
+
+        Reader *reader;
+        uint64_t numOfChunks;
+    };
+
+    std::deque<PrefetchedKey> prefetchedKeys;  // in the order of keyList
+    vector<Reader *> idleReaders;              // prefetch readers not in use
+    uint64_t curNumOfChunks;                   // chunks(threads) of the key being read
+
     BucketContent &getNextKey();
+    uint64_t getNumOfChunks(const BucketContent &key);
     S3Params constructReaderParams(BucketContent &key);
+
+    bool openNextKey();
+    void prefetchKeys();
 };
 
 #endif
@@ -11,9 +11,15 @@ struct Range {
     uint64_t length;
 };
 
+// With adaptive chunk sizes, chunks are sized to take about this long to download: long enough
+// to make the latency of a request negligible, short enough not to leave a slow connection
+// holding a big share of the key.
+#define S3_ADAPTIVE_CHUNK_TARGET_USECS (2 * 1000 * 1000)
+
 class OffsetMgr {
    public:
-    OffsetMgr() : keySize(0), chunkSize(0), curPos(0) {
+    OffsetMgr()
+        : keySize(0), chunkSize(0), minChunkSize(0), maxChunkSize(0), curPos(0), throughput(0) {
         pthread_mutex_init(&this->offsetLock, NULL);
     }
     ~OffsetMgr() {
@@ -22,6 +28,25 @@ class OffsetMgr {
 
     Range getNextOffset();  // ret.length == 0 means EOF
 
+    // Let the chunk size vary between minChunkSize and maxChunkSize, starting at minChunkSize.
+    void setChunkSizeRange(uint64_t minChunkSize, uint64_t maxChunkSize) {
+        this->minChunkSize = minChunkSize;
+        this->maxChunkSize = maxChunkSize;
+        this->chunkSize = minChunkSize;
+        this->throughput = 0;
+    }
+
+    bool isAdaptive() const {
+        return minChunkSize != 0;
+    }
+
+    // Record that a chunk of len bytes took usecs to download.
+    void recordFetch(uint64_t len, uint64_t usecs);
+
+    uint64_t getThroughput() const {
+        return throughput;
+    }
+
     uint64_t getChunkSize() const {
         return chunkSize;
     }
@@ -46,6 +71,7 @@ class OffsetMgr {
         this->setCurPos(0);
         this->setChunkSize(0);
         this->setKeySize(0);
+        this->setChunkSizeRange(0, 0);
     }
 
     uint64_t getCurPos() const {
@@ -56,7 +82,10 @@ class OffsetMgr {
     pthread_mutex_t offsetLock;
     uint64_t keySize;  // size of S3 key(file)
     uint64_t chunkSize;
+    uint64_t minChunkSize;  // 0 if the chunk size is fixed
+    uint64_t maxChunkSize;
     uint64_t curPos;
+    uint64_t throughput;  // moving average of bytes per second of a connection
 };
 
 enum ChunkStatus {
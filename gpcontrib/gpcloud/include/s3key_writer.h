@@ -42,6 +42,7 @@ class S3KeyWriter : public Writer {
     static void* UploadThreadFunc(void* p);
 
     void flushBuffer();
+    void joinFinishedThreads();
     void completeKeyWriting();
     void checkQueryCancelSignal();
 
@@ -55,7 +56,10 @@ class S3KeyWriter : public Writer {
     string uploadId;
     map<uint64_t, string> etagList;
 
+    // Every full buffer is uploaded as a part by a thread of its own, at most
+    // numOfChunks of them at once.
     vector<pthread_t> threadList;
+    vector<pthread_t> finishedThreads;  // threads done uploading, not joined yet
     pthread_mutex_t mutex;
     pthread_cond_t cv;
     uint64_t partNumber;
@@ -14,7 +14,10 @@ class S3Params {
         : s3Url(sourceUrl, useHttps, version, region),
           keySize(0),
           chunkSize(0),
+          minChunkSize(0),
           numOfChunks(0),
+          prefetchKeys(0),
+          compressThreadNum(1),
           lowSpeedLimit(0),
           lowSpeedTime(0),
           proxy(""),
@@ -42,6 +45,14 @@ class S3Params {
         this->chunkSize = chunkSize;
     }
 
+    uint64_t getMinChunkSize() const {
+        return minChunkSize;
+    }
+
+    void setMinChunkSize(uint64_t minChunkSize) {
+        this->minChunkSize = minChunkSize;
+    }
+
     const S3Credential& getCred() const {
         return cred;
     }
@@ -64,6 +75,22 @@ class S3Params {
         this->numOfChunks = numOfChunks;
     }
 
+    uint64_t getPrefetchKeys() const {
+        return prefetchKeys;
+    }
+
+    void setPrefetchKeys(uint64_t prefetchKeys) {
+        this->prefetchKeys = prefetchKeys;
+    }
+
+    uint64_t getCompressThreadNum() const {
+        return compressThreadNum;
+    }
+
+    void setCompressThreadNum(uint64_t compressThreadNum) {
+        this->compressThreadNum = compressThreadNum;
+    }
+
     uint64_t getKeySize() const {
         return keySize;
     }
@@ -154,8 +181,12 @@ class S3Params {
 
     S3Credential cred;  // S3 credential.
 
-    uint64_t chunkSize;    // chunk size
-    uint64_t numOfChunks;  // number of chunks(threads).
+    uint64_t chunkSize;     // chunk size
+    uint64_t minChunkSize;  // lower bound of adaptive chunk size when reading.
+    uint64_t numOfChunks;   // number of chunks(threads).
+    uint64_t prefetchKeys;  // number of keys to open ahead when reading.
+
+    uint64_t compressThreadNum;  // number of threads compressing data before uploading.
 
     uint64_t lowSpeedLimit;  // low speed limit
     uint64_t lowSpeedTime;   // low speed timeout
@@ -2,8 +2,20 @@
 
 uint64_t S3_ZIP_COMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
 
-CompressWriter::CompressWriter() : writer(NULL), isClosed(true) {
+// gzip header of a stream without name, comment or modification time, see RFC 1952.
+static const Byte gzipHeader[] = {0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0x03};
+
+CompressWriter::CompressWriter()
+    : writer(NULL),
+      isClosed(true),
+      compressThreadNum(1),
+      stopping(false),
+      curBlock(NULL),
+      crc(0),
+      inTotal(0) {
     this->out = new char[S3_ZIP_COMPRESS_CHUNKSIZE];
+    pthread_mutex_init(&this->mutex, NULL);
+    pthread_cond_init(&this->cv, NULL);
 }
 
 CompressWriter::~CompressWriter() {
@@ -11,10 +23,35 @@ CompressWriter::~CompressWriter() {
         this->close();
     } catch (...) {
     }
+    this->stopThreads();
+
+    for (size_t i = 0; i < this->blocks.size(); i++) {
+        delete this->blocks[i];
+    }
+    delete this->curBlock;
+
+    pthread_mutex_destroy(&this->mutex);
+    pthread_cond_destroy(&this->cv);
     delete this->out;
 }
 
 void CompressWriter::open(const S3Params& params) {
+    this->compressThreadNum = params.getCompressThreadNum();
+    if (this->compressThreadNum > 1) {
+        this->crc = crc32(0L, Z_NULL, 0);
+        this->inTotal = 0;
+        this->dictionary.clear();
+        this->curBlock = new CompressBlock();
+        this->curBlock->in.reserve(S3_ZIP_COMPRESS_CHUNKSIZE);
+
+        this->writer->open(params);
+        this->writer->write((const char*)gzipHeader, sizeof(gzipHeader));
+
+        this->startThreads();
+        this->isClosed = false;
+        return;
+    }
+
     this->zstream.zalloc = Z_NULL;
     this->zstream.zfree = Z_NULL;
     this->zstream.opaque = Z_NULL;
@@ -74,6 +111,25 @@ uint64_t CompressWriter::write(const char* buf, uint64_t count) {
         return 0;
     }
 
+    if (this->compressThreadNum > 1) {
+        uint64_t offset = 0;
+        while (offset < count) {
+            uint64_t blockRemaining = S3_ZIP_COMPRESS_CHUNKSIZE - this->curBlock->in.size();
+            uint64_t dataRemaining = count - offset;
+            uint64_t dataToBlock = std::min(blockRemaining, dataRemaining);
+
+            this->curBlock->in.insert(this->curBlock->in.end(), buf + offset,
+                                      buf + offset + dataToBlock);
+            if (this->curBlock->in.size() == S3_ZIP_COMPRESS_CHUNKSIZE) {
+                this->submitBlock(false);
+            }
+
+            offset += dataToBlock;
+        }
+
+        return count;
+    }
+
     uint64_t writtenLen = 0;
 
     for (uint64_t i = 0; i < (count / S3_ZIP_COMPRESS_CHUNKSIZE); i++) {
@@ -92,6 +148,11 @@ void CompressWriter::close() {
         return;
     }
 
+    if (this->compressThreadNum > 1) {
+        this->closeParallel();
+        return;
+    }
+
     int status;
     do {
         status = deflate(&this->zstream, Z_FINISH);
@@ -123,3 +184,195 @@ void CompressWriter::flush() {
         this->zstream.avail_out = S3_ZIP_COMPRESS_CHUNKSIZE;
     }
 }
+
+void CompressWriter::startThreads() {
+    this->stopping = false;
+
+    for (uint64_t i = 0; i < this->compressThreadNum; i++) {
+        pthread_t compressThread;
+        int ret = pthread_create(&compressThread, NULL, CompressThreadFunc, this);
+        if (ret != 0) {
+            this->stopThreads();
+            S3_DIE(S3RuntimeError, "Failed to create compress thread: " + std::to_string(ret));
+        }
+        this->threadList.push_back(compressThread);
+    }
+}
+
+void CompressWriter::stopThreads() {
+    {
+        UniqueLock lock(&this->mutex);
+        this->stopping = true;
+        pthread_cond_broadcast(&this->cv);
+    }
+
+    for (size_t i = 0; i < this->threadList.size(); i++) {
+        pthread_join(this->threadList[i], NULL);
+    }
+    this->threadList.clear();
+}
+
+void* CompressWriter::CompressThreadFunc(void* p) {
+    MaskThreadSignals();
+
+    CompressWriter* compressWriter = (CompressWriter*)p;
+    while (true) {
+        CompressBlock* block;
+        {
+            UniqueLock lock(&compressWriter->mutex);
+            while (compressWriter->queue.empty() && !compressWriter->stopping) {
+                pthread_cond_wait(&compressWriter->cv, &compressWriter->mutex);
+            }
+            if (compressWriter->stopping) {
+                break;
+            }
+
+            block = compressWriter->queue.front();
+            compressWriter->queue.pop_front();
+        }
+
+        compressBlock(block);
+
+        UniqueLock lock(&compressWriter->mutex);
+        block->done = true;
+        pthread_cond_broadcast(&compressWriter->cv);
+    }
+
+    return NULL;
+}
+
+// Deflate a block into raw deflate data that continues the blocks before it: the window is
+// primed with their tail, and the data ends on a byte boundary (Z_SYNC_FLUSH), or with the
+// final deflate block (Z_FINISH) if this is the last one.
+void CompressWriter::compressBlock(CompressBlock* block) {
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree = Z_NULL;
+    zs.opaque = Z_NULL;
+
+    int status = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                              Z_DEFAULT_STRATEGY);
+    if (status != Z_OK) {
+        block->error = string("Failed to initialize zlib library: ") + (zs.msg ? zs.msg : "");
+        return;
+    }
+
+    if (!block->dictionary.empty()) {
+        deflateSetDictionary(&zs, block->dictionary.data(), block->dictionary.size());
+    }
+
+    block->crc = crc32(crc32(0L, Z_NULL, 0), block->in.data(), block->in.size());
+
+    zs.next_in = block->in.data();
+    zs.avail_in = block->in.size();
+
+    int flush = block->last ? Z_FINISH : Z_SYNC_FLUSH;
+    size_t outLen = 0;
+    block->out.resize(deflateBound(&zs, block->in.size()) + 16);
+    do {
+        if (outLen == block->out.size()) {
+            block->out.resize(outLen * 2);
+        }
+        zs.next_out = block->out.data() + outLen;
+        zs.avail_out = block->out.size() - outLen;
+
+        status = deflate(&zs, flush);
+        outLen = block->out.size() - zs.avail_out;
+    } while ((status == Z_OK || status == Z_BUF_ERROR) && zs.avail_out == 0);
+
+    if ((status < 0 && status != Z_BUF_ERROR) || (block->last && status != Z_STREAM_END)) {
+        block->error = string("Failed to compress data: ") +
+                       std::to_string((unsigned long long)status) + ", " + (zs.msg ? zs.msg : "");
+    }
+    block->out.resize(outLen);
+
+    deflateEnd(&zs);
+}
+
+void CompressWriter::submitBlock(bool last) {
+    CompressBlock* block = this->curBlock;
+    block->last = last;
+    block->dictionary = this->dictionary;
+
+    // keep the tail of the input for the next block
+    if (block->in.size() >= S3_DEFLATE_DICTIONARY_SIZE) {
+        this->dictionary.assign(block->in.end() - S3_DEFLATE_DICTIONARY_SIZE, block->in.end());
+    } else {
+        this->dictionary.insert(this->dictionary.end(), block->in.begin(), block->in.end());
+        if (this->dictionary.size() > S3_DEFLATE_DICTIONARY_SIZE) {
+            this->dictionary.erase(this->dictionary.begin(),
+                                   this->dictionary.end() - S3_DEFLATE_DICTIONARY_SIZE);
+        }
+    }
+
+    {
+        UniqueLock lock(&this->mutex);
+        this->queue.push_back(block);
+        this->blocks.push_back(block);
+        pthread_cond_broadcast(&this->cv);
+    }
+
+    if (last) {
+        this->curBlock = NULL;
+    } else {
+        this->curBlock = new CompressBlock();
+        this->curBlock->in.reserve(S3_ZIP_COMPRESS_CHUNKSIZE);
+    }
+
+    // Two blocks per thread in flight keep the threads busy while the blocks are written out in
+    // order, and bound the memory taken.
+    this->writeBlocks(2 * this->compressThreadNum - 1);
+}
+
+// Write out the compressed blocks at the head of the list, waiting for them until at most
+// maxPending blocks are left.
+void CompressWriter::writeBlocks(uint64_t maxPending) {
+    while (true) {
+        CompressBlock* block;
+        {
+            UniqueLock lock(&this->mutex);
+            if (this->blocks.empty()) {
+                return;
+            }
+
+            block = this->blocks.front();
+            while (!block->done && this->blocks.size() > maxPending) {
+                pthread_cond_wait(&this->cv, &this->mutex);
+            }
+            if (!block->done) {
+                return;
+            }
+
+            this->blocks.pop_front();
+        }
+
+        std::unique_ptr<CompressBlock> blockHolder(block);
+        S3_CHECK_OR_DIE(block->error.empty(), S3RuntimeError, block->error);
+
+        this->writer->write((const char*)block->out.data(), block->out.size());
+        this->crc = crc32_combine(this->crc, block->crc, block->in.size());
+        this->inTotal += block->in.size();
+    }
+}
+
+void CompressWriter::closeParallel() {
+    // a failed close() can not be retried, the blocks written out are gone.
+    this->isClosed = true;
+
+    this->submitBlock(true);
+    this->writeBlocks(0);
+    this->stopThreads();
+
+    // gzip trailer: crc32 and length of the input, both little endian
+    Byte trailer[8];
+    for (int i = 0; i < 4; i++) {
+        trailer[i] = (Byte)(this->crc >> (8 * i));
+        trailer[4 + i] = (Byte)(this->inTotal >> (8 * i));
+    }
+    this->writer->write((const char*)trailer, sizeof(trailer));
+
+    S3DEBUG("Compression finished: %" PRIu64 " bytes compressed by %" PRIu64 " threads.",
+            this->inTotal, this->compressThreadNum);
+
+    this->writer->close();
+}
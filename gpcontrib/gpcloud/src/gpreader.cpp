@@ -68,6 +68,16 @@ void GPReader::open(const S3Params& params) {
     this->bucketReader.setS3InterfaceService(&this->s3InterfaceService);
     this->bucketReader.setUpstreamReader(&this->commonReader);
     this->commonReader.setS3InterfaceService(&this->s3InterfaceService);
+
+    vector<Reader*> readers;
+    this->prefetchReaders.clear();
+    for (uint64_t i = 0; i < this->params.getPrefetchKeys(); i++) {
+        this->prefetchReaders.emplace_back(new S3CommonReader());
+        this->prefetchReaders.back()->setS3InterfaceService(&this->s3InterfaceService);
+        readers.push_back(this->prefetchReaders.back().get());
+    }
+    this->bucketReader.setPrefetchReaders(readers);
+
     this->bucketReader.open(this->params);
 }
 
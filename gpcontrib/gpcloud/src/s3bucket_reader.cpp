@@ -8,6 +8,8 @@ S3BucketReader::S3BucketReader() : Reader() {
 
     this->needNewReader = true;
     this->isFirstFile = true;
+
+    this->curNumOfChunks = 0;
 }
 
 S3BucketReader::~S3BucketReader() {
@@ -35,6 +37,26 @@ BucketContent& S3BucketReader::getNextKey() {
     return key;
 }
 
+// There is no point in downloading a key with more threads than it has chunks, leave the
+// rest to the keys opened ahead.
+uint64_t S3BucketReader::getNumOfChunks(const BucketContent& key) {
+    uint64_t numOfChunks = this->params.getNumOfChunks();
+
+    // the chunk size the key starts with
+    uint64_t chunkSize = this->params.getChunkSize();
+    if (this->params.getMinChunkSize() > 0 && this->params.getMinChunkSize() < chunkSize) {
+        chunkSize = this->params.getMinChunkSize();
+    }
+
+    if (chunkSize == 0) {
+        return numOfChunks;
+    }
+
+    uint64_t keyChunks = std::max((key.getSize() + chunkSize - 1) / chunkSize, (uint64_t)1);
+
+    return std::min(numOfChunks, keyChunks);
+}
+
 S3Params S3BucketReader::constructReaderParams(BucketContent& key) {
     // encode the key name but leave the "/"
     // "/encoded_path/encoded_name"
@@ -44,12 +66,64 @@ S3Params S3BucketReader::constructReaderParams(BucketContent& key) {
     S3Params readerParams = this->params.setPrefix(keyEncoded);
 
     readerParams.setKeySize(key.getSize());
+    readerParams.setNumOfChunks(this->getNumOfChunks(key));
 
     S3DEBUG("key: %s, size: %" PRIu64, readerParams.getS3Url().getFullUrlForCurl().c_str(),
             readerParams.getKeySize());
     return readerParams;
 }
 
+// Make the next key the one being read, return false if there is none left.
+bool S3BucketReader::openNextKey() {
+    if (!this->prefetchedKeys.empty()) {
+        this->idleReaders.push_back(this->upstreamReader);
+
+        this->upstreamReader = this->prefetchedKeys.front().reader;
+        this->curNumOfChunks = this->prefetchedKeys.front().numOfChunks;
+        this->prefetchedKeys.pop_front();
+        return true;
+    }
+
+    if (this->keyIndex >= this->keyList.contents.size()) {
+        return false;
+    }
+
+    S3Params readerParams = constructReaderParams(this->getNextKey());
+
+    this->upstreamReader->open(readerParams);
+    this->curNumOfChunks = readerParams.getNumOfChunks();
+    return true;
+}
+
+// Open the keys following the one being read, so that they are downloaded by the threads the
+// current key leaves idle, which is most of them in a bucket of small keys. A key is opened
+// ahead only if it gets all the threads it can use, and the threads of all open keys add up
+// to at most threadnum, which also bounds the memory of their chunk buffers.
+void S3BucketReader::prefetchKeys() {
+    uint64_t usedChunks = this->curNumOfChunks;
+    for (size_t i = 0; i < this->prefetchedKeys.size(); i++) {
+        usedChunks += this->prefetchedKeys[i].numOfChunks;
+    }
+
+    while (!this->idleReaders.empty() && this->keyIndex < this->keyList.contents.size()) {
+        uint64_t numOfChunks = this->getNumOfChunks(this->keyList.contents[this->keyIndex]);
+        if (usedChunks + numOfChunks > this->params.getNumOfChunks()) {
+            break;
+        }
+
+        S3Params readerParams = constructReaderParams(this->getNextKey());
+
+        Reader* reader = this->idleReaders.back();
+        this->idleReaders.pop_back();
+
+        // queue it first, so that close() cleans it up if open() fails.
+        this->prefetchedKeys.emplace_back(reader, numOfChunks);
+        reader->open(readerParams);
+
+        usedChunks += numOfChunks;
+    }
+}
+
 uint64_t S3BucketReader::readWithoutHeaderLine(char* buf, uint64_t count) {
     char* current = NULL;
     char* end = NULL;
@@ -98,15 +172,14 @@ uint64_t S3BucketReader::read(char* buf, uint64_t count) {
     uint64_t readCount = 0;
     while (true) {
         if (this->needNewReader) {
-            if (this->keyIndex >= this->keyList.contents.size()) {
+            if (!this->openNextKey()) {
                 S3DEBUG("Read finished for segment: %d", s3ext_segid);
                 return 0;
             }
-            BucketContent& key = this->getNextKey();
-
-            this->upstreamReader->open(constructReaderParams(key));
             this->needNewReader = false;
 
+            this->prefetchKeys();
+
             // ignore header line if it is not the first file
             if (hasHeader && !this->isFirstFile) {
                 readCount = readWithoutHeaderLine(buf, count);
@@ -134,6 +207,12 @@ void S3BucketReader::close() {
         this->upstreamReader = NULL;
     }
 
+    for (size_t i = 0; i < this->prefetchedKeys.size(); i++) {
+        this->prefetchedKeys[i].reader->close();
+    }
+    this->prefetchedKeys.clear();
+    this->idleReaders.clear();
+
     if (!this->keyList.contents.empty()) {
         this->keyList.contents.clear();
     }
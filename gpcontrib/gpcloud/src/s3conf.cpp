@@ -115,6 +115,16 @@ S3Params InitConfig(const string& urlWithOptions) {
                                        8 * 1024 * 1024, 128 * 1024 * 1024);
     params.setChunkSize(chunkSize);
 
+    // chunks downloaded are sized between min_chunksize and chunksize by the throughput
+    // observed, the default turns that off.
+    int64_t minChunkSize =
+        s3Cfg.SafeScan("min_chunksize", configSection, chunkSize, 1024 * 1024, chunkSize);
+    params.setMinChunkSize(minChunkSize);
+
+    // every key opened ahead takes at least one of the threads.
+    int64_t prefetchKeys = s3Cfg.SafeScan("prefetch_keys", configSection, 0, 0, numOfChunks - 1);
+    params.setPrefetchKeys(prefetchKeys);
+
     int64_t lowSpeedLimit = s3Cfg.SafeScan("low_speed_limit", configSection, 10240, 0, INT_MAX);
     params.setLowSpeedLimit(lowSpeedLimit);
 
@@ -125,6 +135,9 @@ S3Params InitConfig(const string& urlWithOptions) {
 
     params.setAutoCompress(s3Cfg.GetBool(configSection, "autocompress", "true"));
 
+    int64_t compressThreadNum = s3Cfg.SafeScan("compress_threadnum", configSection, 1, 1, 8);
+    params.setCompressThreadNum(compressThreadNum);
+
     params.setVerifyCert(s3Cfg.GetBool(configSection, "verifycert", "true"));
 
     string sse_type = s3Cfg.Get(configSection, "server_side_encryption", "");
@@ -1,5 +1,7 @@
 #include "s3key_reader.h"
 
+#include <chrono>
+
 // Return (offset, length) of next chunk to download,
 // or (fileSize, 0) if reach end of file.
 Range OffsetMgr::getNextOffset() {
@@ -20,6 +22,25 @@ Range OffsetMgr::getNextOffset() {
     return ret;
 }
 
+// Size the following chunks after the throughput of the connections, as measured by the
+// chunks downloaded so far. Chunks shorter than minChunkSize, like the tail of a key, are
+// dominated by the latency of the request and ignored.
+void OffsetMgr::recordFetch(uint64_t len, uint64_t usecs) {
+    if (!this->isAdaptive() || len < this->minChunkSize) {
+        return;
+    }
+
+    uint64_t rate = len * 1000000 / std::max(usecs, (uint64_t)1);
+
+    UniqueLock lock(&this->offsetLock);
+
+    // smooth out the jitter of single requests
+    this->throughput = (this->throughput == 0) ? rate : (this->throughput * 3 + rate) / 4;
+
+    uint64_t size = this->throughput * S3_ADAPTIVE_CHUNK_TARGET_USECS / 1000000;
+    this->chunkSize = std::min(std::max(size, this->minChunkSize), this->maxChunkSize);
+}
+
 ChunkBuffer::ChunkBuffer(const S3Url& s3Url, S3KeyReader& reader, const S3MemoryContext& context)
     : s3Url(s3Url), chunkData(context), offsetMgr(reader.getOffsetMgr()), sharedKeyReader(reader) {
     s3Interface = NULL;
@@ -119,12 +140,19 @@ uint64_t ChunkBuffer::fill() {
 
     if (leftLen != 0) {
         try {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
             readLen = this->s3Interface->fetchData(offset, this->chunkData, leftLen, this->s3Url);
             if (readLen != leftLen) {
                 S3DEBUG("Failed to fetch expected data from S3");
                 this->setSharedError(true, S3PartialResponseError(leftLen, readLen));
             } else {
-                S3DEBUG("Got %" PRIu64 " bytes from S3", readLen);
+                uint64_t usecs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now() - start)
+                                     .count();
+                this->offsetMgr.recordFetch(readLen, usecs);
+
+                S3DEBUG("Got %" PRIu64 " bytes from S3 in %" PRIu64 " us", readLen, usecs);
             }
         } catch (S3Exception& e) {
             S3DEBUG("Failed to fetch expected data from S3");
@@ -195,6 +223,11 @@ void S3KeyReader::open(const S3Params& params) {
     S3_CHECK_OR_DIE(params.getChunkSize() > 0, S3RuntimeError,
                     "chunk size must be greater than zero");
 
+    // Chunk buffers are preallocated with chunkSize, adaptive chunks may only be smaller.
+    if (params.getMinChunkSize() > 0 && params.getMinChunkSize() < params.getChunkSize()) {
+        this->offsetMgr.setChunkSizeRange(params.getMinChunkSize(), params.getChunkSize());
+    }
+
     this->chunkBuffers.reserve(this->numOfChunks);
 
     for (uint64_t i = 0; i < this->numOfChunks; i++) {
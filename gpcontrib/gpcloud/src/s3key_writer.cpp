@@ -60,6 +60,7 @@ void S3KeyWriter::checkQueryCancelSignal() {
             pthread_join(threadList[i], NULL);
         }
         this->threadList.clear();
+        this->finishedThreads.clear();
 
         // to avoid double unlock as other parts may lock it
         pthread_mutex_lock(&this->mutex);
@@ -88,21 +89,12 @@ void* S3KeyWriter::UploadThreadFunc(void* data) {
     ThreadParams* params = (ThreadParams*)data;
     S3KeyWriter* writer = params->keyWriter;
 
+    string etag;
     try {
         S3DEBUG("Upload thread start: %" PRIX64 ", part number: %" PRIu64 ", data size: %zu",
                 (uint64_t) pthread_self(), params->currentNumber, params->data.size());
-        string etag = writer->s3Interface->uploadPartOfData(
+        etag = writer->s3Interface->uploadPartOfData(
             params->data, writer->params.getS3Url(), params->currentNumber, writer->uploadId);
-
-        // when unique_lock destructs it will automatically unlock the mutex.
-        UniqueLock threadLock(&writer->mutex);
-
-        // etag is empty if the query is cancelled by user.
-        if (!etag.empty()) {
-            writer->etagList[params->currentNumber] = etag;
-        }
-        writer->activeThreads--;
-        pthread_cond_broadcast(&writer->cv);
         S3DEBUG("Upload part finish: %" PRIX64 ", eTag: %s, part number: %" PRIu64, (uint64_t) pthread_self(),
                 etag.c_str(), params->currentNumber);
     } catch (S3Exception& e) {
@@ -110,9 +102,20 @@ void* S3KeyWriter::UploadThreadFunc(void* data) {
         UniqueLock exceptLock(&writer->exceptionMutex);
         writer->sharedError = true;
         writer->sharedException = std::current_exception();
+    }
+
+    {
+        // when unique_lock destructs it will automatically unlock the mutex.
+        UniqueLock threadLock(&writer->mutex);
+
+        // etag is empty if the query is cancelled by user, or the upload failed.
+        if (!etag.empty()) {
+            writer->etagList[params->currentNumber] = etag;
+        }
 
         // notify the flushBuffer, otherwise it will be locked when trying to create a new thread.
         writer->activeThreads--;
+        writer->finishedThreads.push_back(pthread_self());
         pthread_cond_broadcast(&writer->cv);
     }
 
@@ -120,6 +123,22 @@ void* S3KeyWriter::UploadThreadFunc(void* data) {
     return NULL;
 }
 
+// Join the upload threads that have finished, must be called with the mutex held. A key can
+// have up to 10000 parts, so don't keep the finished threads around until the end.
+void S3KeyWriter::joinFinishedThreads() {
+    for (size_t i = 0; i < finishedThreads.size(); i++) {
+        pthread_join(finishedThreads[i], NULL);
+
+        for (size_t j = 0; j < threadList.size(); j++) {
+            if (pthread_equal(threadList[j], finishedThreads[i])) {
+                threadList.erase(threadList.begin() + j);
+                break;
+            }
+        }
+    }
+    finishedThreads.clear();
+}
+
 void S3KeyWriter::flushBuffer() {
     if (!this->buffer.empty()) {
         UniqueLock queueLock(&this->mutex);
@@ -131,6 +150,8 @@ void S3KeyWriter::flushBuffer() {
         // and clean up upload.
         this->checkQueryCancelSignal();
 
+        this->joinFinishedThreads();
+
         this->activeThreads++;
 
         pthread_t writerThread;
@@ -154,6 +175,7 @@ void S3KeyWriter::completeKeyWriting() {
         pthread_join(threadList[i], NULL);
     }
     this->threadList.clear();
+    this->finishedThreads.clear();
 
     this->checkQueryCancelSignal();
 
@@ -210,3 +210,103 @@ TEST_F(CompressWriterTest, CompressCompressedData) {
 
     EXPECT_TRUE(memcmp(compressedData.data(), result.get(), compressedData.size()) == 0);
 }
+
+class CompressWriterParallelTest : public testing::Test {
+   protected:
+    virtual void SetUp() {
+        S3Params params("s3://abc/def/");
+        params.setCompressThreadNum(4);
+
+        compressWriter.setWriter(&writer);
+        compressWriter.open(params);
+    }
+
+    virtual void TearDown() {
+        compressWriter.close();
+    }
+
+    // Uncompress the data written as one gzip stream, checking its crc32 and length.
+    void checkUncompress(const string &expected) {
+        z_stream zstream;
+        zstream.zalloc = Z_NULL;
+        zstream.zfree = Z_NULL;
+        zstream.opaque = Z_NULL;
+
+        ASSERT_EQ(Z_OK, inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS));
+
+        vector<Byte> result(expected.length() + 1);
+        zstream.next_in = (Byte *)writer.getRawData();
+        zstream.avail_in = writer.getDataSize();
+        zstream.next_out = result.data();
+        zstream.avail_out = result.size();
+
+        int ret = inflate(&zstream, Z_FINISH);
+        uint64_t resultLen = result.size() - zstream.avail_out;
+        uint64_t unused = zstream.avail_in;
+        inflateEnd(&zstream);
+
+        ASSERT_EQ(Z_STREAM_END, ret);
+        EXPECT_EQ((uint64_t)0, unused);
+        ASSERT_EQ(expected.length(), resultLen);
+        EXPECT_TRUE(memcmp(expected.data(), result.data(), resultLen) == 0);
+    }
+
+    CompressWriter compressWriter;
+    MockWriter writer;
+};
+
+TEST_F(CompressWriterParallelTest, AbleToCompressNothing) {
+    compressWriter.close();
+
+    this->checkUncompress("");
+}
+
+TEST_F(CompressWriterParallelTest, AbleToCompressOneSmallString) {
+    const string input = "The quick brown fox jumps over the lazy dog";
+
+    compressWriter.write(input.c_str(), input.length());
+    compressWriter.close();
+
+    const char *header = writer.getRawData();
+    ASSERT_TRUE(header[0] == char(0x1f));
+    ASSERT_TRUE(header[1] == char(0x8b));
+
+    this->checkUncompress(input);
+}
+
+TEST_F(CompressWriterParallelTest, AbleToCompressSeveralBlocksInOrder) {
+    std::default_random_engine re(1);
+
+    // numbered lines, so that blocks swapped or repeated are noticed, and some random bytes, so
+    // that the blocks compress at different speeds.
+    string input;
+    for (uint64_t i = 0; input.length() < S3_ZIP_COMPRESS_CHUNKSIZE * 10 + 12345; i++) {
+        input.append(std::to_string((unsigned long long)i));
+        input.append(i % 7 == 0 ? string(re() % 200, char(re())) : "\n");
+    }
+
+    // in pieces of odd sizes, so that they straddle the blocks
+    uint64_t offset = 0;
+    while (offset < input.length()) {
+        uint64_t len = std::min((uint64_t)re() % (S3_ZIP_COMPRESS_CHUNKSIZE / 3) + 1,
+                                (uint64_t)input.length() - offset);
+        ASSERT_EQ(len, compressWriter.write(input.data() + offset, len));
+        offset += len;
+    }
+    compressWriter.close();
+
+    // blocks see the data of the block before them, so it compresses about as well as one stream.
+    EXPECT_LT(writer.getDataSize(), input.length() / 2);
+
+    this->checkUncompress(input);
+}
+
+TEST_F(CompressWriterParallelTest, AbleToCompressMultipleOfBlockSize) {
+    string input(S3_ZIP_COMPRESS_CHUNKSIZE * 3, 'x');
+
+    compressWriter.write(input.c_str(), input.length());
+    compressWriter.close();
+    compressWriter.close();
+
+    this->checkUncompress(input);
+}
@@ -6,6 +6,7 @@
 using ::testing::_;
 using ::testing::AtLeast;
 using ::testing::Invoke;
+using ::testing::Property;
 using ::testing::Return;
 using ::testing::Throw;
 
@@ -45,6 +46,7 @@ class S3BucketReaderTest : public testing::Test {
 
     MockS3Interface s3Interface;
     MockS3Reader s3Reader;
+    MockS3Reader prefetchReader;
 };
 
 TEST_F(S3BucketReaderTest, OpenURL) {
@@ -169,6 +171,77 @@ TEST_F(S3BucketReaderTest, UpstreamReaderThrowException) {
     EXPECT_THROW(bucketReader->read(buf, sizeof(buf)), S3RuntimeError);
 }
 
+TEST_F(S3BucketReaderTest, ReadBucketWithPrefetchedKeys) {
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 100);
+    result.contents.emplace_back("bar", 100);
+    result.contents.emplace_back("baz", 100);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    // every key fits in one chunk, so the next one is opened with the other thread
+    EXPECT_CALL(s3Reader, open(Property(&S3Params::getNumOfChunks, 1))).Times(2);
+    EXPECT_CALL(prefetchReader, open(Property(&S3Params::getNumOfChunks, 1))).Times(1);
+
+    EXPECT_CALL(s3Reader, read(_, _))
+        .Times(4)
+        .WillOnce(Return(100))
+        .WillOnce(Return(0))
+        .WillOnce(Return(100))
+        .WillOnce(Return(0));
+    EXPECT_CALL(prefetchReader, read(_, _))
+        .Times(2)
+        .WillOnce(Return(100))
+        .WillOnce(Return(0));
+
+    s3ext_segid = 0;
+    s3ext_segnum = 1;
+    S3Params params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+    params.setNumOfChunks(2);
+    params.setChunkSize(1024);
+    bucketReader->open(params);
+    bucketReader->setUpstreamReader(&s3Reader);
+    bucketReader->setPrefetchReaders(vector<Reader*>(1, &prefetchReader));
+
+    EXPECT_EQ((uint64_t)100, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)100, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)100, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)0, bucketReader->read(buf, sizeof(buf)));
+}
+
+TEST_F(S3BucketReaderTest, ReadBucketWithKeyTooLargeToPrefetch) {
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 100);
+    result.contents.emplace_back("bar", 4096);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    // bar needs both threads, it waits for foo to finish
+    EXPECT_CALL(s3Reader, open(Property(&S3Params::getNumOfChunks, 1))).Times(1);
+    EXPECT_CALL(s3Reader, open(Property(&S3Params::getNumOfChunks, 2))).Times(1);
+    EXPECT_CALL(prefetchReader, open(_)).Times(0);
+
+    EXPECT_CALL(s3Reader, read(_, _))
+        .Times(4)
+        .WillOnce(Return(100))
+        .WillOnce(Return(0))
+        .WillOnce(Return(64))
+        .WillOnce(Return(0));
+
+    s3ext_segid = 0;
+    s3ext_segnum = 1;
+    S3Params params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+    params.setNumOfChunks(2);
+    params.setChunkSize(1024);
+    bucketReader->open(params);
+    bucketReader->setUpstreamReader(&s3Reader);
+    bucketReader->setPrefetchReaders(vector<Reader*>(1, &prefetchReader));
+
+    EXPECT_EQ((uint64_t)100, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)64, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)0, bucketReader->read(buf, sizeof(buf)));
+}
+
 class MockRead {
    public:
     MockRead(const char* ptr) : p(ptr) {
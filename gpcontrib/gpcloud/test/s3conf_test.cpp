@@ -19,6 +19,8 @@ TEST(Config, Basic) {
 
     EXPECT_EQ((uint64_t)6, params.getNumOfChunks());
     EXPECT_EQ((uint64_t)(64 * 1024 * 1024 + 1), params.getChunkSize());
+    EXPECT_EQ((uint64_t)(64 * 1024 * 1024 + 1), params.getMinChunkSize());
+    EXPECT_EQ((uint64_t)0, params.getPrefetchKeys());
 
     EXPECT_EQ(EXT_INFO, s3ext_loglevel);
     EXPECT_EQ(STDERR_LOG, s3ext_logtype);
@@ -34,6 +36,7 @@ TEST(Config, Basic) {
     EXPECT_EQ("", params.getProxy());
 
     EXPECT_TRUE(params.isAutoCompress());
+    EXPECT_EQ((uint64_t)1, params.getCompressThreadNum());
     EXPECT_TRUE(params.isVerifyCert());
 
     EXPECT_EQ(SSE_S3, params.getSSEType());
@@ -46,6 +49,9 @@ TEST(Config, SpecialSectionValues) {
 
     EXPECT_EQ((uint64_t)8, params.getNumOfChunks());
     EXPECT_EQ((uint64_t)(128 * 1024 * 1024), params.getChunkSize());
+    EXPECT_EQ((uint64_t)(128 * 1024 * 1024), params.getMinChunkSize());
+    EXPECT_EQ((uint64_t)7, params.getPrefetchKeys());
+    EXPECT_EQ((uint64_t)8, params.getCompressThreadNum());
 
     EXPECT_EQ((uint64_t)10240, params.getLowSpeedLimit());
     EXPECT_EQ((uint64_t)60, params.getLowSpeedTime());
@@ -59,6 +65,9 @@ TEST(Config, SpecialSectionLowValues) {
 
     EXPECT_EQ((uint64_t)1, params.getNumOfChunks());
     EXPECT_EQ((uint64_t)(8 * 1024 * 1024), params.getChunkSize());
+    EXPECT_EQ((uint64_t)(1024 * 1024), params.getMinChunkSize());
+    EXPECT_EQ((uint64_t)0, params.getPrefetchKeys());
+    EXPECT_EQ((uint64_t)1, params.getCompressThreadNum());
 }
 
 TEST(Config, SpecialSectionWrongKeyName) {
@@ -216,6 +216,81 @@ TEST(OffsetMgr, reset) {
     EXPECT_EQ((uint64_t)0, o.getCurPos());
 }
 
+TEST(OffsetMgr, AdaptiveChunkSizeStartsAtMin) {
+    OffsetMgr o;
+    o.setKeySize(4096);
+    o.setChunkSizeRange(100, 1000);
+
+    EXPECT_TRUE(o.isAdaptive());
+    EXPECT_EQ((uint64_t)100, o.getChunkSize());
+
+    Range r = o.getNextOffset();
+    EXPECT_EQ((uint64_t)0, r.offset);
+    EXPECT_EQ((uint64_t)100, r.length);
+}
+
+TEST(OffsetMgr, AdaptiveChunkSizeFollowsThroughput) {
+    OffsetMgr o;
+    o.setKeySize(1024 * 1024 * 1024);
+    o.setChunkSizeRange(1024 * 1024, 64 * 1024 * 1024);
+
+    // 1MB in 100ms, 10MB per second, i.e. 20MB for the target time.
+    o.recordFetch(1024 * 1024, 100 * 1000);
+    EXPECT_EQ((uint64_t)10 * 1024 * 1024, o.getThroughput());
+    EXPECT_EQ((uint64_t)20 * 1024 * 1024, o.getChunkSize());
+
+    Range r = o.getNextOffset();
+    EXPECT_EQ((uint64_t)0, r.offset);
+    EXPECT_EQ((uint64_t)20 * 1024 * 1024, r.length);
+
+    r = o.getNextOffset();
+    EXPECT_EQ((uint64_t)20 * 1024 * 1024, r.offset);
+
+    // a much faster fetch moves the average, and the chunk size up to its maximum.
+    o.recordFetch(20 * 1024 * 1024, 20 * 1000);
+    EXPECT_EQ((uint64_t)64 * 1024 * 1024, o.getChunkSize());
+
+    // a slow one moves it down, but no lower than the minimum.
+    for (int i = 0; i < 32; i++) {
+        o.recordFetch(1024 * 1024, 10 * 1000 * 1000);
+    }
+    EXPECT_EQ((uint64_t)1024 * 1024, o.getChunkSize());
+}
+
+TEST(OffsetMgr, AdaptiveChunkSizeIgnoresShortChunks) {
+    OffsetMgr o;
+    o.setKeySize(4096);
+    o.setChunkSizeRange(1000, 2000);
+
+    o.recordFetch(999, 1000 * 1000);
+    EXPECT_EQ((uint64_t)0, o.getThroughput());
+    EXPECT_EQ((uint64_t)1000, o.getChunkSize());
+}
+
+TEST(OffsetMgr, FixedChunkSizeIgnoresThroughput) {
+    OffsetMgr o;
+    o.setKeySize(4096);
+    o.setChunkSize(1000);
+
+    EXPECT_FALSE(o.isAdaptive());
+
+    o.recordFetch(1000, 1);
+    EXPECT_EQ((uint64_t)1000, o.getChunkSize());
+}
+
+TEST(OffsetMgr, ResetAdaptiveChunkSize) {
+    OffsetMgr o;
+    o.setKeySize(4096);
+    o.setChunkSizeRange(1000, 2000);
+    o.recordFetch(1000, 1000);
+
+    o.reset();
+
+    EXPECT_FALSE(o.isAdaptive());
+    EXPECT_EQ((uint64_t)0, o.getThroughput());
+    EXPECT_EQ((uint64_t)0, o.getChunkSize());
+}
+
 TEST_F(S3KeyReaderTest, OpenWithZeroChunk) {
     S3Params params("s3://abc/def");
 
@@ -504,6 +579,28 @@ TEST_F(S3KeyReaderTest, MTReadWith2Chunks) {
     EXPECT_EQ((uint64_t)0, this->read(buffer, 32));
 }
 
+TEST_F(S3KeyReaderTest, ReadWithAdaptiveChunkSize) {
+    S3Params params("s3://abc/def");
+
+    params.setNumOfChunks(1);
+    params.setKeySize(255);
+    params.setChunkSize(128);
+    params.setMinChunkSize(64);
+
+    // the first chunk is downloaded in no time, the next ones get the maximum size.
+    EXPECT_CALL(s3Interface, fetchData(0, _, 64, _)).WillOnce(Invoke(MockFetchData(64, 64)));
+    EXPECT_CALL(s3Interface, fetchData(64, _, 128, _)).WillOnce(Invoke(MockFetchData(128, 128)));
+    EXPECT_CALL(s3Interface, fetchData(192, _, 63, _)).WillOnce(Invoke(MockFetchData(63, 64)));
+
+    this->open(params);
+
+    EXPECT_EQ((uint64_t)64, this->read(buffer, 128));
+    EXPECT_EQ((uint64_t)128, this->read(buffer, 128));
+    EXPECT_EQ((uint64_t)63, this->read(buffer, 128));
+    EXPECT_EQ((uint64_t)1, this->read(buffer, 128));
+    EXPECT_EQ((uint64_t)0, this->read(buffer, 128));
+}
+
 TEST_F(S3KeyReaderTest, MTReadWithRedundantChunks) {
     S3Params params("s3://abc/def");
 
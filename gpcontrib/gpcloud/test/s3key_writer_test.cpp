@@ -186,3 +186,23 @@ TEST_F(S3KeyWriterTest, TestWriteAbortInClosing) {
     EXPECT_THROW(this->close(), S3QueryAbort);
     QueryCancelPending = false;
 }
+
+TEST_F(S3KeyWriterTest, TestManyPartsJoinFinishedThreads) {
+    testParams.setChunkSize(0x100);
+
+    char data[0x100 * 100];
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadid1"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, _, "uploadid1"))
+        .Times(100)
+        .WillRepeatedly(Invoke(MockUploadPartOfData(0x100)));
+    EXPECT_CALL(this->mockS3Interface, completeMultiPart(_, _, _)).WillOnce(Return(true));
+
+    this->open(testParams);
+    ASSERT_EQ(sizeof(data), this->write(data, sizeof(data)));
+
+    // the threads of the parts uploaded before are joined when a new one starts
+    EXPECT_GE(this->testParams.getNumOfChunks() + 1, this->threadList.size());
+
+    this->close();
+    EXPECT_TRUE(this->threadList.empty());
+}
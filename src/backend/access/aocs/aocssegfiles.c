@@ -442,6 +442,7 @@ GetAOCSSSegFilesTotals(Relation parentrel, Snapshot appendOnlyMetaDataSnapshot)
 			totals->totaltuples += allseg[s]->total_tupcount;
 		}
 		totals->totalvarblocks += allseg[s]->varblockcount;
+		totals->totalmodcount += allseg[s]->modcount;
 		totals->totalfilesegs++;
 	}
 
@@ -905,8 +905,8 @@ UpdateFileSegInfo_internal(Relation parentrel,
 /*
  * GetSegFilesTotals
  *
- * Get the total bytes, tuples, and varblocks for a specific AO table
- * from the pg_aoseg table on this local segdb.
+ * Get the total bytes, tuples, varblocks and modcount for a specific AO
+ * table from the pg_aoseg table on this local segdb.
  */
 FileSegTotals *
 GetSegFilesTotals(Relation parentrel, Snapshot appendOnlyMetaDataSnapshot)
@@ -921,6 +921,7 @@ GetSegFilesTotals(Relation parentrel, Snapshot appendOnlyMetaDataSnapshot)
 				eof_uncompressed,
 				tupcount,
 				varblockcount,
+				modcount,
 				state;
 	bool		isNull;
 
@@ -940,6 +941,9 @@ GetSegFilesTotals(Relation parentrel, Snapshot appendOnlyMetaDataSnapshot)
 		eof = fastgetattr(tuple, Anum_pg_aoseg_eof, pg_aoseg_dsc, &isNull);
 		tupcount = fastgetattr(tuple, Anum_pg_aoseg_tupcount, pg_aoseg_dsc, &isNull);
 		varblockcount = fastgetattr(tuple, Anum_pg_aoseg_varblockcount, pg_aoseg_dsc, &isNull);
+		modcount = fastgetattr(tuple, Anum_pg_aoseg_modcount, pg_aoseg_dsc, &isNull);
+		if (!isNull)
+			result->totalmodcount += DatumGetInt64(modcount);
 		eof_uncompressed = fastgetattr(tuple, Anum_pg_aoseg_eofuncompressed, pg_aoseg_dsc, &isNull);
 		state = fastgetattr(tuple, Anum_pg_aoseg_state, pg_aoseg_dsc, &isNull);
 
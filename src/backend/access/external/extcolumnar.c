@@ -0,0 +1,1185 @@
+/*-------------------------------------------------------------------------
+ *
+ * extcolumnar.c
+ *	  Reading and writing the columnar external table format.
+ *
+ * The text and CSV formats make every segment format each value as text
+ * on unload, and parse every line and value back on reload.  The columnar
+ * format instead carries batches of rows column by column, each value in
+ * the binary send/receive format of its type, see access/extcolumnar.h for
+ * the layout.  The reader hands the values straight to the receive
+ * functions, without copying them out of the block, and the writer emits
+ * the output of the send functions as is.
+ *
+ * A scan that needs only some of the columns tells the reader, which leaves
+ * the others alone.  The writer also records the minimum and maximum of the
+ * columns in every block, by which the reader skips the blocks that the
+ * simple quals of the scan rule out, without decompressing them.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/access/external/extcolumnar.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
+#include "access/extcolumnar.h"
+#include "access/nbtree.h"
+#include "access/transam.h"
+#include "commands/defrem.h"
+#include "nodes/primnodes.h"
+#include "utils/builtins.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/typcache.h"
+
+typedef struct ExtColumnarColumn
+{
+	AttrNumber	attnum;			/* 0-based index into the tuple descriptor */
+	Oid			typid;
+	int32		typmod;
+	Oid			typioparam;
+	FmgrInfo	func;			/* receive or send function */
+
+	/* reader: the values of this column in the current block */
+	char	   *cursor;
+	char	   *end;
+	bool		skip;			/* not needed by the scan */
+
+	/* writer: the values of this column added since the last flush */
+	StringInfoData buf;
+
+	/* writer: their minimum and maximum, if the type has a btree ordering */
+	FmgrInfo   *cmp;
+	bool		typbyval;
+	int16		typlen;
+	bool		hasminmax;
+	Datum		min;
+	Datum		max;
+} ExtColumnarColumn;
+
+/*
+ * A qual of the form "column op constant", with op a btree operator of the
+ * type of the column, that can rule out blocks by the statistics of the
+ * column.
+ */
+typedef struct ExtColumnarFilter
+{
+	int			column;			/* index into the columns array */
+	StrategyNumber strategy;	/* of op, as if the column were on its left */
+	bool		varonleft;		/* as written, for the order of cmp's args */
+	FmgrInfo	cmp;			/* btree comparison of the column and constant */
+	Datum		value;
+} ExtColumnarFilter;
+
+struct ExtColumnarReader
+{
+	MemoryContext mcxt;
+	TupleDesc	tupdesc;
+	int			ncolumns;		/* number of columns that are not dropped */
+	ExtColumnarColumn *columns;
+
+	/* data received but not decoded yet, starting at input.cursor */
+	StringInfoData input;
+
+	/* payload of a compressed block, decompressed */
+	char	   *rawbuf;
+	uint32		rawbufsize;
+
+	List	   *filters;		/* ExtColumnarFilters to skip blocks by */
+	MemoryContext statcxt;		/* for the statistics of a block */
+
+	uint32		nrows;			/* number of rows in the current block */
+	uint32		currow;			/* next row to decode in it */
+	uint64		rowsread;		/* rows started so far, for error messages */
+	uint64		blocksread;		/* blocks loaded, skipped ones included */
+	uint64		blocksskipped;	/* blocks passed over by the filters */
+	uint64		bytesskipped;	/* and their size */
+	int			curcol;			/* column being decoded, or -1 */
+};
+
+struct ExtColumnarWriter
+{
+	MemoryContext mcxt;
+	MemoryContext rowcxt;		/* for the results of the send functions */
+	int			ncolumns;
+	ExtColumnarColumn *columns;
+
+	int			block_size;
+	bool		compress;
+	bool		statistics;		/* record the minimum and maximum of columns */
+	MemoryContext statcxt;		/* for the minimums and maximums */
+
+	uint32		nrows;			/* rows added since the last flush */
+	int			datasize;		/* total size of their values */
+};
+
+static int
+live_columns(TupleDesc tupdesc, ExtColumnarColumn **columns)
+{
+	int			ncolumns = 0;
+	int			i;
+
+	*columns = palloc0(sizeof(ExtColumnarColumn) * tupdesc->natts);
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[i];
+		ExtColumnarColumn *column;
+
+		if (attr->attisdropped)
+			continue;
+
+		column = &(*columns)[ncolumns++];
+		column->attnum = i;
+		column->typid = attr->atttypid;
+		column->typmod = attr->atttypmod;
+	}
+
+	return ncolumns;
+}
+
+static void
+put_uint32(StringInfo buf, uint32 i)
+{
+	unsigned char b[4];
+
+	b[0] = (unsigned char) (i >> 24);
+	b[1] = (unsigned char) (i >> 16);
+	b[2] = (unsigned char) (i >> 8);
+	b[3] = (unsigned char) i;
+	appendBinaryStringInfo(buf, (char *) b, 4);
+}
+
+static void
+put_uint16(StringInfo buf, uint16 i)
+{
+	unsigned char b[2];
+
+	b[0] = (unsigned char) (i >> 8);
+	b[1] = (unsigned char) i;
+	appendBinaryStringInfo(buf, (char *) b, 2);
+}
+
+/*
+ * extcolumnar_parse_options
+ *		Validate the FORMAT options of a columnar external table.
+ *
+ * block_size is the size a writer lets the values of a block grow to before
+ * sending it, compression is 'zstd' or 'none', and statistics tells whether
+ * to record the minimum and maximum of the columns in each block.  Readers
+ * take all of them from the blocks themselves.
+ */
+void
+extcolumnar_parse_options(List *options, int *block_size, bool *compress,
+						  bool *statistics)
+{
+	ListCell   *lc;
+
+	*block_size = EXTCOLUMNAR_DEFAULT_BLOCK_SIZE;
+	*compress = false;
+	*statistics = true;
+
+	foreach(lc, options)
+	{
+		DefElem    *defel = (DefElem *) lfirst(lc);
+		char	   *val = defGetString(defel);
+
+		if (strcmp(defel->defname, "block_size") == 0)
+		{
+			char	   *endptr;
+			long		size;
+
+			errno = 0;
+			size = strtol(val, &endptr, 10);
+			if (errno != 0 || *endptr != '\0' ||
+				size < 1 || size > EXTCOLUMNAR_MAX_BLOCK_SIZE)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("block_size must be between 1 and %d bytes",
+								EXTCOLUMNAR_MAX_BLOCK_SIZE)));
+			*block_size = (int) size;
+		}
+		else if (strcmp(defel->defname, "statistics") == 0)
+			*statistics = defGetBoolean(defel);
+		else if (strcmp(defel->defname, "compression") == 0)
+		{
+			if (pg_strcasecmp(val, "zstd") == 0)
+			{
+#ifndef HAVE_LIBZSTD
+				ereport(ERROR,
+						(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+						 errmsg("zstd compression is not supported by this build")));
+#endif
+				*compress = true;
+			}
+			else if (pg_strcasecmp(val, "none") == 0)
+				*compress = false;
+			else
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("unrecognized compression \"%s\" for columnar format", val),
+						 errhint("Valid values are \"zstd\" and \"none\".")));
+		}
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_SYNTAX_ERROR),
+					 errmsg("option \"%s\" not recognized for columnar format",
+							defel->defname)));
+	}
+}
+
+/*
+ * extcolumnar_begin_read
+ *		Prepare to decode rows of the given descriptor.
+ */
+ExtColumnarReader *
+extcolumnar_begin_read(TupleDesc tupdesc)
+{
+	ExtColumnarReader *reader;
+	int			i;
+
+	reader = palloc0(sizeof(ExtColumnarReader));
+	reader->mcxt = CurrentMemoryContext;
+	reader->tupdesc = tupdesc;
+	reader->ncolumns = live_columns(tupdesc, &reader->columns);
+	for (i = 0; i < reader->ncolumns; i++)
+	{
+		ExtColumnarColumn *column = &reader->columns[i];
+		Oid			recv_func;
+
+		getTypeBinaryInputInfo(column->typid, &recv_func, &column->typioparam);
+		fmgr_info(recv_func, &column->func);
+	}
+	initStringInfo(&reader->input);
+	reader->curcol = -1;
+	reader->statcxt = AllocSetContextCreate(CurrentMemoryContext,
+											"ExtColumnarStatCxt",
+											ALLOCSET_SMALL_MINSIZE,
+											ALLOCSET_SMALL_INITSIZE,
+											ALLOCSET_SMALL_MAXSIZE);
+
+	return reader;
+}
+
+/*
+ * extcolumnar_set_projection
+ *		Tell the reader which columns the scan needs.
+ *
+ * proj has an entry for every attribute of the descriptor, the columns that
+ * are not needed read as NULL.
+ */
+void
+extcolumnar_set_projection(ExtColumnarReader *reader, bool *proj)
+{
+	int			i;
+
+	for (i = 0; i < reader->ncolumns; i++)
+	{
+		ExtColumnarColumn *column = &reader->columns[i];
+
+		column->skip = (proj != NULL && !proj[column->attnum]);
+	}
+}
+
+/*
+ * Make a filter out of a qual, if it compares a column with a constant by a
+ * btree operator of the type of the column.  Types with collations are left
+ * out, as the data may have been sorted by another one.
+ */
+static ExtColumnarFilter *
+make_filter(ExtColumnarReader *reader, Expr *qual)
+{
+	OpExpr	   *op;
+	Node	   *left;
+	Node	   *right;
+	Var		   *var;
+	Const	   *con;
+	bool		varonleft;
+	ExtColumnarColumn *column = NULL;
+	int			colidx;
+	TypeCacheEntry *typentry;
+	int			strategy;
+	Oid			lefttype;
+	Oid			righttype;
+	Oid			cmpproc;
+	ExtColumnarFilter *filter;
+
+	if (!IsA(qual, OpExpr))
+		return NULL;
+	op = (OpExpr *) qual;
+	if (list_length(op->args) != 2)
+		return NULL;
+
+	left = (Node *) linitial(op->args);
+	right = (Node *) lsecond(op->args);
+	if (left && IsA(left, RelabelType))
+		left = (Node *) ((RelabelType *) left)->arg;
+	if (right && IsA(right, RelabelType))
+		right = (Node *) ((RelabelType *) right)->arg;
+
+	if (IsA(left, Var) && IsA(right, Const))
+	{
+		var = (Var *) left;
+		con = (Const *) right;
+		varonleft = true;
+	}
+	else if (IsA(left, Const) && IsA(right, Var))
+	{
+		var = (Var *) right;
+		con = (Const *) left;
+		varonleft = false;
+	}
+	else
+		return NULL;
+
+	if (IS_SPECIAL_VARNO(var->varno) || var->varlevelsup != 0 ||
+		var->varattno <= 0 || con->constisnull)
+		return NULL;
+
+	for (colidx = 0; colidx < reader->ncolumns; colidx++)
+	{
+		if (reader->columns[colidx].attnum == var->varattno - 1)
+		{
+			column = &reader->columns[colidx];
+			break;
+		}
+	}
+	if (column == NULL || var->vartype != column->typid ||
+		type_is_collatable(column->typid) || type_is_rowtype(column->typid))
+		return NULL;
+
+	typentry = lookup_type_cache(column->typid, TYPECACHE_BTREE_OPFAMILY);
+	if (!OidIsValid(typentry->btree_opf) ||
+		!op_in_opfamily(op->opno, typentry->btree_opf))
+		return NULL;
+
+	get_op_opfamily_properties(op->opno, typentry->btree_opf, false,
+							   &strategy, &lefttype, &righttype);
+	if ((varonleft ? lefttype : righttype) != column->typid ||
+		(varonleft ? righttype : lefttype) != con->consttype)
+		return NULL;
+	cmpproc = get_opfamily_proc(typentry->btree_opf, lefttype, righttype,
+								BTORDER_PROC);
+	if (!OidIsValid(cmpproc))
+		return NULL;
+
+	filter = palloc0(sizeof(ExtColumnarFilter));
+	filter->column = colidx;
+	filter->strategy = varonleft ? strategy : BTCommuteStrategyNumber(strategy);
+	filter->varonleft = varonleft;
+	fmgr_info(cmpproc, &filter->cmp);
+	filter->value = datumCopy(con->constvalue, con->constbyval, con->constlen);
+
+	return filter;
+}
+
+/*
+ * extcolumnar_set_filter
+ *		Let the reader skip the blocks in which no row can pass the quals.
+ *
+ * quals is an implicitly ANDed list of expressions, that the caller still
+ * checks each row against.  Only the ones the statistics can decide are
+ * used.
+ */
+void
+extcolumnar_set_filter(ExtColumnarReader *reader, List *quals)
+{
+	MemoryContext oldcontext = MemoryContextSwitchTo(reader->mcxt);
+	ListCell   *lc;
+
+	list_free_deep(reader->filters);
+	reader->filters = NIL;
+	foreach(lc, quals)
+	{
+		ExtColumnarFilter *filter = make_filter(reader, (Expr *) lfirst(lc));
+
+		if (filter)
+			reader->filters = lappend(reader->filters, filter);
+	}
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * extcolumnar_add_data
+ *		Feed more input to the reader.
+ *
+ * Only to be called after extcolumnar_next_row() ran out of rows, the data of
+ * the block being decoded must stay where it is until then.
+ */
+void
+extcolumnar_add_data(ExtColumnarReader *reader, const char *data, int len)
+{
+	MemoryContext oldcontext = MemoryContextSwitchTo(reader->mcxt);
+
+	Assert(reader->currow == reader->nrows);
+	appendBinaryStringInfo(&reader->input, data, len);
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/*
+ * Call the receive function of the column on the len bytes at data.
+ */
+static Datum
+receive_value(ExtColumnarColumn *column, char *data, int32 len)
+{
+	StringInfoData buf;
+	char		csave;
+	Datum		value;
+
+	/*
+	 * Let the receive function work on the value where it is.  Like
+	 * array_recv() does for its elements, terminate it for the time being, as
+	 * StringInfos are expected to be.  There is always a byte to spare after
+	 * the value.
+	 */
+	buf.data = data;
+	buf.len = len;
+	buf.maxlen = len + 1;
+	buf.cursor = 0;
+	csave = buf.data[len];
+	buf.data[len] = '\0';
+
+	value = ReceiveFunctionCall(&column->func, &buf, column->typioparam,
+								column->typmod);
+	buf.data[len] = csave;
+
+	if (buf.cursor != len)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+				 errmsg("incorrect binary data format")));
+
+	return value;
+}
+
+/*
+ * Compare a minimum or maximum of a block with the constant of a filter, the
+ * result is as for "stat cmp constant".
+ */
+static int
+compare_stat(ExtColumnarFilter *filter, Datum stat)
+{
+	int32		result;
+
+	if (filter->varonleft)
+		return DatumGetInt32(FunctionCall2(&filter->cmp, stat, filter->value));
+
+	result = DatumGetInt32(FunctionCall2(&filter->cmp, filter->value, stat));
+	return (result > 0) ? -1 : (result < 0) ? 1 : 0;
+}
+
+/*
+ * Can any row of a block pass the filters, by the statistics of the block?
+ */
+static bool
+block_may_match(ExtColumnarReader *reader, char *stats, uint32 statslen)
+{
+	MemoryContext oldcontext;
+	char	   *p = stats;
+	char	   *end = stats + statslen;
+	char	  **mins;
+	char	  **maxs;
+	int32	   *minlens;
+	int32	   *maxlens;
+	ListCell   *lc;
+	bool		result = true;
+	int			i;
+
+	MemoryContextReset(reader->statcxt);
+	oldcontext = MemoryContextSwitchTo(reader->statcxt);
+
+	mins = palloc(sizeof(char *) * reader->ncolumns);
+	maxs = palloc(sizeof(char *) * reader->ncolumns);
+	minlens = palloc(sizeof(int32) * reader->ncolumns);
+	maxlens = palloc(sizeof(int32) * reader->ncolumns);
+	for (i = 0; i < reader->ncolumns; i++)
+	{
+		if (end - p < 4)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("columnar block ends in the middle of its statistics")));
+		minlens[i] = (int32) extcolumnar_get_uint32(p);
+		p += 4;
+		if (minlens[i] == -1)
+			continue;
+		if (minlens[i] < 0 || end - p < minlens[i] + 4)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("columnar block ends in the middle of its statistics")));
+		mins[i] = p;
+		p += minlens[i];
+
+		maxlens[i] = (int32) extcolumnar_get_uint32(p);
+		p += 4;
+		if (maxlens[i] < 0 || end - p < maxlens[i])
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("columnar block ends in the middle of its statistics")));
+		maxs[i] = p;
+		p += maxlens[i];
+	}
+	if (p != end)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("extra data after the statistics of columnar block")));
+
+	foreach(lc, reader->filters)
+	{
+		ExtColumnarFilter *filter = (ExtColumnarFilter *) lfirst(lc);
+		ExtColumnarColumn *column = &reader->columns[filter->column];
+		Datum		min;
+		Datum		max;
+
+		if (minlens[filter->column] == -1)
+			continue;
+		min = receive_value(column, mins[filter->column], minlens[filter->column]);
+		max = receive_value(column, maxs[filter->column], maxlens[filter->column]);
+
+		switch (filter->strategy)
+		{
+			case BTLessStrategyNumber:
+				result = compare_stat(filter, min) < 0;
+				break;
+			case BTLessEqualStrategyNumber:
+				result = compare_stat(filter, min) <= 0;
+				break;
+			case BTEqualStrategyNumber:
+				result = compare_stat(filter, min) <= 0 &&
+					compare_stat(filter, max) >= 0;
+				break;
+			case BTGreaterEqualStrategyNumber:
+				result = compare_stat(filter, max) >= 0;
+				break;
+			case BTGreaterStrategyNumber:
+				result = compare_stat(filter, max) > 0;
+				break;
+		}
+		if (!result)
+			break;
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+	MemoryContextReset(reader->statcxt);
+
+	return result;
+}
+
+/*
+ * Check that the rows of the current block used up the values of every
+ * column, walking over the columns that were not decoded, and forget the
+ * block.
+ */
+static void
+finish_block(ExtColumnarReader *reader)
+{
+	int			i;
+
+	for (i = 0; i < reader->ncolumns; i++)
+	{
+		ExtColumnarColumn *column = &reader->columns[i];
+
+		if (column->skip)
+		{
+			uint32		row;
+
+			for (row = 0; row < reader->nrows; row++)
+			{
+				int32		len;
+
+				if (column->end - column->cursor < 4)
+					ereport(ERROR,
+							(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+							 errmsg("missing value in columnar block")));
+				len = (int32) extcolumnar_get_uint32(column->cursor);
+				column->cursor += 4;
+				if (len == -1)
+					continue;
+				if (len < 0 || column->end - column->cursor < len)
+					ereport(ERROR,
+							(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+							 errmsg("invalid value length %d in columnar block", len)));
+				column->cursor += len;
+			}
+		}
+		if (column->cursor != column->end)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("extra data after the last row of column %d in columnar block",
+							i + 1)));
+		column->cursor = NULL;
+		column->end = NULL;
+	}
+	reader->nrows = 0;
+	reader->currow = 0;
+}
+
+/*
+ * Load the next block from the input, if all of it is there.
+ *
+ * A block that the filters rule out is passed over, leaving no rows to decode.
+ */
+static bool
+load_block(ExtColumnarReader *reader)
+{
+	StringInfo	input = &reader->input;
+	ExtColumnarBlockHeader hdr;
+	char	   *payload;
+	uint32		datalen;
+	char	   *p;
+	char	   *end;
+	int			i;
+
+	/* get rid of the blocks decoded so far */
+	if (input->cursor > 0)
+	{
+		input->len -= input->cursor;
+		memmove(input->data, input->data + input->cursor, input->len);
+		input->data[input->len] = '\0';
+		input->cursor = 0;
+	}
+
+	if (input->len < EXTCOLUMNAR_HEADER_SIZE)
+		return false;
+
+	if (!extcolumnar_read_header(input->data, &hdr))
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("invalid columnar block header")));
+	if ((hdr.flags & ~EXTCOLUMNAR_KNOWN_FLAGS) != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("unrecognized flags 0x%04x in columnar block header",
+						hdr.flags)));
+	if (hdr.datalen >= MaxAllocSize || hdr.rawlen >= MaxAllocSize)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("columnar block of %u bytes is too large",
+						Max(hdr.datalen, hdr.rawlen))));
+	if (hdr.ncolumns != reader->ncolumns)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("columnar block has %d columns, expected %d",
+						hdr.ncolumns, reader->ncolumns)));
+
+	if (input->len - EXTCOLUMNAR_HEADER_SIZE < (int64) hdr.datalen)
+		return false;
+
+	payload = input->data + EXTCOLUMNAR_HEADER_SIZE;
+	datalen = hdr.datalen;
+	if (hdr.flags & EXTCOLUMNAR_FLAG_STATS)
+	{
+		uint32		statslen;
+
+		if (datalen < 4 || (statslen = extcolumnar_get_uint32(payload)) > datalen - 4)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("invalid length of columnar block statistics")));
+
+		if (reader->filters != NIL &&
+			!block_may_match(reader, payload + 4, statslen))
+		{
+			reader->blocksread++;
+			reader->blocksskipped++;
+			reader->bytesskipped += EXTCOLUMNAR_HEADER_SIZE + hdr.datalen;
+			reader->nrows = 0;
+			reader->currow = 0;
+			input->cursor = EXTCOLUMNAR_HEADER_SIZE + hdr.datalen;
+			return true;
+		}
+
+		payload += 4 + statslen;
+		datalen -= 4 + statslen;
+	}
+
+	if (hdr.flags & EXTCOLUMNAR_FLAG_ZSTD)
+	{
+#ifdef HAVE_LIBZSTD
+		size_t		rawlen;
+
+		/* one more byte for the receive functions, see next_row() */
+		if (reader->rawbufsize < hdr.rawlen + 1)
+		{
+			if (reader->rawbuf)
+				pfree(reader->rawbuf);
+			reader->rawbufsize = hdr.rawlen + 1;
+			reader->rawbuf = MemoryContextAlloc(reader->mcxt, reader->rawbufsize);
+		}
+		rawlen = ZSTD_decompress(reader->rawbuf, hdr.rawlen, payload, datalen);
+		if (ZSTD_isError(rawlen))
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("could not decompress columnar block: %s",
+							ZSTD_getErrorName(rawlen))));
+		if (rawlen != hdr.rawlen)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("columnar block decompressed to %u bytes, expected %u",
+							(uint32) rawlen, hdr.rawlen)));
+		payload = reader->rawbuf;
+#else
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("columnar block is compressed with zstd, which is not supported by this build")));
+#endif
+	}
+	else if (hdr.rawlen != datalen)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("invalid length of uncompressed columnar block")));
+
+	/* find the values of each column */
+	p = payload;
+	end = payload + hdr.rawlen;
+	for (i = 0; i < reader->ncolumns; i++)
+	{
+		ExtColumnarColumn *column = &reader->columns[i];
+		Oid			typid;
+		uint32		len;
+
+		if (end - p < 8)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("columnar block ends in the middle of a column header")));
+		typid = extcolumnar_get_uint32(p);
+		len = extcolumnar_get_uint32(p + 4);
+		p += 8;
+		if (end - p < (int64) len)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("columnar block ends in the middle of column %d", i + 1)));
+
+		/*
+		 * User-defined types may have other OIDs in the cluster that wrote
+		 * the data, so only insist on a match for built-in types.
+		 */
+		if (typid != column->typid &&
+			(typid < FirstNormalObjectId || column->typid < FirstNormalObjectId))
+			ereport(ERROR,
+					(errcode(ERRCODE_DATATYPE_MISMATCH),
+					 errmsg("column \"%s\" is of type %s in the table, but of type OID %u in the data",
+							NameStr(reader->tupdesc->attrs[column->attnum]->attname),
+							format_type_be(column->typid), typid)));
+
+		column->cursor = p;
+		column->end = p + len;
+		p += len;
+	}
+	if (p != end)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("extra data after the last column in columnar block")));
+
+	reader->blocksread++;
+	reader->nrows = hdr.nrows;
+	reader->currow = 0;
+	input->cursor = EXTCOLUMNAR_HEADER_SIZE + hdr.datalen;
+
+	/* next_row() never gets to the end of a block without rows */
+	if (hdr.nrows == 0)
+		finish_block(reader);
+
+	return true;
+}
+
+/*
+ * extcolumnar_next_row
+ *		Decode the next row into values and nulls.
+ *
+ * Returns false if more input is needed.  Memory for the values is allocated
+ * in the current memory context.
+ */
+bool
+extcolumnar_next_row(ExtColumnarReader *reader, Datum *values, bool *nulls)
+{
+	int			i;
+
+	while (reader->currow >= reader->nrows)
+	{
+		MemoryContext oldcontext = MemoryContextSwitchTo(reader->mcxt);
+		bool		loaded = load_block(reader);
+
+		MemoryContextSwitchTo(oldcontext);
+		if (!loaded)
+			return false;
+	}
+
+	reader->rowsread++;
+	MemSet(nulls, true, sizeof(bool) * reader->tupdesc->natts);
+	for (i = 0; i < reader->ncolumns; i++)
+	{
+		ExtColumnarColumn *column = &reader->columns[i];
+		int32		len;
+
+		/* the scan does not need it, leave it NULL */
+		if (column->skip)
+			continue;
+
+		reader->curcol = i;
+		if (column->end - column->cursor < 4)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("missing value in columnar block")));
+		len = (int32) extcolumnar_get_uint32(column->cursor);
+		column->cursor += 4;
+
+		if (len == -1)
+		{
+			values[column->attnum] = ReceiveFunctionCall(&column->func, NULL,
+														 column->typioparam,
+														 column->typmod);
+			continue;
+		}
+		if (len < 0 || column->end - column->cursor < len)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("invalid value length %d in columnar block", len)));
+
+		values[column->attnum] = receive_value(column, column->cursor, len);
+		nulls[column->attnum] = false;
+		column->cursor += len;
+	}
+	reader->curcol = -1;
+	reader->currow++;
+
+	if (reader->currow == reader->nrows)
+		finish_block(reader);
+
+	return true;
+}
+
+/*
+ * extcolumnar_end_of_data
+ *		Check that the input did not end in the middle of a block.
+ */
+void
+extcolumnar_end_of_data(ExtColumnarReader *reader)
+{
+	if (reader->input.len > reader->input.cursor)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("unexpected end of data in the middle of a columnar block")));
+}
+
+/*
+ * Number of the row being decoded, for error messages.
+ */
+uint64
+extcolumnar_rows_read(ExtColumnarReader *reader)
+{
+	return reader->rowsread;
+}
+
+/*
+ * Number of blocks loaded so far, and how many of them, of how many bytes,
+ * the filters passed over, for EXPLAIN ANALYZE.
+ */
+void
+extcolumnar_blocks_read(ExtColumnarReader *reader, uint64 *blocks,
+						uint64 *skipped, uint64 *skippedbytes)
+{
+	*blocks = reader->blocksread;
+	*skipped = reader->blocksskipped;
+	*skippedbytes = reader->bytesskipped;
+}
+
+/*
+ * Name of the column being decoded, NULL if none.
+ */
+const char *
+extcolumnar_current_column(ExtColumnarReader *reader)
+{
+	if (reader->curcol < 0)
+		return NULL;
+
+	return NameStr(reader->tupdesc->attrs[reader->columns[reader->curcol].attnum]->attname);
+}
+
+void
+extcolumnar_end_read(ExtColumnarReader *reader)
+{
+	pfree(reader->input.data);
+	if (reader->rawbuf)
+		pfree(reader->rawbuf);
+	list_free_deep(reader->filters);
+	MemoryContextDelete(reader->statcxt);
+	pfree(reader->columns);
+	pfree(reader);
+}
+
+/*
+ * extcolumnar_begin_write
+ *		Prepare to encode rows of the given descriptor.
+ *
+ * options are the FORMAT options of the table.
+ */
+ExtColumnarWriter *
+extcolumnar_begin_write(TupleDesc tupdesc, List *options)
+{
+	ExtColumnarWriter *writer;
+	int			i;
+
+	writer = palloc0(sizeof(ExtColumnarWriter));
+	writer->mcxt = CurrentMemoryContext;
+	writer->rowcxt = AllocSetContextCreate(CurrentMemoryContext,
+										   "ExtColumnarRowCxt",
+										   ALLOCSET_DEFAULT_MINSIZE,
+										   ALLOCSET_DEFAULT_INITSIZE,
+										   ALLOCSET_DEFAULT_MAXSIZE);
+	writer->statcxt = AllocSetContextCreate(CurrentMemoryContext,
+											"ExtColumnarStatCxt",
+											ALLOCSET_SMALL_MINSIZE,
+											ALLOCSET_SMALL_INITSIZE,
+											ALLOCSET_SMALL_MAXSIZE);
+	extcolumnar_parse_options(options, &writer->block_size, &writer->compress,
+							  &writer->statistics);
+	writer->ncolumns = live_columns(tupdesc, &writer->columns);
+	for (i = 0; i < writer->ncolumns; i++)
+	{
+		ExtColumnarColumn *column = &writer->columns[i];
+		Oid			send_func;
+		bool		isvarlena;
+
+		getTypeBinaryOutputInfo(column->typid, &send_func, &isvarlena);
+		fmgr_info(send_func, &column->func);
+		initStringInfo(&column->buf);
+
+		/*
+		 * The reader only compares with the statistics of columns of types
+		 * that have no collation, see make_filter().
+		 */
+		if (writer->statistics && !type_is_collatable(column->typid) &&
+			!type_is_rowtype(column->typid))
+		{
+			TypeCacheEntry *typentry;
+
+			typentry = lookup_type_cache(column->typid,
+										 TYPECACHE_CMP_PROC_FINFO);
+			if (OidIsValid(typentry->cmp_proc_finfo.fn_oid))
+				column->cmp = &typentry->cmp_proc_finfo;
+			get_typlenbyval(column->typid, &column->typlen, &column->typbyval);
+		}
+	}
+
+	return writer;
+}
+
+/*
+ * Take a value into the minimum and maximum of its column in the block.
+ */
+static void
+update_minmax(ExtColumnarWriter *writer, ExtColumnarColumn *column, Datum value)
+{
+	bool		newmin;
+	bool		newmax;
+	MemoryContext oldcontext;
+
+	if (!column->hasminmax)
+		newmin = newmax = true;
+	else
+	{
+		newmin = DatumGetInt32(FunctionCall2(column->cmp, value, column->min)) < 0;
+		newmax = DatumGetInt32(FunctionCall2(column->cmp, value, column->max)) > 0;
+		if (!newmin && !newmax)
+			return;
+	}
+
+	oldcontext = MemoryContextSwitchTo(writer->statcxt);
+	if (column->typlen == -1)
+		value = PointerGetDatum(PG_DETOAST_DATUM_COPY(value));
+	else
+		value = datumCopy(value, column->typbyval, column->typlen);
+	MemoryContextSwitchTo(oldcontext);
+
+	if (newmin)
+		column->min = value;
+	if (newmax)
+		column->max = value;
+	column->hasminmax = true;
+}
+
+/*
+ * Append the minimum and maximum of the columns in the block to buf, and
+ * forget them.
+ */
+static void
+put_statistics(ExtColumnarWriter *writer, StringInfo buf)
+{
+	int			i;
+
+	for (i = 0; i < writer->ncolumns; i++)
+	{
+		ExtColumnarColumn *column = &writer->columns[i];
+		bytea	   *outputbytes;
+
+		if (!column->hasminmax)
+		{
+			put_uint32(buf, (uint32) -1);
+			continue;
+		}
+
+		outputbytes = SendFunctionCall(&column->func, column->min);
+		put_uint32(buf, (uint32) (VARSIZE(outputbytes) - VARHDRSZ));
+		appendBinaryStringInfo(buf, VARDATA(outputbytes),
+							   VARSIZE(outputbytes) - VARHDRSZ);
+		pfree(outputbytes);
+
+		outputbytes = SendFunctionCall(&column->func, column->max);
+		put_uint32(buf, (uint32) (VARSIZE(outputbytes) - VARHDRSZ));
+		appendBinaryStringInfo(buf, VARDATA(outputbytes),
+							   VARSIZE(outputbytes) - VARHDRSZ);
+		pfree(outputbytes);
+
+		column->hasminmax = false;
+	}
+	MemoryContextReset(writer->statcxt);
+}
+
+/*
+ * extcolumnar_add_row
+ *		Add a row to the current block.
+ *
+ * Returns true once the block has reached the block size, the caller should
+ * then send it with extcolumnar_flush().
+ */
+bool
+extcolumnar_add_row(ExtColumnarWriter *writer, Datum *values, bool *nulls)
+{
+	MemoryContext oldcontext = MemoryContextSwitchTo(writer->rowcxt);
+	int			i;
+
+	for (i = 0; i < writer->ncolumns; i++)
+	{
+		ExtColumnarColumn *column = &writer->columns[i];
+		int			before = column->buf.len;
+
+		if (nulls[column->attnum])
+			put_uint32(&column->buf, (uint32) -1);
+		else
+		{
+			bytea	   *outputbytes;
+			int			len;
+
+			outputbytes = SendFunctionCall(&column->func, values[column->attnum]);
+			len = VARSIZE(outputbytes) - VARHDRSZ;
+			put_uint32(&column->buf, (uint32) len);
+			appendBinaryStringInfo(&column->buf, VARDATA(outputbytes), len);
+
+			if (column->cmp)
+				update_minmax(writer, column, values[column->attnum]);
+		}
+		writer->datasize += column->buf.len - before;
+	}
+	writer->nrows++;
+
+	MemoryContextSwitchTo(oldcontext);
+	MemoryContextReset(writer->rowcxt);
+
+	return writer->datasize >= writer->block_size;
+}
+
+/*
+ * extcolumnar_flush
+ *		Append the rows added so far to out as one block, and start a new one.
+ */
+void
+extcolumnar_flush(ExtColumnarWriter *writer, StringInfo out)
+{
+	StringInfoData payload;
+	StringInfoData stats;
+	uint16		flags = 0;
+	char	   *data;
+	uint32		datalen;
+	int			i;
+
+	if (writer->nrows == 0)
+		return;
+
+	if (writer->statistics)
+	{
+		initStringInfo(&stats);
+		put_statistics(writer, &stats);
+		flags |= EXTCOLUMNAR_FLAG_STATS;
+	}
+
+	initStringInfo(&payload);
+	for (i = 0; i < writer->ncolumns; i++)
+	{
+		ExtColumnarColumn *column = &writer->columns[i];
+
+		put_uint32(&payload, column->typid);
+		put_uint32(&payload, (uint32) column->buf.len);
+		appendBinaryStringInfo(&payload, column->buf.data, column->buf.len);
+		resetStringInfo(&column->buf);
+	}
+	data = payload.data;
+	datalen = payload.len;
+
+#ifdef HAVE_LIBZSTD
+	if (writer->compress)
+	{
+		size_t		bound = ZSTD_compressBound(payload.len);
+		char	   *compressed = palloc(bound);
+		size_t		len;
+
+		len = ZSTD_compress(compressed, bound, payload.data, payload.len,
+							ZSTD_CLEVEL_DEFAULT);
+		if (ZSTD_isError(len))
+			elog(ERROR, "could not compress columnar block: %s",
+				 ZSTD_getErrorName(len));
+
+		/* keep the block as it is if it does not get any smaller */
+		if (len < payload.len)
+		{
+			flags |= EXTCOLUMNAR_FLAG_ZSTD;
+			data = compressed;
+			datalen = len;
+		}
+		else
+			pfree(compressed);
+	}
+#endif
+
+	appendBinaryStringInfo(out, EXTCOLUMNAR_MAGIC, 4);
+	put_uint16(out, flags);
+	put_uint16(out, (uint16) writer->ncolumns);
+	put_uint32(out, writer->nrows);
+	put_uint32(out, (uint32) payload.len);
+	if (writer->statistics)
+	{
+		put_uint32(out, 4 + stats.len + datalen);
+		put_uint32(out, (uint32) stats.len);
+		appendBinaryStringInfo(out, stats.data, stats.len);
+		pfree(stats.data);
+	}
+	else
+		put_uint32(out, datalen);
+	appendBinaryStringInfo(out, data, datalen);
+
+	if (data != payload.data)
+		pfree(data);
+	pfree(payload.data);
+
+	writer->nrows = 0;
+	writer->datasize = 0;
+}
+
+void
+extcolumnar_end_write(ExtColumnarWriter *writer)
+{
+	int			i;
+
+	for (i = 0; i < writer->ncolumns; i++)
+		pfree(writer->columns[i].buf.data);
+	pfree(writer->columns);
+	MemoryContextDelete(writer->rowcxt);
+	MemoryContextDelete(writer->statcxt);
+	pfree(writer);
+}
@@ -37,6 +37,7 @@
 #include <tcop/tcopprot.h>
 
 #include "funcapi.h"
+#include "access/extcolumnar.h"
 #include "access/fileam.h"
 #include "access/formatter.h"
 #include "access/heapam.h"
@@ -66,6 +67,7 @@
 #include "cdb/cdbvars.h"
 
 static HeapTuple externalgettup(FileScanDesc scan, ScanDirection dir);
+static HeapTuple externalgettup_columnar(FileScanDesc scan);
 static void InitParseState(CopyState pstate, Relation relation,
 			   bool writable,
 			   char fmtType,
@@ -87,7 +89,9 @@ static void FunctionCallPrepareFormatter(FunctionCallInfoData *fcinfo,
 static void open_external_readable_source(FileScanDesc scan, ExternalSelectDesc desc);
 static void open_external_writable_source(ExternalInsertDesc extInsertDesc);
 static int	external_getdata_callback(void *outbuf, int datasize, void *extra);
-static int	external_getdata(URL_FILE *extfile, CopyState pstate, void *outbuf, int maxread);
+static int	external_getdata(FileScanDesc scan, void *outbuf, int maxread);
+static char *external_projected_columns(FileScanDesc scan);
+static void end_columnar_read(FileScanDesc scan);
 static void external_senddata(URL_FILE *extfile, CopyState pstate);
 static void external_scan_error_callback(void *arg);
 static void parseCustomFormatString(char *fmtstr, char **formatter_name, List **formatter_params);
@@ -96,8 +100,9 @@ static void justifyDatabuf(StringInfo buf);
 
 static void base16_encode(char *raw, int len, char *encoded);
 static char *get_eol_delimiter(List *params);
-static void external_set_env_vars_ext(extvar_t *extvar, char *uri, bool csv, char *escape,
-				 char *quote, EolType eol_type, bool header, uint32 scancounter, List *params);
+static void external_set_env_vars_ext(extvar_t *extvar, char *uri, bool csv, bool columnar,
+				 char *escape, char *quote, EolType eol_type, bool header,
+				 uint32 scancounter, List *params);
 
 
 /* ----------------------------------------------------------------
@@ -161,6 +166,11 @@ external_beginscan(Relation relation, uint32 scancounter,
 	scan->fs_noop = false;
 	scan->fs_file = NULL;
 	scan->fs_formatter = NULL;
+	scan->fs_columnar = NULL;
+	scan->fs_proj = NULL;
+	scan->fs_filter = NULL;
+	scan->fs_columns_passed = NULL;
+	scan->fs_filter_passed = NULL;
 	scan->fs_constraintExprs = NULL;
 	if (relation->rd_att->constr != NULL && relation->rd_att->constr->num_check > 0)
 	{
@@ -278,6 +288,11 @@ external_beginscan(Relation relation, uint32 scancounter,
 								&custom_formatter_name,
 								&custom_formatter_params);
 	}
+	else if (fmttype_is_columnar(fmtType))
+	{
+		/* the options only matter to the writer */
+		copyFmtOpts = NIL;
+	}
 	else
 		copyFmtOpts = parseCopyFormatString(relation, fmtOptString, fmtType);
 
@@ -320,6 +335,8 @@ external_beginscan(Relation relation, uint32 scancounter,
 		scan->fs_formatter->fmt_perrow_ctx = scan->fs_pstate->rowcontext;
 
 	}
+	else if (fmttype_is_columnar(fmtType))
+		scan->fs_columnar = extcolumnar_begin_read(tupDesc);
 
 	/* pgstat_initstats(relation); */
 
@@ -349,6 +366,150 @@ external_rescan(FileScanDesc scan)
 	scan->fs_pstate->cur_lineno = 0;
 	scan->fs_pstate->cur_attname = NULL;
 	scan->fs_pstate->raw_buf_len = 0;
+
+	/* throw away any partial block left from the previous scan */
+	if (scan->fs_columnar)
+	{
+		end_columnar_read(scan);
+		scan->fs_columnar = extcolumnar_begin_read(scan->fs_tupDesc);
+		external_set_projection(scan, scan->fs_proj);
+	}
+}
+
+/* ----------------
+*		external_set_projection - tell which columns the scan needs
+*
+* proj is indexed by attribute number - 1, NULL means all of them.  The
+* columnar format does not decode the other columns, which are returned as
+* NULL, and the source is told about them, see GP_COLUMNS.  The constraints
+* of an external partition may look at any column, so all of them are needed
+* then.
+* ----------------
+*/
+void
+external_set_projection(FileScanDesc scan, bool *proj)
+{
+	scan->fs_proj = proj;
+
+	if (scan->fs_columnar && !scan->fs_hasConstraints)
+		extcolumnar_set_projection(scan->fs_columnar, proj);
+}
+
+/* ----------------
+*		external_set_filter - set the quals to pass to the source
+*
+* filter is an SQL boolean expression over the columns of the table, see
+* GP_FILTER.  The source may use it to leave out rows early.
+* ----------------
+*/
+void
+external_set_filter(FileScanDesc scan, char *filter)
+{
+	scan->fs_filter = filter;
+}
+
+/* ----------------
+*		external_explain - add the statistics of the scan to EXPLAIN ANALYZE
+* ----------------
+*/
+void
+external_explain(FileScanDesc scan, StringInfo buf)
+{
+	uint64		blocks = scan->fs_blocks;
+	uint64		skipped = scan->fs_blocksskipped;
+	uint64		skippedbytes = scan->fs_bytesskipped;
+
+	if (scan->fs_columnar)
+	{
+		uint64		rb;
+		uint64		rs;
+		uint64		rsb;
+
+		extcolumnar_blocks_read(scan->fs_columnar, &rb, &rs, &rsb);
+		blocks += rb;
+		skipped += rs;
+		skippedbytes += rsb;
+	}
+
+	appendStringInfo(buf, UINT64_FORMAT " bytes received from the external source\n",
+					 scan->fs_bytesread);
+	if (scan->fs_columns_passed)
+		appendStringInfo(buf, "Columns passed to the external source: %s\n",
+						 scan->fs_columns_passed);
+	if (scan->fs_filter_passed)
+		appendStringInfo(buf, "Filter passed to the external source: %s\n",
+						 scan->fs_filter_passed);
+
+	if (skipped > 0)
+		appendStringInfo(buf, UINT64_FORMAT " of " UINT64_FORMAT " columnar blocks (" UINT64_FORMAT " bytes) skipped by their statistics\n",
+						 skipped, blocks, skippedbytes);
+}
+
+/*
+ * End the columnar reader of the scan, keeping its statistics.
+ */
+static void
+end_columnar_read(FileScanDesc scan)
+{
+	uint64		blocks;
+	uint64		skipped;
+	uint64		skippedbytes;
+
+	extcolumnar_blocks_read(scan->fs_columnar, &blocks, &skipped, &skippedbytes);
+	scan->fs_blocks += blocks;
+	scan->fs_blocksskipped += skipped;
+	scan->fs_bytesskipped += skippedbytes;
+
+	extcolumnar_end_read(scan->fs_columnar);
+	scan->fs_columnar = NULL;
+}
+
+/*
+ * The columns that the scan needs as a comma-separated list of quoted names,
+ * NULL if it needs all of them.  When it needs none, as for count(*), the
+ * first column is listed like AOCS scans read it.
+ */
+static char *
+external_projected_columns(FileScanDesc scan)
+{
+	TupleDesc	tupDesc = scan->fs_tupDesc;
+	StringInfoData buf;
+	bool		all = true;
+	int			first = -1;
+	int			i;
+
+	if (scan->fs_proj == NULL || scan->fs_hasConstraints)
+		return NULL;
+
+	initStringInfo(&buf);
+	for (i = 0; i < tupDesc->natts; i++)
+	{
+		if (tupDesc->attrs[i]->attisdropped)
+			continue;
+		if (first < 0)
+			first = i;
+		if (!scan->fs_proj[i])
+		{
+			all = false;
+			continue;
+		}
+		if (buf.len > 0)
+			appendStringInfoChar(&buf, ',');
+		appendStringInfoString(&buf,
+							   quote_identifier(NameStr(tupDesc->attrs[i]->attname)));
+	}
+	if (buf.len == 0 && first >= 0)
+		appendStringInfoString(&buf,
+							   quote_identifier(NameStr(tupDesc->attrs[first]->attname)));
+
+	/* it goes into an HTTP header */
+	if (all || strpbrk(buf.data, "\r\n") != NULL)
+	{
+		pfree(buf.data);
+		return NULL;
+	}
+
+	return buf.data;
 }
 
 /* ----------------
@@ -441,6 +602,9 @@ external_endscan(FileScanDesc scan)
 		scan->fs_formatter = NULL;
 	}
 
+	if (scan->fs_columnar)
+		end_columnar_read(scan);
+
 	/*
 	 * free parse state memory
 	 */
@@ -591,6 +755,7 @@ external_insert_init(Relation rel)
 	else
 		extInsertDesc->ext_noop = (Gp_role == GP_ROLE_DISPATCH);
 	extInsertDesc->ext_formatter_data = NULL;
+	extInsertDesc->ext_columnar = NULL;
 
 	if (extentry->command)
 	{
@@ -651,6 +816,13 @@ external_insert_init(Relation rel)
 								&custom_formatter_name,
 								&custom_formatter_params);
 	}
+	else if (fmttype_is_columnar(extentry->fmtcode))
+	{
+		copyFmtOpts = NIL;
+		parseCustomFormatString(extentry->fmtopts,
+								NULL,
+								&custom_formatter_params);
+	}
 	else
 		copyFmtOpts = parseCopyFormatString(rel, extentry->fmtopts, extentry->fmtcode);
 
@@ -686,6 +858,10 @@ external_insert_init(Relation rel)
 		extInsertDesc->ext_formatter_data = (FormatterData *) palloc0(sizeof(FormatterData));
 		extInsertDesc->ext_formatter_data->fmt_perrow_ctx = extInsertDesc->ext_pstate->rowcontext;
 	}
+	else if (fmttype_is_columnar(extentry->fmtcode))
+		extInsertDesc->ext_columnar =
+			extcolumnar_begin_write(extInsertDesc->ext_tupDesc,
+									custom_formatter_params);
 
 	return extInsertDesc;
 }
@@ -721,7 +897,19 @@ external_insert(ExternalInsertDesc extInsertDesc, HeapTuple instup)
 	/*
 	 * deconstruct the tuple and format it into text
 	 */
-	if (!customFormat)
+	if (extInsertDesc->ext_columnar)
+	{
+		/*
+		 * Columnar format: rows are collected into a block, which is only
+		 * sent once it is full.
+		 */
+		heap_deform_tuple(instup, tupDesc, values, nulls);
+		if (!extcolumnar_add_row(extInsertDesc->ext_columnar, values, nulls))
+			return HeapTupleGetOid(instup);
+
+		extcolumnar_flush(extInsertDesc->ext_columnar, pstate->fe_msgbuf);
+	}
+	else if (!customFormat)
 	{
 		/* TEXT or CSV */
 		heap_deform_tuple(instup, tupDesc, values, nulls);
@@ -803,6 +991,16 @@ external_insert_finish(ExternalInsertDesc extInsertDesc)
 	{
 		char	   *relname = RelationGetRelationName(extInsertDesc->ext_rel);
 
+		/* send the last, partially filled block of the columnar format */
+		if (extInsertDesc->ext_columnar)
+		{
+			CopyState	pstate = extInsertDesc->ext_pstate;
+
+			extcolumnar_flush(extInsertDesc->ext_columnar, pstate->fe_msgbuf);
+			if (pstate->fe_msgbuf->len > 0)
+				external_senddata(extInsertDesc->ext_file, pstate);
+		}
+
 		url_fflush(extInsertDesc->ext_file, extInsertDesc->ext_pstate);
 		url_fclose(extInsertDesc->ext_file, true, relname);
 	}
@@ -810,6 +1008,9 @@ external_insert_finish(ExternalInsertDesc extInsertDesc)
 	if (extInsertDesc->ext_formatter_data)
 		pfree(extInsertDesc->ext_formatter_data);
 
+	if (extInsertDesc->ext_columnar)
+		extcolumnar_end_write(extInsertDesc->ext_columnar);
+
 	pfree(extInsertDesc);
 }
 
@@ -961,7 +1162,7 @@ externalgettup_custom(FileScanDesc scan)
 		/* need to fill our buffer with data? */
 		if (formatter->fmt_databuf.len == 0 || need_more_data)
 		{
-			int			bytesread = external_getdata(scan->fs_file, pstate, pstate->raw_buf, RAW_BUF_SIZE);
+			int			bytesread = external_getdata(scan, pstate->raw_buf, RAW_BUF_SIZE);
 
 			if (bytesread > 0)
 			{
@@ -1109,6 +1310,39 @@ externalgettup_custom(FileScanDesc scan)
 	return NULL;
 }
 
+static HeapTuple
+externalgettup_columnar(FileScanDesc scan)
+{
+	CopyState	pstate = scan->fs_pstate;
+	MemoryContext oldcontext;
+
+	MemoryContextReset(pstate->rowcontext);
+	oldcontext = MemoryContextSwitchTo(pstate->rowcontext);
+
+	while (!extcolumnar_next_row(scan->fs_columnar, scan->values, scan->nulls))
+	{
+		int			bytesread;
+
+		if (pstate->fe_eof)
+		{
+			/* complain about a truncated block, if any */
+			extcolumnar_end_of_data(scan->fs_columnar);
+
+			MemoryContextSwitchTo(oldcontext);
+			scan->fs_inited = false;
+			return NULL;
+		}
+
+		bytesread = external_getdata(scan, pstate->raw_buf, RAW_BUF_SIZE);
+		if (bytesread > 0)
+			extcolumnar_add_data(scan->fs_columnar, pstate->raw_buf, bytesread);
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return heap_form_tuple(scan->fs_tupDesc, scan->values, scan->nulls);
+}
+
 /* ----------------
 *		externalgettup	form another tuple from the data file.
 *		This is the workhorse - make sure it's fast!
@@ -1145,7 +1379,9 @@ externalgettup(FileScanDesc scan,
 		/* (set current state...) */
 	}
 
-	if (!custom)
+	if (scan->fs_columnar)
+		tup = externalgettup_columnar(scan);	/* columnar */
+	else if (!custom)
 		tup = externalgettup_defined(scan); /* text/csv */
 	else
 		tup = externalgettup_custom(scan);  /* custom */
@@ -1364,17 +1600,27 @@ open_external_readable_source(FileScanDesc scan, ExternalSelectDesc desc)
 {
 	extvar_t	extvar;
 
+	/*
+	 * Let the columnar reader pass over the blocks that the statistics show
+	 * to have no rows the quals of the scan accept.
+	 */
+	if (scan->fs_columnar && desc && !scan->fs_hasConstraints)
+		extcolumnar_set_filter(scan->fs_columnar, desc->filter_quals);
+
 	/* set up extvar */
 	memset(&extvar, 0, sizeof(extvar));
 	external_set_env_vars_ext(&extvar,
 							  scan->fs_uri,
 							  scan->fs_pstate->csv_mode,
+							  scan->fs_columnar != NULL,
 							  scan->fs_pstate->escape,
 							  scan->fs_pstate->quote,
 							  scan->fs_pstate->eol_type,
 							  scan->fs_pstate->header_line,
 							  scan->fs_scancounter,
 							  scan->fs_custom_formatter_params);
+	extvar.GP_COLUMNS = external_projected_columns(scan);
+	extvar.GP_FILTER = scan->fs_filter;
 
 	/* actually open the external source */
 	scan->fs_file = url_fopen(scan->fs_uri,
@@ -1382,6 +1628,10 @@ open_external_readable_source(FileScanDesc scan, ExternalSelectDesc desc)
 							  &extvar,
 							  scan->fs_pstate,
 							  desc);
+
+	/* what the source was told, for EXPLAIN ANALYZE */
+	scan->fs_columns_passed = extvar.GP_COLUMNS;
+	scan->fs_filter_passed = extvar.GP_FILTER;
 }
 
 /*
@@ -1401,11 +1651,13 @@ open_external_writable_source(ExternalInsertDesc extInsertDesc)
 	external_set_env_vars_ext(&extvar,
 							  extInsertDesc->ext_uri,
 							  extInsertDesc->ext_pstate->csv_mode,
+							  extInsertDesc->ext_columnar != NULL,
 							  extInsertDesc->ext_pstate->escape,
 							  extInsertDesc->ext_pstate->quote,
 							  extInsertDesc->ext_pstate->eol_type,
 							  extInsertDesc->ext_pstate->header_line,
 							  0,
+						 extInsertDesc->ext_columnar ? NIL :
 						 extInsertDesc->ext_custom_formatter_params);
 
 	/* actually open the external source */
@@ -1425,15 +1677,17 @@ external_getdata_callback(void *outbuf, int datasize, void *extra)
 {
 	FileScanDesc scan = (FileScanDesc) extra;
 
-	return external_getdata(scan->fs_file, scan->fs_pstate, outbuf, datasize);
+	return external_getdata(scan, outbuf, datasize);
 }
 
 /*
  * get a chunk of data from the external data file.
  */
 static int
-external_getdata(URL_FILE *extfile, CopyState pstate, void *outbuf, int maxread)
+external_getdata(FileScanDesc scan, void *outbuf, int maxread)
 {
+	URL_FILE   *extfile = scan->fs_file;
+	CopyState	pstate = scan->fs_pstate;
 	int			bytesread;
 
 	/*
@@ -1460,6 +1714,8 @@ external_getdata(URL_FILE *extfile, CopyState pstate, void *outbuf, int maxread)
 					 errmsg("could not read from external file: %m")));
 
 	}
+	else
+		scan->fs_bytesread += bytesread;
 
 	return bytesread;
 }
@@ -1512,6 +1768,23 @@ external_scan_error_callback(void *arg)
 		return;
 	}
 
+	/* the columnar format has rows, but no lines to show */
+	if (scan->fs_columnar)
+	{
+		const char *attname = extcolumnar_current_column(scan->fs_columnar);
+		char		rownum[32];
+
+		snprintf(rownum, sizeof(rownum), UINT64_FORMAT,
+				 extcolumnar_rows_read(scan->fs_columnar) + 1);
+		if (attname)
+			errcontext("External table %s, row %s of %s, column %s",
+					   cstate->cur_relname, rownum, scan->fs_uri, attname);
+		else
+			errcontext("External table %s, row %s of %s",
+					   cstate->cur_relname, rownum, scan->fs_uri);
+		return;
+	}
+
 	if (cstate->cur_attname)
 	{
 		/* error is relevant to a particular column */
@@ -2142,6 +2415,11 @@ error:
 				 errmsg("external table internal parse error at end of line")));
 }
 
+/*
+ * Parse the options of a custom format into a list of DefElems.  The
+ * formatter function name is taken out of the list and returned separately,
+ * unless formatter_name is NULL, as for the columnar format that has none.
+ */
 static void
 parseCustomFormatString(char *fmtstr, char **formatter_name, List **formatter_params)
 {
@@ -2177,7 +2455,7 @@ parseCustomFormatString(char *fmtstr, char **formatter_name, List **formatter_pa
 			if (val)
 			{
 
-				if (pg_strcasecmp(key, "formatter") == 0)
+				if (formatter_name && pg_strcasecmp(key, "formatter") == 0)
 				{
 					*formatter_name = pstrdup(val);
 					formatter_found = true;
@@ -2195,7 +2473,7 @@ parseCustomFormatString(char *fmtstr, char **formatter_name, List **formatter_pa
 
 	}
 
-	if (!formatter_found)
+	if (formatter_name && !formatter_found)
 		ereport(ERROR,
 				(errcode(ERRCODE_INTERNAL_ERROR),
 				 errmsg("external table internal parse error: no formatter function name found")));
@@ -2246,11 +2524,12 @@ base16_encode(char *raw, int len, char *encoded)
 void
 external_set_env_vars(extvar_t *extvar, char *uri, bool csv, char *escape, char *quote, bool header, uint32 scancounter)
 {
-	external_set_env_vars_ext(extvar, uri, csv, escape, quote, EOL_UNKNOWN, header, scancounter, NULL);
+	external_set_env_vars_ext(extvar, uri, csv, false, escape, quote, EOL_UNKNOWN, header, scancounter, NULL);
 }
 
 static void
-external_set_env_vars_ext(extvar_t *extvar, char *uri, bool csv, char *escape, char *quote, EolType eol_type, bool header,
+external_set_env_vars_ext(extvar_t *extvar, char *uri, bool csv, bool columnar,
+						  char *escape, char *quote, EolType eol_type, bool header,
 						  uint32 scancounter, List *params)
 {
 	time_t		now = time(0);
@@ -2260,9 +2539,10 @@ external_set_env_vars_ext(extvar_t *extvar, char *uri, bool csv, char *escape, c
 	char	   *encoded_delim;
 	int			line_delim_len;
 
+	/* m is 0 for text, 1 for csv and 2 for columnar */
 	snprintf(extvar->GP_CSVOPT, sizeof(extvar->GP_CSVOPT),
 			"m%1dx%3dq%3dn%1dh%1d",
-			csv ? 1 : 0,
+			columnar ? 2 : (csv ? 1 : 0),
 			escape ? 255 & *escape : 0,
 			quote ? 255 & *quote : 0,
 			eol_type,
@@ -2318,6 +2598,7 @@ external_set_env_vars_ext(extvar_t *extvar, char *uri, bool csv, char *escape, c
 	sprintf(extvar->GP_SEGMENT_COUNT, "%d", getgpsegmentCount());
 
 	extvar->GP_QUERY_STRING = (char *)debug_query_string;
+	extvar->columnar = columnar;
 
 	if (NULL != params)
 	{
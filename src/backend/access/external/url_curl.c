@@ -125,6 +125,13 @@ typedef struct
 #define DEFAULT_TCP_KEEPALIVE_TIME 7200
 #define DEFAULT_TCP_KEEPALIVE_INTVL 75
 #define DEFAULT_TCP_KEEPALIVE_PROBES 9
+
+/*
+ * gpfdist reads all the headers of a request into a 4kB buffer, so keep the
+ * X-GP-COLUMNS and X-GP-FILTER headers short enough to leave room for the
+ * others.
+ */
+#define GPFDIST_MAX_PUSHDOWN_HEADER 1024
 /*
  * SSL support GUCs - should be added soon. Until then we will use stubs
  *
@@ -1356,6 +1363,10 @@ url_curl_fopen(char *url, bool forwrite, extvar_t *ev, CopyState pstate)
 		set_httpheader(file, "X-GP-PROTO", "0");
 		set_httpheader(file, "X-GP-SEQ", "1");
 		set_httpheader(file, "Content-Type", "text/xml");
+
+		/* gpfdist must only write whole blocks of the columnar format */
+		if (ev->columnar)
+			set_httpheader(file, "X-GP-CSVOPT", ev->GP_CSVOPT);
 	}
 	else
 	{
@@ -1395,8 +1406,26 @@ url_curl_fopen(char *url, bool forwrite, extvar_t *ev, CopyState pstate)
 		 * copy #transform fragment, if present, into X-GP-TRANSFORM header
 		 */
 		char* p = local_strstr(file->common.url, "#transform=");
-		if (p && p[11])
+		bool transform = (p && p[11]);
+
+		if (transform)
 			set_httpheader(file, "X-GP-TRANSFORM", p + 11);
+
+		/*
+		 * Only a transform can make use of the columns and the filter, and
+		 * a long one is left out rather than fail the request.  Tell the
+		 * caller what was not passed on.
+		 */
+		if (!transform ||
+			(ev->GP_COLUMNS && strlen(ev->GP_COLUMNS) > GPFDIST_MAX_PUSHDOWN_HEADER))
+			ev->GP_COLUMNS = NULL;
+		if (!transform ||
+			(ev->GP_FILTER && strlen(ev->GP_FILTER) > GPFDIST_MAX_PUSHDOWN_HEADER))
+			ev->GP_FILTER = NULL;
+		if (ev->GP_COLUMNS)
+			set_httpheader(file, "X-GP-COLUMNS", ev->GP_COLUMNS);
+		if (ev->GP_FILTER)
+			set_httpheader(file, "X-GP-FILTER", ev->GP_FILTER);
 	}
 
 	CURL_EASY_SETOPT(file->curl->handle, CURLOPT_HTTPHEADER, file->curl->x_httpheader);
@@ -94,6 +94,10 @@ url_custom_fopen(char *url,
 	/* we found our function. set it in custom file handler */
 	fmgr_info(procOid, file->protocol_udf);
 
+	/* unlike desc, these stay valid for all the calls */
+	file->extprotocol->prot_columns = ev->GP_COLUMNS ? pstrdup(ev->GP_COLUMNS) : NULL;
+	file->extprotocol->prot_filter = ev->GP_FILTER ? pstrdup(ev->GP_FILTER) : NULL;
+
 	MemoryContextSwitchTo(oldcontext);
 
 	file->extprotocol->prot_user_ctx = NULL;
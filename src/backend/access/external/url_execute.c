@@ -229,6 +229,10 @@ make_command(const char *cmd, extvar_t *ev)
 	make_export("GP_SESSION_ID", ev->GP_SESSION_ID, &buf);
 	make_export("GP_SEGMENT_COUNT", ev->GP_SEGMENT_COUNT, &buf);
 	make_export("GP_QUERY_STRING", ev->GP_QUERY_STRING, &buf);
+	if (ev->GP_COLUMNS)
+		make_export("GP_COLUMNS", ev->GP_COLUMNS, &buf);
+	if (ev->GP_FILTER)
+		make_export("GP_FILTER", ev->GP_FILTER, &buf);
 
 	appendStringInfoString(&buf, cmd);
 
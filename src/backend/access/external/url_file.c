@@ -44,6 +44,10 @@ url_file_fopen(char *url, bool forwrite, extvar_t *ev, CopyState pstate)
 	if (forwrite)
 		elog(ERROR, "cannot change a readable external table \"%s\"", pstate->cur_relname);
 
+	/* a file has no use for the columns and the filter of the scan */
+	ev->GP_COLUMNS = NULL;
+	ev->GP_FILTER = NULL;
+
 	memset(&fo, 0, sizeof fo);
 
 	if (!path)
@@ -75,6 +75,7 @@
 
 #include "access/distributedlog.h"
 #include "cdb/cdbdistributedsnapshot.h"
+#include "cdb/cdbdtxgroupcommit.h"
 #include "cdb/cdbendpoint.h"
 #include "cdb/cdbgang.h"
 #include "cdb/cdblocaldistribxact.h"
@@ -1549,7 +1550,11 @@ RecordTransactionCommit(void)
 		forceSyncCommit || nrels > 0)
 #endif
 	{
-		XLogFlush(recptr);
+		/* batch the distributed commit records of concurrent backends */
+		if (isDtxPrepared)
+			DtxGroupCommitFlush(recptr);
+		else
+			XLogFlush(recptr);
 
 #ifdef FAULT_INJECTOR
 		if (isDtxPrepared == 0 &&
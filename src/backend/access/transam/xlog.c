@@ -2915,6 +2915,17 @@ UpdateMinRecoveryPoint(XLogRecPtr lsn, bool force)
  */
 void
 XLogFlush(XLogRecPtr record)
+{
+	XLogFlushWithDelay(record, CommitDelay, CommitSiblings);
+}
+
+/*
+ * Like XLogFlush(), but the backend that ends up doing the flush sleeps for
+ * the given delay instead of commit_delay, if at least the given number of
+ * other backends have active transactions.
+ */
+void
+XLogFlushWithDelay(XLogRecPtr record, int delay, int siblings)
 {
 	XLogRecPtr	WriteRqstPtr;
 	XLogwrtRqst WriteRqst;
@@ -3009,6 +3020,16 @@ XLogFlush(XLogRecPtr record)
 			break;
 		}
 
+#ifdef FAULT_INJECTOR
+		/*
+		 * Lets tests hold the flush while other backends insert records, and
+		 * have it take those along like the delay below would.
+		 */
+		if (delay > 0 &&
+			SIMPLE_FAULT_INJECTOR("xlog_flush_with_delay") == FaultInjectorTypeSuspend)
+			insertpos = WaitXLogInsertionsToFinish(insertpos);
+#endif
+
 		/*
 		 * Sleep before flush! By adding a delay here, we may give further
 		 * backends the opportunity to join the backlog of group commit
@@ -3016,12 +3037,12 @@ XLogFlush(XLogRecPtr record)
 		 * at the risk of increasing transaction latency.
 		 *
 		 * We do not sleep if enableFsync is not turned on, nor if there are
-		 * fewer than CommitSiblings other backends with active transactions.
+		 * fewer than siblings other backends with active transactions.
 		 */
-		if (CommitDelay > 0 && enableFsync &&
-			MinimumActiveBackends(CommitSiblings))
+		if (delay > 0 && enableFsync &&
+			MinimumActiveBackends(siblings))
 		{
-			pg_usleep(CommitDelay);
+			pg_usleep(delay);
 
 			/*
 			 * Re-check how far we can now flush the WAL. It's generally not
@@ -84,6 +84,7 @@ InsertAppendOnlyEntry(Oid relid,
 	values[Anum_pg_appendonly_blkdiridxid - 1] = ObjectIdGetDatum(blkdiridxid);
 	values[Anum_pg_appendonly_visimaprelid - 1] = ObjectIdGetDatum(visimaprelid);
 	values[Anum_pg_appendonly_visimapidxid - 1] = ObjectIdGetDatum(visimapidxid);
+	values[Anum_pg_appendonly_analyzemodcount - 1] = Int64GetDatum(-1);
 
 	/*
 	 * form the tuple and insert it
@@ -319,6 +320,110 @@ UpdateAppendOnlyEntryAuxOids(Oid relid,
 	CacheInvalidateRelcacheByRelid(relid);
 }
 
+/*
+ * Get the master aoseg modcount recorded by the last ANALYZE of an
+ * appendonly relation, or -1 if none was recorded.
+ */
+int64
+GetAppendOnlyEntryAnalyzeModcount(Oid relid)
+{
+	Relation	pg_appendonly;
+	ScanKeyData key[1];
+	SysScanDesc scan;
+	HeapTuple	tuple;
+	Datum		datum;
+	bool		isNull;
+	int64		result;
+
+	pg_appendonly = heap_open(AppendOnlyRelationId, AccessShareLock);
+
+	ScanKeyInit(&key[0],
+				Anum_pg_appendonly_relid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(relid));
+
+	scan = systable_beginscan(pg_appendonly, AppendOnlyRelidIndexId, true,
+							  NULL, 1, key);
+	tuple = systable_getnext(scan);
+	if (!HeapTupleIsValid(tuple))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_OBJECT),
+				 errmsg("missing pg_appendonly entry for relation \"%s\"",
+						get_rel_name(relid))));
+
+	datum = heap_getattr(tuple,
+						 Anum_pg_appendonly_analyzemodcount,
+						 RelationGetDescr(pg_appendonly),
+						 &isNull);
+	result = isNull ? -1 : DatumGetInt64(datum);
+
+	systable_endscan(scan);
+	heap_close(pg_appendonly, AccessShareLock);
+
+	return result;
+}
+
+/*
+ * Record the master aoseg modcount observed by ANALYZE. Passing -1 forgets
+ * the recorded value, e.g. after the aoseg tables have been truncated and
+ * the modcount restarts from zero. The entry is left alone if it already
+ * holds that value, to not dirty the catalog on every ANALYZE.
+ */
+void
+UpdateAppendOnlyEntryAnalyzeModcount(Oid relid, int64 modcount)
+{
+	Relation	pg_appendonly;
+	ScanKeyData key[1];
+	SysScanDesc scan;
+	HeapTuple	tuple, newTuple;
+	Datum		newValues[Natts_pg_appendonly];
+	bool		newNulls[Natts_pg_appendonly];
+	bool		replace[Natts_pg_appendonly];
+	Datum		oldValue;
+	bool		isNull;
+
+	pg_appendonly = heap_open(AppendOnlyRelationId, RowExclusiveLock);
+
+	ScanKeyInit(&key[0],
+				Anum_pg_appendonly_relid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(relid));
+
+	scan = systable_beginscan(pg_appendonly, AppendOnlyRelidIndexId, true,
+							  NULL, 1, key);
+	tuple = systable_getnext(scan);
+	if (!HeapTupleIsValid(tuple))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_OBJECT),
+				 errmsg("missing pg_appendonly entry for relation \"%s\"",
+						get_rel_name(relid))));
+
+	oldValue = heap_getattr(tuple, Anum_pg_appendonly_analyzemodcount,
+							RelationGetDescr(pg_appendonly), &isNull);
+	if (!isNull && DatumGetInt64(oldValue) == modcount)
+	{
+		systable_endscan(scan);
+		heap_close(pg_appendonly, RowExclusiveLock);
+		return;
+	}
+
+	MemSet(newValues, 0, sizeof(newValues));
+	MemSet(newNulls, false, sizeof(newNulls));
+	MemSet(replace, false, sizeof(replace));
+
+	replace[Anum_pg_appendonly_analyzemodcount - 1] = true;
+	newValues[Anum_pg_appendonly_analyzemodcount - 1] = Int64GetDatum(modcount);
+
+	newTuple = heap_modify_tuple(tuple, RelationGetDescr(pg_appendonly),
+								 newValues, newNulls, replace);
+	CatalogTupleUpdate(pg_appendonly, &newTuple->t_self, newTuple);
+
+	heap_freetuple(newTuple);
+
+	systable_endscan(scan);
+	heap_close(pg_appendonly, RowExclusiveLock);
+}
+
 /*
  * Remove all pg_appendonly entries that the table we are DROPing
  * refers to (using the table's relfilenode)
@@ -682,6 +682,35 @@ CREATE VIEW gp_stat_replication AS
          ON G.gp_segment_id = R.gp_segment_id
     );
 
+CREATE FUNCTION gp_interconnect_get_master_conn_stats() RETURNS SETOF RECORD AS
+$$
+    SELECT pg_catalog.gp_execution_segment() AS gp_segment_id, *
+    FROM pg_catalog.gp_interconnect_get_conn_stats()
+$$
+LANGUAGE SQL EXECUTE ON MASTER;
+
+CREATE FUNCTION gp_interconnect_get_segment_conn_stats() RETURNS SETOF RECORD AS
+$$
+    SELECT pg_catalog.gp_execution_segment() AS gp_segment_id, *
+    FROM pg_catalog.gp_interconnect_get_conn_stats()
+$$
+LANGUAGE SQL EXECUTE ON ALL SEGMENTS;
+
+CREATE VIEW gp_interconnect_conn_stats AS
+    SELECT * FROM pg_catalog.gp_interconnect_get_master_conn_stats() AS S
+    (gp_segment_id integer, sess_id integer, command_count integer,
+     pid integer, motion_id integer, dst_content integer, dst_pid integer,
+     fc_method text, packets_sent bigint, packets_resent bigint, acks bigint,
+     srtt bigint, rtt_dev bigint, min_rtt bigint, max_ack_time bigint,
+     cwnd float8, ssthresh float8, end_time timestamptz)
+    UNION ALL
+    SELECT * FROM pg_catalog.gp_interconnect_get_segment_conn_stats() AS S
+    (gp_segment_id integer, sess_id integer, command_count integer,
+     pid integer, motion_id integer, dst_content integer, dst_pid integer,
+     fc_method text, packets_sent bigint, packets_resent bigint, acks bigint,
+     srtt bigint, rtt_dev bigint, min_rtt bigint, max_ack_time bigint,
+     cwnd float8, ssthresh float8, end_time timestamptz);
+
 CREATE VIEW pg_replication_slots AS
     SELECT
             L.slot_name,
@@ -0,0 +1,214 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbdtxgroupcommit.c
+ *	  Group commit of distributed commit records on the QD.
+ *
+ * Every distributed transaction that went through two-phase commit writes a
+ * distributed commit record on the QD, and must flush it before telling the
+ * segments to commit.  XLogFlush() already lets backends that wait for the
+ * WAL write lock piggyback on the flush of the backend holding it, but with
+ * many short transactions the flushes still tend to carry one or two
+ * records each.  The backend that gets to do the flush may therefore wait
+ * gp_dtx_commit_delay microseconds for more records to join, as long as at
+ * least gp_dtx_commit_siblings other transactions are active; the backends
+ * that queue up behind it meanwhile don't wait, their records are flushed
+ * along with its own.  This is commit_delay, as XLogFlush() implements it,
+ * with its own settings for distributed commits.
+ *
+ * To show how well that works, the number of records made durable by each
+ * flush is kept in a histogram in shared memory, see gp_dtx_commit_batches().
+ * A batch is the records found flushed by the same flush position: the first
+ * backend to return from XLogFlush() with its record past the previous
+ * batch starts a new one.  Two flushes that complete back to back may thus
+ * be counted as one batch.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/cdbdtxgroupcommit.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/xlog.h"
+#include "cdb/cdbdtxgroupcommit.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/builtins.h"
+#include "utils/faultinjector.h"
+#include "utils/guc.h"
+
+/* batches of 1, 2-3, 4-7, ..., 64-127 and 128 or more records */
+#define DTX_COMMIT_BATCH_BUCKETS (8)
+
+#define NUM_DTX_COMMIT_BATCHES_COLS (3)
+
+typedef struct DtxGroupCommitShared
+{
+	slock_t		mutex;
+
+	/* flush position that ended the current batch, and its size so far */
+	XLogRecPtr	batchEnd;
+	int			batchSize;
+
+	/* number of completed batches, by size */
+	uint64		batches[DTX_COMMIT_BATCH_BUCKETS];
+} DtxGroupCommitShared;
+
+static DtxGroupCommitShared *dtxGroupCommit = NULL;
+
+Size
+DtxGroupCommitShmemSize(void)
+{
+	return sizeof(DtxGroupCommitShared);
+}
+
+void
+DtxGroupCommitShmemInit(void)
+{
+	bool		found;
+
+	dtxGroupCommit = ShmemInitStruct("Distributed Commit Batches",
+									 DtxGroupCommitShmemSize(), &found);
+	if (!found)
+	{
+		SpinLockInit(&dtxGroupCommit->mutex);
+		dtxGroupCommit->batchEnd = InvalidXLogRecPtr;
+		dtxGroupCommit->batchSize = 0;
+		MemSet(dtxGroupCommit->batches, 0, sizeof(dtxGroupCommit->batches));
+	}
+}
+
+static int
+batchBucket(int batchSize)
+{
+	int			bucket = 0;
+
+	while (batchSize > 1 && bucket < DTX_COMMIT_BATCH_BUCKETS - 1)
+	{
+		batchSize >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+/*
+ * Count a distributed commit record that has been flushed into its batch.
+ */
+static void
+countFlushedRecord(XLogRecPtr recptr)
+{
+	XLogRecPtr	flushed = GetFlushRecPtr();
+
+	SpinLockAcquire(&dtxGroupCommit->mutex);
+	if (recptr > dtxGroupCommit->batchEnd)
+	{
+		if (dtxGroupCommit->batchSize > 0)
+			dtxGroupCommit->batches[batchBucket(dtxGroupCommit->batchSize)]++;
+		dtxGroupCommit->batchEnd = flushed;
+		dtxGroupCommit->batchSize = 1;
+	}
+	else
+		dtxGroupCommit->batchSize++;
+	SpinLockRelease(&dtxGroupCommit->mutex);
+}
+
+/*
+ * DtxGroupCommitFlush
+ * 		Flush the WAL up to the distributed commit record at recptr.
+ *
+ * This is called in the commit critical section.
+ */
+void
+DtxGroupCommitFlush(XLogRecPtr recptr)
+{
+	SIMPLE_FAULT_INJECTOR("dtx_group_commit_flush");
+
+	/*
+	 * Only the backend that holds the WAL write lock sleeps, to give other
+	 * backends the chance to insert their commit records, so that one flush
+	 * makes all of them durable.
+	 */
+	if (gp_dtx_commit_delay > 0)
+		XLogFlushWithDelay(recptr, gp_dtx_commit_delay, gp_dtx_commit_siblings);
+	else
+		XLogFlush(recptr);
+
+	if (dtxGroupCommit != NULL)
+		countFlushedRecord(recptr);
+}
+
+/*
+ * gp_dtx_commit_batches
+ * 		Return how many flushes of distributed commit records on the QD made
+ * 		how many records durable at once.
+ *
+ * Each row covers batches of batch_size_from up to batch_size_to records,
+ * the last one has no upper bound.  The batch still being filled is counted
+ * as well.
+ */
+Datum
+gp_dtx_commit_batches(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	uint64	   *batches;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		batches = palloc0(sizeof(uint64) * DTX_COMMIT_BATCH_BUCKETS);
+		if (dtxGroupCommit != NULL)
+		{
+			SpinLockAcquire(&dtxGroupCommit->mutex);
+			memcpy(batches, dtxGroupCommit->batches,
+				   sizeof(uint64) * DTX_COMMIT_BATCH_BUCKETS);
+			if (dtxGroupCommit->batchSize > 0)
+				batches[batchBucket(dtxGroupCommit->batchSize)]++;
+			SpinLockRelease(&dtxGroupCommit->mutex);
+		}
+
+		funcctx->user_fctx = batches;
+		funcctx->max_calls = DTX_COMMIT_BATCH_BUCKETS;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	batches = (uint64 *) funcctx->user_fctx;
+
+	if (funcctx->call_cntr < funcctx->max_calls)
+	{
+		int			bucket = funcctx->call_cntr;
+		Datum		values[NUM_DTX_COMMIT_BATCHES_COLS];
+		bool		nulls[NUM_DTX_COMMIT_BATCHES_COLS];
+		HeapTuple	tuple;
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = Int32GetDatum(1 << bucket);
+		if (bucket < DTX_COMMIT_BATCH_BUCKETS - 1)
+			values[1] = Int32GetDatum((1 << (bucket + 1)) - 1);
+		else
+			nulls[1] = true;
+		values[2] = Int64GetDatum((int64) batches[bucket]);
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
@@ -15,7 +15,9 @@
 
 #include "postgres.h"
 
+#include "access/hash.h"
 #include "cdb/cdbsrlz.h"
+#include "cdb/cdbvars.h"
 #include "nodes/nodes.h"
 #include "utils/memaccounting.h"
 #include "utils/memutils.h"
@@ -33,6 +35,43 @@ static char *uncompress_string(const char *src, int size, int *uncompressed_size
 
 #endif			/* HAVE_LIBZSTD */
 
+/*
+ * A plan recently dispatched by this QD backend.
+ *
+ * The QD modifies cached plans in place between executions, so a plan is
+ * recognized by its serialized form rather than by the PlannedStmt it came
+ * from: the uncompressed string is kept to compare against, the compressed
+ * one to send.  Each distinct plan gets a new plan id, unique within the
+ * session.
+ */
+typedef struct DispatchedPlan
+{
+	uint32		planId;			/* 0 if the entry is unused */
+	uint32		hash;			/* hash of the uncompressed string */
+	uint64		lastUsed;
+	int			uncompressed_size;
+	char	   *uncompressed;
+	int			size;
+	char	   *compressed;
+} DispatchedPlan;
+
+static DispatchedPlan dispatchedPlans[MAX_DISPATCHED_PLANS];
+static uint64 dispatchedPlansClock = 0;
+static uint32 lastPlanId = 0;
+static MemoryContext DispatchedPlanContext = NULL;
+
+/*
+ * A plan received by this QE with a plan id, see storeReceivedPlan().
+ */
+typedef struct ReceivedPlan
+{
+	uint32		planId;			/* 0 if the slot is empty */
+	MemoryContext context;
+	Node	   *plan;
+} ReceivedPlan;
+
+static ReceivedPlan receivedPlans[MAX_DISPATCHED_PLANS];
+
 /*
  * This is used by dispatcher to serialize Plan and Query Trees for
  * dispatching to qExecs.
@@ -101,6 +140,181 @@ deserializeNode(const char *strNode, int size)
 	return node;
 }
 
+static void
+freeDispatchedPlan(DispatchedPlan *entry)
+{
+	if (entry->compressed != entry->uncompressed)
+		pfree(entry->compressed);
+	pfree(entry->uncompressed);
+	MemSet(entry, 0, sizeof(DispatchedPlan));
+}
+
+/*
+ * Like serializeNode(), but looks the plan up among the last
+ * gp_dispatch_plan_cache_size plans dispatched, so that a plan dispatched
+ * again is not compressed again.  The plan is still turned into a string to
+ * look it up, that is much cheaper than compressing it.
+ *
+ * *planId is set to the id of the plan, which stays the same as long as
+ * the plan is dispatched often enough to stay in the cache.
+ */
+char *
+serializePlanCached(Node *node, int *size, int *uncompressed_size_out,
+					uint32 *planId)
+{
+	DispatchedPlan *entry = NULL;
+	DispatchedPlan *victim = NULL;
+	char	   *pszNode;
+	char	   *sNode;
+	int			uncompressed_size;
+	uint32		hash;
+	int			nentries = Min(gp_dispatch_plan_cache_size, MAX_DISPATCHED_PLANS);
+	int			i;
+
+	Assert(node != NULL);
+	Assert(size != NULL);
+	Assert(nentries > 0);
+
+	if (DispatchedPlanContext == NULL)
+		DispatchedPlanContext = AllocSetContextCreate(TopMemoryContext,
+													  "Dispatched plans",
+													  ALLOCSET_DEFAULT_MINSIZE,
+													  ALLOCSET_DEFAULT_INITSIZE,
+													  ALLOCSET_DEFAULT_MAXSIZE);
+
+	START_MEMORY_ACCOUNT(MemoryAccounting_CreateAccount(0, MEMORY_OWNER_TYPE_Serializer));
+	{
+		pszNode = nodeToBinaryStringFast(node, &uncompressed_size);
+		Assert(pszNode != NULL);
+		hash = DatumGetUInt32(hash_any((unsigned char *) pszNode, uncompressed_size));
+
+		for (i = 0; i < MAX_DISPATCHED_PLANS; i++)
+		{
+			DispatchedPlan *p = &dispatchedPlans[i];
+
+			/* the cache may have been shrunk since these were added */
+			if (i >= nentries)
+			{
+				if (p->planId != 0)
+					freeDispatchedPlan(p);
+				continue;
+			}
+
+			if (p->planId != 0 && p->hash == hash &&
+				p->uncompressed_size == uncompressed_size &&
+				memcmp(p->uncompressed, pszNode, uncompressed_size) == 0)
+			{
+				entry = p;
+				break;
+			}
+
+			/* unused entries have never been used, so they go first */
+			if (victim == NULL || p->lastUsed < victim->lastUsed)
+				victim = p;
+		}
+
+		if (entry == NULL)
+		{
+			char	   *compressed;
+			int			compressed_size;
+
+#ifdef HAVE_LIBZSTD
+			compressed = compress_string(pszNode, uncompressed_size, &compressed_size);
+#else
+			compressed = pszNode;
+			compressed_size = uncompressed_size;
+#endif
+
+			entry = victim;
+			if (entry->planId != 0)
+				freeDispatchedPlan(entry);
+
+			entry->uncompressed = MemoryContextAlloc(DispatchedPlanContext,
+													 uncompressed_size);
+			memcpy(entry->uncompressed, pszNode, uncompressed_size);
+			entry->uncompressed_size = uncompressed_size;
+#ifdef HAVE_LIBZSTD
+			entry->compressed = MemoryContextAlloc(DispatchedPlanContext,
+												   compressed_size);
+			memcpy(entry->compressed, compressed, compressed_size);
+			pfree(compressed);
+#else
+			entry->compressed = entry->uncompressed;
+#endif
+			entry->size = compressed_size;
+			entry->hash = hash;
+			if (++lastPlanId == 0)
+				lastPlanId = 1;
+			entry->planId = lastPlanId;
+		}
+		entry->lastUsed = ++dispatchedPlansClock;
+
+		pfree(pszNode);
+
+		sNode = palloc(entry->size);
+		memcpy(sNode, entry->compressed, entry->size);
+	}
+	END_MEMORY_ACCOUNT();
+
+	*size = entry->size;
+	if (NULL != uncompressed_size_out)
+		*uncompressed_size_out = entry->uncompressed_size;
+	*planId = entry->planId;
+	return sNode;
+}
+
+/*
+ * Keep a plan received from the QD with a plan id in the given slot, for
+ * later commands that only refer to it.  This replaces whatever plan was
+ * in the slot before.
+ */
+void
+storeReceivedPlan(uint32 planId, int slot, Node *plan)
+{
+	ReceivedPlan *entry;
+	MemoryContext oldcontext;
+
+	Assert(planId != 0);
+
+	if (slot < 0 || slot >= MAX_DISPATCHED_PLANS)
+		elog(ERROR, "invalid plan cache slot %d", slot);
+	entry = &receivedPlans[slot];
+
+	if (entry->context == NULL)
+		entry->context = AllocSetContextCreate(TopMemoryContext,
+											   "Received plan",
+											   ALLOCSET_SMALL_MINSIZE,
+											   ALLOCSET_SMALL_INITSIZE,
+											   ALLOCSET_DEFAULT_MAXSIZE);
+	else
+		MemoryContextReset(entry->context);
+	entry->planId = 0;
+	entry->plan = NULL;
+
+	oldcontext = MemoryContextSwitchTo(entry->context);
+	entry->plan = copyObject(plan);
+	MemoryContextSwitchTo(oldcontext);
+
+	entry->planId = planId;
+}
+
+/*
+ * Return a copy of the plan kept in the given slot, in the current memory
+ * context.  The QD only refers to plans it knows this QE has kept.
+ */
+Node *
+lookupReceivedPlan(uint32 planId, int slot)
+{
+	if (slot < 0 || slot >= MAX_DISPATCHED_PLANS ||
+		receivedPlans[slot].planId != planId)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("dispatched plan %u not found in plan cache slot %d",
+						planId, slot)));
+
+	return copyObject(receivedPlans[slot].plan);
+}
+
 #ifdef HAVE_LIBZSTD
 /*
  * Compress a (binary) string using libzstd
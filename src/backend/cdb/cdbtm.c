@@ -86,6 +86,9 @@ volatile DistributedTransactionId *shmGIDSeq;
 uint32 *shmNextSnapshotId;
 slock_t *shmGxidGenLock;
 
+/* the statement that ends the current implicit transaction, if known */
+static PlannedStmt *dtxFinalStatement = NULL;
+
 int	max_tm_gxacts = 100;
 
 
@@ -119,6 +122,12 @@ int	max_tm_gxacts = 100;
  */
 #define GP_OPT_SYNCHRONIZATION_SET						0x0040
 
+/*
+ * The writer QEs prepare the transaction as soon as they have run the
+ * statement, see dtxPrepareWithStatement().
+ */
+#define GP_OPT_PREPARE_WITH_STATEMENT					0x0080
+
 /*=========================================================================
  * FUNCTIONS PROTOTYPES
  */
@@ -439,7 +448,16 @@ doPrepareTransaction(void)
 		   DtxStateToString(MyTmGxactLocal->state));
 
 	Assert(MyTmGxactLocal->dtxSegments != NIL);
-	succeeded = currentDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_PREPARE, true);
+
+	/*
+	 * Segments that have not written anything may commit right away, they are
+	 * then dropped from dtxSegments and get no COMMIT PREPARED.  A segment
+	 * that wrote xlog holds an xid, and always prepares.
+	 */
+	if (gp_dtx_skip_readonly_segments)
+		succeeded = currentDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY, true);
+	else
+		succeeded = currentDtxDispatchProtocolCommand(DTX_PROTOCOL_COMMAND_PREPARE, true);
 
 	/*
 	 * Now we've cleaned up our dispatched statement, cancels are allowed
@@ -902,14 +920,39 @@ prepareDtxTransaction(void)
 		return;
 	}
 
+	/*
+	 * The writer QEs have already prepared along with the last statement, so
+	 * there is nothing left to broadcast.
+	 */
+	if (isDtxPreparingWithStatement())
+	{
+		if (!MyTmGxactLocal->preparedWithStatement)
+			ereport(ERROR,
+					(errmsg("The distributed transaction was not prepared along with its last statement"),
+					TM_ERRDETAIL));
+
+		setCurrentDtxState(DTX_STATE_PREPARED);
+
+		SIMPLE_FAULT_INJECTOR("dtm_broadcast_prepare");
+
+		elogif(Debug_print_full_dtm, LOG,
+			   "prepareDtxTransaction prepared along with the last statement");
+		return;
+	}
+
 	/*
 	 * If only one segment was involved in the transaction, and no local XID
 	 * has been assigned on the QD either, or there is no xlog writing related
 	 * to this transaction on all segments, we can perform one-phase commit.
-	 * Otherwise, broadcast PREPARE TRANSACTION to the segments.
+	 * With gp_dtx_skip_readonly_segments, it is enough that no more than one
+	 * segment wrote xlog: like above, the segments that wrote nothing have
+	 * nothing to lose if the one that did fails to commit.  Otherwise,
+	 * broadcast PREPARE TRANSACTION to the segments.
 	 */
 	if (!TopXactExecutorDidWriteXLog() ||
-		(!markXidCommitted && list_length(MyTmGxactLocal->dtxSegments) < 2))
+		(!markXidCommitted && list_length(MyTmGxactLocal->dtxSegments) < 2) ||
+		(gp_dtx_skip_readonly_segments && !markXidCommitted &&
+		 bms_num_members(MyTmGxactLocal->xlogSegmentsMap) < 2))
 	{
 		setCurrentDtxState(DTX_STATE_ONE_PHASE_COMMIT);
 		/*
@@ -1212,6 +1255,9 @@ mppTxnOptions(bool needDtx)
 	if (isCurrentDtxActivated() && MyTmGxactLocal->explicitBeginRemembered)
 		options |= GP_OPT_EXPLICT_BEGIN;
 
+	if (needDtx && isDtxPreparingWithStatement())
+		options |= GP_OPT_PREPARE_WITH_STATEMENT;
+
 	elogif(Debug_print_full_dtm, LOG,
 		   "mppTxnOptions txnOptions = 0x%x, needDtx = %s, explicitBegin = %s, isoLevel = %s, readOnly = %s.",
 		   options,
@@ -1275,6 +1321,12 @@ isMppTxOptions_SynchronizationSet(int txnOptions)
 	return ((txnOptions & GP_OPT_SYNCHRONIZATION_SET) != 0);
 }
 
+bool
+isMppTxOptions_PrepareWithStatement(int txnOptions)
+{
+	return ((txnOptions & GP_OPT_PREPARE_WITH_STATEMENT) != 0);
+}
+
 /*=========================================================================
  * HELPER FUNCTIONS
  */
@@ -1395,7 +1447,9 @@ doDispatchDtxProtocolCommand(DtxProtocolCommand dtxProtocolCommand,
 			cmdStatus = PQcmdStatus(results[i]);
 
 			elog(DEBUG3, "DTM: status message cmd '%s' [%d] result '%s'", dtxProtocolCommandStr, i, cmdStatus);
-			if (strncmp(cmdStatus, dtxProtocolCommandStr, strlen(cmdStatus)) != 0)
+			if (strncmp(cmdStatus, dtxProtocolCommandStr, strlen(cmdStatus)) != 0 &&
+				!(dtxProtocolCommand == DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY &&
+				  strcmp(cmdStatus, DTX_READONLY_COMMIT_TAG) == 0))
 			{
 				/* failed */
 				numOfFailed++;
@@ -1534,8 +1588,11 @@ resetGxact()
 	MyTmGxactLocal->explicitBeginRemembered = false;
 	MyTmGxactLocal->badPrepareGangs = false;
 	MyTmGxactLocal->writerGangLost = false;
+	MyTmGxactLocal->prepareWithStatement = false;
+	MyTmGxactLocal->preparedWithStatement = false;
 	MyTmGxactLocal->dtxSegmentsMap = NULL;
 	MyTmGxactLocal->dtxSegments = NIL;
+	MyTmGxactLocal->xlogSegmentsMap = NULL;
 	MyTmGxactLocal->isOnePhaseCommit = false;
 	if (MyTmGxactLocal->waitGxids != NULL)
 	{
@@ -2095,6 +2152,76 @@ isDtxExplicitBegin(void)
 	return (isCurrentDtxActivated() && MyTmGxactLocal->explicitBeginRemembered);
 }
 
+/*
+ * Remember the statement that makes up the rest of the current transaction.
+ *
+ * exec_simple_query() sets this around the last statement of a query string
+ * that runs in an implicit transaction, and resets it to NULL afterwards.
+ */
+void
+setDtxFinalStatement(PlannedStmt *stmt)
+{
+	dtxFinalStatement = stmt;
+}
+
+/*
+ * Is 'stmt' the last statement of the current transaction, so that the writer
+ * QEs running it may prepare the transaction right afterwards?
+ */
+bool
+isDtxFinalStatement(PlannedStmt *stmt)
+{
+	if (!gp_dtx_prepare_with_statement)
+		return false;
+
+	if (Gp_role != GP_ROLE_DISPATCH ||
+		DistributedTransactionContext != DTX_CONTEXT_QD_DISTRIBUTED_CAPABLE)
+		return false;
+
+	if (stmt == NULL || stmt != dtxFinalStatement)
+		return false;
+
+	return !IsTransactionBlock() && !isDtxExplicitBegin();
+}
+
+/*
+ * Tell the writer QEs to prepare the transaction right after the statement
+ * about to be dispatched, piggybacking the PREPARE on the statement itself.
+ *
+ * From here on the transaction counts as being prepared: an abort has to
+ * tell the QEs that some of them may have prepared already, and nothing
+ * else may be dispatched before the commit.  The dispatcher calls
+ * dtxPreparedWithStatement() once all QEs have finished the statement
+ * successfully.
+ */
+void
+dtxPrepareWithStatement(void)
+{
+	Assert(MyTmGxactLocal->state == DTX_STATE_ACTIVE_DISTRIBUTED);
+
+	setCurrentDtxState(DTX_STATE_PREPARING);
+	MyTmGxactLocal->prepareWithStatement = true;
+
+	elogif(Debug_print_full_dtm, LOG,
+		   "dtxPrepareWithStatement moved to state = %s",
+		   DtxStateToString(MyTmGxactLocal->state));
+}
+
+void
+dtxPreparedWithStatement(void)
+{
+	if (isDtxPreparingWithStatement())
+		MyTmGxactLocal->preparedWithStatement = true;
+}
+
+bool
+isDtxPreparingWithStatement(void)
+{
+	return (MyTmGxactLocal != NULL &&
+			MyTmGxactLocal->state == DTX_STATE_PREPARING &&
+			MyTmGxactLocal->prepareWithStatement);
+}
+
 /*
  * This is mostly here because
  * cdbcopy doesn't use cdbdisp's services.
@@ -2285,11 +2412,14 @@ performDtxProtocolCommand(DtxProtocolCommand dtxProtocolCommand,
 			break;
 
 		case DTX_PROTOCOL_COMMAND_PREPARE:
+		case DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY:
 		case DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE:
 
 			/*
 			 * The QD has directed us to read-only commit or prepare an
-			 * implicit or explicit distributed transaction.
+			 * implicit or explicit distributed transaction.  With
+			 * PREPARE_SKIP_READONLY, we commit right away if we have no xid,
+			 * i.e. have not written anything, not even to a temp table.
 			 */
 			switch (DistributedTransactionContext)
 			{
@@ -2305,6 +2435,9 @@ performDtxProtocolCommand(DtxProtocolCommand dtxProtocolCommand,
 				case DTX_CONTEXT_QE_TWO_PHASE_IMPLICIT_WRITER:
 					if (dtxProtocolCommand == DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE)
 						performDtxProtocolCommitOnePhase(gid);
+					else if (dtxProtocolCommand == DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY &&
+							 !TransactionIdIsValid(GetTopTransactionIdIfAny()))
+						performDtxProtocolCommitOnePhase(gid);
 					else
 						performDtxProtocolPrepare(gid);
 					break;
@@ -2525,3 +2658,40 @@ addToGxactDtxSegments(Gang *gang)
 	}
 	MemoryContextSwitchTo(oldContext);
 }
+
+/*
+ * Drop a segment that already committed its part of the distributed
+ * transaction, it takes no part in the rest of the commit.
+ */
+void
+removeFromGxactDtxSegments(int segindex)
+{
+	if (!bms_is_member(segindex, MyTmGxactLocal->dtxSegmentsMap))
+		return;
+
+	MyTmGxactLocal->dtxSegmentsMap =
+		bms_del_member(MyTmGxactLocal->dtxSegmentsMap, segindex);
+	MyTmGxactLocal->dtxSegments =
+		list_delete_int(MyTmGxactLocal->dtxSegments, segindex);
+}
+
+/*
+ * Remember that the QEs of a segment wrote xlog in the current transaction.
+ */
+void
+addToGxactXLogSegments(int segindex)
+{
+	MemoryContext oldContext;
+
+	/* the entry db shares the QD's xid, we know of its writes already */
+	if (!isCurrentDtxActivated() || segindex < 0)
+		return;
+
+	if (bms_is_member(segindex, MyTmGxactLocal->xlogSegmentsMap))
+		return;
+
+	oldContext = MemoryContextSwitchTo(TopTransactionContext);
+	MyTmGxactLocal->xlogSegmentsMap =
+		bms_add_member(MyTmGxactLocal->xlogSegmentsMap, segindex);
+	MemoryContextSwitchTo(oldContext);
+}
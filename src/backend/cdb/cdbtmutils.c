@@ -122,6 +122,8 @@ DtxProtocolCommandToString(DtxProtocolCommand command)
 			return "Release Current Subtransaction";
 		case DTX_PROTOCOL_COMMAND_SUBTRANSACTION_ROLLBACK_INTERNAL:
 			return "Rollback Current Subtransaction";
+		case DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY:
+			return "Distributed Prepare (skip read-only)";
 	}
 
 	return "Unknown";
@@ -88,6 +88,9 @@ int			gp_safefswritesize; /* set for safe AO writes in non-mature fs */
 int			gp_cached_gang_threshold;	/* How many gangs to keep around from
 										 * stmt to stmt. */
 
+int			gp_qe_backend_pool_size = 0;	/* How many backends a segment
+											 * postmaster pre-forks */
+
 bool		Gp_write_shared_snapshot;	/* tell the writer QE to write the
 										 * shared snapshot */
 
@@ -224,6 +227,12 @@ bool		gp_interconnect_log_stats = false;	/* emit stats at log-level */
 
 bool		gp_interconnect_cache_future_packets = true;
 
+bool		gp_interconnect_shm = false;	/* same-host peers use shared memory */
+int			Gp_interconnect_shm_queue_depth = 32;
+
+int			Gp_interconnect_batch_size = 32;
+bool		gp_interconnect_udp_gso = true;
+
 /*
  * format: dbid:content:address:port,dbid:content:address:port ...
  * example: 1:-1:10.0.0.1:2000 2:0:10.0.0.2:2000 3:1:10.0.0.2:2001
@@ -299,6 +308,9 @@ int			gp_segworker_relative_priority = PRIO_MAX;
 /* Max size of dispatched plans; 0 if no limit */
 int			gp_max_plan_size = 0;
 
+/* Number of dispatched plans kept for repeated dispatch; 0 if none */
+int			gp_dispatch_plan_cache_size = 0;
+
 /* Disable setting of tuple hints while reading */
 bool		gp_disable_tuple_hints = false;
 
@@ -92,6 +92,10 @@ cdbconn_createSegmentDescriptor(struct CdbComponentDatabaseInfo *cdbinfo, int id
 	segdbDesc->isWriter = isWriter;
 	segdbDesc->establishConnTime = 0;
 
+	/* Plan cache slots of the QE, see cdbdisp_dispatchToGang_async */
+	segdbDesc->pendingPlanId = 0;
+	segdbDesc->pendingPlanSlot = -1;
+
 	MemoryContextSwitchTo(oldContext);
 	return segdbDesc;
 }
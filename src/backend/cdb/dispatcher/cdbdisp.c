@@ -26,9 +26,11 @@
 #include "libpq-int.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
+#include "cdb/cdbconn.h"
 #include "cdb/cdbfts.h"
 #include "cdb/cdbgang.h"
 #include "cdb/cdbsreh.h"
+#include "cdb/cdbtm.h"
 #include "cdb/cdbvars.h"
 #include "utils/resowner.h"
 
@@ -41,6 +43,7 @@ static dispatcher_handle_t *find_dispatcher_handle(CdbDispatcherState *ds);
 static dispatcher_handle_t *allocate_dispatcher_handle(void);
 static void destroy_dispatcher_handle(dispatcher_handle_t *h);
 static char * segmentsListToString(const char *prefix, List *segments);
+static void confirmDispatchedPlan(CdbDispatchResult *dispatchResult);
 
 static DispatcherInternalFuncs *pDispatchFuncs = &DispatcherAsyncFuncs;
 
@@ -303,6 +306,13 @@ cdbdisp_makeDispatcherState(bool isExtendedQuery)
 {
 	dispatcher_handle_t *handle;
 
+	/*
+	 * The writer QEs may have prepared the transaction already, they must not
+	 * be handed anything but the final COMMIT or ABORT PREPARED.
+	 */
+	if (isDtxPreparingWithStatement())
+		elog(ERROR, "cannot dispatch after the distributed transaction was prepared along with its last statement");
+
 	if (!isExtendedQuery)
 	{
 		if (numNonExtendedDispatcherState == 1)
@@ -327,6 +337,10 @@ cdbdisp_makeDispatcherState(bool isExtendedQuery)
 	handle->dispatcherState->allocatedGangs = NIL;
 	handle->dispatcherState->largestGangSize = 0;
 	handle->dispatcherState->rootGangSize = 0;
+	handle->dispatcherState->planId = 0;
+	handle->dispatcherState->planSlot = -1;
+	handle->dispatcherState->planRefText = NULL;
+	handle->dispatcherState->planRefTextLen = 0;
 
 	return handle->dispatcherState;
 }
@@ -355,6 +369,30 @@ cdbdisp_makeDispatchParams(CdbDispatcherState *ds,
  *
  * Free dispatcher memory context.
  */
+/*
+ * A QE sent a plan in full keeps it in its plan cache slot, but the QD only
+ * refers to it there once the QE has run the command successfully.  If the
+ * QE failed, it may or may not have kept the plan, so the slot is taken as
+ * empty.
+ */
+static void
+confirmDispatchedPlan(CdbDispatchResult *dispatchResult)
+{
+	SegmentDatabaseDescriptor *segdbDesc = dispatchResult->segdbDesc;
+
+	if (segdbDesc == NULL || segdbDesc->pendingPlanSlot < 0)
+		return;
+
+	if (dispatchResult->hasDispatched &&
+		!dispatchResult->stillRunning &&
+		!dispatchResult->wasCanceled &&
+		dispatchResult->errcode == 0)
+		segdbDesc->dispatchedPlans[segdbDesc->pendingPlanSlot] = segdbDesc->pendingPlanId;
+
+	segdbDesc->pendingPlanId = 0;
+	segdbDesc->pendingPlanSlot = -1;
+}
+
 void
 cdbdisp_destroyDispatcherState(CdbDispatcherState *ds)
 {
@@ -385,6 +423,7 @@ cdbdisp_destroyDispatcherState(CdbDispatcherState *ds)
 
 		for (i = 0; i < results->resultCount; i++)
 		{
+			confirmDispatchedPlan(&results->resultArray[i]);
 			cdbdisp_termResult(&results->resultArray[i]);
 		}
 		results->resultArray = NULL;
@@ -408,6 +447,10 @@ cdbdisp_destroyDispatcherState(CdbDispatcherState *ds)
 	ds->primaryResults = NULL;
 	ds->largestGangSize = 0;
 	ds->rootGangSize = 0;
+	ds->planId = 0;
+	ds->planSlot = -1;
+	ds->planRefText = NULL;
+	ds->planRefTextLen = 0;
 
 	if (h != NULL)
 		destroy_dispatcher_handle(h);
@@ -33,6 +33,7 @@
 #include "libpq-int.h"
 #include "cdb/cdbfts.h"
 #include "cdb/cdbgang.h"
+#include "cdb/cdbtm.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbpq.h"
 #include "miscadmin.h"
@@ -323,6 +324,24 @@ cdbdisp_dispatchToGang_async(struct CdbDispatcherState *ds,
 		}
 		pParms->dispatchResultPtrArray[pParms->dispatchCount++] = qeResult;
 
+		/*
+		 * A QE that keeps the plan already only needs to be told which one
+		 * to run.  Otherwise the QE keeps the plan it is sent, in place of
+		 * whatever it had in that slot.
+		 */
+		if (ds->planId != 0 &&
+			segdbDesc->dispatchedPlans[ds->planSlot] == ds->planId)
+		{
+			dispatchCommand(qeResult, ds->planRefText, ds->planRefTextLen);
+			continue;
+		}
+		if (ds->planId != 0)
+		{
+			segdbDesc->dispatchedPlans[ds->planSlot] = 0;
+			segdbDesc->pendingPlanId = ds->planId;
+			segdbDesc->pendingPlanSlot = ds->planSlot;
+		}
+
 		dispatchCommand(qeResult, pParms->query_text, pParms->query_text_len);
 	}
 }
@@ -1093,6 +1112,7 @@ processResults(CdbDispatchResult *dispatchResult)
 		if (segdbDesc->conn->wrote_xlog)
 		{
 			MarkTopTransactionWriteXLogOnExecutor();
+			addToGxactXLogSegments(segdbDesc->segindex);
 
 			/*
 			 * Reset the worte_xlog here. Since if the received pgresult not process
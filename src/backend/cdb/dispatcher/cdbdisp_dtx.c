@@ -52,6 +52,7 @@ static DtxContextInfo TempQDDtxContextInfo = DtxContextInfo_StaticInit;
 
 static char *buildGpDtxProtocolCommand(DispatchCommandDtxProtocolParms *pDtxProtocolParms,
 						  int *finalLen);
+static void removeReadOnlyCommitted(CdbDispatchResults *pr);
 
 /*
  * CdbDispatchDtxProtocolCommand:
@@ -135,6 +136,9 @@ CdbDispatchDtxProtocolCommand(DtxProtocolCommand dtxProtocolCommand,
 		return NULL;
 	}
 
+	if (dtxProtocolCommand == DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY)
+		removeReadOnlyCommitted(pr);
+
 	cdbdisp_returnResults(pr, &cdb_pgresults);
 
 	cdbdisp_destroyDispatcherState(ds);
@@ -143,6 +147,31 @@ CdbDispatchDtxProtocolCommand(DtxProtocolCommand dtxProtocolCommand,
 	return cdb_pgresults.pg_results;
 }
 
+/*
+ * The QEs that had nothing to prepare have committed already, drop their
+ * segments from the distributed transaction.
+ */
+static void
+removeReadOnlyCommitted(CdbDispatchResults *pr)
+{
+	int			i;
+
+	for (i = 0; i < pr->resultCount; i++)
+	{
+		CdbDispatchResult *dispatchResult = &pr->resultArray[i];
+		int			nres = cdbdisp_numPGresult(dispatchResult);
+		struct pg_result *res;
+
+		if (nres == 0)
+			continue;
+
+		res = cdbdisp_getPGresult(dispatchResult, nres - 1);
+		if (PQresultStatus(res) == PGRES_COMMAND_OK &&
+			strcmp(PQcmdStatus(res), DTX_READONLY_COMMIT_TAG) == 0)
+			removeFromGxactDtxSegments(dispatchResult->segdbDesc->segindex);
+	}
+}
+
 char *
 qdSerializeDtxContextInfo(int *size, bool wantSnapshot, bool inCursor,
 						  int txnOptions, char *debugCaller)
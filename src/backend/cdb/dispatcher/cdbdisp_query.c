@@ -25,9 +25,11 @@
 #include "cdb/cdbvars.h"
 #include "cdb/cdbmutate.h"
 #include "cdb/cdbsrlz.h"
+#include "cdb/cdbtm.h"
 #include "cdb/tupleremap.h"
 #include "catalog/namespace.h" /* for GetTempNamespaceState() */
 #include "nodes/execnodes.h"
+#include "postmaster/autostats.h"
 #include "storage/proc.h"
 #include "tcop/tcopprot.h"
 #include "utils/datum.h"
@@ -81,6 +83,8 @@ typedef struct DispatchCommandQueryParms
 	int			serializedQuerytreelen;
 	char	   *serializedPlantree;
 	int			serializedPlantreelen;
+	uint32		planId;			/* 0 if the plan is not cached */
+	int			planSlot;
 	char	   *serializedQueryDispatchDesc;
 	int			serializedQueryDispatchDesclen;
 	char	   *serializedParams;
@@ -105,7 +109,7 @@ static int fillSliceVector(SliceTable *sliceTable,
 				int len);
 
 static char *buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
-				   int *finalLen);
+				   bool planByReference, int *finalLen);
 
 static DispatchCommandQueryParms *cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc, bool planRequiresTxn);
 static DispatchCommandQueryParms *cdbdisp_buildUtilityQueryParms(struct Node *stmt, int flags, List *oid_assignments);
@@ -118,7 +122,10 @@ static void cdbdisp_dispatchCommandInternal(DispatchCommandQueryParms *pQueryPar
 static void
 cdbdisp_dispatchX(QueryDesc *queryDesc,
 			bool planRequiresTxn,
-			bool cancelOnError);
+			bool cancelOnError,
+			bool isFinalStatement);
+
+static bool canPrepareWithPlan(SliceVec *sliceVector, int nSlices);
 
 static char *serializeParamListInfo(ParamListInfo paramLI, int *len_p);
 
@@ -169,6 +176,7 @@ CdbDispatchPlan(struct QueryDesc *queryDesc,
 {
 	PlannedStmt *stmt;
 	bool		is_SRI = false;
+	bool		isFinalStatement = false;
 
 	Assert(Gp_role == GP_ROLE_DISPATCH);
 	Assert(queryDesc != NULL && queryDesc->estate != NULL);
@@ -179,6 +187,23 @@ CdbDispatchPlan(struct QueryDesc *queryDesc,
 	stmt = queryDesc->plannedstmt;
 	Assert(stmt);
 
+	/*
+	 * Is this DML the last statement of an implicit transaction?  Check
+	 * before the plan is copied below.  An auto-ANALYZE would have to
+	 * dispatch once more after the statement, so that rules it out, too.
+	 */
+	if (planRequiresTxn && isDtxFinalStatement(stmt) &&
+		(stmt->commandType == CMD_INSERT ||
+		 stmt->commandType == CMD_UPDATE ||
+		 stmt->commandType == CMD_DELETE))
+	{
+		AutoStatsCmdType cmdType;
+		Oid			relationOid;
+
+		autostats_get_cmdtype(queryDesc, &cmdType, &relationOid);
+		isFinalStatement = !auto_stats_may_analyze(cmdType, relationOid, false);
+	}
+
 	/*
 	 * Let's evaluate STABLE functions now, so we get consistent values on the
 	 * QEs
@@ -251,7 +276,7 @@ CdbDispatchPlan(struct QueryDesc *queryDesc,
 		stmt->nsegments_master = ResGroupGetSegmentNum();
 	}
 
-	cdbdisp_dispatchX(queryDesc, planRequiresTxn, cancelOnError);
+	cdbdisp_dispatchX(queryDesc, planRequiresTxn, cancelOnError, isFinalStatement);
 }
 
 /*
@@ -300,7 +325,7 @@ cdbdisp_dispatchSetCommandInternal(const char *strCommand, bool cancelOnError, b
 
 	ds = cdbdisp_makeDispatcherState(false);
 
-	queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+	queryText = buildGpQueryString(pQueryParms, false, &queryTextLength);
 
 	primaryGang = AllocateGang(ds, GANGTYPE_PRIMARY_WRITER, cdbcomponent_getCdbComponentsList());
 	if (gp_print_create_gang_time)
@@ -483,7 +508,7 @@ cdbdisp_dispatchCommandInternal(DispatchCommandQueryParms *pQueryParms,
 	 */
 	ds = cdbdisp_makeDispatcherState(false);
 
-	queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+	queryText = buildGpQueryString(pQueryParms, false, &queryTextLength);
 
 	/*
 	 * Allocate a primary QE for every available segDB in the system.
@@ -651,8 +676,22 @@ cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
 	 * serialized plan tree. Note that we're called for a single slice tree
 	 * (corresponding to an initPlan or the main plan), so the parameters are
 	 * fixed and we can include them in the prefix.
+	 *
+	 * With the plan cache, a plan dispatched before keeps its plan id and
+	 * the QEs that still have it are sent only a reference to it.
 	 */
-	splan = serializeNode((Node *) queryDesc->plannedstmt, &splan_len, &splan_len_uncompressed);
+	if (gp_dispatch_plan_cache_size > 0)
+	{
+		splan = serializePlanCached((Node *) queryDesc->plannedstmt, &splan_len,
+									&splan_len_uncompressed, &pQueryParms->planId);
+		pQueryParms->planSlot = pQueryParms->planId % gp_dispatch_plan_cache_size;
+	}
+	else
+	{
+		splan = serializeNode((Node *) queryDesc->plannedstmt, &splan_len, &splan_len_uncompressed);
+		pQueryParms->planId = 0;
+		pQueryParms->planSlot = -1;
+	}
 
 	uint64		plan_size_in_kb = ((uint64) splan_len_uncompressed) / (uint64) 1024;
 
@@ -877,10 +916,13 @@ fillSliceVector(SliceTable *sliceTbl, int rootIdx,
 
 /*
  * Build a query string to be dispatched to QE.
+ *
+ * If planByReference is set, the plan tree is left out, for QEs that keep
+ * the plan with the plan id already.
  */
 static char *
 buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
-				   int *finalLen)
+				   bool planByReference, int *finalLen)
 {
 	const char *command = pQueryParms->strCommand;
 	int			command_len;
@@ -888,6 +930,8 @@ buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 	int			querytree_len = pQueryParms->serializedQuerytreelen;
 	const char *plantree = pQueryParms->serializedPlantree;
 	int			plantree_len = pQueryParms->serializedPlantreelen;
+	uint32		planId = pQueryParms->planId;
+	int			planSlot = pQueryParms->planSlot;
 	const char *params = pQueryParms->serializedParams;
 	int			params_len = pQueryParms->serializedParamslen;
 	const char *sddesc = pQueryParms->serializedQueryDispatchDesc;
@@ -932,6 +976,10 @@ buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 		command_len = pg_mbcliplen(command, command_len,
 								   QUERY_STRING_TRUNCATE_SIZE-1) + 1;
 
+	Assert(!planByReference || planId != 0);
+	if (planByReference)
+		plantree_len = 0;
+
 	initStringInfo(&resgroupInfo);
 	if (IsResGroupActivated())
 		SerializeResGroupInfo(&resgroupInfo);
@@ -960,6 +1008,8 @@ buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 		resgroupInfo.len +
 		sizeof(tempNamespaceId) +
 		sizeof(tempToastNamespaceId) +
+		sizeof(planId) +
+		sizeof(planSlot) +
 		0;
 
 	shared_query = palloc(total_query_len);
@@ -1085,6 +1135,14 @@ buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 	memcpy(pos, &tempToastNamespaceId, sizeof(tempToastNamespaceId));
 	pos += sizeof(tempToastNamespaceId);
 
+	tmp = htonl(planId);
+	memcpy(pos, &tmp, sizeof(planId));
+	pos += sizeof(planId);
+
+	tmp = htonl(planSlot);
+	memcpy(pos, &tmp, sizeof(planSlot));
+	pos += sizeof(planSlot);
+
 	/*
 	 * fill in length placeholder
 	 */
@@ -1108,7 +1166,8 @@ buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 static void
 cdbdisp_dispatchX(QueryDesc* queryDesc,
 					bool planRequiresTxn,
-					bool cancelOnError)
+					bool cancelOnError,
+					bool isFinalStatement)
 {
 	SliceVec   *sliceVector = NULL;
 	int			nSlices = 1;	/* slices this dispatch cares about */
@@ -1160,8 +1219,27 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 	/* Each slice table has a unique-id. */
 	sliceTbl->ic_instance_id = ++gp_interconnect_id;
 
+	/*
+	 * The last statement of an implicit transaction may have the writer QEs
+	 * prepare the transaction right after running it, saving the QD the
+	 * PREPARE round trip at commit.  This must be decided before the DTX
+	 * context is serialized.
+	 */
+	if (isFinalStatement && rootIdx == 0 &&
+		canPrepareWithPlan(sliceVector, nSlices))
+		dtxPrepareWithStatement();
+
 	pQueryParms = cdbdisp_buildPlanQueryParms(queryDesc, planRequiresTxn);
-	queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+	queryText = buildGpQueryString(pQueryParms, false, &queryTextLength);
+
+	/* QEs that keep the plan already get a query text without it */
+	if (pQueryParms->planId != 0)
+	{
+		ds->planId = pQueryParms->planId;
+		ds->planSlot = pQueryParms->planSlot;
+		ds->planRefText = buildGpQueryString(pQueryParms, true,
+											 &ds->planRefTextLen);
+	}
 
 	/*
 	 * Allocate result array with enough slots for QEs of primary gangs.
@@ -1311,6 +1389,52 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 	estate->dispatcherState = ds;
 }
 
+/*
+ * Can the writer gang of the plan prepare the transaction as soon as it has
+ * run the plan?
+ *
+ * Only if it is the only gang the plan is dispatched to: a reader QE on the
+ * same segment could still be running when its writer prepares.  And the
+ * writer gang has to cover all the segments the transaction has written to
+ * before.  A transaction on a single segment commits in one phase, which is
+ * cheaper still.
+ */
+static bool
+canPrepareWithPlan(SliceVec *sliceVector, int nSlices)
+{
+	Gang	   *writerGang = NULL;
+	Bitmapset  *segments = NULL;
+	bool		result;
+	int			i;
+
+	if (getCurrentDtxState() != DTX_STATE_ACTIVE_DISTRIBUTED)
+		return false;
+
+	for (i = 0; i < nSlices; i++)
+	{
+		Slice	   *slice = sliceVector[i].slice;
+
+		if (slice == NULL || slice->gangType == GANGTYPE_UNALLOCATED)
+			continue;
+
+		if (slice->gangType != GANGTYPE_PRIMARY_WRITER || writerGang != NULL)
+			return false;
+
+		writerGang = slice->primaryGang;
+	}
+
+	if (writerGang == NULL || writerGang->size < 2)
+		return false;
+
+	for (i = 0; i < writerGang->size; i++)
+		segments = bms_add_member(segments, writerGang->db_descriptors[i]->segindex);
+
+	result = bms_is_subset(MyTmGxactLocal->dtxSegmentsMap, segments);
+	bms_free(segments);
+
+	return result;
+}
+
 /*
  * Serialization of query parameters (ParamListInfos).
  *
@@ -1523,7 +1647,7 @@ CdbDispatchCopyStart(struct CdbCopy *cdbCopy, Node *stmt, int flags)
 	 */
 	ds = cdbdisp_makeDispatcherState(false);
 
-	queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+	queryText = buildGpQueryString(pQueryParms, false, &queryTextLength);
 
 	/*
 	 * Allocate a primary QE for every available segDB in the system.
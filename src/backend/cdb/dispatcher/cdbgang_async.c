@@ -65,6 +65,10 @@ cdbgang_createGang_async(List *segments, SegmentType segmentType)
 	 */
 	bool	   *connStatusDone = NULL;
 
+	/* connection options, the same for every segment */
+	char	   *options = NULL;
+	char	   *diff_options = NULL;
+
 	size = list_length(segments);
 
 	ELOG_DISPATCHER_DEBUG("createGang size = %d, segment type = %d", size, segmentType);
@@ -125,8 +129,6 @@ create_gang_retry:
 		{
 			bool		ret;
 			char		gpqeid[100];
-			char	   *options = NULL;
-			char	   *diff_options = NULL;
 
 			/*
 			 * Create the connection requests.	If we find a segment without a
@@ -161,7 +163,12 @@ create_gang_retry:
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 						 errmsg("failed to construct connectionstring")));
 
-			makeOptions(&options, &diff_options);
+			/*
+			 * The options are the same for every segment, but walking all the
+			 * GUCs for each of them adds up on a large cluster.
+			 */
+			if (options == NULL)
+				makeOptions(&options, &diff_options);
 
 			/* start connection in asynchronous way */
 			cdbconn_doConnectStart(segdbDesc, gpqeid, options, diff_options);
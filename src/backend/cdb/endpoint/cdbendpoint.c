@@ -84,12 +84,6 @@
 
 #define WAIT_ENDPOINT_TIMEOUT_MS	100
 
-/*
- * The size of endpoint tuple queue in bytes.
- * This value refers upstream PARALLEL_TUPLE_QUEUE_SIZE
- */
-#define ENDPOINT_TUPLE_QUEUE_SIZE		65536
-
 #define SHMEM_ENDPOINTS_ENTRIES			"SharedMemoryEndpointEntries"
 #define SHMEM_ENPOINTS_SESSION_INFO		"EndpointsSessionInfosHashtable"
 #define SHMEM_PARALLEL_CURSOR_COUNT		"ParallelCursorCount"
@@ -516,6 +510,14 @@ create_and_connect_mq(TupleDesc tupleDesc, dsm_segment **mqSeg /* out */ ,
 	char		*tupdescSpace;
 	TupleDescNode *node = makeNode(TupleDescNode);
 
+	/*
+	 * The size of the tuple queue in bytes.  The upstream
+	 * PARALLEL_TUPLE_QUEUE_SIZE of 64 kB makes the endpoint stop for every
+	 * few tuples when the retrieve session reads in bursts, so it is set by
+	 * gp_endpoint_queue_size instead.
+	 */
+	Size		queueSize = (Size) gp_endpoint_queue_size * 1024;
+
 	elogif(gp_log_endpoints, LOG, "CDB_ENDPOINT: create and setup the shared memory message queue");
 
 	/* Serialize TupleDesc */
@@ -528,7 +530,7 @@ create_and_connect_mq(TupleDesc tupleDesc, dsm_segment **mqSeg /* out */ ,
 	shm_toc_initialize_estimator(&tocEst);
 	shm_toc_estimate_chunk(&tocEst, sizeof(tupdescLen));
 	shm_toc_estimate_chunk(&tocEst, tupdescLen);
-	shm_toc_estimate_chunk(&tocEst, ENDPOINT_TUPLE_QUEUE_SIZE);
+	shm_toc_estimate_chunk(&tocEst, queueSize);
 	shm_toc_estimate_keys(&tocEst, 3);
 	tocSize = shm_toc_estimate(&tocEst);
 
@@ -548,8 +550,7 @@ create_and_connect_mq(TupleDesc tupleDesc, dsm_segment **mqSeg /* out */ ,
 	memcpy(tupdescSpace, tupdescSer, tupdescLen);
 	shm_toc_insert(toc, ENDPOINT_KEY_TUPLE_DESC, tupdescSpace);
 
-	mq = shm_mq_create(shm_toc_allocate(toc, ENDPOINT_TUPLE_QUEUE_SIZE),
-					   ENDPOINT_TUPLE_QUEUE_SIZE);
+	mq = shm_mq_create(shm_toc_allocate(toc, queueSize), queueSize);
 	shm_toc_insert(toc, ENDPOINT_KEY_TUPLE_QUEUE, mq);
 	shm_mq_set_sender(mq, MyProc);
 	*mqHandle = shm_mq_attach(mq, *mqSeg, NULL);
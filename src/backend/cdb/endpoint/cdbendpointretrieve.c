@@ -21,6 +21,12 @@
  * other words, one retrieve session can attach and retrieve from multiple
  * endpoints.
  *
+ * By default RETRIEVE returns a row for every tuple.  With the FORMAT option
+ * 'batch' or 'columnar', it packs many tuples in the binary send/receive
+ * format of their types into each row of a single bytea column instead, see
+ * RetrieveFormat.  That saves a client that reads a lot of data a protocol
+ * message, and the text conversion of every value, for every tuple.
+ *
  * Copyright (c) 2020-Present VMware, Inc. or its affiliates
  *
  * IDENTIFICATION
@@ -31,13 +37,20 @@
 
 #include "postgres.h"
 
+#include "access/extcolumnar.h"
 #include "access/xact.h"
+#include "catalog/pg_type.h"
+#include "commands/defrem.h"
+#include "libpq/pqformat.h"
+#include "nodes/makefuncs.h"
 #include "storage/ipc.h"
 #include "utils/backend_cancel.h"
 #include "utils/dynahash.h"
 #include "utils/elog.h"
 #include "utils/faultinjector.h"
 #include "utils/guc.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "cdbendpoint_private.h"
 #include "cdb/cdbendpoint.h"
 #include "cdb/cdbsrlz.h"
@@ -60,6 +73,31 @@ enum RetrieveState
 	RETRIEVE_STATE_FINISHED,
 };
 
+/*
+ * The layout of the rows returned by RETRIEVE, chosen by its FORMAT option.
+ *
+ * With RETRIEVE_FORMAT_BATCH and RETRIEVE_FORMAT_COLUMNAR every row has a
+ * single bytea column named "batch", holding tuples worth about BATCH_SIZE
+ * bytes.  The count of RETRIEVE is still a number of tuples.
+ */
+typedef enum RetrieveFormat
+{
+	RETRIEVE_FORMAT_TUPLE,		/* a row for every tuple */
+	RETRIEVE_FORMAT_BATCH,		/* tuples laid out as in binary COPY, without
+								 * the header and the trailer */
+	RETRIEVE_FORMAT_COLUMNAR	/* a block of the columnar external table
+								 * format, see access/extcolumnar.h */
+} RetrieveFormat;
+
+#define RETRIEVE_DEFAULT_BATCH_SIZE		(1024 * 1024)
+
+typedef struct RetrieveOptions
+{
+	RetrieveFormat format;
+	int			batchSize;
+	List	   *columnarOptions;	/* for extcolumnar_begin_write() */
+} RetrieveOptions;
+
 /*
  * For receiver, we have a hash table to store connected endpoint's shared
  * message queue. So that we can retrieve from different endpoints in the same
@@ -130,6 +168,10 @@ static void retrieve_subxact_callback(SubXactEvent event,
 									  SubTransactionId parentSubid,
 									  void *arg);
 static TupleTableSlot *retrieve_next_tuple(void);
+static void parse_retrieve_options(List *options, RetrieveOptions *opts);
+static TupleDesc batch_tuple_desc(void);
+static void retrieve_batches(const RetrieveOptions *opts, bool all,
+							 int64 count, DestReceiver *dest);
 
 /*
  * AuthEndpoint - Authenticate for retrieve connection.
@@ -165,8 +207,15 @@ AuthEndpoint(Oid userID, const char *tokenStr)
 TupleDesc
 GetRetrieveStmtTupleDesc(const RetrieveStmt * stmt)
 {
+	RetrieveOptions opts;
+
+	parse_retrieve_options(stmt->options, &opts);
+
 	start_retrieve(stmt->endpoint_name);
 
+	if (opts.format != RETRIEVE_FORMAT_TUPLE)
+		return batch_tuple_desc();
+
 	return RetrieveCtl.current_entry->retrieveTs->tts_tupleDescriptor;
 }
 
@@ -183,6 +232,9 @@ ExecRetrieveStmt(const RetrieveStmt *stmt, DestReceiver *dest)
 {
 	TupleTableSlot *result = NULL;
 	int64		retrieveCount = 0;
+	RetrieveOptions opts;
+	MemoryContext tupleContext;
+	MemoryContext oldcontext;
 
 	if (RetrieveCtl.current_entry == NULL)
 		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
@@ -196,13 +248,29 @@ ExecRetrieveStmt(const RetrieveStmt *stmt, DestReceiver *dest)
 							   "count should not be: %ld",
 							   retrieveCount)));
 
+	parse_retrieve_options(stmt->options, &opts);
+
 	Assert(dest->mydest == DestTuplestore);
 	Assert(RetrieveCtl.current_entry->retrieveState > RETRIEVE_STATE_INIT);
 
-	if (RetrieveCtl.current_entry->retrieveState < RETRIEVE_STATE_FINISHED)
+	if (RetrieveCtl.current_entry->retrieveState < RETRIEVE_STATE_FINISHED &&
+		opts.format != RETRIEVE_FORMAT_TUPLE)
+		retrieve_batches(&opts, stmt->is_all, retrieveCount, dest);
+	else if (RetrieveCtl.current_entry->retrieveState < RETRIEVE_STATE_FINISHED)
 	{
+		/*
+		 * The tuplestore keeps a copy of every tuple, so free the ones read
+		 * from the queue as we go rather than at the end of the statement.
+		 */
+		tupleContext = AllocSetContextCreate(CurrentMemoryContext,
+											 "RetrieveTupleContext",
+											 ALLOCSET_DEFAULT_SIZES);
+		oldcontext = MemoryContextSwitchTo(tupleContext);
+
 		while (stmt->is_all || retrieveCount > 0)
 		{
+			MemoryContextReset(tupleContext);
+
 			result = retrieve_next_tuple();
 			if (!result)
 				break;
@@ -211,6 +279,9 @@ ExecRetrieveStmt(const RetrieveStmt *stmt, DestReceiver *dest)
 			if (!stmt->is_all)
 				retrieveCount--;
 		}
+
+		MemoryContextSwitchTo(oldcontext);
+		MemoryContextDelete(tupleContext);
 	}
 	else
 	{
@@ -220,6 +291,245 @@ ExecRetrieveStmt(const RetrieveStmt *stmt, DestReceiver *dest)
 	finish_retrieve(false);
 }
 
+/*
+ * parse_retrieve_options - Check the WITH options of RETRIEVE.
+ */
+static void
+parse_retrieve_options(List *options, RetrieveOptions *opts)
+{
+	ListCell   *lc;
+	DefElem    *format = NULL;
+	DefElem    *batchSize = NULL;
+	DefElem    *compression = NULL;
+
+	opts->format = RETRIEVE_FORMAT_TUPLE;
+	opts->batchSize = RETRIEVE_DEFAULT_BATCH_SIZE;
+	opts->columnarOptions = NIL;
+
+	foreach(lc, options)
+	{
+		DefElem    *defel = (DefElem *) lfirst(lc);
+		DefElem   **dest;
+
+		if (strcmp(defel->defname, "format") == 0)
+			dest = &format;
+		else if (strcmp(defel->defname, "batch_size") == 0)
+			dest = &batchSize;
+		else if (strcmp(defel->defname, "compression") == 0)
+			dest = &compression;
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_SYNTAX_ERROR),
+					 errmsg("option \"%s\" not recognized", defel->defname)));
+
+		if (*dest != NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_SYNTAX_ERROR),
+					 errmsg("conflicting or redundant options")));
+		*dest = defel;
+	}
+
+	if (format)
+	{
+		char	   *fmt = defGetString(format);
+
+		if (pg_strcasecmp(fmt, "tuple") == 0)
+			opts->format = RETRIEVE_FORMAT_TUPLE;
+		else if (pg_strcasecmp(fmt, "batch") == 0)
+			opts->format = RETRIEVE_FORMAT_BATCH;
+		else if (pg_strcasecmp(fmt, "columnar") == 0)
+			opts->format = RETRIEVE_FORMAT_COLUMNAR;
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("RETRIEVE format \"%s\" not recognized", fmt),
+					 errhint("Valid formats are \"tuple\", \"batch\" and \"columnar\".")));
+	}
+
+	if (batchSize)
+	{
+		int64		size = defGetInt64(batchSize);
+
+		if (opts->format == RETRIEVE_FORMAT_TUPLE)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("RETRIEVE option \"batch_size\" is only valid with format \"batch\" or \"columnar\"")));
+		if (size < 1 || size > EXTCOLUMNAR_MAX_BLOCK_SIZE)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("batch_size must be between 1 and %d bytes",
+							EXTCOLUMNAR_MAX_BLOCK_SIZE)));
+		opts->batchSize = (int) size;
+	}
+
+	if (opts->format == RETRIEVE_FORMAT_COLUMNAR)
+	{
+		/* the statistics of a block are of no use to a client */
+		opts->columnarOptions =
+			list_make2(makeDefElem("block_size",
+								   (Node *) makeInteger(opts->batchSize)),
+					   makeDefElem("statistics",
+								   (Node *) makeString("false")));
+		if (compression)
+			opts->columnarOptions = lappend(opts->columnarOptions, compression);
+	}
+	else if (compression)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("RETRIEVE option \"compression\" is only valid with format \"columnar\"")));
+}
+
+/*
+ * The descriptor of the rows of the batch formats.
+ */
+static TupleDesc
+batch_tuple_desc(void)
+{
+	TupleDesc	tupdesc = CreateTemplateTupleDesc(1, false);
+
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "batch", BYTEAOID, -1, 0);
+
+	return tupdesc;
+}
+
+/*
+ * Send the batch in buf to dest as a row, and start a new one.
+ *
+ * buf starts with room for a varlena header, so that its data can be sent
+ * as the bytea without another copy.
+ */
+static void
+send_batch(StringInfo buf, TupleTableSlot *slot, DestReceiver *dest)
+{
+	SET_VARSIZE(buf->data, buf->len);
+
+	ExecClearTuple(slot);
+	slot_get_values(slot)[0] = PointerGetDatum(buf->data);
+	slot_get_isnull(slot)[0] = false;
+	ExecStoreVirtualTuple(slot);
+	(*dest->receiveSlot) (slot, dest);
+
+	resetStringInfo(buf);
+	appendStringInfoSpaces(buf, VARHDRSZ);
+}
+
+/*
+ * retrieve_batches - RETRIEVE in one of the batch formats.
+ *
+ * Read up to count tuples from the endpoint, all of them if all is set, and
+ * send them to dest packed into rows of batch_tuple_desc().
+ */
+static void
+retrieve_batches(const RetrieveOptions *opts, bool all, int64 count,
+				 DestReceiver *dest)
+{
+	TupleDesc	tupdesc = RetrieveCtl.current_entry->retrieveTs->tts_tupleDescriptor;
+	int			natts = tupdesc->natts;
+	TupleTableSlot *batchSlot;
+	ExtColumnarWriter *writer = NULL;
+	FmgrInfo   *sendFuncs = NULL;
+	MemoryContext tupleContext;
+	MemoryContext oldcontext;
+	StringInfoData buf;
+	int			i;
+
+	batchSlot = MakeSingleTupleTableSlot(batch_tuple_desc());
+	initStringInfo(&buf);
+	appendStringInfoSpaces(&buf, VARHDRSZ);
+
+	if (opts->format == RETRIEVE_FORMAT_COLUMNAR)
+		writer = extcolumnar_begin_write(tupdesc, opts->columnarOptions);
+	else
+	{
+		sendFuncs = palloc(natts * sizeof(FmgrInfo));
+		for (i = 0; i < natts; i++)
+		{
+			Oid			sendFunc;
+			bool		isvarlena;
+
+			getTypeBinaryOutputInfo(tupdesc->attrs[i]->atttypid,
+									&sendFunc, &isvarlena);
+			fmgr_info(sendFunc, &sendFuncs[i]);
+		}
+	}
+
+	/* for the tuple read from the queue, and the output of send functions */
+	tupleContext = AllocSetContextCreate(CurrentMemoryContext,
+										 "RetrieveTupleContext",
+										 ALLOCSET_DEFAULT_SIZES);
+
+	while (all || count > 0)
+	{
+		TupleTableSlot *slot;
+		Datum	   *values;
+		bool	   *isnull;
+		bool		full;
+
+		MemoryContextReset(tupleContext);
+		oldcontext = MemoryContextSwitchTo(tupleContext);
+
+		slot = retrieve_next_tuple();
+		if (!slot)
+		{
+			MemoryContextSwitchTo(oldcontext);
+			break;
+		}
+
+		slot_getallattrs(slot);
+		values = slot_get_values(slot);
+		isnull = slot_get_isnull(slot);
+
+		if (writer)
+			full = extcolumnar_add_row(writer, values, isnull);
+		else
+		{
+			/* the tuple layout of binary COPY */
+			pq_sendint(&buf, natts, 2);
+			for (i = 0; i < natts; i++)
+			{
+				bytea	   *outputbytes;
+
+				if (isnull[i])
+				{
+					pq_sendint(&buf, -1, 4);
+					continue;
+				}
+				outputbytes = SendFunctionCall(&sendFuncs[i], values[i]);
+				pq_sendint(&buf, VARSIZE(outputbytes) - VARHDRSZ, 4);
+				pq_sendbytes(&buf, VARDATA(outputbytes),
+							 VARSIZE(outputbytes) - VARHDRSZ);
+			}
+			full = buf.len - VARHDRSZ >= opts->batchSize;
+		}
+
+		MemoryContextSwitchTo(oldcontext);
+
+		if (full)
+		{
+			if (writer)
+				extcolumnar_flush(writer, &buf);
+			send_batch(&buf, batchSlot, dest);
+		}
+
+		if (!all)
+			count--;
+	}
+
+	if (writer)
+	{
+		extcolumnar_flush(writer, &buf);
+		extcolumnar_end_write(writer);
+	}
+	if (buf.len > VARHDRSZ)
+		send_batch(&buf, batchSlot, dest);
+
+	MemoryContextDelete(tupleContext);
+	ExecDropSingleTupleTableSlot(batchSlot);
+	pfree(buf.data);
+	if (sendFuncs)
+		pfree(sendFuncs);
+}
+
 /*
  * init_retrieve_exec_entry - Initialize RetrieveExecEntry.
  */
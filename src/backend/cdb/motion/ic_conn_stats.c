@@ -0,0 +1,247 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_conn_stats.c
+ *	  Statistics of recently closed UDP interconnect connections.
+ *
+ * When a motion sender tears down its UDP interconnect connections, it files
+ * the round trip times, retransmits and congestion window of each of them in
+ * a small ring in shared memory.  The ring keeps the last
+ * IC_CONN_STATS_SLOTS connections of the whole segment, older ones are
+ * overwritten.  gp_interconnect_get_conn_stats() shows the ring of the local
+ * segment, the gp_interconnect_conn_stats view those of the whole cluster.
+ *
+ * Connections to peers on the same host that go through shared memory have
+ * no round trips to speak of and are left out.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/motion/ic_conn_stats.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "cdb/cdbgang.h"
+#include "cdb/cdbvars.h"
+#include "cdb/ic_conn_stats.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/builtins.h"
+#include "utils/timestamp.h"
+
+#define IC_CONN_STATS_SLOTS (1024)
+
+#define NUM_IC_CONN_STATS_COLS (17)
+
+typedef struct ICConnStatsEntry
+{
+	int			sessionId;
+	int			commandCount;
+	int			pid;
+	int			motNodeId;
+	int			dstContentId;
+	int			dstPid;
+	int			fcMethod;
+	uint64		packetsSent;
+	uint64		packetsResent;
+	uint64		acks;
+	uint64		rtt;
+	uint64		dev;
+	uint64		minRtt;
+	uint64		maxAckTime;
+	float		cwnd;
+	float		ssthresh;
+	TimestampTz endTime;
+} ICConnStatsEntry;
+
+typedef struct ICConnStatsShared
+{
+	slock_t		mutex;
+
+	/* number of entries ever reported, the next one goes to slot next % N */
+	uint64		next;
+
+	ICConnStatsEntry entries[IC_CONN_STATS_SLOTS];
+} ICConnStatsShared;
+
+static ICConnStatsShared *icConnStats = NULL;
+
+Size
+ICConnStatsShmemSize(void)
+{
+	return sizeof(ICConnStatsShared);
+}
+
+void
+ICConnStatsShmemInit(void)
+{
+	bool		found;
+
+	icConnStats = ShmemInitStruct("Interconnect Connection Stats",
+								  ICConnStatsShmemSize(), &found);
+	if (!found)
+	{
+		SpinLockInit(&icConnStats->mutex);
+		icConnStats->next = 0;
+	}
+}
+
+/*
+ * ICConnStatsReport
+ * 		File the statistics of a sender's connection that is being closed.
+ *
+ * This is called during interconnect teardown and must not throw.
+ */
+void
+ICConnStatsReport(MotionConn *conn, int motNodeId)
+{
+	ICConnStatsEntry entry;
+
+	if (icConnStats == NULL || conn->cdbProc == NULL)
+		return;
+
+	entry.sessionId = gp_session_id;
+	entry.commandCount = gp_command_count;
+	entry.pid = MyProcPid;
+	entry.motNodeId = motNodeId;
+	entry.dstContentId = conn->cdbProc->contentid;
+	entry.dstPid = conn->cdbProc->pid;
+	entry.fcMethod = Gp_interconnect_fc_method;
+	entry.packetsSent = conn->sentSeq;
+	entry.packetsResent = conn->stat_count_resent;
+	entry.acks = conn->stat_count_acks;
+	entry.rtt = conn->rtt;
+	entry.dev = conn->dev;
+	entry.minRtt = conn->minRtt;
+	entry.maxAckTime = conn->stat_max_ack_time;
+	entry.cwnd = conn->cwnd;
+	entry.ssthresh = conn->ssthresh;
+	entry.endTime = GetCurrentTimestamp();
+
+	SpinLockAcquire(&icConnStats->mutex);
+	icConnStats->entries[icConnStats->next % IC_CONN_STATS_SLOTS] = entry;
+	icConnStats->next++;
+	SpinLockRelease(&icConnStats->mutex);
+}
+
+static const char *
+fcMethodName(int fcMethod)
+{
+	switch (fcMethod)
+	{
+		case INTERCONNECT_FC_METHOD_CAPACITY:
+			return "capacity";
+		case INTERCONNECT_FC_METHOD_LOSS:
+			return "loss";
+		case INTERCONNECT_FC_METHOD_DELAY:
+			return "delay";
+	}
+	return "unknown";
+}
+
+typedef struct
+{
+	ICConnStatsEntry *entries;
+	int			nentries;
+} ICConnStatsContext;
+
+/*
+ * gp_interconnect_get_conn_stats
+ * 		Return the connection statistics filed on this segment, oldest first.
+ *
+ * RTTs and ack times are in microseconds.  The congestion window and slow
+ * start threshold only exist under delay based flow control, min_rtt only
+ * under loss and delay based flow control; they are NULL otherwise.
+ */
+Datum
+gp_interconnect_get_conn_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	ICConnStatsContext *context;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+		uint64		next;
+		int			i;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		context = palloc(sizeof(ICConnStatsContext));
+		context->entries = palloc(sizeof(ICConnStatsEntry) * IC_CONN_STATS_SLOTS);
+		context->nentries = 0;
+
+		/* copy the ring out, so that the lock is held for a short time only */
+		if (icConnStats != NULL)
+		{
+			SpinLockAcquire(&icConnStats->mutex);
+			next = icConnStats->next;
+			context->nentries = Min(next, IC_CONN_STATS_SLOTS);
+			for (i = 0; i < context->nentries; i++)
+				context->entries[i] =
+					icConnStats->entries[(next - context->nentries + i) % IC_CONN_STATS_SLOTS];
+			SpinLockRelease(&icConnStats->mutex);
+		}
+
+		funcctx->user_fctx = context;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	context = (ICConnStatsContext *) funcctx->user_fctx;
+
+	if (funcctx->call_cntr < context->nentries)
+	{
+		ICConnStatsEntry *entry = &context->entries[funcctx->call_cntr];
+		Datum		values[NUM_IC_CONN_STATS_COLS];
+		bool		nulls[NUM_IC_CONN_STATS_COLS];
+		bool		hasWindow = (entry->fcMethod == INTERCONNECT_FC_METHOD_DELAY);
+		HeapTuple	tuple;
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = Int32GetDatum(entry->sessionId);
+		values[1] = Int32GetDatum(entry->commandCount);
+		values[2] = Int32GetDatum(entry->pid);
+		values[3] = Int32GetDatum(entry->motNodeId);
+		values[4] = Int32GetDatum(entry->dstContentId);
+		values[5] = Int32GetDatum(entry->dstPid);
+		values[6] = CStringGetTextDatum(fcMethodName(entry->fcMethod));
+		values[7] = Int64GetDatum((int64) entry->packetsSent);
+		values[8] = Int64GetDatum((int64) entry->packetsResent);
+		values[9] = Int64GetDatum((int64) entry->acks);
+		values[10] = Int64GetDatum((int64) entry->rtt);
+		values[11] = Int64GetDatum((int64) entry->dev);
+		if (entry->minRtt == PG_UINT64_MAX)
+			nulls[12] = true;
+		else
+			values[12] = Int64GetDatum((int64) entry->minRtt);
+		values[13] = Int64GetDatum((int64) entry->maxAckTime);
+		if (hasWindow)
+			values[14] = Float8GetDatum(entry->cwnd);
+		else
+			nulls[14] = true;
+		if (hasWindow && entry->ssthresh < PG_INT32_MAX)
+			values[15] = Float8GetDatum(entry->ssthresh);
+		else
+			nulls[15] = true;
+		values[16] = TimestampTzGetDatum(entry->endTime);
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
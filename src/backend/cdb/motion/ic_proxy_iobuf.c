@@ -19,6 +19,12 @@
  *
  * Other formats can be supported by providing custom methods.
  *
+ * A callback that forwards the packets can take them over with
+ * ic_proxy_ibuf_take() or ic_proxy_obuf_take(), instead of copying them.
+ * Whenever possible the buffer that holds the packet is handed over, so a
+ * packet can travel from the socket it is read from to the one it is written
+ * to without being copied at all.
+ *
  *
  * Copyright (c) 2020-Present Pivotal Software, Inc.
  *
@@ -53,6 +59,9 @@ ic_proxy_ibuf_init(ICProxyIBuf *ibuf, uint16 header_size,
 
 	ibuf->header_size = header_size;
 	ibuf->get_packet_size = get_packet_size;
+
+	ibuf->takeable = NULL;
+	ibuf->taken = false;
 }
 
 /*
@@ -92,27 +101,38 @@ ic_proxy_ibuf_empty(const ICProxyIBuf *ibuf)
 }
 
 /*
- * Push data to the ibuf.
- *
- * The "data" and "size" are the pointer and the size of the data, they are
- * appended to the "ibuf".  If a complete packet is composed the "callback" is
- * called with the "opaque" as the callback data.
+ * Feed a packet to the ibuf callback.
  *
- * If "size" is 0 then a force flush is triggered, the "callback" is called
- * with the incomplete packet.
+ * If "takeable" is true the callback may take over the packet buffer with
+ * ic_proxy_ibuf_take().  Return true if it did so.
+ */
+static inline bool
+ic_proxy_ibuf_callback(ICProxyIBuf *ibuf, const char *data, uint16 size,
+					   bool takeable,
+					   ic_proxy_iobuf_data_callback callback, void *opaque)
+{
+	ibuf->takeable = takeable ? data : NULL;
+	ibuf->taken = false;
+
+	callback(opaque, data, size);
+
+	ibuf->takeable = NULL;
+	return ibuf->taken;
+}
+
+/*
+ * Push data to the ibuf, the common part of ic_proxy_ibuf_push() and
+ * ic_proxy_ibuf_push_buffer().
  *
- * TODO: libuv supports sending an array of buffers, so it is technically
- * possible to prevent the memory copying in this function, we only need to let
- * the get_packet_size() method supports parsing the packet size from an array
- * of buffers.  However the callback function also needs to support
- * non-continues packet, an easy way is to only copying the header into
- * continues memory.
+ * "buffer" is the packet cache buffer that holds the data, or NULL if the data
+ * is not in a packet cache buffer.  It is set to NULL once the callback takes
+ * it over.
  */
-void
-ic_proxy_ibuf_push(ICProxyIBuf *ibuf,
-				   const char *data, uint16 size,
-				   ic_proxy_iobuf_data_callback callback,
-				   void *opaque)
+static void
+ic_proxy_ibuf_push_internal(ICProxyIBuf *ibuf,
+							const char *data, uint16 size, char **buffer,
+							ic_proxy_iobuf_data_callback callback,
+							void *opaque)
 {
 	uint16		packet_size;
 	uint16		delta;
@@ -124,7 +144,9 @@ ic_proxy_ibuf_push(ICProxyIBuf *ibuf,
 	if (unlikely(size == 0))
 	{
 		/* TODO: do we need to flush if ibuf->len is 0? */
-		callback(opaque, ibuf->buf, ibuf->len);
+		if (ic_proxy_ibuf_callback(ibuf, ibuf->buf, ibuf->len, true,
+								   callback, opaque))
+			ibuf->buf = NULL;
 		ibuf->len = 0;
 		return;
 	}
@@ -165,9 +187,13 @@ ic_proxy_ibuf_push(ICProxyIBuf *ibuf,
 		}
 
 		{
-			/* have a complete pkt now */
-
-			callback(opaque, ibuf->buf, packet_size);
+			/*
+			 * have a complete pkt now, the callback can have our buffer as
+			 * we are done with it.
+			 */
+			if (ic_proxy_ibuf_callback(ibuf, ibuf->buf, packet_size, true,
+									   callback, opaque))
+				ibuf->buf = NULL;
 			ibuf->len = 0;
 		}
 	}
@@ -178,9 +204,18 @@ ic_proxy_ibuf_push(ICProxyIBuf *ibuf,
 
 		if (packet_size > 0 && packet_size <= size)
 		{
-			/* got a complete pkt */
-			callback(opaque, data, packet_size);
-
+			/*
+			 * got a complete pkt.  The callback can have the caller's buffer
+			 * only if the pkt fills it from the start to the end, otherwise we
+			 * still need the buffer after the callback, or the pkt does not
+			 * start where a packet cache buffer does.
+			 */
+			bool		takeable = (buffer && *buffer == data &&
+									packet_size == size);
+
+			if (ic_proxy_ibuf_callback(ibuf, data, packet_size, takeable,
+									   callback, opaque))
+				*buffer = NULL;
 			data += packet_size;
 			size -= packet_size;
 		}
@@ -192,11 +227,85 @@ ic_proxy_ibuf_push(ICProxyIBuf *ibuf,
 	if (size > 0)
 	{
 		/* got a incomplete pkt */
+		if (unlikely(ibuf->buf == NULL))
+			ibuf->buf = ic_proxy_pkt_cache_alloc(NULL);
+
 		memcpy(ibuf->buf, data, size);
 		ibuf->len = size;
 	}
 }
 
+/*
+ * Push data to the ibuf.
+ *
+ * The "data" and "size" are the pointer and the size of the data, they are
+ * appended to the "ibuf".  If a complete packet is composed the "callback" is
+ * called with the "opaque" as the callback data.
+ *
+ * If "size" is 0 then a force flush is triggered, the "callback" is called
+ * with the incomplete packet.
+ *
+ * A packet passed to the "callback" is only valid during the callback, unless
+ * the callback takes it over with ic_proxy_ibuf_take().
+ */
+void
+ic_proxy_ibuf_push(ICProxyIBuf *ibuf,
+				   const char *data, uint16 size,
+				   ic_proxy_iobuf_data_callback callback,
+				   void *opaque)
+{
+	ic_proxy_ibuf_push_internal(ibuf, data, size, NULL, callback, opaque);
+}
+
+/*
+ * Push a packet cache buffer to the ibuf.
+ *
+ * Same as ic_proxy_ibuf_push(), but the data is in "buffer", a buffer
+ * allocated with ic_proxy_pkt_cache_alloc(), whose ownership is taken.  When
+ * the buffer holds exactly one packet, which is the common case for large
+ * packets, the callback can take over the buffer itself instead of a copy.
+ */
+void
+ic_proxy_ibuf_push_buffer(ICProxyIBuf *ibuf,
+						  char *buffer, uint16 size,
+						  ic_proxy_iobuf_data_callback callback,
+						  void *opaque)
+{
+	ic_proxy_ibuf_push_internal(ibuf, buffer, size, &buffer,
+								callback, opaque);
+
+	if (buffer)
+		ic_proxy_pkt_cache_free(buffer);
+}
+
+/*
+ * Take over a packet that is being fed to an ibuf callback.
+ *
+ * This must be called by the callback, with the "data" and "size" it is
+ * called with.  Return a packet cache buffer that contains the packet, it
+ * must be freed with ic_proxy_pkt_cache_free().
+ *
+ * The buffer that the ibuf assembled the packet in, or that the caller pushed
+ * with ic_proxy_ibuf_push_buffer(), is returned directly when possible, so
+ * forwarding a packet needs no copying; otherwise a copy is returned.
+ */
+void *
+ic_proxy_ibuf_take(ICProxyIBuf *ibuf, const void *data, uint16 size)
+{
+	char	   *buf;
+
+	if (data == ibuf->takeable)
+	{
+		ibuf->takeable = NULL;
+		ibuf->taken = true;
+		return (void *) data;
+	}
+
+	buf = ic_proxy_pkt_cache_alloc(NULL);
+	memcpy(buf, data, size);
+	return buf;
+}
+
 /*
  * Get the packet size of a b2c one.
  *
@@ -365,6 +474,35 @@ ic_proxy_obuf_push(ICProxyOBuf *obuf,
 	}
 }
 
+/*
+ * Take over a packet that is being fed to an obuf callback.
+ *
+ * This must be called by the callback, with the "data" and "size" it is
+ * called with.  Return a packet cache buffer that contains the packet, it
+ * must be freed with ic_proxy_pkt_cache_free().
+ *
+ * The obuf buffer itself is returned, so no data is copied, and the obuf
+ * continues with a new buffer, only the header is copied to it.
+ */
+void *
+ic_proxy_obuf_take(ICProxyOBuf *obuf, const void *data, uint16 size)
+{
+	char	   *buf;
+
+	if (data != obuf->buf)
+	{
+		buf = ic_proxy_pkt_cache_alloc(NULL);
+		memcpy(buf, data, size);
+		return buf;
+	}
+
+	buf = obuf->buf;
+	obuf->buf = ic_proxy_pkt_cache_alloc(NULL);
+	memcpy(obuf->buf, buf, obuf->header_size);
+
+	return buf;
+}
+
 /*
  * Set the packet size of a b2c one.
  *
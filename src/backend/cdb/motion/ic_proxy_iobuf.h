@@ -32,6 +32,13 @@ struct ICProxyIBuf
 
 	uint16		header_size;
 	uint16		(* get_packet_size) (const void *data);
+
+	/*
+	 * The packet being fed to the callback if the callback may take it over
+	 * with ic_proxy_ibuf_take(), NULL otherwise.
+	 */
+	const char *takeable;
+	bool		taken;
 };
 
 struct ICProxyOBuf
@@ -55,6 +62,8 @@ extern void ic_proxy_obuf_push(ICProxyOBuf *obuf,
 							   const char *data, uint16 size,
 							   ic_proxy_iobuf_data_callback callback,
 							   void *opaque);
+extern void *ic_proxy_obuf_take(ICProxyOBuf *obuf,
+								const void *data, uint16 size);
 
 
 extern void ic_proxy_ibuf_init(ICProxyIBuf *ibuf, uint16 header_size,
@@ -68,5 +77,11 @@ extern void ic_proxy_ibuf_push(ICProxyIBuf *ibuf,
 							   const char *data, uint16 size,
 							   ic_proxy_iobuf_data_callback callback,
 							   void *opaque);
+extern void ic_proxy_ibuf_push_buffer(ICProxyIBuf *ibuf,
+									  char *buffer, uint16 size,
+									  ic_proxy_iobuf_data_callback callback,
+									  void *opaque);
+extern void *ic_proxy_ibuf_take(ICProxyIBuf *ibuf,
+								const void *data, uint16 size);
 
 #endif   /* IC_PROXY_IOBUF_H */
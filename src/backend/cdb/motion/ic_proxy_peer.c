@@ -309,7 +309,9 @@ ic_proxy_peer_on_data_pkt(void *opaque, const void *data, uint16 size)
 		return;
 	}
 
-	ic_proxy_router_route(peer->tcp.loop, ic_proxy_pkt_dup(pkt), NULL, NULL);
+	ic_proxy_router_route(peer->tcp.loop,
+						  ic_proxy_ibuf_take(&peer->ibuf, data, size),
+						  NULL, NULL);
 }
 
 /*
@@ -345,9 +347,9 @@ ic_proxy_peer_on_data(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf)
 		return;
 	}
 
-	ic_proxy_ibuf_push(&peer->ibuf, buf->base, nread,
-					   ic_proxy_peer_on_data_pkt, peer);
-	ic_proxy_pkt_cache_free(buf->base);
+	/* the ibuf takes the ownership of the buffer */
+	ic_proxy_ibuf_push_buffer(&peer->ibuf, buf->base, nread,
+							  ic_proxy_peer_on_data_pkt, peer);
 }
 
 /*
@@ -14,10 +14,8 @@
  * size, discarding the size requested by libuv, so the packet buffer can be
  * safely reused later.
  *
- * TODO:
- * - many libuv requests, such as uv_write(), needs us to allocate the request
- *   buffer, they are not reused, too, we could consider saving them in a
- *   free list similarly, or even share the same free list with packets;
+ * The write requests of the router are recycled the same way, see
+ * ic_proxy_router_write().
  *
  *
  * Copyright (c) 2020-Present Pivotal Software, Inc.
@@ -38,8 +38,19 @@ struct ICProxyWriteReq
 
 	ic_proxy_sent_cb callback;	/* the callback */
 	void	   *opaque;			/* the callback data */
+
+	ICProxyWriteReq *next;		/* link in the free list */
 };
 
+/*
+ * Every packet is written with its own request, so they are recycled in a
+ * free list instead of being allocated and freed per packet.
+ */
+#define IC_PROXY_WRITE_REQ_CACHE_MAX_SIZE 1024
+
+static ICProxyWriteReq *ic_proxy_router_free_wreqs;
+static int	ic_proxy_router_n_free_wreqs;
+
 /*
  * The loopback packet queue.
  *
@@ -159,6 +170,9 @@ ic_proxy_router_init(uv_loop_t *loop)
 {
 	uv_check_init(loop, &ic_proxy_router_loopback.check);
 	ic_proxy_router_loopback.queue = NIL;
+
+	ic_proxy_router_free_wreqs = NULL;
+	ic_proxy_router_n_free_wreqs = 0;
 }
 
 /*
@@ -193,6 +207,15 @@ ic_proxy_router_uninit(void)
 	}
 
 	list_free(queue);
+
+	while (ic_proxy_router_free_wreqs)
+	{
+		ICProxyWriteReq *wreq = ic_proxy_router_free_wreqs;
+
+		ic_proxy_router_free_wreqs = wreq->next;
+		ic_proxy_free(wreq);
+	}
+	ic_proxy_router_n_free_wreqs = 0;
 }
 
 /*
@@ -274,7 +297,15 @@ ic_proxy_router_on_write(uv_write_t *req, int status)
 		wreq->callback(wreq->opaque, pkt, status);
 
 	ic_proxy_pkt_cache_free(pkt);
-	ic_proxy_free(req);
+
+	if (ic_proxy_router_n_free_wreqs < IC_PROXY_WRITE_REQ_CACHE_MAX_SIZE)
+	{
+		wreq->next = ic_proxy_router_free_wreqs;
+		ic_proxy_router_free_wreqs = wreq;
+		ic_proxy_router_n_free_wreqs++;
+	}
+	else
+		ic_proxy_free(wreq);
 }
 
 /*
@@ -305,7 +336,14 @@ ic_proxy_router_write(uv_stream_t *stream, ICProxyPkt *pkt, int32 offset,
 	elogif(gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG, DEBUG5,
 		   "ic-proxy: router: sending %s", ic_proxy_pkt_to_str(pkt));
 
-	wreq = ic_proxy_new(ICProxyWriteReq);
+	if (ic_proxy_router_free_wreqs)
+	{
+		wreq = ic_proxy_router_free_wreqs;
+		ic_proxy_router_free_wreqs = wreq->next;
+		ic_proxy_router_n_free_wreqs--;
+	}
+	else
+		wreq = ic_proxy_new(ICProxyWriteReq);
 
 	wreq->req.data = pkt;
 	wreq->callback = callback;
@@ -0,0 +1,685 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_shm.c
+ *	  Shared-memory packet rings for interconnect peers on the same host.
+ *
+ * When a motion sender and its receiver run on the same host, the UDP
+ * interconnect moves their data packets through a ring in shared memory
+ * instead of the loopback device.  This saves the system calls, the kernel
+ * copies, the CRC and the whole ack/retransmit machinery for that pair:
+ * shared memory does not lose or reorder packets.
+ *
+ * Each sender/receiver pair of a motion gets its own single-producer,
+ * single-consumer ring of fixed-size slots, each big enough for one
+ * interconnect packet.  The sender copies a finished packet into the next
+ * free slot and advances the head; the receiver parses the packet in place
+ * and advances the tail once the motion layer is done with it.
+ *
+ * The two ends belong to different postmasters, so the dynamic shared memory
+ * of either one cannot be used.  Instead both ends shm_open() the same,
+ * deterministically named POSIX segment, whichever comes first creates it.
+ * As the name is easy to guess, the segment is created exclusively, and the
+ * end that finds it already there only uses it if it belongs to our user and
+ * nobody else has access to it; otherwise another local user could read or
+ * inject interconnect data.  The second one to attach removes the name
+ * again, so a finished ring is gone as soon as both ends unmap it.  If the
+ * peer never attached, the ring is kept for it as long as the peer process
+ * exists (in the normal case the peer is just late), and removed otherwise.
+ * A process remembers the rings it kept and removes whatever is left of them
+ * when it exits, and the postmaster removes the rings of processes that are
+ * gone when it starts, so that rings of crashed backends don't pile up.
+ *
+ * Whether a process "exists" is decided by ic_shm_pid_alive(): the pid must
+ * belong to a process of our user that was started before the ring was
+ * created, so that a recycled pid does not keep a dead ring alive.
+ *
+ * Waking up a receiver that sleeps on an empty ring is left to the caller:
+ * ic_shm_ring_publish() tells it when the receiver asked to be woken.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/motion/ic_shm.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cdb/ml_ipc.h"
+#include "portability/mem.h"
+
+#include "ic_shm.h"
+
+#ifdef IC_SHM_AVAILABLE
+
+/*
+ * Where the names of POSIX shared memory segments show up as files, and the
+ * prefix ic_shm_build_ring_name() gives the names of ring segments.
+ */
+#define IC_SHM_DIR			"/dev/shm"
+#define IC_SHM_NAME_PREFIX	"PostgreSQL.gpic."
+
+/*
+ * Rings this process kept for a peer that had not attached yet, removed at
+ * exit at the latest.  If there are more, the oldest one is removed early:
+ * its statement is long over.
+ */
+#define IC_SHM_MAX_KEPT_RINGS 64
+
+static char keptRings[IC_SHM_MAX_KEPT_RINGS][IC_SHM_NAME_LEN];
+static int	nextKeptRing = 0;
+
+/*
+ * Control block at the start of every ring segment.
+ *
+ * A fresh segment is zero-filled, which is a valid empty ring, so apart from
+ * the creation time neither end has to initialize it.  head and tail are
+ * free-running counters, the slot of a counter value is its remainder modulo
+ * the number of slots.  They are kept in separate cache lines as each one is
+ * written by a different process.
+ */
+typedef struct ICShmRingHeader
+{
+	/* number of processes that attached to the segment so far */
+	pg_atomic_uint32 attached;
+
+	/* set by the receiver when it needs no more data */
+	pg_atomic_uint32 stopRequested;
+
+	/* ic_shm_boot_ticks() when the segment was created, 0 if unknown */
+	uint64		createdAt;
+
+	char		pad1[PG_CACHE_LINE_SIZE - 2 * sizeof(pg_atomic_uint32) - sizeof(uint64)];
+
+	/* written by the sender only */
+	pg_atomic_uint32 head;
+
+	char		pad2[PG_CACHE_LINE_SIZE - sizeof(pg_atomic_uint32)];
+
+	/* written by the receiver only */
+	pg_atomic_uint32 tail;
+
+	/* set by the receiver before it goes to sleep on an empty ring */
+	pg_atomic_uint32 receiverWaiting;
+
+	char		pad3[PG_CACHE_LINE_SIZE - 2 * sizeof(pg_atomic_uint32)];
+} ICShmRingHeader;
+
+#define IC_SHM_HEADER_SIZE	TYPEALIGN(PG_CACHE_LINE_SIZE, sizeof(ICShmRingHeader))
+
+/*
+ * ic_shm_boot_ticks
+ * 		Clock ticks since boot, in the unit of process start times in
+ * 		/proc/<pid>/stat; 0 if that is not available.
+ */
+static uint64
+ic_shm_boot_ticks(void)
+{
+	FILE	   *file;
+	double		uptime;
+	uint64		result = 0;
+
+	file = fopen("/proc/uptime", "r");
+	if (file == NULL)
+		return 0;
+	if (fscanf(file, "%lf", &uptime) == 1 && uptime > 0)
+		result = (uint64) (uptime * sysconf(_SC_CLK_TCK));
+	fclose(file);
+
+	return result;
+}
+
+/*
+ * ic_shm_process_start_ticks
+ * 		Start time of a process in clock ticks since boot, 0 if unknown.
+ */
+static uint64
+ic_shm_process_start_ticks(int pid)
+{
+	char		path[MAXPGPATH];
+	char		buf[1024];
+	FILE	   *file;
+	size_t		len;
+	char	   *p;
+	unsigned long long starttime;
+
+	snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+	file = fopen(path, "r");
+	if (file == NULL)
+		return 0;
+	len = fread(buf, 1, sizeof(buf) - 1, file);
+	fclose(file);
+	buf[len] = '\0';
+
+	/*
+	 * The command name in parentheses may contain anything, so start after
+	 * its closing parenthesis: from there, starttime is the 20th field.
+	 */
+	p = strrchr(buf, ')');
+	if (p == NULL)
+		return 0;
+	for (int field = 0; field < 20; field++)
+	{
+		p = strchr(p + 1, ' ');
+		if (p == NULL)
+			return 0;
+	}
+	if (sscanf(p, " %llu", &starttime) != 1)
+		return 0;
+
+	return (uint64) starttime;
+}
+
+/*
+ * ic_shm_pid_alive
+ * 		Can pid still be an end of a ring created at createdAt?
+ *
+ * Only a process of our own user can be; kill() fails with EPERM for any
+ * other.  A process started after the ring was created only reuses the pid
+ * of a process that is gone.  We allow a second of slack for the different
+ * clocks the two times come from.  Where start times are not available, the
+ * pid existing has to do.
+ */
+static bool
+ic_shm_pid_alive(int pid, uint64 createdAt)
+{
+	uint64		started;
+
+	if (kill(pid, 0) != 0)
+		return false;
+
+	if (createdAt == 0)
+		return true;
+	started = ic_shm_process_start_ticks(pid);
+	if (started == 0)
+		return true;
+
+	return started <= createdAt + sysconf(_SC_CLK_TCK);
+}
+
+/*
+ * ic_shm_check_owner
+ * 		Error out unless the segment is ours and private to us.
+ */
+static void
+ic_shm_check_owner(int fd, const char *name, struct stat *st)
+{
+	if (st->st_uid != geteuid())
+	{
+		close(fd);
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("interconnect shared memory segment \"%s\" has wrong ownership",
+						name),
+				 errhint("Another user may have created the segment; remove it.")));
+	}
+	if (st->st_mode & (S_IRWXG | S_IRWXO))
+	{
+		close(fd);
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("interconnect shared memory segment \"%s\" has group or world access",
+						name),
+				 errdetail("Permissions should be u=rw (0600).")));
+	}
+}
+
+/*
+ * ic_shm_ring_attach
+ * 		Create or open the named ring segment and map it.
+ *
+ * Both ends must pass the same slot size and count.
+ */
+void
+ic_shm_ring_attach(ICShmRing *ring, const char *name,
+				   int slotSize, int nslots, bool isSender, int peerPid)
+{
+	struct stat st;
+	Size		mapSize;
+	void	   *addr;
+	bool		created;
+	int			fd;
+
+	Assert(slotSize > 0 && nslots > 0);
+
+	slotSize = MAXALIGN(slotSize);
+	mapSize = IC_SHM_HEADER_SIZE + (Size) slotSize * nslots;
+
+	/*
+	 * Create the segment, or open the one the peer created.  The peer may
+	 * give up on the ring and remove it in between, then try again.
+	 */
+	for (;;)
+	{
+		fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+		created = (fd >= 0);
+		if (fd >= 0 || errno != EEXIST)
+			break;
+		fd = shm_open(name, O_RDWR, 0);
+		if (fd >= 0 || errno != ENOENT)
+			break;
+	}
+	if (fd < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("interconnect could not open shared memory segment \"%s\": %m",
+						name)));
+
+	if (fstat(fd, &st) != 0)
+	{
+		int			save_errno = errno;
+
+		close(fd);
+		errno = save_errno;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("interconnect could not stat shared memory segment \"%s\": %m",
+						name)));
+	}
+
+	if (!created)
+		ic_shm_check_owner(fd, name, &st);
+
+	/*
+	 * Both ends may find the segment empty and resize it; that is harmless as
+	 * they resize it to the same size.
+	 */
+	if (st.st_size == 0 && ftruncate(fd, mapSize) != 0)
+	{
+		int			save_errno = errno;
+
+		close(fd);
+		shm_unlink(name);
+		errno = save_errno;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("interconnect could not resize shared memory segment \"%s\" to %zu bytes: %m",
+						name, mapSize)));
+	}
+	else if (st.st_size != 0 && st.st_size != mapSize)
+	{
+		close(fd);
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("interconnect shared memory segment \"%s\" has size %zu, expected %zu",
+						name, (Size) st.st_size, mapSize),
+				 errhint("Make sure gp_max_packet_size and gp_interconnect_shm_queue_depth are the same on all segments.")));
+	}
+
+	addr = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_HASSEMAPHORE, fd, 0);
+	if (addr == MAP_FAILED)
+	{
+		int			save_errno = errno;
+
+		close(fd);
+		errno = save_errno;
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("interconnect could not map shared memory segment \"%s\": %m",
+						name)));
+	}
+	close(fd);
+
+	strlcpy(ring->name, name, sizeof(ring->name));
+	ring->hdr = (ICShmRingHeader *) addr;
+	ring->slots = (char *) addr + IC_SHM_HEADER_SIZE;
+	ring->mapSize = mapSize;
+	ring->slotSize = slotSize;
+	ring->nslots = nslots;
+	ring->isSender = isSender;
+	ring->peerPid = peerPid;
+	ring->unlinked = false;
+	ring->pos = isSender ? pg_atomic_read_u32(&ring->hdr->head) :
+		pg_atomic_read_u32(&ring->hdr->tail);
+
+	if (created)
+		ring->hdr->createdAt = ic_shm_boot_ticks();
+
+	/* both ends are here, nobody else will look the segment up */
+	if (pg_atomic_fetch_add_u32(&ring->hdr->attached, 1) == 1)
+	{
+		shm_unlink(ring->name);
+		ring->unlinked = true;
+	}
+}
+
+/*
+ * ic_shm_ring_detach
+ * 		Unmap the ring.
+ *
+ * A receiver always leaves a stop request behind, so that a sender that is
+ * still producing finds out it can quit.  If the peer never attached, the
+ * segment is kept for it when keepForPeer is set and the peer process still
+ * exists, and removed otherwise.
+ *
+ * This is called during interconnect teardown and must not throw.
+ */
+void
+ic_shm_ring_detach(ICShmRing *ring, bool keepForPeer)
+{
+	if (ring->hdr == NULL)
+		return;
+
+	if (!ring->isSender)
+		pg_atomic_write_u32(&ring->hdr->stopRequested, 1);
+
+	if (!ring->unlinked && pg_atomic_read_u32(&ring->hdr->attached) < 2)
+	{
+		if (keepForPeer &&
+			ic_shm_pid_alive(ring->peerPid, ring->hdr->createdAt))
+		{
+			char	   *kept = keptRings[nextKeptRing];
+
+			if (kept[0] != '\0')
+				shm_unlink(kept);
+			strlcpy(kept, ring->name, IC_SHM_NAME_LEN);
+			nextKeptRing = (nextKeptRing + 1) % IC_SHM_MAX_KEPT_RINGS;
+		}
+		else
+			shm_unlink(ring->name);
+	}
+
+	munmap(ring->hdr, ring->mapSize);
+	ring->hdr = NULL;
+	ring->slots = NULL;
+}
+
+/*
+ * ic_shm_ring_reserve
+ * 		Return the next free slot, or NULL if the ring is full.
+ *
+ * The slot is handed to the receiver by ic_shm_ring_publish().
+ */
+char *
+ic_shm_ring_reserve(ICShmRing *ring)
+{
+	ICShmRingHeader *hdr = ring->hdr;
+
+	Assert(ring->isSender);
+
+	if (ring->pos - pg_atomic_read_u32(&hdr->tail) >= (uint32) ring->nslots)
+		return NULL;
+
+	/* don't let our writes into the slot overtake the read of tail */
+	pg_memory_barrier();
+
+	return ring->slots + (Size) (ring->pos % ring->nslots) * ring->slotSize;
+}
+
+/*
+ * ic_shm_ring_publish
+ * 		Hand the reserved slot to the receiver.
+ *
+ * Returns true if the receiver is asleep and must be woken up.
+ */
+bool
+ic_shm_ring_publish(ICShmRing *ring)
+{
+	ICShmRingHeader *hdr = ring->hdr;
+
+	Assert(ring->isSender);
+
+	/* the packet must be visible before the new head */
+	pg_write_barrier();
+	pg_atomic_write_u32(&hdr->head, ++ring->pos);
+
+	/* pairs with the barrier in ic_shm_ring_arm_wakeup() */
+	pg_memory_barrier();
+
+	return pg_atomic_read_u32(&hdr->receiverWaiting) != 0 &&
+		pg_atomic_exchange_u32(&hdr->receiverWaiting, 0) != 0;
+}
+
+/*
+ * ic_shm_ring_stop_requested
+ * 		Has the receiver asked for no more data?
+ */
+bool
+ic_shm_ring_stop_requested(ICShmRing *ring)
+{
+	return pg_atomic_read_u32(&ring->hdr->stopRequested) != 0;
+}
+
+/*
+ * ic_shm_ring_peek
+ * 		Return the oldest unconsumed packet, or NULL if the ring is empty.
+ *
+ * The packet stays valid until ic_shm_ring_release().
+ */
+char *
+ic_shm_ring_peek(ICShmRing *ring)
+{
+	ICShmRingHeader *hdr = ring->hdr;
+
+	Assert(!ring->isSender);
+
+	if (pg_atomic_read_u32(&hdr->head) == ring->pos)
+		return NULL;
+
+	/* don't read the packet before the head that published it */
+	pg_read_barrier();
+
+	return ring->slots + (Size) (ring->pos % ring->nslots) * ring->slotSize;
+}
+
+/*
+ * ic_shm_ring_release
+ * 		Give the oldest packet's slot back to the sender.
+ */
+void
+ic_shm_ring_release(ICShmRing *ring)
+{
+	ICShmRingHeader *hdr = ring->hdr;
+
+	Assert(!ring->isSender);
+	Assert(pg_atomic_read_u32(&hdr->head) != ring->pos);
+
+	/* we must be done reading the slot before the sender may reuse it */
+	pg_memory_barrier();
+	pg_atomic_write_u32(&hdr->tail, ++ring->pos);
+}
+
+/*
+ * ic_shm_ring_arm_wakeup
+ * 		Ask the sender for a wakeup on its next packet.
+ *
+ * Returns false if a packet arrived meanwhile, in which case the caller must
+ * not go to sleep.
+ */
+bool
+ic_shm_ring_arm_wakeup(ICShmRing *ring)
+{
+	ICShmRingHeader *hdr = ring->hdr;
+
+	Assert(!ring->isSender);
+
+	pg_atomic_write_u32(&hdr->receiverWaiting, 1);
+
+	/* pairs with the barrier in ic_shm_ring_publish() */
+	pg_memory_barrier();
+
+	return pg_atomic_read_u32(&hdr->head) == ring->pos;
+}
+
+/*
+ * ic_shm_ring_request_stop
+ * 		Tell the sender that no more data is needed.
+ */
+void
+ic_shm_ring_request_stop(ICShmRing *ring)
+{
+	Assert(!ring->isSender);
+
+	pg_atomic_write_u32(&ring->hdr->stopRequested, 1);
+}
+
+/*
+ * ic_shm_remove_kept_rings
+ * 		Remove the rings kept for peers by ic_shm_ring_detach().
+ *
+ * Called at process exit.  Rings the peer attached to meanwhile are gone
+ * already, so most of these fail harmlessly.
+ */
+void
+ic_shm_remove_kept_rings(void)
+{
+	for (int i = 0; i < IC_SHM_MAX_KEPT_RINGS; i++)
+	{
+		if (keptRings[i][0] != '\0')
+			shm_unlink(keptRings[i]);
+		keptRings[i][0] = '\0';
+	}
+	nextKeptRing = 0;
+}
+
+/*
+ * RemoveStaleInterconnectShmRings
+ * 		Remove the rings of sender/receiver pairs one of which is gone.
+ *
+ * A ring is named after the pids of both ends and is useless once either
+ * process has exited; this catches the rings of crashed backends.  Rings of
+ * other users are left alone.  Called at postmaster start.  Only possible
+ * where segment names can be listed.
+ */
+void
+RemoveStaleInterconnectShmRings(void)
+{
+	DIR		   *dir;
+	struct dirent *de;
+
+	dir = opendir(IC_SHM_DIR);
+	if (dir == NULL)
+		return;
+
+	while ((de = readdir(dir)) != NULL)
+	{
+		char		name[MAXPGPATH];
+		struct stat st;
+		uint64		createdAt = 0;
+		int			senderPid;
+		int			receiverPid;
+		int			fd;
+
+		if (strncmp(de->d_name, IC_SHM_NAME_PREFIX,
+					strlen(IC_SHM_NAME_PREFIX)) != 0)
+			continue;
+
+		if (sscanf(de->d_name + strlen(IC_SHM_NAME_PREFIX), "%d.%d.",
+				   &senderPid, &receiverPid) != 2)
+			continue;
+
+		snprintf(name, sizeof(name), "/%s", de->d_name);
+
+		fd = shm_open(name, O_RDONLY, 0);
+		if (fd < 0)
+			continue;
+		if (fstat(fd, &st) != 0 || st.st_uid != geteuid())
+		{
+			close(fd);
+			continue;
+		}
+		if (st.st_size >= IC_SHM_HEADER_SIZE)
+		{
+			ICShmRingHeader *hdr;
+
+			hdr = mmap(NULL, IC_SHM_HEADER_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+			if (hdr != MAP_FAILED)
+			{
+				createdAt = hdr->createdAt;
+				munmap(hdr, IC_SHM_HEADER_SIZE);
+			}
+		}
+		close(fd);
+
+		if (ic_shm_pid_alive(senderPid, createdAt) &&
+			ic_shm_pid_alive(receiverPid, createdAt))
+			continue;
+
+		if (shm_unlink(name) == 0)
+			elog(DEBUG1, "removed stale interconnect shared memory segment \"%s\"",
+				 name);
+	}
+
+	closedir(dir);
+}
+
+#else							/* !IC_SHM_AVAILABLE */
+
+/*
+ * Without POSIX shared memory or native atomics the UDP interconnect never
+ * selects the shared-memory path, so none of these can be reached.
+ */
+
+void
+ic_shm_ring_attach(ICShmRing *ring, const char *name,
+				   int slotSize, int nslots, bool isSender, int peerPid)
+{
+	elog(ERROR, "interconnect shared memory rings are not supported on this platform");
+}
+
+void
+ic_shm_ring_detach(ICShmRing *ring, bool keepForPeer)
+{
+}
+
+char *
+ic_shm_ring_reserve(ICShmRing *ring)
+{
+	return NULL;
+}
+
+bool
+ic_shm_ring_publish(ICShmRing *ring)
+{
+	return false;
+}
+
+bool
+ic_shm_ring_stop_requested(ICShmRing *ring)
+{
+	return true;
+}
+
+char *
+ic_shm_ring_peek(ICShmRing *ring)
+{
+	return NULL;
+}
+
+void
+ic_shm_ring_release(ICShmRing *ring)
+{
+}
+
+bool
+ic_shm_ring_arm_wakeup(ICShmRing *ring)
+{
+	return true;
+}
+
+void
+ic_shm_ring_request_stop(ICShmRing *ring)
+{
+}
+
+void
+ic_shm_remove_kept_rings(void)
+{
+}
+
+void
+RemoveStaleInterconnectShmRings(void)
+{
+}
+
+#endif							/* IC_SHM_AVAILABLE */
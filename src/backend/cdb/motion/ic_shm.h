@@ -0,0 +1,85 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_shm.h
+ *	  Shared-memory packet rings for interconnect peers on the same host.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/motion/ic_shm.h
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef IC_SHM_H
+#define IC_SHM_H
+
+#include "port/atomics.h"
+
+/*
+ * The rings live in POSIX shared memory and are driven by lock-free atomics
+ * shared between two unrelated backends, so both are required.
+ */
+#if defined(HAVE_SHM_OPEN) && !defined(PG_HAVE_ATOMIC_U32_SIMULATION)
+#define IC_SHM_AVAILABLE
+#endif
+
+struct ICShmRingHeader;
+
+/* room for a segment name built by ic_shm_build_ring_name() */
+#define IC_SHM_NAME_LEN 64
+
+/*
+ * Process-local handle of one end of a single-producer, single-consumer ring
+ * of fixed-size packet slots.
+ */
+typedef struct ICShmRing
+{
+	char		name[IC_SHM_NAME_LEN];	/* shm_open() name of the segment */
+	struct ICShmRingHeader *hdr;	/* control block at the start of the
+									 * mapping */
+	char	   *slots;			/* first packet slot */
+	Size		mapSize;		/* total size of the mapping */
+	int			slotSize;		/* bytes per slot, MAXALIGN'ed */
+	int			nslots;			/* number of slots */
+	bool		isSender;		/* which end of the ring we are */
+	int			peerPid;		/* pid of the other end */
+	bool		unlinked;		/* we removed the name already */
+	uint32		pos;			/* private copy of head (sender) or tail
+								 * (receiver) */
+} ICShmRing;
+
+/*
+ * Build the name of the segment shared by a sender and a receiver.
+ *
+ * Process ids are unique on a host, so they keep segments of different
+ * segments, sessions and even clusters apart; the interconnect id and motion
+ * id tell apart the rings of one pair of processes.
+ */
+static inline void
+ic_shm_build_ring_name(char *buf, size_t bufsize, int senderPid,
+					   int receiverPid, uint32 icId, int motNodeId)
+{
+	snprintf(buf, bufsize, "/PostgreSQL.gpic.%d.%d.%u.%d",
+			 senderPid, receiverPid, icId, motNodeId);
+}
+
+extern void ic_shm_ring_attach(ICShmRing *ring, const char *name,
+							   int slotSize, int nslots, bool isSender,
+							   int peerPid);
+extern void ic_shm_ring_detach(ICShmRing *ring, bool keepForPeer);
+extern void ic_shm_remove_kept_rings(void);
+
+/* sender side */
+extern char *ic_shm_ring_reserve(ICShmRing *ring);
+extern bool ic_shm_ring_publish(ICShmRing *ring);
+extern bool ic_shm_ring_stop_requested(ICShmRing *ring);
+
+/* receiver side */
+extern char *ic_shm_ring_peek(ICShmRing *ring);
+extern void ic_shm_ring_release(ICShmRing *ring);
+extern bool ic_shm_ring_arm_wakeup(ICShmRing *ring);
+extern void ic_shm_ring_request_stop(ICShmRing *ring);
+
+#endif   /* IC_SHM_H */
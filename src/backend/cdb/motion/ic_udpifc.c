@@ -51,6 +51,9 @@
 #include "cdb/cdbdisp.h"
 #include "cdb/cdbdispatchresult.h"
 #include "cdb/cdbicudpfaultinjection.h"
+#include "cdb/ic_conn_stats.h"
+
+#include "ic_shm.h"
 
 #include <fcntl.h>
 #include <limits.h>
@@ -58,6 +61,7 @@
 #include <arpa/inet.h>
 #include "pgtime.h"
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <ifaddrs.h>
 
 #ifdef WIN32
@@ -138,6 +142,20 @@ int
 /* 1/4 sec in msec */
 #define RX_THREAD_POLL_TIMEOUT (250)
 
+/* upper limit of gp_interconnect_batch_size */
+#define IC_MAX_BATCH (64)
+
+/*
+ * UDP generic segmentation offload: the kernel cuts one message into
+ * datagrams of the given size.  It takes at most 64 segments, and all of
+ * them together must fit into the largest UDP payload.
+ */
+#if defined(HAVE_SENDMMSG) && defined(UDP_SEGMENT)
+#define IC_HAVE_UDP_GSO
+#define IC_GSO_MAX_SEGMENTS (64)
+#define IC_GSO_MAX_BYTES (65507)
+#endif
+
 /*
  * Flags definitions for flag-field of UDP-messages
  *
@@ -151,6 +169,7 @@ int
 #define UDPIC_FLAGS_DISORDER    		(32)
 #define UDPIC_FLAGS_DUPLICATE   		(64)
 #define UDPIC_FLAGS_CAPACITY    		(128)
+#define UDPIC_FLAGS_SHM_DOORBELL		(256)
 
 /*
  * ConnHtabBin
@@ -523,6 +542,27 @@ static ICGlobalControlInfo ic_control_info;
 
 #define MAX_SEQS_IN_DISORDER_ACK (4)
 
+/*
+ * Delay based flow control (gp_interconnect_fc_method = delay) keeps a
+ * congestion window per connection. It estimates how many packets of a
+ * connection wait in some queue along the path from how much the RTT exceeds
+ * the smallest RTT seen on it:
+ *     queued = cwnd x (RTT - minRTT) / RTT
+ * Once per round trip, the window grows by one packet if fewer than
+ * DELAY_FC_ALPHA packets are queued, and shrinks by one if more than
+ * DELAY_FC_BETA are. Slow start doubles the window every round trip until
+ * more than DELAY_FC_GAMMA packets are queued. A loss halves the window.
+ */
+#define DELAY_FC_ALPHA (2)
+#define DELAY_FC_BETA (4)
+#define DELAY_FC_GAMMA (1)
+#define DELAY_FC_MIN_CWND (2)
+
+/* LOSS and DELAY flow control both retransmit from the unack queue ring */
+#define IC_FC_USES_UNACK_RING() \
+	(Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS || \
+	 Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+
 /*
  * UnackQueueRing
  *
@@ -624,7 +664,9 @@ typedef struct ICStatistics
 	int32		mismatchNum;
 	int32		crcErrors;
 	int32		sndPktNum;
+	int32		sndSyscallNum;
 	int32		recvPktNum;
+	int32		recvSyscallNum;
 	int32		disorderedPktNum;
 	int32		duplicatedPktNum;
 	int32		recvAckNum;
@@ -637,6 +679,11 @@ static ICStatistics ic_statistics;
 /* Cached sockaddr of the listening udp socket */
 static struct sockaddr_storage udp_dummy_packet_sockaddr;
 
+#ifdef IC_HAVE_UDP_GSO
+/* Set once the kernel refused to segment our packets */
+static bool udp_gso_failed = false;
+#endif
+
 /*=========================================================================
  * STATIC FUNCTIONS declarations
  */
@@ -738,8 +785,12 @@ static void checkQDConnectionAlive(void);
 
 
 static void *rxThreadFunc(void *arg);
+static bool handleRxPacket(icpkthdr *pkt, int read_count, struct sockaddr_storage *peer, socklen_t *peerlen);
+static int	rxReceivePackets(icpkthdr **pkts, int *lens, struct sockaddr_storage *peers,
+							 socklen_t *peerlens, int nbufs);
 
 static bool handleMismatch(icpkthdr *pkt, struct sockaddr_storage *peer, int peer_len);
+static void updateDelayWindow(MotionConn *conn, uint32 seq, uint64 ackTime);
 static void handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now);
 static bool handleAcks(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry);
 static void handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, int16 motionId);
@@ -749,10 +800,23 @@ static bool handleAckForDuplicatePkt(MotionConn *conn, icpkthdr *pkt);
 static bool handleAckForDisorderPkt(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn, icpkthdr *pkt);
 
 static inline void prepareXmit(MotionConn *conn);
+static bool useShmForPeer(Slice *localSlice, CdbProcess *peer);
+static void setupShmConnection(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+							   MotionConn *conn, bool isSender);
+static void sendBuffersShm(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static void checkExceptions(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+				MotionConn *conn, int retry, int timeout);
+static bool prepareShmConnForRead(MotionConn *conn);
+static MotionConn *findShmConnForRead(ChunkTransportStateEntry *pEntry, MotionConn *conn);
+static bool armShmWakeups(ChunkTransportStateEntry *pEntry, MotionConn *conn);
 static inline void addCRC(icpkthdr *pkt);
 static inline bool checkCRC(icpkthdr *pkt);
 static void sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
 static void sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn *conn);
+static void sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn);
+#ifdef HAVE_SENDMMSG
+static int	sendBatchMmsg(ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn);
+#endif
 static inline uint64 computeExpirationPeriod(MotionConn *conn, uint32 retry);
 
 static ICBuffer *getSndBuffer(MotionConn *conn);
@@ -1648,6 +1712,9 @@ CleanupMotionUDPIFC(void)
 	pfree(rx_control_info.disorderBuffer);
 	rx_control_info.disorderBuffer = NULL;
 
+	/* remove the shared-memory rings no peer came for */
+	ic_shm_remove_kept_rings();
+
 	/* free the buffer for acks */
 	pfree(snd_control_info.ackBuffer);
 	snd_control_info.ackBuffer = NULL;
@@ -2110,6 +2177,17 @@ MlPutRxBufferIFC(ChunkTransportState *transportStates, int motNodeID, int route)
 
 	conn = pEntry->conns + route;
 
+	/* packets from shared memory are neither acked nor counted in the pool */
+	if (conn->shmRing != NULL)
+	{
+		if (conn->pBuff == NULL)
+			elog(FATAL, "Interconnect error: tried to release a NULL buffer");
+
+		conn->pBuff = NULL;
+		ic_shm_ring_release(conn->shmRing);
+		return;
+	}
+
 	memset(&param, 0, sizeof(AckSendParam));
 
 	pthread_mutex_lock(&ic_control_info.lock);
@@ -2816,6 +2894,11 @@ startOutgoingUDPConnections(ChunkTransportState *transportStates,
 
 			conn->rtt = DEFAULT_RTT;
 			conn->dev = DEFAULT_DEV;
+			conn->cwnd = DELAY_FC_MIN_CWND;
+			conn->ssthresh = PG_INT32_MAX;	/* slow start until queueing or loss */
+			conn->minRtt = PG_UINT64_MAX;
+			conn->roundRtt = PG_UINT64_MAX;
+			conn->roundEndSeq = 0;
 			conn->deadlockCheckBeginTime = 0;
 			conn->tupleCount = 0;
 			conn->msgSize = sizeof(conn->conn_info);
@@ -3033,8 +3116,80 @@ setupOutgoingUDPConnection(ChunkTransportState *transportStates, ChunkTransportS
 	conn->conn_info.seq = 1;
 	Assert(conn->peer.ss_family == AF_INET || conn->peer.ss_family == AF_INET6);
 
+	if (useShmForPeer(pEntry->sendSlice, cdbProc))
+		setupShmConnection(transportStates, pEntry, conn, true);
+
 }								/* setupOutgoingUDPConnection */
 
+/*
+ * useShmForPeer
+ * 		Should the data packets exchanged with the given peer go through
+ * 		shared memory?
+ *
+ * That is the case when the peer runs on our host.  Both ends of a connection
+ * must come to the same conclusion, so this only compares the addresses the
+ * dispatcher put into the slice table; peers that were given different
+ * addresses keep using the network even if they share a host.
+ */
+static bool
+useShmForPeer(Slice *localSlice, CdbProcess *peer)
+{
+#ifdef IC_SHM_AVAILABLE
+	ListCell   *cell;
+
+	if (!gp_interconnect_shm || peer == NULL || peer->listenerAddr == NULL)
+		return false;
+
+	foreach(cell, localSlice->primaryProcesses)
+	{
+		CdbProcess *proc = (CdbProcess *) lfirst(cell);
+
+		if (proc != NULL &&
+			proc->pid == MyProcPid &&
+			proc->contentid == GpIdentity.segindex)
+			return proc->listenerAddr != NULL &&
+				strcmp(proc->listenerAddr, peer->listenerAddr) == 0;
+	}
+#endif
+
+	return false;
+}
+
+/*
+ * setupShmConnection
+ * 		Attach the shared-memory ring that carries the data packets of a
+ * 		connection to a peer on the same host.
+ *
+ * The connection keeps its UDP setup: the sender still rings the receiver's
+ * doorbell through the network when the receiver sleeps on an empty ring.
+ */
+static void
+setupShmConnection(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+				   MotionConn *conn, bool isSender)
+{
+	ICShmRing  *ring;
+	char		name[IC_SHM_NAME_LEN];
+
+	ic_shm_build_ring_name(name, sizeof(name),
+						   isSender ? MyProcPid : conn->cdbProc->pid,
+						   isSender ? conn->cdbProc->pid : MyProcPid,
+						   transportStates->sliceTable->ic_instance_id,
+						   pEntry->motNodeId);
+
+	ring = (ICShmRing *) palloc0(sizeof(ICShmRing));
+	ic_shm_ring_attach(ring, name, Gp_max_packet_size,
+					   Gp_interconnect_shm_queue_depth, isSender,
+					   conn->cdbProc->pid);
+	conn->shmRing = ring;
+
+	SIMPLE_FAULT_INJECTOR("interconnect_shm_ring_attached");
+
+	if (gp_log_interconnect >= GPVARS_VERBOSITY_DEBUG)
+		elog(DEBUG1, "Interconnect %s seg%d pid=%d through shared memory ring %s",
+			 isSender ? "sending to" : "receiving from",
+			 conn->cdbProc->contentid, conn->cdbProc->pid, name);
+}
+
 /*
  * handleCachedPackets
  * 		Deal with cached packets.
@@ -3304,6 +3459,9 @@ SetupUDPIFCInterconnect_Internal(SliceTable *sliceTable)
 				conn->conn_info.flags = UDPIC_FLAGS_RECEIVER_TO_SENDER;
 
 				connAddHash(&ic_control_info.connHtab, conn);
+
+				if (useShmForPeer(mySlice, conn->cdbProc))
+					setupShmConnection(interconnect_context, pEntry, conn, false);
 			}
 		}
 	}
@@ -3616,14 +3774,26 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 					computeNetworkStatistics(conn->rtt, &minRtt, &maxRtt, &avgRtt);
 					computeNetworkStatistics(conn->dev, &minDev, &maxDev, &avgDev);
 
+					if (conn->shmRing == NULL)
+						ICConnStatsReport(conn, pEntry->motNodeId);
+
 					icBufferListReturn(&conn->sndQueue, false);
 					icBufferListReturn(&conn->unackQueue, Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_CAPACITY ? false : true);
 
+					if (conn->shmRing != NULL)
+						ic_shm_ring_detach(conn->shmRing, !hasErrors);
+
 					connDelHash(&ic_control_info.connHtab, conn);
 				}
 				avgRtt = avgRtt / pEntry->numConns;
 				avgDev = avgDev / pEntry->numConns;
 
+				elog((gp_interconnect_log_stats ? LOG : DEBUG1),
+					 "Interconnect seg%d slice%d sent " UINT64_FORMAT " bytes through shared memory, "
+					 UINT64_FORMAT " bytes through the network",
+					 GpIdentity.segindex, mySlice->sliceIndex,
+					 pEntry->stat_shm_bytes_sent, pEntry->stat_udp_bytes_sent);
+
 				/* free all send side buffers */
 				cleanSndBufferPool(&snd_buffer_pool);
 			}
@@ -3691,6 +3861,9 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 
 					connDelHash(&ic_control_info.connHtab, conn);
 
+					if (conn->shmRing != NULL)
+						ic_shm_ring_detach(conn->shmRing, !hasErrors);
+
 					/*
 					 * putRxBufferAndSendAck() dequeues messages and moves
 					 * them to pBuff
@@ -3754,8 +3927,8 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 		 "UNACK_QUEUE_RING_SLOTS_NUM %d TIMER_SPAN %lld DEFAULT_RTT %d "
 		 "hasErrors %d, ic_instance_id %d ic_id_last_teardown %d "
 		 "snd_buffer_pool.count %d snd_buffer_pool.maxCount %d snd_sock_bufsize %d recv_sock_bufsize %d "
-		 "snd_pkt_count %d retransmits %d crc_errors %d"
-		 " recv_pkt_count %d recv_ack_num %d"
+		 "snd_pkt_count %d snd_syscall_count %d retransmits %d crc_errors %d"
+		 " recv_pkt_count %d recv_syscall_count %d recv_ack_num %d"
 		 " recv_queue_size_avg %f"
 		 " capacity_avg %f"
 		 " freebuf_avg %f "
@@ -3767,8 +3940,8 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 		 UNACK_QUEUE_RING_SLOTS_NUM, TIMER_SPAN, DEFAULT_RTT,
 		 hasErrors, transportStates->sliceTable->ic_instance_id, rx_control_info.lastTornIcId,
 		 snd_buffer_pool.count, snd_buffer_pool.maxCount, ic_control_info.socketSendBufferSize, ic_control_info.socketRecvBufferSize,
-		 ic_statistics.sndPktNum, ic_statistics.retransmits, ic_statistics.crcErrors,
-		 ic_statistics.recvPktNum, ic_statistics.recvAckNum,
+		 ic_statistics.sndPktNum, ic_statistics.sndSyscallNum, ic_statistics.retransmits, ic_statistics.crcErrors,
+		 ic_statistics.recvPktNum, ic_statistics.recvSyscallNum, ic_statistics.recvAckNum,
 		 (double) ((double) ic_statistics.totalRecvQueueSize) / ((double) ic_statistics.recvQueueSizeCountingTime),
 		 (double) ((double) ic_statistics.totalCapacity) / ((double) ic_statistics.capacityCountingTime),
 		 (double) ((double) ic_statistics.totalBuffers) / ((double) ic_statistics.bufferCountingTime),
@@ -3847,6 +4020,91 @@ prepareRxConnForRead(MotionConn *conn)
 	conn->recvBytes = conn->msgSize;
 }
 
+/*
+ * prepareShmConnForRead
+ * 		Prepare a same-host connection to read the oldest packet of its
+ * 		shared-memory ring, if there is one.
+ *
+ * The packet is parsed in place; MlPutRxBufferIFC() gives its slot back.
+ */
+static bool
+prepareShmConnForRead(MotionConn *conn)
+{
+	icpkthdr   *pkt;
+
+	if (conn->shmRing == NULL)
+		return false;
+
+	pkt = (icpkthdr *) ic_shm_ring_peek(conn->shmRing);
+	if (pkt == NULL)
+		return false;
+
+	conn->pBuff = (uint8 *) pkt;
+	conn->msgPos = conn->pBuff;
+	conn->msgSize = pkt->len;
+	conn->recvBytes = conn->msgSize;
+
+	return true;
+}
+
+/*
+ * findShmConnForRead
+ * 		Find a connection with a packet waiting in its shared-memory ring and
+ * 		prepare it for reading.
+ *
+ * conn is the connection of a directed receive, or NULL to look at all
+ * active connections of the motion.
+ */
+static MotionConn *
+findShmConnForRead(ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	int			i,
+				index;
+
+	if (conn != NULL)
+		return prepareShmConnForRead(conn) ? conn : NULL;
+
+	index = pEntry->scanStart;
+	for (i = 0; i < pEntry->numConns; i++, index++)
+	{
+		if (index >= pEntry->numConns)
+			index = 0;
+
+		conn = pEntry->conns + index;
+		if (conn->stillActive && prepareShmConnForRead(conn))
+			return conn;
+	}
+
+	return NULL;
+}
+
+/*
+ * armShmWakeups
+ * 		Ask the same-host senders we are waiting on to ring our doorbell when
+ * 		they publish a packet.
+ *
+ * Returns false if a packet arrived in the meantime, so that we must not go
+ * to sleep.
+ */
+static bool
+armShmWakeups(ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	int			i;
+
+	if (conn != NULL)
+		return conn->shmRing == NULL || ic_shm_ring_arm_wakeup(conn->shmRing);
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		conn = pEntry->conns + i;
+		if (conn->shmRing != NULL && conn->stillActive &&
+			!ic_shm_ring_arm_wakeup(conn->shmRing))
+			return false;
+	}
+
+	return true;
+}
+
 /*
  * receiveChunksUDPIFC
  * 		Receive chunks from the senders
@@ -3896,6 +4154,10 @@ receiveChunksUDPIFC(ChunkTransportState *pTransportStates, ChunkTransportStateEn
 			elog(DEBUG2, "receiveChunksUDPIFC: non-directed rx woke on route %d", rx_control_info.mainWaitingState.reachRoute);
 			resetMainThreadWaiting(&rx_control_info.mainWaitingState);
 		}
+		else if ((rxconn = findShmConnForRead(pEntry, conn)) != NULL)
+		{
+			resetMainThreadWaiting(&rx_control_info.mainWaitingState);
+		}
 
 		aggregateStatistics(pEntry);
 
@@ -3923,6 +4185,14 @@ receiveChunksUDPIFC(ChunkTransportState *pTransportStates, ChunkTransportStateEn
 		 * arrive. The RX thread will wake us up using the latch.
 		 */
 		ResetLatch(&ic_control_info.latch);
+
+		/*
+		 * Same-host senders only ring our doorbell when asked to, and may have
+		 * published a packet since we last looked at their rings.
+		 */
+		if (!armShmWakeups(pEntry, conn))
+			continue;
+
 		pthread_mutex_unlock(&ic_control_info.lock);
 
 		/*
@@ -4042,6 +4312,12 @@ RecvTupleChunkFromAnyUDPIFC_Internal(ChunkTransportState *transportStates,
 			prepareRxConnForRead(conn);
 			break;
 		}
+
+		if (conn->stillActive && prepareShmConnForRead(conn))
+		{
+			found = true;
+			break;
+		}
 	}
 
 	if (found)
@@ -4171,6 +4447,13 @@ RecvTupleChunkFromUDPIFC_Internal(ChunkTransportState *transportStates,
 		return tcItem;
 	}
 
+	if (prepareShmConnForRead(conn))
+	{
+		pthread_mutex_unlock(&ic_control_info.lock);
+
+		return RecvTupleChunk(conn, transportStates);
+	}
+
 	/* no existing data, we've got to read a packet */
 	/* receiveChunksUDPIFC() releases ic_control_info.lock as a side-effect */
 
@@ -4284,6 +4567,55 @@ logPkt(char *prefix, icpkthdr *pkt)
 			  pkt->flags);
 }
 
+/*
+ * updateDelayWindow
+ * 		Adjust the congestion window of a connection under delay based flow
+ * 		control, given the RTT of a packet acked on the first attempt.
+ *
+ * See DELAY_FC_ALPHA for the rules.
+ */
+static void
+updateDelayWindow(MotionConn *conn, uint32 seq, uint64 ackTime)
+{
+	float		queued;
+
+	conn->roundRtt = Min(conn->roundRtt, ackTime);
+
+	/* in slow start every ack adds a packet, which doubles cwnd per round */
+	if (conn->cwnd < conn->ssthresh)
+		conn->cwnd += 1;
+
+	if (seq < conn->roundEndSeq)
+		return;
+
+	/*
+	 * A round trip is over. Judge it by its smallest RTT, the others may
+	 * just suffer from delayed acks or scheduling noise.
+	 */
+	queued = conn->cwnd * (float) (conn->roundRtt - conn->minRtt) /
+		(float) Max(conn->roundRtt, 1);
+
+	if (conn->cwnd < conn->ssthresh)
+	{
+		if (queued > DELAY_FC_GAMMA)
+		{
+			/* leave slow start with a window that drains the queue */
+			conn->cwnd -= queued;
+			conn->ssthresh = Max(conn->cwnd, DELAY_FC_MIN_CWND);
+		}
+	}
+	else if (queued < DELAY_FC_ALPHA)
+		conn->cwnd += 1;
+	else if (queued > DELAY_FC_BETA)
+		conn->cwnd -= 1;
+
+	conn->cwnd = Min(Max(conn->cwnd, DELAY_FC_MIN_CWND), snd_buffer_pool.maxCount);
+
+	/* the next round ends when the first packet sent from now on is acked */
+	conn->roundEndSeq = conn->sentSeq + 1;
+	conn->roundRtt = PG_UINT64_MAX;
+}
+
 /*
  * handleAckedPacket
  * 		Called by sender to process acked packet.
@@ -4319,7 +4651,7 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 
 	buf = icBufferListDelete(&ackConn->unackQueue, buf);
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (IC_FC_USES_UNACK_RING())
 	{
 		buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 		unack_queue_ring.numOutStanding--;
@@ -4350,12 +4682,19 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 				newDEV = Min(MAX_DEV, Max(newDEV, MIN_DEV));
 				buf->conn->dev = newDEV;
 
+				buf->conn->minRtt = Min(buf->conn->minRtt, ackTime);
+
 				/* adjust the congestion control window. */
-				if (snd_control_info.cwnd < snd_control_info.ssthresh)
-					snd_control_info.cwnd += 1;
+				if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+					updateDelayWindow(buf->conn, buf->pkt->seq, ackTime);
 				else
-					snd_control_info.cwnd += 1 / snd_control_info.cwnd;
-				snd_control_info.cwnd = Min(snd_control_info.cwnd, snd_buffer_pool.maxCount);
+				{
+					if (snd_control_info.cwnd < snd_control_info.ssthresh)
+						snd_control_info.cwnd += 1;
+					else
+						snd_control_info.cwnd += 1 / snd_control_info.cwnd;
+					snd_control_info.cwnd = Min(snd_control_info.cwnd, snd_buffer_pool.maxCount);
+				}
 			}
 		}
 	}
@@ -4759,6 +5098,167 @@ xmit_retry:
 	return;
 }
 
+/*
+ * sendBatch
+ * 		Send a batch of packets of one connection.
+ *
+ * The packets go out with as few system calls as the platform allows.
+ * Whatever sendBatchMmsg() leaves over is sent one by one by sendOnce(),
+ * which also does all the error reporting.
+ */
+static void
+sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+		  ICBuffer **bufs, int nbufs, MotionConn *conn)
+{
+	int			i = 0;
+
+#ifdef HAVE_SENDMMSG
+	bool		batched = nbufs > 1;
+
+#ifdef USE_ASSERT_CHECKING
+	/* sendOnce() drops packets on purpose for testing */
+	if (gp_udpic_dropxmit_percent != 0)
+		batched = false;
+#endif
+
+	if (batched)
+		i = sendBatchMmsg(pEntry, bufs, nbufs, conn);
+#endif
+
+	for (; i < nbufs; i++)
+	{
+		sendOnce(transportStates, pEntry, bufs[i], conn);
+		ic_statistics.sndSyscallNum++;
+	}
+}
+
+#ifdef HAVE_SENDMMSG
+/*
+ * sendBatchMmsg
+ * 		Send a batch of packets of one connection with sendmmsg().
+ *
+ * With UDP GSO, a run of packets of the same size moreover goes into a single
+ * message that the kernel, or the NIC, cuts into datagrams; only the last
+ * packet of a run may be shorter.  The peer receives the same datagrams
+ * either way.
+ *
+ * Returns the number of packets sent.  On error we stop and leave the rest
+ * to the caller.
+ */
+static int
+sendBatchMmsg(ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn)
+{
+	struct mmsghdr msgs[IC_MAX_BATCH];
+	struct iovec iovs[IC_MAX_BATCH];
+	int			firstBuf[IC_MAX_BATCH + 1];
+	int			nmsgs = 0;
+	int			sent = 0;
+	int			i = 0;
+
+#ifdef IC_HAVE_UDP_GSO
+	union
+	{
+		char		buf[CMSG_SPACE(sizeof(uint16))];
+		struct cmsghdr align;
+	}			cmsgs[IC_MAX_BATCH];
+	bool		gso = gp_interconnect_udp_gso && !udp_gso_failed;
+#endif
+
+	Assert(nbufs <= IC_MAX_BATCH);
+
+	memset(msgs, 0, nbufs * sizeof(struct mmsghdr));
+
+	while (i < nbufs)
+	{
+		struct msghdr *hdr = &msgs[nmsgs].msg_hdr;
+		int			segSize = bufs[i]->pkt->len;
+
+		firstBuf[nmsgs] = i;
+		hdr->msg_name = &conn->peer;
+		hdr->msg_namelen = conn->peer_len;
+		hdr->msg_iov = &iovs[i];
+
+		iovs[i].iov_base = bufs[i]->pkt;
+		iovs[i].iov_len = segSize;
+		i++;
+
+#ifdef IC_HAVE_UDP_GSO
+		if (gso)
+		{
+			int			lastLen = segSize;
+			int			msgLen = segSize;
+
+			while (i < nbufs &&
+				   lastLen == segSize &&
+				   bufs[i]->pkt->len <= segSize &&
+				   i - firstBuf[nmsgs] < IC_GSO_MAX_SEGMENTS &&
+				   msgLen + bufs[i]->pkt->len <= IC_GSO_MAX_BYTES)
+			{
+				lastLen = bufs[i]->pkt->len;
+				msgLen += lastLen;
+				iovs[i].iov_base = bufs[i]->pkt;
+				iovs[i].iov_len = lastLen;
+				i++;
+			}
+		}
+#endif
+
+		hdr->msg_iovlen = i - firstBuf[nmsgs];
+
+#ifdef IC_HAVE_UDP_GSO
+		if (hdr->msg_iovlen > 1)
+		{
+			struct cmsghdr *cmsg;
+
+			hdr->msg_control = cmsgs[nmsgs].buf;
+			hdr->msg_controllen = sizeof(cmsgs[nmsgs].buf);
+			cmsg = CMSG_FIRSTHDR(hdr);
+			cmsg->cmsg_level = SOL_UDP;
+			cmsg->cmsg_type = UDP_SEGMENT;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(uint16));
+			*(uint16 *) CMSG_DATA(cmsg) = (uint16) segSize;
+		}
+#endif
+
+		nmsgs++;
+	}
+	firstBuf[nmsgs] = nbufs;
+
+	while (sent < nmsgs)
+	{
+		int			n;
+
+		n = sendmmsg(pEntry->txfd, msgs + sent, nmsgs - sent, 0);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+#ifdef IC_HAVE_UDP_GSO
+
+			/*
+			 * The kernel refuses to segment if it is too old, if the
+			 * segments don't fit into the MTU of the route, or if the device
+			 * cannot checksum them.  Give up on GSO for this process.
+			 */
+			if (msgs[sent].msg_hdr.msg_controllen != 0 &&
+				(errno == EINVAL || errno == EIO || errno == ENOPROTOOPT))
+			{
+				elog(DEBUG1, "Interconnect disabled UDP segmentation offload: %m");
+				udp_gso_failed = true;
+			}
+#endif
+			break;
+		}
+
+		ic_statistics.sndSyscallNum++;
+		sent += n;
+	}
+
+	return firstBuf[sent];
+}
+#endif							/* HAVE_SENDMMSG */
+
 
 /*
  * handleStopMsgs
@@ -4868,6 +5368,16 @@ handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *p
 static void
 sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
 {
+	ICBuffer   *batch[IC_MAX_BATCH];
+	int			nbatch = 0;
+	int			maxBatch = Max(1, Min(Gp_interconnect_batch_size, IC_MAX_BATCH));
+
+	if (conn->shmRing != NULL)
+	{
+		sendBuffersShm(transportStates, pEntry, conn);
+		return;
+	}
+
 	while (conn->capacity > 0 && icBufferListLength(&conn->sndQueue) > 0)
 	{
 		ICBuffer   *buf = NULL;
@@ -4877,6 +5387,11 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 			 unack_queue_ring.numSharedOutStanding >= (snd_control_info.cwnd - snd_control_info.minCwnd)))
 			break;
 
+		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY &&
+			icBufferListLength(&conn->unackQueue) > 0 &&
+			icBufferListLength(&conn->unackQueue) >= conn->cwnd)
+			break;
+
 		/* for connection setup, we only allow one outstanding packet. */
 		if (conn->state == mcsSetupOutgoingConnection && icBufferListLength(&conn->unackQueue) >= 1)
 			break;
@@ -4893,7 +5408,7 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 
 		icBufferListAppend(&conn->unackQueue, buf);
 
-		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+		if (IC_FC_USES_UNACK_RING())
 		{
 			unack_queue_ring.numOutStanding++;
 			if (icBufferListLength(&conn->unackQueue) > 1)
@@ -4906,7 +5421,7 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		}
 
 		/*
-		 * Note the place of sendOnce here. If we send before appending it to
+		 * Note the place of sendBatch here. If we send before appending it to
 		 * the unack queue and putting it into unack queue ring, and there is
 		 * a network error occurred in the sendOnce function, error message
 		 * will be output. In the time of error message output, interrupts is
@@ -4917,14 +5432,87 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		updateStats(TPE_DATA_PKT_SEND, conn, buf->pkt);
 #endif
 
-		sendOnce(transportStates, pEntry, buf, conn);
+		batch[nbatch++] = buf;
 		ic_statistics.sndPktNum++;
+		pEntry->stat_udp_bytes_sent += buf->pkt->len;
 
 #ifdef AMS_VERBOSE_LOGGING
 		logPkt("SEND PKT DETAIL", buf->pkt);
 #endif
 
 		buf->conn->sentSeq = buf->pkt->seq;
+
+		if (nbatch == maxBatch)
+		{
+			sendBatch(transportStates, pEntry, batch, nbatch, conn);
+			nbatch = 0;
+		}
+	}
+
+	if (nbatch > 0)
+		sendBatch(transportStates, pEntry, batch, nbatch, conn);
+}
+
+/*
+ * sendBuffersShm
+ * 		Move the send queue of a same-host connection into its shared-memory
+ * 		ring.
+ *
+ * Shared memory neither loses nor reorders packets, so unlike sendBuffers()
+ * nothing is kept for retransmission and the buffers go right back to the
+ * pool.  When the ring is full we wait for the receiver to make room, unless
+ * it asks for no more data, in which case the rest of the queue is dropped.
+ */
+static void
+sendBuffersShm(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
+{
+	ICShmRing  *ring = conn->shmRing;
+
+	while (icBufferListLength(&conn->sndQueue) > 0)
+	{
+		ICBuffer   *buf;
+		char	   *slot;
+		int			retry = 0;
+
+		/* wait for room before taking the packet off the queue */
+		while ((slot = ic_shm_ring_reserve(ring)) == NULL)
+		{
+			if (ic_shm_ring_stop_requested(ring))
+			{
+				icBufferListReturn(&conn->sndQueue, false);
+				return;
+			}
+
+			checkExceptions(transportStates, pEntry, conn, retry++, 0);
+			pg_usleep(Min(10L << Min(retry, 7), 1000L));
+		}
+
+		buf = icBufferListPop(&conn->sndQueue);
+
+#ifdef TRANSFER_PROTOCOL_STATS
+		updateStats(TPE_DATA_PKT_SEND, conn, buf->pkt);
+#endif
+
+		memcpy(slot, buf->pkt, buf->pkt->len);
+
+		/*
+		 * The receiver sleeps on its latch; the rx thread sets it when the
+		 * doorbell arrives.
+		 */
+		if (ic_shm_ring_publish(ring))
+		{
+			icpkthdr	msg;
+
+			memcpy(&msg, &conn->conn_info, sizeof(icpkthdr));
+			msg.flags = UDPIC_FLAGS_SHM_DOORBELL;
+			msg.len = sizeof(icpkthdr);
+			sendControlMessage(&msg, pEntry->txfd, (struct sockaddr *) &conn->peer, conn->peer_len);
+		}
+
+		conn->sentSeq = buf->pkt->seq;
+		pEntry->stat_shm_bytes_sent += buf->pkt->len;
+
+		icBufferListAppend(&snd_buffer_pool.freeList, buf);
 	}
 }
 
@@ -5069,7 +5657,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates,
 			/* this is a lost packet, retransmit */
 
 			buf->nRetry++;
-			if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+			if (IC_FC_USES_UNACK_RING())
 			{
 				buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 				putIntoUnackQueueRing(&unack_queue_ring, buf,
@@ -5120,6 +5708,11 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates,
 		snd_control_info.ssthresh = Max(snd_control_info.cwnd / 2, snd_control_info.minCwnd);
 		snd_control_info.cwnd = snd_control_info.ssthresh;
 	}
+	else if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+	{
+		conn->ssthresh = Max(conn->cwnd / 2, DELAY_FC_MIN_CWND);
+		conn->cwnd = conn->ssthresh;
+	}
 #ifdef AMS_VERBOSE_LOGGING
 	write_log("After DISORDER: sndQ %d unackQ %d",
 			  icBufferListLength(&conn->sndQueue), icBufferListLength(&conn->unackQueue));
@@ -5288,6 +5881,14 @@ checkExpiration(ChunkTransportState *transportStates,
 			curBuf->conn->stat_max_resent = Max(curBuf->conn->stat_max_resent,
 												curBuf->conn->stat_count_resent);
 
+			/* a timeout restarts slow start, once per burst of timeouts */
+			if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY &&
+				curBuf->conn->cwnd > DELAY_FC_MIN_CWND)
+			{
+				curBuf->conn->ssthresh = Max(curBuf->conn->cwnd / 2, DELAY_FC_MIN_CWND);
+				curBuf->conn->cwnd = DELAY_FC_MIN_CWND;
+			}
+
 			checkNetworkTimeout(curBuf, now, &transportStates->networkTimeoutIsLogged);
 
 #ifdef AMS_VERBOSE_LOGGING
@@ -5484,7 +6085,7 @@ checkExceptions(ChunkTransportState *transportStates,
 		checkExpirationCapacityFC(transportStates, pEntry, conn, timeout);
 	}
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (IC_FC_USES_UNACK_RING())
 	{
 		uint64		now = getCurrentTime();
 
@@ -5537,7 +6138,7 @@ computeTimeout(MotionConn *conn, int retry)
 	if (buf->nRetry == 0 && retry == 0)
 		return 0;
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (IC_FC_USES_UNACK_RING())
 		return TIMER_CHECKING_PERIOD;
 
 	/* for capacity based flow control */
@@ -5595,6 +6196,14 @@ SendChunkUDPIFC(ChunkTransportState *transportStates,
 	icBufferListAppend(&conn->sndQueue, conn->curBuff);
 	sendBuffers(transportStates, pEntry, conn);
 
+	/* a same-host receiver asks for no more data through its ring */
+	if (conn->shmRing != NULL && !conn->stopRequested &&
+		ic_shm_ring_stop_requested(conn->shmRing))
+	{
+		conn->stopRequested = true;
+		gotStops = true;
+	}
+
 	uint64		now = getCurrentTime();
 
 	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_CAPACITY)
@@ -5849,6 +6458,12 @@ doSendStopMessageUDPIFC(ChunkTransportState *transportStates, int16 motNodeID)
 				conn->stopRequested = true;
 				conn->conn_info.flags |= UDPIC_FLAGS_STOP;
 
+				if (conn->shmRing != NULL)
+				{
+					ic_shm_ring_request_stop(conn->shmRing);
+					continue;
+				}
+
 				/*
 				 * The peer addresses for incoming connections will not be set
 				 * until the first packet has arrived. However, when the lower
@@ -6262,6 +6877,194 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 	return true;
 }
 
+/*
+ * handleRxPacket
+ * 		Process one packet read by the receive background thread.
+ *
+ * Returns true if the packet was queued on its connection, in which case the
+ * buffer belongs to the connection now.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements, see
+ * rxThreadFunc().
+ */
+static bool
+handleRxPacket(icpkthdr *pkt, int read_count, struct sockaddr_storage *peer, socklen_t *peerlen)
+{
+	MotionConn *conn = NULL;
+	bool		consumed = false;
+	bool		wakeup_mainthread = false;
+	AckSendParam param;
+
+	if (DEBUG5 >= log_min_messages)
+		write_log("received inbound len %d", read_count);
+
+	if (read_count < sizeof(icpkthdr))
+	{
+		if (DEBUG1 >= log_min_messages)
+			write_log("Interconnect error: short conn receive (%d)", read_count);
+		return false;
+	}
+
+	/* length must be >= 0 */
+	if (pkt->len < 0)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound with negative length");
+		return false;
+	}
+
+	if (pkt->len != read_count)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+		return false;
+	}
+
+	/*
+	 * check the CRC of the payload.
+	 */
+	if (gp_interconnect_full_crc)
+	{
+		if (!checkCRC(pkt))
+		{
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.crcErrors, 1);
+			if (DEBUG2 >= log_min_messages)
+				write_log("received network data error, dropping bad packet, user data unaffected.");
+			return false;
+		}
+	}
+
+#ifdef AMS_VERBOSE_LOGGING
+	logPkt("GOT MESSAGE", pkt);
+#endif
+
+	/*
+	 * A doorbell only says that a same-host sender published packets in its
+	 * shared-memory ring while the main thread was asleep.
+	 */
+	if (pkt->flags & UDPIC_FLAGS_SHM_DOORBELL)
+	{
+		SetLatch(&ic_control_info.latch);
+		return false;
+	}
+
+	memset(&param, 0, sizeof(AckSendParam));
+
+	/*
+	 * Get the connection for the pkt.
+	 *
+	 * The connection hash table should be locked until finishing the
+	 * processing of the packet to avoid the connection addition/removal from
+	 * the hash table during the mean time.
+	 */
+
+	pthread_mutex_lock(&ic_control_info.lock);
+	conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+
+	if (conn != NULL)
+	{
+		/* Handling a regular packet */
+		if (handleDataPacket(conn, pkt, peer, peerlen, &param, &wakeup_mainthread))
+			consumed = true;
+		ic_statistics.recvPktNum++;
+	}
+	else
+	{
+		/*
+		 * There may have two kinds of Mismatched packets: a) Past packets
+		 * from previous command after I was torn down b) Future packets from
+		 * current command before my connections are built.
+		 *
+		 * The handling logic is to "Ack the past and Nak the future".
+		 */
+		if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+		{
+			if (DEBUG1 >= log_min_messages)
+				write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+
+#ifdef AMS_VERBOSE_LOGGING
+			logPkt("Got a Mismatched Packet", pkt);
+#endif
+
+			if (handleMismatch(pkt, peer, *peerlen))
+				consumed = true;
+			ic_statistics.mismatchNum++;
+		}
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
+
+	if (wakeup_mainthread)
+		SetLatch(&ic_control_info.latch);
+
+	/*
+	 * real ack sending is after lock release to decrease the lock holding
+	 * time.
+	 */
+	if (param.msg.len != 0)
+		sendAckWithParam(&param);
+
+	return consumed;
+}
+
+/*
+ * rxReceivePackets
+ * 		Read up to nbufs packets from the listener socket into the given
+ * 		buffers.
+ *
+ * Returns the number of packets read, with their lengths and senders filled
+ * in, or -1 with errno set.  With recvmmsg() a single call drains as many
+ * packets as there are buffers.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements, see
+ * rxThreadFunc().
+ */
+static int
+rxReceivePackets(icpkthdr **pkts, int *lens, struct sockaddr_storage *peers,
+				 socklen_t *peerlens, int nbufs)
+{
+	int			n;
+
+#ifdef HAVE_RECVMMSG
+	if (nbufs > 1)
+	{
+		struct mmsghdr msgs[IC_MAX_BATCH];
+		struct iovec iovs[IC_MAX_BATCH];
+		int			i;
+
+		memset(msgs, 0, nbufs * sizeof(struct mmsghdr));
+		for (i = 0; i < nbufs; i++)
+		{
+			iovs[i].iov_base = pkts[i];
+			iovs[i].iov_len = Gp_max_packet_size;
+			msgs[i].msg_hdr.msg_name = &peers[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		/* don't wait for the batch to fill up */
+		n = recvmmsg(UDP_listenerFd, msgs, nbufs, MSG_DONTWAIT, NULL);
+
+		for (i = 0; i < n; i++)
+		{
+			lens[i] = msgs[i].msg_len;
+			peerlens[i] = msgs[i].msg_hdr.msg_namelen;
+		}
+
+		return n;
+	}
+#endif
+
+	peerlens[0] = sizeof(struct sockaddr_storage);
+	n = recvfrom(UDP_listenerFd, (char *) pkts[0], Gp_max_packet_size, 0,
+				 (struct sockaddr *) &peers[0], &peerlens[0]);
+	if (n < 0)
+		return n;
+
+	lens[0] = n;
+	return 1;
+}
+
 /*
  * rxThreadFunc
  * 		Main function of the receive background thread.
@@ -6277,13 +7080,20 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 static void *
 rxThreadFunc(void *arg)
 {
-	icpkthdr   *pkt = NULL;
+	icpkthdr   *pkts[IC_MAX_BATCH];
+	int			lens[IC_MAX_BATCH];
+	struct sockaddr_storage peers[IC_MAX_BATCH];
+	socklen_t	peerlens[IC_MAX_BATCH];
 	bool		skip_poll = false;
+	int			i;
+
+	memset(pkts, 0, sizeof(pkts));
 
 	for (;;)
 	{
 		struct pollfd nfd;
 		int			n;
+		int			nbufs;
 
 		/* check shutdown condition */
 		if (pg_atomic_read_u32(&ic_control_info.shutdown) == 1)
@@ -6295,18 +7105,34 @@ rxThreadFunc(void *arg)
 			break;
 		}
 
-		/* Try to get a buffer */
-		if (pkt == NULL)
+		/*
+		 * Try to get buffers.  We need at least one; more let us read a
+		 * batch of packets at once.  Unused buffers are kept at the front of
+		 * the array.
+		 */
+#ifdef HAVE_RECVMMSG
+		nbufs = Max(1, Min(Gp_interconnect_batch_size, IC_MAX_BATCH));
+#else
+		nbufs = 1;
+#endif
+		if (pkts[nbufs - 1] == NULL)
 		{
 			pthread_mutex_lock(&ic_control_info.lock);
-			pkt = getRxBuffer(&rx_buffer_pool);
+			for (i = 0; i < nbufs; i++)
+			{
+				if (pkts[i] == NULL &&
+					(pkts[i] = getRxBuffer(&rx_buffer_pool)) == NULL)
+					break;
+			}
 			pthread_mutex_unlock(&ic_control_info.lock);
 
-			if (pkt == NULL)
+			if (pkts[0] == NULL)
 			{
 				setRxThreadError(ENOMEM);
 				continue;
 			}
+
+			nbufs = i;
 		}
 
 		if (!skip_poll)
@@ -6352,15 +7178,10 @@ rxThreadFunc(void *arg)
 			/* we've got something interesting to read */
 			/* handle incoming */
 			/* ready to read on our socket */
-			MotionConn *conn = NULL;
-			int			read_count = 0;
+			int			nrecv;
+			int			nfree;
 
-			struct sockaddr_storage peer;
-			socklen_t	peerlen;
-
-			peerlen = sizeof(peer);
-			read_count = recvfrom(UDP_listenerFd, (char *) pkt, Gp_max_packet_size, 0,
-								  (struct sockaddr *) &peer, &peerlen);
+			nrecv = rxReceivePackets(pkts, lens, peers, peerlens, nbufs);
 
 			if (pg_atomic_read_u32(&ic_control_info.shutdown) == 1)
 			{
@@ -6371,10 +7192,7 @@ rxThreadFunc(void *arg)
 				break;
 			}
 
-			if (DEBUG5 >= log_min_messages)
-				write_log("received inbound len %d", read_count);
-
-			if (read_count < 0)
+			if (nrecv < 0)
 			{
 				skip_poll = false;
 
@@ -6395,12 +7213,7 @@ rxThreadFunc(void *arg)
 				continue;
 			}
 
-			if (read_count < sizeof(icpkthdr))
-			{
-				if (DEBUG1 >= log_min_messages)
-					write_log("Interconnect error: short conn receive (%d)", read_count);
-				continue;
-			}
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.recvSyscallNum, 1);
 
 			/*
 			 * when we get a "good" recvfrom() result, we can skip poll()
@@ -6408,110 +7221,35 @@ rxThreadFunc(void *arg)
 			 */
 			skip_poll = true;
 
-			/* length must be >= 0 */
-			if (pkt->len < 0)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound with negative length");
-				continue;
-			}
-
-			if (pkt->len != read_count)
+			for (i = 0; i < nrecv; i++)
 			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
-				continue;
-			}
-
-			/*
-			 * check the CRC of the payload.
-			 */
-			if (gp_interconnect_full_crc)
-			{
-				if (!checkCRC(pkt))
-				{
-					pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.crcErrors, 1);
-					if (DEBUG2 >= log_min_messages)
-						write_log("received network data error, dropping bad packet, user data unaffected.");
-					continue;
-				}
+				if (handleRxPacket(pkts[i], lens[i], &peers[i], &peerlens[i]))
+					pkts[i] = NULL;
 			}
 
-#ifdef AMS_VERBOSE_LOGGING
-			logPkt("GOT MESSAGE", pkt);
-#endif
-
-			bool		wakeup_mainthread = false;
-			AckSendParam param;
-
-			memset(&param, 0, sizeof(AckSendParam));
-
-			/*
-			 * Get the connection for the pkt.
-			 *
-			 * The connection hash table should be locked until finishing the
-			 * processing of the packet to avoid the connection
-			 * addition/removal from the hash table during the mean time.
-			 */
-
-			pthread_mutex_lock(&ic_control_info.lock);
-			conn = findConnByHeader(&ic_control_info.connHtab, pkt);
-
-			if (conn != NULL)
+			/* move the buffers that are still ours to the front */
+			for (i = 0, nfree = 0; i < IC_MAX_BATCH; i++)
 			{
-				/* Handling a regular packet */
-				if (handleDataPacket(conn, pkt, &peer, &peerlen, &param, &wakeup_mainthread))
-					pkt = NULL;
-				ic_statistics.recvPktNum++;
-			}
-			else
-			{
-				/*
-				 * There may have two kinds of Mismatched packets: a) Past
-				 * packets from previous command after I was torn down b)
-				 * Future packets from current command before my connections
-				 * are built.
-				 *
-				 * The handling logic is to "Ack the past and Nak the future".
-				 */
-				if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+				if (pkts[i] != NULL)
 				{
-					if (DEBUG1 >= log_min_messages)
-						write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
-
-#ifdef AMS_VERBOSE_LOGGING
-					logPkt("Got a Mismatched Packet", pkt);
-#endif
-
-					if (handleMismatch(pkt, &peer, peerlen))
-						pkt = NULL;
-					ic_statistics.mismatchNum++;
+					pkts[nfree] = pkts[i];
+					if (nfree++ != i)
+						pkts[i] = NULL;
 				}
 			}
-			pthread_mutex_unlock(&ic_control_info.lock);
-
-			if (wakeup_mainthread)
-				SetLatch(&ic_control_info.latch);
-
-			/*
-			 * real ack sending is after lock release to decrease the lock
-			 * holding time.
-			 */
-			if (param.msg.len != 0)
-				sendAckWithParam(&param);
 		}
 
 		/* pthread_yield(); */
 	}
 
-	/* Before return, we release the packet. */
-	if (pkt)
+	/* Before return, we release the packets. */
+	pthread_mutex_lock(&ic_control_info.lock);
+	for (i = 0; i < IC_MAX_BATCH && pkts[i] != NULL; i++)
 	{
-		pthread_mutex_lock(&ic_control_info.lock);
-		freeRxBuffer(&rx_buffer_pool, pkt);
-		pkt = NULL;
-		pthread_mutex_unlock(&ic_control_info.lock);
+		freeRxBuffer(&rx_buffer_pool, pkts[i]);
+		pkts[i] = NULL;
 	}
+	pthread_mutex_unlock(&ic_control_info.lock);
 
 	/* nothing to return */
 	return NULL;
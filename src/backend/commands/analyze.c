@@ -118,6 +118,7 @@
 #include "utils/typcache.h"
 
 #include "catalog/heap.h"
+#include "catalog/pg_appendonly_fn.h"
 #include "cdb/cdbappendonlyam.h"
 #include "cdb/cdbaocsam.h"
 #include "cdb/cdbdisp_query.h"
@@ -174,6 +175,7 @@ static MemoryContext anl_context = NULL;
 static BufferAccessStrategy vac_strategy;
 
 Bitmapset	**acquire_func_colLargeRowIndexes;
+Bitmapset	*acquire_func_colsToSample;
 
 
 static void do_analyze_rel(Relation onerel, VacuumStmt *vacstmt,
@@ -204,6 +206,12 @@ static Datum ind_fetch_func(VacAttrStatsP stats, int rownum, bool *isNull);
 static void analyze_rel_internal(Oid relid, VacuumStmt *vacstmt,
 			bool in_outer_xact, BufferAccessStrategy bstrategy);
 static void acquire_hll_by_query(Relation onerel, int nattrs, VacAttrStats **attrstats, int elevel);
+static Bitmapset *get_cols_to_sample(Relation onerel,
+				   VacAttrStats **vacattrstats, int attr_cnt,
+				   AnlIndexData *indexdata, int nindexes);
+static int64 get_ao_master_modcount(Relation onerel);
+static bool ao_unchanged_since_analyze(Relation onerel, VacuumStmt *vacstmt,
+						   int64 modcount, int elevel);
 
 /*
  *	analyze_rel() -- analyze one relation
@@ -423,8 +431,34 @@ analyze_rel_internal(Oid relid, VacuumStmt *vacstmt,
 	 */
 	PartStatus ps = rel_part_status(relid);
 	if (!(ps == PART_STATUS_ROOT || ps == PART_STATUS_INTERIOR))
-		do_analyze_rel(onerel, vacstmt, acquirefunc, relpages,
-					   false, in_outer_xact, elevel);
+	{
+		int64		modcount = -1;
+
+		/*
+		 * For append-optimized tables, remember the modcount before we
+		 * sample, so that if the table hasn't been modified by the next
+		 * ANALYZE, its sampling can be skipped. This is what makes
+		 * re-analyzing a partitioned table that gets new data loaded into
+		 * only a few leaf partitions cheap: the untouched leaves keep their
+		 * statistics, and the root statistics are merged from those.
+		 */
+		if (Gp_role == GP_ROLE_DISPATCH && RelationIsAppendOptimized(onerel))
+			modcount = get_ao_master_modcount(onerel);
+
+		if (modcount >= 0 &&
+			ao_unchanged_since_analyze(onerel, vacstmt, modcount, elevel))
+		{
+			/* keep the existing statistics */
+		}
+		else
+		{
+			do_analyze_rel(onerel, vacstmt, acquirefunc, relpages,
+						   false, in_outer_xact, elevel);
+
+			if (modcount >= 0 && gp_analyze_skip_unchanged_ao)
+				UpdateAppendOnlyEntryAnalyzeModcount(relid, modcount);
+		}
+	}
 
 	/*
 	 * If there are child tables, do recursive ANALYZE.
@@ -466,6 +500,135 @@ analyze_rel_internal(Oid relid, VacuumStmt *vacstmt,
 	LWLockRelease(ProcArrayLock);
 }
 
+/*
+ * Determine which columns the sample rows need to contain.
+ *
+ * Returns the set of attribute numbers of the columns being analyzed, or
+ * NULL if all columns are needed. Columns left out of the sample are
+ * returned as NULLs, which lets column-oriented tables skip reading them
+ * altogether, and saves shipping them from the segments.
+ */
+static Bitmapset *
+get_cols_to_sample(Relation onerel, VacAttrStats **vacattrstats, int attr_cnt,
+				   AnlIndexData *indexdata, int nindexes)
+{
+	TupleDesc	tupdesc = RelationGetDescr(onerel);
+	Bitmapset  *cols = NULL;
+	int			i;
+
+	/*
+	 * Expression index statistics and partial index predicates are computed
+	 * from the sample rows, and may reference any column.
+	 */
+	for (i = 0; i < nindexes; i++)
+	{
+		if (indexdata[i].attr_cnt > 0 ||
+			indexdata[i].indexInfo->ii_Predicate != NIL)
+			return NULL;
+	}
+
+	for (i = 0; i < attr_cnt; i++)
+		cols = bms_add_member(cols, vacattrstats[i]->attr->attnum);
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = tupdesc->attrs[i];
+
+		if (attr->attisdropped || bms_is_member(attr->attnum, cols))
+			continue;
+
+		/*
+		 * A domain with a NOT NULL constraint would refuse the NULL we put in
+		 * place of the value, when the sample row is read back on the
+		 * dispatcher. Always include domain columns.
+		 */
+		if (get_typtype(attr->atttypid) == TYPTYPE_DOMAIN)
+		{
+			cols = bms_add_member(cols, attr->attnum);
+			continue;
+		}
+
+		/* Found a column that can be left out */
+		return cols;
+	}
+
+	/* All live columns are needed anyway */
+	bms_free(cols);
+	return NULL;
+}
+
+/*
+ * Get the total modcount of an append-optimized relation, from the aoseg
+ * table on the master. The dispatcher bumps it on every INSERT, UPDATE,
+ * DELETE or COPY that touches the relation, see UpdateMasterAosegTotals().
+ */
+static int64
+get_ao_master_modcount(Relation onerel)
+{
+	FileSegTotals *fstotal;
+	int64		modcount;
+
+	if (RelationIsAoRows(onerel))
+		fstotal = GetSegFilesTotals(onerel, GetActiveSnapshot());
+	else
+		fstotal = GetAOCSSSegFilesTotals(onerel, GetActiveSnapshot());
+
+	modcount = fstotal->totalmodcount;
+	pfree(fstotal);
+
+	return modcount;
+}
+
+/*
+ * Can we skip sampling an append-optimized relation, because it hasn't
+ * been modified since the last ANALYZE recorded 'modcount'?
+ *
+ * Only a plain ANALYZE of all columns qualifies. We also insist that every
+ * analyzable column still has statistics, in case a column was added or
+ * its statistics were removed since then.
+ */
+static bool
+ao_unchanged_since_analyze(Relation onerel, VacuumStmt *vacstmt,
+						   int64 modcount, int elevel)
+{
+	TupleDesc	tupdesc = RelationGetDescr(onerel);
+	int			i;
+
+	if (!gp_analyze_skip_unchanged_ao)
+		return false;
+
+	if (vacstmt->va_cols != NIL || (vacstmt->options & VACOPT_FULLSCAN) != 0)
+		return false;
+
+	if (GetAppendOnlyEntryAnalyzeModcount(RelationGetRelid(onerel)) != modcount)
+		return false;
+
+	/* An empty relation has no statistics to check */
+	if (onerel->rd_rel->reltuples > 0)
+	{
+		for (i = 0; i < tupdesc->natts; i++)
+		{
+			Form_pg_attribute attr = tupdesc->attrs[i];
+			HeapTuple	statstup;
+
+			if (attr->attisdropped || attr->attstattarget == 0)
+				continue;
+
+			statstup = fetch_leaf_att_stats(RelationGetRelid(onerel), attr->attnum);
+			if (!HeapTupleIsValid(statstup))
+				return false;
+			heap_freetuple(statstup);
+		}
+	}
+
+	ereport(elevel,
+			(errmsg("skipping analyze of \"%s.%s\" --- append-optimized table not modified since last analyze",
+					get_namespace_name(RelationGetNamespace(onerel)),
+					RelationGetRelationName(onerel))));
+
+	return true;
+}
+
 /*
  *	do_analyze_rel() -- analyze one relation, recursively or not
  *
@@ -699,19 +862,31 @@ do_analyze_rel(Relation onerel, VacuumStmt *vacstmt,
 		/*
 		 * Acquire the sample rows
 		 *
-		 * colLargeRowindexes is passed out-of-band, in a global variable,
-		 * to avoid changing the function signature from upstream's.
+		 * colLargeRowindexes and colsToSample are passed out-of-band, in
+		 * global variables, to avoid changing the function signature from
+		 * upstream's.
+		 *
+		 * The sample of an inheritance tree is collected from each child with
+		 * their own attribute numbers, so we only restrict the sampled
+		 * columns when analyzing a single table.
 		 */
 		acquire_func_colLargeRowIndexes = colLargeRowIndexes;
+		acquire_func_colsToSample = NULL;
 		if (inh)
 			numrows = acquire_inherited_sample_rows(onerel, elevel,
 													rows, targrows,
 													&totalrows, &totaldeadrows);
 		else
+		{
+			acquire_func_colsToSample = get_cols_to_sample(onerel,
+														   vacattrstats, attr_cnt,
+														   indexdata, nindexes);
 			numrows = (*acquirefunc) (onerel, elevel,
 									  rows, targrows,
 									  &totalrows, &totaldeadrows);
+		}
 		acquire_func_colLargeRowIndexes = NULL;
+		acquire_func_colsToSample = NULL;
 	}
 	else
 	{
@@ -1731,6 +1906,7 @@ acquire_sample_rows_ao(Relation onerel, int elevel,
 	int			numrows = 0;	/* # rows now in reservoir */
 	double		samplerows = 0; /* total # rows collected */
 	double		rowstoskip = -1;	/* -1 means not set yet */
+	bool	   *proj = NULL;
 
 	/*
 	 * the append-only meta data should never be fetched with
@@ -1746,11 +1922,16 @@ acquire_sample_rows_ao(Relation onerel, int elevel,
 	else
 	{
 		int			natts = RelationGetNumberOfAttributes(onerel);
-		bool	   *proj = (bool *) palloc(natts * sizeof(bool));
 		int			i;
 
+		/*
+		 * Only read the columns that are going to be analyzed. The others
+		 * are returned as NULLs.
+		 */
+		proj = (bool *) palloc(natts * sizeof(bool));
 		for(i = 0; i < natts; i++)
-			proj[i] = true;
+			proj[i] = (acquire_func_colsToSample == NULL ||
+					   bms_is_member(i + 1, acquire_func_colsToSample));
 
 		Assert(RelationIsAoCols(onerel));
 		aocsScanDesc = aocs_beginscan(onerel,
@@ -1773,6 +1954,18 @@ acquire_sample_rows_ao(Relation onerel, int elevel,
 		if (TupIsNull(slot))
 			break;
 
+		if (proj && acquire_func_colsToSample != NULL)
+		{
+			bool	   *nulls = slot_get_isnull(slot);
+			int			i;
+
+			for (i = 0; i < slot->tts_tupleDescriptor->natts; i++)
+			{
+				if (!proj[i])
+					nulls[i] = true;
+			}
+		}
+
 		if (rowstoskip < 0)
 			rowstoskip = anl_get_next_S(samplerows, targrows,
 										&rstate);
@@ -2609,10 +2802,24 @@ acquire_sample_rows_dispatcher(Relation onerel, bool inh, int elevel,
 	 * may result in different behaviour under different acl configuration.
 	 */
 	initStringInfo(&str);
-	appendStringInfo(&str, "select pg_catalog.gp_acquire_sample_rows(%u, %d, '%s');",
+	appendStringInfo(&str, "select pg_catalog.gp_acquire_sample_rows(%u, %d, '%s'",
 					 RelationGetRelid(onerel),
 					 perseg_targrows,
 					 inh ? "t" : "f");
+	if (acquire_func_colsToSample != NULL && !inh)
+	{
+		int			attnum = -1;
+		bool		first = true;
+
+		appendStringInfoString(&str, ", '{");
+		while ((attnum = bms_next_member(acquire_func_colsToSample, attnum)) >= 0)
+		{
+			appendStringInfo(&str, first ? "%d" : ",%d", attnum);
+			first = false;
+		}
+		appendStringInfoString(&str, "}'::pg_catalog.int2[]");
+	}
+	appendStringInfoString(&str, ");");
 
 	/*
 	 * Execute it.
@@ -10,6 +10,7 @@
 #include "commands/vacuum.h"
 #include "storage/bufmgr.h"
 #include "utils/acl.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
@@ -29,6 +30,9 @@ typedef struct
 	/* Table being sampled */
 	Relation	onerel;
 
+	/* Columns to include in the sample, or NULL for all columns. */
+	Bitmapset  *cols;
+
 	/* Sampled rows and estimated total number of rows in the table. */
 	HeapTuple  *sample_rows;
 	int			num_sample_rows;
@@ -97,6 +101,10 @@ typedef struct
  * The first four rows form the actual sample. One of the columns contained
  * an oversized text datum. The function is marked as EXECUTE ON SEGMENTS in
  * the catalog so you get one summary row *for each segment*.
+ *
+ * There is also a four-argument variant, which takes an array of attribute
+ * numbers to include in the sample. The other columns are returned as NULLs,
+ * and column-oriented tables don't need to read them at all.
  */
 Datum
 gp_acquire_sample_rows(PG_FUNCTION_ARGS)
@@ -107,6 +115,7 @@ gp_acquire_sample_rows(PG_FUNCTION_ARGS)
 	Oid			relOid = PG_GETARG_OID(0);
 	int32		targrows = PG_GETARG_INT32(1);
 	bool		inherited = PG_GETARG_BOOL(2);
+	Bitmapset  *cols = NULL;
 	HeapTuple  *sample_rows;
 	TupleDesc	relDesc;
 	TupleDesc	outDesc;
@@ -139,6 +148,25 @@ gp_acquire_sample_rows(PG_FUNCTION_ARGS)
 		onerel = relation_open(relOid, AccessShareLock);
 		relDesc = RelationGetDescr(onerel);
 
+		if (PG_NARGS() > 3)
+		{
+			ArrayType  *colsarray = PG_GETARG_ARRAYTYPE_P(3);
+			Datum	   *colsdatums;
+			int			ncols;
+			int			i;
+
+			deconstruct_array(colsarray, INT2OID, sizeof(int16), true, 's',
+							  &colsdatums, NULL, &ncols);
+			for (i = 0; i < ncols; i++)
+			{
+				AttrNumber	attnum = DatumGetInt16(colsdatums[i]);
+
+				if (attnum < 1 || attnum > relDesc->natts)
+					elog(ERROR, "invalid attribute number %d", attnum);
+				cols = bms_add_member(cols, attnum);
+			}
+		}
+
 		/* Count the number of non-dropped cols */
 		live_natts = 0;
 		for (attno = 1; attno <= relDesc->natts; attno++)
@@ -215,14 +243,17 @@ gp_acquire_sample_rows(PG_FUNCTION_ARGS)
 		}
 		else
 		{
+			acquire_func_colsToSample = cols;
 			num_sample_rows =
 				acquire_sample_rows(onerel, DEBUG1, sample_rows, targrows,
 									&totalrows, &totaldeadrows);
+			acquire_func_colsToSample = NULL;
 		}
 
 		/* Construct the context to keep across calls. */
 		ctx = (gp_acquire_sample_rows_context *) palloc(sizeof(gp_acquire_sample_rows_context));
 		ctx->onerel = onerel;
+		ctx->cols = cols;
 		funcctx->user_fctx = ctx;
 		ctx->outDesc = outDesc;
 		ctx->sample_rows = sample_rows;
@@ -269,6 +300,13 @@ gp_acquire_sample_rows(PG_FUNCTION_ARGS)
 
 			if (relatt->attisdropped)
 				continue;
+			if (ctx->cols && !bms_is_member(attno, ctx->cols))
+			{
+				outvalues[outattno - 1] = (Datum) 0;
+				outnulls[outattno - 1] = true;
+				outattno++;
+				continue;
+			}
 			relvalue = relvalues[attno - 1];
 			relnull = relnulls[attno - 1];
 
@@ -23,11 +23,20 @@
 #include <sys/stat.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include <catalog/catalog.h>
 
 #include "access/heapam.h"
 #include "access/htup_details.h"
 #include "access/sysattr.h"
+#include "access/tupconvert.h"
 #include "access/xact.h"
 #include "catalog/namespace.h"
 #include "catalog/pg_type.h"
@@ -35,6 +44,7 @@
 #include "commands/defrem.h"
 #include "commands/trigger.h"
 #include "executor/executor.h"
+#include "executor/spi.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
 #include "mb/pg_wchar.h"
@@ -160,7 +170,15 @@ static uint64 CopyToDispatch(CopyState cstate);
 static uint64 CopyTo(CopyState cstate);
 static uint64 CopyFrom(CopyState cstate);
 static uint64 CopyDispatchOnSegment(CopyState cstate, const CopyStmt *stmt);
+static uint64 CopyFromSegmentParse(CopyState cstate, const CopyStmt *stmt);
 static uint64 CopyToQueryOnSegment(CopyState cstate);
+static void BeginCopyCompression(CopyState cstate, bool is_from);
+static void CopyCompressWrite(CopyState cstate, const char *data, int len);
+static int	CopyDecompressRead(CopyState cstate, void *databuf, int datasize);
+static void EndCopyCompression(CopyState cstate);
+static CopyStmt *CopyStmtFromManifest(const CopyStmt *stmt);
+static void WriteCopyManifest(CopyState cstate, const char *filename,
+				  List *options, uint64 processed);
 static void CopyFromInsertBatch(CopyState cstate, EState *estate,
 					CommandId mycid, int hi_options,
 					ResultRelInfo *resultRelInfo, TupleTableSlot *myslot,
@@ -563,9 +581,11 @@ CopySendEndOfRow(CopyState cstate)
 #endif
 			}
 
-			if (fwrite(fe_msgbuf->data, fe_msgbuf->len, 1,
-					   cstate->copy_file) != 1 ||
-				ferror(cstate->copy_file))
+			if (cstate->compress_state)
+				CopyCompressWrite(cstate, fe_msgbuf->data, fe_msgbuf->len);
+			else if (fwrite(fe_msgbuf->data, fe_msgbuf->len, 1,
+							cstate->copy_file) != 1 ||
+					 ferror(cstate->copy_file))
 			{
 				if (cstate->is_program)
 				{
@@ -728,6 +748,13 @@ CopyGetData(CopyState cstate, void *databuf, int datasize)
 	switch (cstate->copy_dest)
 	{
 		case COPY_FILE:
+			if (cstate->compress_state)
+			{
+				bytesread = CopyDecompressRead(cstate, databuf, datasize);
+				if (bytesread == 0)
+					cstate->fe_eof = true;
+				break;
+			}
 			{
 				pgsocket 	sock = fileno(cstate->copy_file);
 				int			rc;
@@ -997,6 +1024,10 @@ DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *processed)
 	TupleDesc	tupDesc;
 	List	   *options;
 
+	/* COPY FROM the manifest written by COPY TO ... ON SEGMENT */
+	if (is_from && Gp_role == GP_ROLE_DISPATCH)
+		stmt = CopyStmtFromManifest(stmt);
+
 	glob_cstate = NULL;
 	glob_copystmt = (CopyStmt *) stmt;
 
@@ -1153,6 +1184,8 @@ DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *processed)
 		{
 			if (Gp_role == GP_ROLE_DISPATCH && cstate->on_segment)
 				*processed = CopyDispatchOnSegment(cstate, stmt);
+			else if (cstate->segment_parse && cstate->dispatch_mode == COPY_DISPATCH)
+				*processed = CopyFromSegmentParse(cstate, stmt);
 			else
 				*processed = CopyFrom(cstate);	/* copy from file to database */
 		}
@@ -1202,6 +1235,10 @@ DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *processed)
 					*processed = CopyDispatchOnSegment(cstate, stmt);
 				else
 					*processed = CopyToQueryOnSegment(cstate);
+
+				if (cstate->manifest)
+					WriteCopyManifest(cstate, stmt->filename, options,
+									  *processed);
 			}
 			else
 				*processed = DoCopyTo(cstate);	/* copy from database to file */
@@ -1259,6 +1296,7 @@ ProcessCopyOptions(CopyState cstate,
 				   bool is_copy) /* false means external table */
 {
 	bool		format_specified = false;
+	bool		compression_specified = false;
 	ListCell   *option;
 
 	/* Support external use for option sanity checking */
@@ -1477,6 +1515,55 @@ ProcessCopyOptions(CopyState cstate,
 						 errmsg("conflicting or redundant options")));
 			cstate->on_segment = TRUE;
 		}
+		else if (strcmp(defel->defname, "compression") == 0)
+		{
+			char	   *method = defGetString(defel);
+
+			if (compression_specified)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			compression_specified = true;
+			if (pg_strcasecmp(method, "gzip") == 0)
+			{
+#ifndef HAVE_LIBZ
+				ereport(ERROR,
+						(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+						 errmsg("gzip compression is not supported by this build")));
+#endif
+				cstate->compress = true;
+			}
+			else if (pg_strcasecmp(method, "none") == 0)
+				cstate->compress = false;
+			else
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("COPY compression \"%s\" not recognized", method),
+						 errhint("Valid values are \"gzip\" and \"none\".")));
+		}
+		else if (strcmp(defel->defname, "manifest") == 0 && !is_from)
+		{
+			/* COPY FROM manifest is handled by CopyStmtFromManifest() */
+			if (cstate->manifest)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			cstate->manifest = defGetString(defel);
+		}
+		else if (strcmp(defel->defname, "segment_parse") == 0)
+		{
+			if (cstate->segment_parse)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			cstate->segment_parse = defGetBoolean(defel);
+		}
+		else if (strcmp(defel->defname, "segment_parse_stage") == 0 &&
+				 Gp_role == GP_ROLE_EXECUTE)
+		{
+			/* added by the QD, see CopyFromSegmentParse() */
+			cstate->segment_parse_stage = (Oid) intVal(defel->arg);
+		}
 		else
 			ereport(ERROR,
 					(errcode(ERRCODE_SYNTAX_ERROR),
@@ -1718,6 +1805,46 @@ ProcessCopyOptions(CopyState cstate,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				errmsg("fill missing fields only available for data loading, not unloading")));
 
+	/* Check segment_parse */
+	if (cstate->segment_parse)
+	{
+		if (!is_copy || !is_from)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY segment_parse only available using COPY FROM")));
+		if (cstate->binary)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY segment_parse is not available in BINARY mode")));
+		if (cstate->oids)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY segment_parse cannot be used with OIDS")));
+		if (cstate->on_segment)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY segment_parse cannot be used with ON SEGMENT")));
+		/*
+		 * Each segment only sees the chunks sent to it, so it could neither
+		 * enforce the reject limit of the whole load nor report the line
+		 * numbers of the rejected rows in the input.
+		 */
+		if (cstate->sreh)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY segment_parse cannot be used with single row error handling")));
+	}
+
+	/* Check compression and manifest, for the files of ON SEGMENT */
+	if (cstate->compress && !cstate->on_segment)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY compression is only available with ON SEGMENT")));
+	if (cstate->manifest && !cstate->on_segment)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY manifest is only available with ON SEGMENT")));
+
 	/*
 	 * NEWLINE
 	 */
@@ -2173,6 +2300,383 @@ CopyDispatchOnSegment(CopyState cstate, const CopyStmt *stmt)
 }
 
 
+/*
+ * COPY FROM ... SEGMENT_PARSE
+ *
+ * Normally, the QD parses every input line far enough to compute the
+ * distribution key, and forwards each line to the segment it belongs to.
+ * That makes the QD the bottleneck of a load, however many segments there
+ * are. With SEGMENT_PARSE, the QD only finds line boundaries: it hands out
+ * the input in chunks of whole lines, round robin, and the segments parse
+ * them. A segment inserts the rows that belong to it, and writes the others
+ * to a staging table. At the end, the QD moves the staged rows to the right
+ * segments with INSERT ... SELECT, which redistributes them with a motion.
+ *
+ * Randomly distributed and replicated tables need no staging.
+ */
+#define SEGMENT_PARSE_CHUNK_SIZE	RAW_BUF_SIZE
+
+/*
+ * Find the line boundaries in raw COPY FROM input, without looking at the
+ * fields.
+ *
+ * The rules are those of CopyReadLineText(), except that in text mode a
+ * backslash followed by a newline is taken as data here, where
+ * CopyReadLineText() ends the line at that newline.  So this may miss a line
+ * end, but never finds one CopyReadLineText() wouldn't: text mode has no
+ * quoting, so the next newline ends a line either way.  A missed line end
+ * only makes a chunk longer; the segment splits it into lines again with
+ * CopyReadLineText().
+ *
+ * Returns the offset just past the last complete line in buf, or the first
+ * one if 'first' is set, or 0 if there is no complete line. If the
+ * end-of-copy marker is found, sets *eod and returns the offset of the
+ * marker instead. 'at_eof' tells that no more data follows.
+ *
+ * buf must start at the beginning of a line.
+ */
+static int
+SegmentParseLineEnd(CopyState cstate, const char *buf, int len,
+					bool first, bool at_eof, bool *eod)
+{
+	char		quotec = '\0';
+	char		escapec = '\0';
+	bool		in_quote = false;
+	bool		last_was_esc = false;
+	bool		first_char_in_line = true;
+	int			end = 0;
+	int			i;
+
+	if (cstate->csv_mode)
+	{
+		quotec = cstate->quote[0];
+		escapec = cstate->escape[0];
+		/* ignore special escape processing if it's the same as quotec */
+		if (quotec == escapec)
+			escapec = '\0';
+	}
+
+	*eod = false;
+	for (i = 0; i < len; i++)
+	{
+		char		c = buf[i];
+		bool		line_start = first_char_in_line;
+
+		first_char_in_line = false;
+
+		if (cstate->csv_mode)
+		{
+			if (in_quote && c == escapec)
+				last_was_esc = !last_was_esc;
+			if (c == quotec && !last_was_esc)
+				in_quote = !in_quote;
+			if (c != escapec)
+				last_was_esc = false;
+			if (in_quote)
+				continue;
+		}
+
+		if (c == '\\' && (!cstate->csv_mode || line_start))
+		{
+			/*
+			 * "\." ends the data. In CSV mode, only when it is alone on its
+			 * line, as it is a valid data value.
+			 */
+			if (i + 1 < len && buf[i + 1] == '.')
+			{
+				if (!cstate->csv_mode ||
+					(i + 2 < len ? (buf[i + 2] == '\n' || buf[i + 2] == '\r') : at_eof))
+				{
+					*eod = true;
+					return i;
+				}
+			}
+			else if (i + 1 >= len && !at_eof)
+				break;			/* need the next character to tell */
+
+			/* in text mode, the escaped character is data, even a newline */
+			if (!cstate->csv_mode)
+				i++;
+			continue;
+		}
+
+		if (c == '\r')
+		{
+			if (cstate->eol_type == EOL_UNKNOWN)
+			{
+				/* the first line tells, like in CopyReadLineText() */
+				if (i + 1 >= len && !at_eof)
+					break;
+				cstate->eol_type = (i + 1 < len && buf[i + 1] == '\n') ? EOL_CRNL : EOL_CR;
+			}
+			if (cstate->eol_type == EOL_CR)
+			{
+				end = i + 1;
+				first_char_in_line = true;
+				if (first)
+					break;
+			}
+		}
+		else if (c == '\n')
+		{
+			if (cstate->eol_type == EOL_UNKNOWN)
+				cstate->eol_type = EOL_NL;
+			if (cstate->eol_type != EOL_CR)
+			{
+				end = i + 1;
+				first_char_in_line = true;
+				if (first)
+					break;
+			}
+		}
+	}
+
+	return end;
+}
+
+/*
+ * Create the staging table for the rows that the segments parse, but that
+ * belong to another segment. Returns its OID, and its name in *stagename.
+ */
+static Oid
+CreateSegmentParseStage(Relation rel, char **stagename)
+{
+	StringInfoData querybuf;
+	char	   *relname;
+	char		name[NAMEDATALEN];
+	Oid			stageOid;
+
+	relname = quote_qualified_identifier(get_namespace_name(RelationGetNamespace(rel)),
+										 RelationGetRelationName(rel));
+	snprintf(name, sizeof(name), "gp_copy_stage_%u", RelationGetRelid(rel));
+
+	initStringInfo(&querybuf);
+	appendStringInfo(&querybuf,
+					 "CREATE TEMP TABLE %s (LIKE %s) "
+					 "WITH (appendonly=false) DISTRIBUTED RANDOMLY",
+					 quote_identifier(name), relname);
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "SPI_connect failed");
+	if (SPI_exec(querybuf.data, 0) != SPI_OK_UTILITY)
+		elog(ERROR, "SPI_exec failed: %s", querybuf.data);
+	SPI_finish();
+
+	CommandCounterIncrement();
+
+	stageOid = RelnameGetRelid(name);
+	if (!OidIsValid(stageOid))
+		elog(ERROR, "could not find COPY staging table \"%s\"", name);
+
+	*stagename = quote_qualified_identifier(get_namespace_name(get_rel_namespace(stageOid)),
+											name);
+	return stageOid;
+}
+
+/*
+ * Move the staged rows to the segments they belong to, and drop the staging
+ * table. Returns the number of rows moved.
+ */
+static uint64
+InsertSegmentParseStage(Relation rel, const char *stagename)
+{
+	StringInfoData querybuf;
+	char	   *relname;
+	uint64		moved;
+
+	relname = quote_qualified_identifier(get_namespace_name(RelationGetNamespace(rel)),
+										 RelationGetRelationName(rel));
+
+	initStringInfo(&querybuf);
+
+	if (SPI_connect() != SPI_OK_CONNECT)
+		elog(ERROR, "SPI_connect failed");
+
+	appendStringInfo(&querybuf, "INSERT INTO %s SELECT * FROM %s",
+					 relname, stagename);
+	if (SPI_exec(querybuf.data, 0) != SPI_OK_INSERT)
+		elog(ERROR, "SPI_exec failed: %s", querybuf.data);
+	moved = SPI_processed;
+
+	resetStringInfo(&querybuf);
+	appendStringInfo(&querybuf, "DROP TABLE %s", stagename);
+	if (SPI_exec(querybuf.data, 0) != SPI_OK_UTILITY)
+		elog(ERROR, "SPI_exec failed: %s", querybuf.data);
+
+	SPI_finish();
+
+	return moved;
+}
+
+/*
+ * Run COPY FROM ... SEGMENT_PARSE in the QD, see above.
+ */
+static uint64
+CopyFromSegmentParse(CopyState cstate, const CopyStmt *stmt)
+{
+	Relation	rel = cstate->rel;
+	GpPolicy   *policy = rel->rd_cdbpolicy;
+	bool		replicated = GpPolicyIsReplicated(policy);
+	bool		partitioned = rel_is_partitioned(RelationGetRelid(rel));
+	CopyStmt   *dispatchStmt;
+	CdbCopy    *cdbCopy;
+	Oid			stageOid = InvalidOid;
+	char	   *stagename = NULL;
+	char	   *buf;
+	int			bufsize = SEGMENT_PARSE_CHUNK_SIZE;
+	int			buflen = 0;
+	bool		skip_header = cstate->header_line;
+	int			target_seg;
+	int64		completed = 0;
+	int64		rejected = 0;
+	uint64		staged = 0;
+
+	/* See Multibyte encoding comment above */
+	if (cstate->encoding_embeds_ascii)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY segment_parse is not supported for encoding \"%s\"",
+						pg_encoding_to_char(cstate->file_encoding))));
+	if (cstate->copy_dest == COPY_OLD_FE)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY segment_parse is not supported with the old frontend protocol")));
+
+	if (!replicated && policy->nattrs > 0)
+		stageOid = CreateSegmentParseStage(rel, &stagename);
+
+	dispatchStmt = copyObject((Node *) stmt);
+	dispatchStmt->skip_ext_partition = cstate->skip_ext_partition;
+	if (OidIsValid(stageOid))
+		dispatchStmt->options = lappend(dispatchStmt->options,
+										makeDefElem("segment_parse_stage",
+													(Node *) makeInteger(stageOid)));
+
+	cdbCopy = makeCdbCopy(cstate, true);
+	cdbCopyStart(cdbCopy, dispatchStmt,
+				 RelationBuildPartitionDesc(rel, false),
+				 cstate->ao_segnos, cstate->file_encoding);
+
+	/* don't start every load on the same segment */
+	target_seg = gp_command_count % cdbCopy->total_segs;
+
+	buf = palloc(bufsize);
+	for (;;)
+	{
+		bool		at_eof;
+		bool		eod;
+		int			end;
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* a line longer than the buffer: make room for the rest of it */
+		if (buflen == bufsize)
+		{
+			bufsize *= 2;
+			buf = repalloc(buf, bufsize);
+		}
+
+		buflen += CopyGetData(cstate, buf + buflen, bufsize - buflen);
+		at_eof = cstate->fe_eof;
+
+		if (skip_header)
+		{
+			end = SegmentParseLineEnd(cstate, buf, buflen, true, at_eof, &eod);
+			if (end == 0 && !eod && !at_eof)
+				continue;
+			if (end == 0 && !eod)
+				end = buflen;
+			buflen -= end;
+			memmove(buf, buf + end, buflen);
+			skip_header = false;
+		}
+
+		end = SegmentParseLineEnd(cstate, buf, buflen, false, at_eof, &eod);
+		if (at_eof && !eod)
+			end = buflen;
+
+		if (end > 0)
+		{
+			if (replicated)
+				cdbCopySendDataToAll(cdbCopy, buf, end);
+			else
+			{
+				cdbCopySendData(cdbCopy, target_seg, buf, end);
+				target_seg = (target_seg + 1) % cdbCopy->total_segs;
+			}
+		}
+
+		if (at_eof || eod)
+			break;
+
+		/* keep the incomplete last line for the next round */
+		buflen -= end;
+		memmove(buf, buf + end, buflen);
+	}
+	pfree(buf);
+
+	/*
+	 * If the data ended with "\.", there may be more of it in the protocol,
+	 * which we ignore, like CopyReadLine() does.
+	 */
+	if (cstate->copy_dest == COPY_NEW_FE)
+	{
+		char		discard[1024];
+
+		while (!cstate->fe_eof)
+			(void) CopyGetData(cstate, discard, sizeof(discard));
+	}
+
+	cdbCopyEnd(cdbCopy, &completed, &rejected);
+	cstate->cdbCopy = NULL;
+
+	/* every segment loaded all the rows of a replicated table */
+	if (replicated)
+		completed /= cdbCopy->total_segs;
+
+	if (OidIsValid(stageOid))
+		staged = InsertSegmentParseStage(rel, stagename);
+
+	/*
+	 * Record new tuple counts in the pg_aoseg entries of append only tables.
+	 * The staged rows were counted by the INSERT.
+	 */
+	if (partitioned && cdbCopy->aotupcounts)
+	{
+		ListCell   *lc;
+
+		foreach(lc, cstate->ao_segnos)
+		{
+			SegfileMapNode *map = lfirst(lc);
+			struct {
+				Oid relid;
+				int64 tupcount;
+			} *entry;
+			bool found;
+
+			entry = hash_search(cdbCopy->aotupcounts,
+								&(map->relid),
+								HASH_FIND,
+								&found);
+
+			if (found && entry->tupcount > 0)
+			{
+				Relation aorel = heap_open(map->relid, AccessShareLock);
+				UpdateMasterAosegTotals(aorel, map->segno, entry->tupcount, 1);
+				heap_close(aorel, NoLock);
+			}
+		}
+	}
+	else if (!partitioned && RelationIsAppendOptimized(rel) &&
+			 completed > (int64) staged)
+	{
+		SegfileMapNode *map = linitial(cstate->ao_segnos);
+		UpdateMasterAosegTotals(rel, map->segno, completed - staged, 1);
+	}
+
+	return (uint64) completed;
+}
+
 /*
  * Modify the filename in cstate->filename, and cstate->cdbsreh if any,
  * for COPY ON SEGMENT.
@@ -2209,6 +2713,441 @@ MangleCopyFileName(CopyState cstate)
 	}
 }
 
+/*
+ * COPY ... ON SEGMENT WITH (compression 'gzip') writes and reads the data
+ * files of the segments through zlib, in the gzip format, so that the files
+ * can be handled with gzip outside the database too.  zlib allocates in the
+ * copy context, nothing is left behind on error.
+ */
+#define COPY_GZIP_LEVEL		1	/* as gzip -1, an export is CPU bound enough */
+
+typedef struct CopyCompressState
+{
+#ifdef HAVE_LIBZ
+	z_stream	zstream;
+#endif
+	bool		is_from;
+	bool		stream_end;		/* COPY FROM: between two gzip members */
+	char		buf[RAW_BUF_SIZE];	/* compressed data */
+} CopyCompressState;
+
+#ifdef HAVE_LIBZ
+static voidpf
+copy_zalloc(voidpf opaque, uInt items, uInt size)
+{
+	return MemoryContextAlloc((MemoryContext) opaque, (Size) items * size);
+}
+
+static void
+copy_zfree(voidpf opaque, voidpf address)
+{
+	pfree(address);
+}
+
+/*
+ * Run deflate() on the pending input, and write out what it produces.
+ */
+static void
+CopyCompressFlush(CopyState cstate, int flush)
+{
+	CopyCompressState *cs = cstate->compress_state;
+	z_stream   *zs = &cs->zstream;
+	int			ret;
+
+	do
+	{
+		size_t		len;
+
+		zs->next_out = (Bytef *) cs->buf;
+		zs->avail_out = sizeof(cs->buf);
+
+		ret = deflate(zs, flush);
+		if (ret == Z_STREAM_ERROR)
+			elog(ERROR, "could not compress COPY data: %s",
+				 zs->msg ? zs->msg : "unknown error");
+
+		len = sizeof(cs->buf) - zs->avail_out;
+		if (len > 0 &&
+			(fwrite(cs->buf, len, 1, cstate->copy_file) != 1 ||
+			 ferror(cstate->copy_file)))
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write to COPY file: %m")));
+	} while (zs->avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+}
+#endif
+
+static void
+BeginCopyCompression(CopyState cstate, bool is_from)
+{
+#ifdef HAVE_LIBZ
+	CopyCompressState *cs;
+	int			ret;
+
+	cs = MemoryContextAllocZero(cstate->copycontext, sizeof(CopyCompressState));
+	cs->is_from = is_from;
+	cs->stream_end = true;
+	cs->zstream.zalloc = copy_zalloc;
+	cs->zstream.zfree = copy_zfree;
+	cs->zstream.opaque = (voidpf) cstate->copycontext;
+
+	/* 16 + MAX_WBITS asks for the gzip format, 32 + MAX_WBITS detects it */
+	if (is_from)
+		ret = inflateInit2(&cs->zstream, 32 + MAX_WBITS);
+	else
+		ret = deflateInit2(&cs->zstream, COPY_GZIP_LEVEL, Z_DEFLATED,
+						   16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+	if (ret != Z_OK)
+		elog(ERROR, "could not initialize compression library: %s",
+			 cs->zstream.msg ? cs->zstream.msg : "unknown error");
+
+	cstate->compress_state = cs;
+#else
+	elog(ERROR, "gzip compression is not supported by this build");
+#endif
+}
+
+static void
+CopyCompressWrite(CopyState cstate, const char *data, int len)
+{
+#ifdef HAVE_LIBZ
+	z_stream   *zs = &cstate->compress_state->zstream;
+
+	zs->next_in = (Bytef *) data;
+	zs->avail_in = len;
+	CopyCompressFlush(cstate, Z_NO_FLUSH);
+#endif
+}
+
+/*
+ * Read up to datasize bytes of decompressed data. Returns 0 only at the end
+ * of the file. Like gzip, reads a file of several concatenated gzip members
+ * as the concatenation of their data.
+ */
+static int
+CopyDecompressRead(CopyState cstate, void *databuf, int datasize)
+{
+#ifdef HAVE_LIBZ
+	CopyCompressState *cs = cstate->compress_state;
+	z_stream   *zs = &cs->zstream;
+
+	zs->next_out = (Bytef *) databuf;
+	zs->avail_out = datasize;
+
+	while (zs->avail_out == (uInt) datasize)
+	{
+		int			ret;
+
+		if (zs->avail_in == 0)
+		{
+			ssize_t		nread;
+
+			CHECK_FOR_INTERRUPTS();
+
+			nread = read(fileno(cstate->copy_file), cs->buf, sizeof(cs->buf));
+			if (nread < 0)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not read from COPY file: %m")));
+			if (nread == 0)
+			{
+				if (!cs->stream_end)
+					ereport(ERROR,
+							(errcode(ERRCODE_DATA_CORRUPTED),
+							 errmsg("unexpected end of compressed COPY file \"%s\"",
+									cstate->filename)));
+				break;
+			}
+			zs->next_in = (Bytef *) cs->buf;
+			zs->avail_in = nread;
+		}
+
+		cs->stream_end = false;
+		ret = inflate(zs, Z_NO_FLUSH);
+		if (ret == Z_STREAM_END)
+		{
+			inflateReset(zs);
+			cs->stream_end = true;
+		}
+		else if (ret != Z_OK && ret != Z_BUF_ERROR)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("could not decompress COPY file \"%s\": %s",
+							cstate->filename,
+							zs->msg ? zs->msg : "unknown error")));
+	}
+
+	return datasize - zs->avail_out;
+#else
+	return 0;
+#endif
+}
+
+/*
+ * Finish the compressed stream, before the file is closed.
+ */
+static void
+EndCopyCompression(CopyState cstate)
+{
+#ifdef HAVE_LIBZ
+	CopyCompressState *cs = cstate->compress_state;
+
+	if (cs->is_from)
+		inflateEnd(&cs->zstream);
+	else
+	{
+		CopyCompressFlush(cstate, Z_FINISH);
+		deflateEnd(&cs->zstream);
+	}
+#endif
+	cstate->compress_state = NULL;
+}
+
+/*
+ * COPY TO ... ON SEGMENT WITH (manifest '<file>') writes, on the master, a
+ * manifest of the files written by the segments, with the options needed to
+ * read them back:
+ *
+ *		version 1
+ *		file /data/t<SEGID>.bin
+ *		segments 3
+ *		rows 1000
+ *		format binary
+ *		...
+ *
+ * one "keyword value" per line, the value taking the rest of the line.
+ * COPY FROM '<file>' WITH (manifest) then loads the files with COPY FROM
+ * ... ON SEGMENT.  A backup or a migration thus moves the data through the
+ * segments in parallel, rather than through the master.
+ */
+#define COPY_MANIFEST_VERSION	1
+
+/* COPY options recorded in a manifest, as given to COPY TO */
+static const char *const CopyManifestOptions[] = {
+	"delimiter", "null", "header", "quote", "escape", "oids", NULL
+};
+
+static void
+WriteCopyManifest(CopyState cstate, const char *filename, List *options,
+				  uint64 processed)
+{
+	StringInfoData buf;
+	ListCell   *lc;
+	FILE	   *file;
+	mode_t		oumask;
+
+	Assert(Gp_role == GP_ROLE_DISPATCH);
+
+	initStringInfo(&buf);
+	appendStringInfoString(&buf, "# written by COPY TO ... ON SEGMENT, read by COPY FROM ... WITH (manifest)\n");
+	appendStringInfo(&buf, "version %d\n", COPY_MANIFEST_VERSION);
+	appendStringInfo(&buf, "file %s\n", filename);
+	appendStringInfo(&buf, "segments %d\n", getgpsegmentCount());
+	appendStringInfo(&buf, "rows " UINT64_FORMAT "\n", processed);
+	appendStringInfo(&buf, "format %s\n",
+					 cstate->binary ? "binary" : (cstate->csv_mode ? "csv" : "text"));
+	appendStringInfo(&buf, "compression %s\n", cstate->compress ? "gzip" : "none");
+	appendStringInfo(&buf, "encoding %s\n",
+					 pg_encoding_to_char(cstate->file_encoding));
+
+	foreach(lc, options)
+	{
+		DefElem    *defel = (DefElem *) lfirst(lc);
+		int			i;
+
+		for (i = 0; CopyManifestOptions[i] != NULL; i++)
+		{
+			if (strcmp(defel->defname, CopyManifestOptions[i]) != 0)
+				continue;
+
+			if (strcmp(defel->defname, "header") == 0 ||
+				strcmp(defel->defname, "oids") == 0)
+				appendStringInfo(&buf, "%s %s\n", defel->defname,
+								 defGetBoolean(defel) ? "true" : "false");
+			else
+				appendStringInfo(&buf, "%s %s\n", defel->defname,
+								 defGetString(defel));
+		}
+	}
+
+	oumask = umask(S_IWGRP | S_IWOTH);
+	file = AllocateFile(cstate->manifest, PG_BINARY_W);
+	umask(oumask);
+	if (file == NULL)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\" for writing: %m",
+						cstate->manifest)));
+
+	if (fwrite(buf.data, buf.len, 1, file) != 1 || ferror(file))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to file \"%s\": %m",
+						cstate->manifest)));
+
+	if (FreeFile(file))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not close file \"%s\": %m",
+						cstate->manifest)));
+
+	pfree(buf.data);
+}
+
+/*
+ * If a COPY FROM has the manifest option, return a COPY FROM ... ON SEGMENT
+ * of the files listed in the manifest it names, with the options they were
+ * written with.  Otherwise return the statement as it is.
+ */
+static CopyStmt *
+CopyStmtFromManifest(const CopyStmt *stmt)
+{
+	CopyStmt   *newstmt;
+	DefElem    *manifest = NULL;
+	List	   *options = NIL;
+	char	   *filename = NULL;
+	int			segments = -1;
+	int			version = -1;
+	StringInfoData buf;
+	char	   *line;
+	char	   *next;
+	ListCell   *lc;
+	FILE	   *file;
+
+	foreach(lc, stmt->options)
+	{
+		DefElem    *defel = (DefElem *) lfirst(lc);
+
+		if (strcmp(defel->defname, "manifest") == 0)
+		{
+			if (manifest)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			manifest = defel;
+		}
+		else
+			options = lappend(options, defel);
+	}
+
+	if (manifest == NULL)
+		return (CopyStmt *) stmt;
+
+	newstmt = copyObject((Node *) stmt);
+	newstmt->options = options;
+	if (!defGetBoolean(manifest))
+		return newstmt;
+
+	if (stmt->filename == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY FROM STDIN cannot read a manifest")));
+	if (stmt->is_program)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY manifest is not available with PROGRAM")));
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("must be superuser to COPY to or from a file"),
+				 errhint("Anyone can COPY to stdout or from stdin. "
+						 "psql's \\copy command also works for anyone.")));
+
+	file = AllocateFile(stmt->filename, PG_BINARY_R);
+	if (file == NULL)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\" for reading: %m",
+						stmt->filename)));
+
+	initStringInfo(&buf);
+	for (;;)
+	{
+		size_t		nread;
+
+		enlargeStringInfo(&buf, 1024);
+		nread = fread(buf.data + buf.len, 1, buf.maxlen - buf.len - 1, file);
+		if (ferror(file))
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read file \"%s\": %m", stmt->filename)));
+		if (nread == 0)
+			break;
+		buf.len += nread;
+		buf.data[buf.len] = '\0';
+	}
+	FreeFile(file);
+
+	for (line = buf.data; line != NULL && *line != '\0'; line = next)
+	{
+		char	   *value;
+
+		next = strchr(line, '\n');
+		if (next)
+			*next++ = '\0';
+
+		if (line[0] == '\0' || line[0] == '#')
+			continue;
+
+		value = strchr(line, ' ');
+		if (value)
+			*value++ = '\0';
+		else
+			value = "";
+
+		if (strcmp(line, "version") == 0)
+			version = atoi(value);
+		else if (strcmp(line, "file") == 0)
+			filename = value;
+		else if (strcmp(line, "segments") == 0)
+			segments = atoi(value);
+		else if (strcmp(line, "rows") == 0)
+			 /* only for the reader's information */ ;
+		else if (strcmp(line, "format") == 0 ||
+				 strcmp(line, "compression") == 0 ||
+				 strcmp(line, "encoding") == 0 ||
+				 strcmp(line, "delimiter") == 0 ||
+				 strcmp(line, "null") == 0 ||
+				 strcmp(line, "header") == 0 ||
+				 strcmp(line, "quote") == 0 ||
+				 strcmp(line, "escape") == 0 ||
+				 strcmp(line, "oids") == 0)
+			newstmt->options = lappend(newstmt->options,
+									   makeDefElem(pstrdup(line),
+												   (Node *) makeString(pstrdup(value))));
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("invalid COPY manifest \"%s\"", stmt->filename),
+					 errdetail("Unrecognized keyword \"%s\".", line)));
+	}
+
+	if (version != COPY_MANIFEST_VERSION)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid COPY manifest \"%s\"", stmt->filename),
+				 errdetail("Manifest version %d is not supported.", version)));
+	if (filename == NULL || segments < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid COPY manifest \"%s\"", stmt->filename),
+				 errdetail("The manifest does not name the files or their number.")));
+
+	/* every segment reads the file of the segment with the same ID */
+	if (segments != getgpsegmentCount())
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY manifest \"%s\" is for %d segments, but there are %d segments",
+						stmt->filename, segments, getgpsegmentCount()),
+				 errhint("Load the file of each segment with COPY FROM, without ON SEGMENT.")));
+
+	newstmt->filename = pstrdup(filename);
+	newstmt->options = lappend(newstmt->options,
+							   makeDefElem("on_segment", (Node *) makeInteger(TRUE)));
+
+	return newstmt;
+}
+
 /*
  * Release resources allocated in a cstate for COPY TO/FROM.
  */
@@ -2221,6 +3160,9 @@ EndCopy(CopyState cstate)
 	}
 	else
 	{
+		if (cstate->compress_state)
+			EndCopyCompression(cstate);
+
 		if (cstate->filename != NULL && FreeFile(cstate->copy_file))
 			ereport(ERROR,
 					(errcode_for_file_access(),
@@ -2324,6 +3266,9 @@ BeginCopyToOnSegment(QueryDesc *queryDesc)
 			ereport(ERROR,
 					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
 							errmsg("\"%s\" is a directory", filename)));
+
+		if (cstate->compress)
+			BeginCopyCompression(cstate, false);
 	}
 
 	attr = tupDesc->attrs;
@@ -2496,6 +3441,22 @@ BeginCopyTo(Relation rel,
 
 	bool		pipe = (filename == NULL || (Gp_role == GP_ROLE_EXECUTE && !cstate->on_segment));
 
+	if (cstate->compress && is_program)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY compression is not available with PROGRAM")));
+	if (cstate->manifest && Gp_role == GP_ROLE_DISPATCH)
+	{
+		if (is_program)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY manifest is not available with PROGRAM")));
+		if (!is_absolute_path(cstate->manifest))
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_NAME),
+					 errmsg("relative path not allowed for COPY manifest")));
+	}
+
 	if (cstate->on_segment && Gp_role == GP_ROLE_DISPATCH)
 	{
 		/* in ON SEGMENT mode, we don't open anything on the dispatcher. */
@@ -2569,6 +3530,9 @@ BeginCopyTo(Relation rel,
 				ereport(ERROR,
 						(errcode(ERRCODE_WRONG_OBJECT_TYPE),
 								errmsg("\"%s\" is a directory", filename)));
+
+			if (cstate->compress)
+				BeginCopyCompression(cstate, false);
 		}
 	}
 
@@ -3566,6 +4530,9 @@ CopyFrom(CopyState cstate)
 	bool	   *baseNulls;
 	GpDistributionData *part_distData = NULL;
 	int			firstBufferedLineNo = 0;
+	Relation	stageRel = NULL;
+	TupleConversionMap *stageMap = NULL;
+	BulkInsertState stageBiState = NULL;
 
 	Assert(cstate->rel);
 
@@ -3799,11 +4766,25 @@ CopyFrom(CopyState cstate)
 	 */
 	is_check_distkey = (cstate->on_segment && Gp_role == GP_ROLE_EXECUTE && gp_enable_segment_copy_checking) ? true : false;
 
+	/*
+	 * In COPY FROM ... SEGMENT_PARSE, the QD hands out the lines without
+	 * looking at them. Rows that belong to another segment are written to a
+	 * staging table instead, and the QD moves them to the right segment at
+	 * the end.
+	 */
+	if (Gp_role == GP_ROLE_EXECUTE && OidIsValid(cstate->segment_parse_stage))
+	{
+		stageRel = heap_open(cstate->segment_parse_stage, RowExclusiveLock);
+		stageMap = convert_tuples_by_name(tupDesc, RelationGetDescr(stageRel),
+										  gettext_noop("could not convert row type"));
+		stageBiState = GetBulkInsertState();
+	}
+
 	/*
 	 * Initialize information about distribution keys, needed to compute target
 	 * segment for each row.
 	 */
-	if (cstate->dispatch_mode == COPY_DISPATCH || is_check_distkey)
+	if (cstate->dispatch_mode == COPY_DISPATCH || is_check_distkey || stageRel)
 	{
 		distData = InitDistributionData(cstate, estate);
 
@@ -4085,6 +5066,39 @@ CopyFrom(CopyState cstate)
 					}
 				}
 			}
+			else if (stageRel)
+			{
+				part_distData = GetDistributionPolicyForPartition(
+																  distData,
+																  resultRelInfo,
+																  cstate->copycontext);
+
+				if (part_distData->policy->nattrs != 0)
+				{
+					target_seg = GetTargetSeg(part_distData, slot_get_values(slot), slot_get_isnull(slot));
+
+					if (GpIdentity.segindex != target_seg)
+					{
+						/*
+						 * Not ours. Stage it in the format of the parent
+						 * table; triggers and constraints are dealt with
+						 * when it is inserted on the right segment.
+						 */
+						HeapTuple	tuple;
+
+						tuple = heap_form_tuple(tupDesc, baseValues, baseNulls);
+						if (stageMap)
+							tuple = do_convert_tuple(tuple, stageMap);
+						heap_insert(stageRel, tuple, mycid, 0, stageBiState,
+									GetCurrentTransactionId());
+
+						processed++;
+						if (cstate->cdbsreh)
+							cstate->cdbsreh->processed++;
+						continue;
+					}
+				}
+			}
 		}
 
 		/*
@@ -4323,6 +5337,12 @@ CopyFrom(CopyState cstate)
 		MemoryContextReset(batchcontext);
 	}
 
+	if (stageRel)
+	{
+		FreeBulkInsertState(stageBiState);
+		heap_close(stageRel, NoLock);
+	}
+
 	/* Done, clean up */
 	error_context_stack = errcallback.previous;
 
@@ -4382,10 +5402,11 @@ CopyFrom(CopyState cstate)
 	 * completed rows as well.
 	 */
 	if ((cstate->errMode != ALL_OR_NOTHING && cstate->dispatch_mode == COPY_EXECUTOR)
-		|| cstate->on_segment)
+		|| cstate->on_segment
+		|| (cstate->segment_parse && Gp_role == GP_ROLE_EXECUTE))
 	{
 		SendNumRows((cstate->errMode != ALL_OR_NOTHING) ? cstate->cdbsreh->rejectcount : 0,
-				cstate->on_segment ? processed : 0);
+				(cstate->on_segment || cstate->segment_parse) ? processed : 0);
 	}
 
 	if (estate->es_result_partitions && Gp_role == GP_ROLE_EXECUTE)
@@ -4599,6 +5620,15 @@ BeginCopyFrom(Relation rel,
 		cstate->dispatch_mode = COPY_DIRECT;
 	else if (Gp_role == GP_ROLE_DISPATCH && cstate->rel->rd_cdbpolicy)
 		cstate->dispatch_mode = COPY_DISPATCH;
+	else if (Gp_role == GP_ROLE_EXECUTE && cstate->segment_parse)
+	{
+		/*
+		 * SEGMENT_PARSE: the QD forwards the raw lines, without the header
+		 * line, and we parse them ourselves.
+		 */
+		cstate->dispatch_mode = COPY_DIRECT;
+		cstate->header_line = false;
+	}
 	else if (Gp_role == GP_ROLE_EXECUTE)
 		cstate->dispatch_mode = COPY_EXECUTOR;
 	else
@@ -4699,7 +5729,13 @@ BeginCopyFrom(Relation rel,
 	cstate->num_defaults = num_defaults;
 	cstate->is_program = is_program;
 
-	bool		pipe = (filename == NULL || cstate->dispatch_mode == COPY_EXECUTOR);
+	bool		pipe = (filename == NULL || cstate->dispatch_mode == COPY_EXECUTOR ||
+						(Gp_role == GP_ROLE_EXECUTE && cstate->segment_parse));
+
+	if (cstate->compress && is_program)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY compression is not available with PROGRAM")));
 
 	if (cstate->on_segment && Gp_role == GP_ROLE_DISPATCH)
 	{
@@ -4718,7 +5754,7 @@ BeginCopyFrom(Relation rel,
 	}
 	else if (pipe)
 	{
-		Assert(!is_program || cstate->dispatch_mode == COPY_EXECUTOR);	/* the grammar does not allow this */
+		Assert(!is_program || Gp_role == GP_ROLE_EXECUTE);	/* the grammar does not allow this */
 		if (whereToSendOutput == DestRemote)
 			ReceiveCopyBegin(cstate);
 		else
@@ -4760,6 +5796,9 @@ BeginCopyFrom(Relation rel,
 				ereport(ERROR,
 						(errcode(ERRCODE_WRONG_OBJECT_TYPE),
 						 errmsg("\"%s\" is a directory", filename)));
+
+			if (cstate->compress)
+				BeginCopyCompression(cstate, true);
 		}
 	}
 
@@ -6138,6 +7177,113 @@ CopyReadLine(CopyState cstate)
 	return result;
 }
 
+/*
+ * Scanning for structural characters.
+ *
+ * Most of the bytes in COPY input are plain data, and only a handful of
+ * characters (newlines, delimiters, quotes and escapes) need a closer look.
+ * CopyScanNext() skips to the next of those, comparing a whole SSE2 or AVX2
+ * register of input against each of them at once and picking the first hit
+ * out of the resulting bitmask.  The vector code is chosen at compile time:
+ * SSE2 is part of every x86-64 target, AVX2 is used if the compiler is told
+ * it may (e.g. -march=native).  Other platforms, and the tail of the input
+ * that does not fill a register, go one byte at a time.
+ */
+#define COPY_SCAN_MAX_CHARS		5
+
+typedef struct CopyScanChars
+{
+	int			nchars;
+	char		chars[COPY_SCAN_MAX_CHARS];
+} CopyScanChars;
+
+/*
+ * Add c to the characters to stop at.  '\0' stands for "none", as in the
+ * callers' quotec and escapec.
+ */
+static inline void
+CopyScanAddChar(CopyScanChars *scan, char c)
+{
+	int			i;
+
+	if (c == '\0')
+		return;
+	for (i = 0; i < scan->nchars; i++)
+	{
+		if (scan->chars[i] == c)
+			return;
+	}
+	Assert(scan->nchars < COPY_SCAN_MAX_CHARS);
+	scan->chars[scan->nchars++] = c;
+}
+
+/*
+ * Return a pointer to the first character in [ptr, end) that is one of the
+ * characters in scan, or end if there is none.
+ */
+static inline char *
+CopyScanNext(const CopyScanChars *scan, char *ptr, char *end)
+{
+	int			nchars = scan->nchars;
+	int			i;
+
+#if defined(__AVX2__)
+	if (end - ptr >= (ptrdiff_t) sizeof(__m256i))
+	{
+		__m256i		chars[COPY_SCAN_MAX_CHARS];
+
+		for (i = 0; i < nchars; i++)
+			chars[i] = _mm256_set1_epi8(scan->chars[i]);
+
+		while (end - ptr >= (ptrdiff_t) sizeof(__m256i))
+		{
+			__m256i		data = _mm256_loadu_si256((const __m256i *) ptr);
+			__m256i		hits = _mm256_setzero_si256();
+			uint32		mask;
+
+			for (i = 0; i < nchars; i++)
+				hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(data, chars[i]));
+			mask = (uint32) _mm256_movemask_epi8(hits);
+			if (mask != 0)
+				return ptr + __builtin_ctz(mask);
+			ptr += sizeof(__m256i);
+		}
+	}
+#elif defined(__SSE2__)
+	if (end - ptr >= (ptrdiff_t) sizeof(__m128i))
+	{
+		__m128i		chars[COPY_SCAN_MAX_CHARS];
+
+		for (i = 0; i < nchars; i++)
+			chars[i] = _mm_set1_epi8(scan->chars[i]);
+
+		while (end - ptr >= (ptrdiff_t) sizeof(__m128i))
+		{
+			__m128i		data = _mm_loadu_si128((const __m128i *) ptr);
+			__m128i		hits = _mm_setzero_si128();
+			uint32		mask;
+
+			for (i = 0; i < nchars; i++)
+				hits = _mm_or_si128(hits, _mm_cmpeq_epi8(data, chars[i]));
+			mask = (uint32) _mm_movemask_epi8(hits);
+			if (mask != 0)
+				return ptr + __builtin_ctz(mask);
+			ptr += sizeof(__m128i);
+		}
+	}
+#endif
+
+	for (; ptr < end; ptr++)
+	{
+		for (i = 0; i < nchars; i++)
+		{
+			if (*ptr == scan->chars[i])
+				return ptr;
+		}
+	}
+	return end;
+}
+
 /*
  * CopyReadLineText - inner loop of CopyReadLine for text mode
  */
@@ -6158,6 +7304,7 @@ CopyReadLineText(CopyState cstate)
 				last_was_esc = false;
 	char		quotec = '\0';
 	char		escapec = '\0';
+	CopyScanChars scan;
 
 	if (cstate->csv_mode)
 	{
@@ -6168,6 +7315,14 @@ CopyReadLineText(CopyState cstate)
 			escapec = '\0';
 	}
 
+	/* the characters the loop below cares about */
+	scan.nchars = 0;
+	CopyScanAddChar(&scan, '\\');
+	CopyScanAddChar(&scan, '\r');
+	CopyScanAddChar(&scan, '\n');
+	CopyScanAddChar(&scan, quotec);
+	CopyScanAddChar(&scan, escapec);
+
 	mblen_str[1] = '\0';
 
 	/*
@@ -6235,6 +7390,29 @@ CopyReadLineText(CopyState cstate)
 			need_data = false;
 		}
 
+		/*
+		 * Skip over plain data in bulk.  Characters that are none of the
+		 * above can't end the line or change the CSV quoting state, all they
+		 * do is end an escape sequence.  Multi-byte encodings that embed
+		 * ASCII in their trailing bytes must go one character at a time.
+		 */
+		if (!cstate->encoding_embeds_ascii)
+		{
+			int			skip;
+
+			skip = CopyScanNext(&scan, copy_raw_buf + raw_buf_ptr,
+								copy_raw_buf + copy_buf_len) -
+				(copy_raw_buf + raw_buf_ptr);
+			if (skip > 0)
+			{
+				raw_buf_ptr += skip;
+				first_char_in_line = false;
+				last_was_esc = false;
+				if (raw_buf_ptr >= copy_buf_len)
+					continue;
+			}
+		}
+
 		/* OK to fetch a character */
 		prev_raw_ptr = raw_buf_ptr;
 		c = copy_raw_buf[raw_buf_ptr++];
@@ -6639,6 +7817,7 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 	char	   *output_ptr;
 	char	   *cur_ptr;
 	char	   *line_end_ptr;
+	CopyScanChars scan;
 
 	/*
 	 * We need a special case for zero-column tables: check that the input
@@ -6670,6 +7849,13 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 	cur_ptr = cstate->line_buf.data + cstate->line_buf.cursor;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
 
+	/* the characters that end a run of plain data */
+	scan.nchars = 0;
+	if (!delim_off)
+		CopyScanAddChar(&scan, delimc);
+	if (!cstate->escape_off)
+		CopyScanAddChar(&scan, escapec);
+
 	/* Outer loop iterates over fields */
 	fieldno = 0;
 	for (;;)
@@ -6715,6 +7901,16 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 		for (;;)
 		{
 			char		c;
+			char	   *run_end;
+
+			/* copy plain data up to the next delimiter or escape as is */
+			run_end = CopyScanNext(&scan, cur_ptr, line_end_ptr);
+			if (run_end > cur_ptr)
+			{
+				memcpy(output_ptr, cur_ptr, run_end - cur_ptr);
+				output_ptr += run_end - cur_ptr;
+				cur_ptr = run_end;
+			}
 
 			end_ptr = cur_ptr;
 			if (cur_ptr >= line_end_ptr)
@@ -6888,6 +8084,8 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 	char	   *output_ptr;
 	char	   *cur_ptr;
 	char	   *line_end_ptr;
+	CopyScanChars unquoted_scan;
+	CopyScanChars quoted_scan;
 
 	/*
 	 * We need a special case for zero-column tables: check that the input
@@ -6919,6 +8117,15 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 	cur_ptr = cstate->line_buf.data + cstate->line_buf.cursor;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
 
+	/* the characters that end a run of plain data, outside and in quotes */
+	unquoted_scan.nchars = 0;
+	if (!delim_off)
+		CopyScanAddChar(&unquoted_scan, delimc);
+	CopyScanAddChar(&unquoted_scan, quotec);
+	quoted_scan.nchars = 0;
+	CopyScanAddChar(&quoted_scan, escapec);
+	CopyScanAddChar(&quoted_scan, quotec);
+
 	/* Outer loop iterates over fields */
 	fieldno = 0;
 	for (;;)
@@ -6960,10 +8167,19 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 		for (;;)
 		{
 			char		c;
+			char	   *run_end;
 
 			/* Not in quote */
 			for (;;)
 			{
+				run_end = CopyScanNext(&unquoted_scan, cur_ptr, line_end_ptr);
+				if (run_end > cur_ptr)
+				{
+					memcpy(output_ptr, cur_ptr, run_end - cur_ptr);
+					output_ptr += run_end - cur_ptr;
+					cur_ptr = run_end;
+				}
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					goto endfield;
@@ -6987,6 +8203,14 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 			/* In quote */
 			for (;;)
 			{
+				run_end = CopyScanNext(&quoted_scan, cur_ptr, line_end_ptr);
+				if (run_end > cur_ptr)
+				{
+					memcpy(output_ptr, cur_ptr, run_end - cur_ptr);
+					output_ptr += run_end - cur_ptr;
+					cur_ptr = run_end;
+				}
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					ereport(ERROR,
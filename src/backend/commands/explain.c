@@ -656,7 +656,21 @@ ExplainOnePlan(PlannedStmt *plannedstmt, IntoClause *into, ExplainState *es,
 		ExplainProperty("Optimizer", "Postgres query optimizer", false, es);
 #ifdef USE_ORCA
 	else
+	{
 		ExplainPropertyStringInfo("Optimizer", es, "Pivotal Optimizer (GPORCA)");
+
+		/* peak memory GPORCA needed to come up with the plan */
+		if (es->summary && queryDesc->plannedstmt->optimizer_peak_memory > 0)
+		{
+			long		peak_kb;
+
+			peak_kb = (long) ((queryDesc->plannedstmt->optimizer_peak_memory + 1023) / 1024);
+			if (es->format == EXPLAIN_FORMAT_TEXT)
+				ExplainPropertyStringInfo("Optimizer peak memory", es, "%ldkB", peak_kb);
+			else
+				ExplainPropertyLong("Optimizer Peak Memory", peak_kb, es);
+		}
+	}
 #endif
 
 	/* We only list the non-default GUCs in verbose mode */
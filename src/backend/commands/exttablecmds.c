@@ -16,6 +16,7 @@
  */
 #include "postgres.h"
 
+#include "access/extcolumnar.h"
 #include "access/extprotocol.h"
 #include "access/reloptions.h"
 #include "catalog/namespace.h"
@@ -278,6 +279,11 @@ DefineExternalRelation(CreateExternalStmt *createExtStmt)
 	{
 		Assert(!iswritable);
 
+		if (fmttype_is_columnar(formattype))
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("single row error handling is not supported for the columnar format")));
+
 		issreh = true;
 
 		logerrors = singlerowerrorDesc->into_file;
@@ -679,11 +685,13 @@ transformFormatType(char *formatname)
 		result = 'c';
 	else if (pg_strcasecmp(formatname, "custom") == 0)
 		result = 'b';
+	else if (pg_strcasecmp(formatname, "columnar") == 0)
+		result = 'o';
 	else
 		ereport(ERROR,
 				(errcode(ERRCODE_SYNTAX_ERROR),
 				 errmsg("unsupported format '%s'", formatname),
-				 errhint("Available formats for external tables are \"text\", \"csv\" and \"custom\".")));
+				 errhint("Available formats for external tables are \"text\", \"csv\", \"custom\" and \"columnar\".")));
 
 	return result;
 }
@@ -739,7 +747,8 @@ transformFormatOpts(char formattype, List *formatOpts, int numcols, bool iswrita
 
 	Assert(fmttype_is_custom(formattype) ||
 		   fmttype_is_text(formattype) ||
-		   fmttype_is_csv(formattype));
+		   fmttype_is_csv(formattype) ||
+		   fmttype_is_columnar(formattype));
 
 	/* Extract options from the statement node tree */
 	if (fmttype_is_text(formattype) || fmttype_is_csv(formattype))
@@ -854,6 +863,22 @@ transformFormatOpts(char formattype, List *formatOpts, int numcols, bool iswrita
 
 		format_str = cfbuf.data;
 	}
+	else if (fmttype_is_columnar(formattype))
+	{
+		int			block_size;
+		bool		compress;
+		bool		statistics;
+
+		extcolumnar_parse_options(formatOpts, &block_size, &compress,
+								  &statistics);
+
+		/* stored like the options of a custom format */
+		initStringInfo(&cfbuf);
+		appendStringInfo(&cfbuf, "block_size '%d' compression '%s' statistics '%s'",
+						 block_size, compress ? "zstd" : "none",
+						 statistics ? "true" : "false");
+		format_str = cfbuf.data;
+	}
 	else
 	{
 		/* custom format */
@@ -1482,6 +1482,12 @@ ao_aux_tables_safe_truncate(Relation rel, MultiXactId minmulti)
 	 */
 	RemoveFastSequenceEntry(aoseg_relid);
 	InsertInitialFastSequenceEntries(aoseg_relid);
+
+	/*
+	 * The modcount restarts from zero in the new aoseg table, so whatever
+	 * ANALYZE recorded is no longer comparable.
+	 */
+	UpdateAppendOnlyEntryAnalyzeModcount(relid, -1);
 }
 
 /*
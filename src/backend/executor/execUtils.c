@@ -68,6 +68,7 @@
 #include "cdb/ml_ipc.h"
 #include "cdb/cdbmotion.h"
 #include "cdb/cdbsreh.h"
+#include "cdb/cdbtm.h"
 #include "cdb/memquota.h"
 #include "executor/instrument.h"
 #include "executor/nodeBitmapHeapscan.h"
@@ -2159,6 +2160,9 @@ void mppExecutorFinishup(QueryDesc *queryDesc)
 			ThrowErrorData(qeError);
 		}
 
+		/* The writer QEs have prepared, if they were asked to. */
+		dtxPreparedWithStatement();
+
 		/* If top slice was delegated to QEs, get num of rows processed. */
 		int primaryWriterSliceIndex = PrimaryWriterSliceIndex(estate);
 		//if (sliceRunsOnQE(currentSlice))
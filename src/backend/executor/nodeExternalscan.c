@@ -25,6 +25,7 @@
 
 #include "access/fileam.h"
 #include "access/heapam.h"
+#include "catalog/pg_exttable.h"
 #include "cdb/cdbvars.h"
 #include "executor/execdebug.h"
 #include "executor/nodeExternalscan.h"
@@ -34,9 +35,13 @@
 #include "parser/parsetree.h"
 #include "optimizer/var.h"
 #include "optimizer/clauses.h"
+#include "rewrite/rewriteManip.h"
+#include "utils/builtins.h"
 
 static TupleTableSlot *ExternalNext(ExternalScanState *node);
 static void ExecEagerFreeExternalScan(ExternalScanState *node);
+static char *ExternalFilterString(ExternalScan *node, Relation rel);
+static void ExecExternalScanExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 
 static bool
 ExternalConstraintCheck(TupleTableSlot *slot, ExternalScanState *node)
@@ -279,6 +284,24 @@ ExecInitExternalScan(ExternalScan *node, EState *estate, int eflags)
 	externalstate->ss.ss_currentRelation = currentRelation;
 	externalstate->ess_ScanDesc = currentScanDesc;
 
+	/*
+	 * Tell the scan which columns neither the targetlist nor the quals look
+	 * at, like AOCS scans are told, and which quals the source can check
+	 * early.  The columnar format leaves those columns out, and both are
+	 * passed on to the source.
+	 */
+	{
+		int			ncol = currentRelation->rd_att->natts;
+		bool	   *proj = palloc0(ncol * sizeof(bool));
+
+		GetNeededColumnsForScan((Node *) node->scan.plan.targetlist, proj, ncol);
+		GetNeededColumnsForScan((Node *) node->scan.plan.qual, proj, ncol);
+		external_set_projection(currentScanDesc, proj);
+	}
+	if (gp_external_enable_filter_pushdown)
+		external_set_filter(currentScanDesc,
+							ExternalFilterString(node, currentRelation));
+
 	ExecAssignScanType(&externalstate->ss, RelationGetDescr(currentRelation));
 
 	/*
@@ -294,9 +317,117 @@ ExecInitExternalScan(ExternalScan *node, EState *estate, int eflags)
 	externalstate->delayEagerFree =
 		((eflags & (EXEC_FLAG_REWIND | EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)) != 0);
 
+	/*
+	 * CDB: Offer extra info for EXPLAIN ANALYZE.
+	 */
+	if (estate->es_instrument && (estate->es_instrument & INSTRUMENT_CDB))
+	{
+		/* Allocate string buffer. */
+		externalstate->ss.ps.cdbexplainbuf = makeStringInfo();
+
+		/* Request a callback at end of query. */
+		externalstate->ss.ps.cdbexplainfun = ExecExternalScanExplainEnd;
+	}
+
 	return externalstate;
 }
 
+/*
+ * Is the qual simple enough to pass to the source: a column compared with a
+ * constant, or with an array of them by ANY or ALL, or a NULL test of a
+ * column?
+ */
+static bool
+IsSimpleExternalQual(Node *qual)
+{
+	List	   *args;
+	ListCell   *lc;
+	int			nvars = 0;
+
+	if (IsA(qual, OpExpr))
+		args = ((OpExpr *) qual)->args;
+	else if (IsA(qual, ScalarArrayOpExpr))
+		args = ((ScalarArrayOpExpr *) qual)->args;
+	else if (IsA(qual, NullTest) && !((NullTest *) qual)->argisrow)
+		args = list_make1(((NullTest *) qual)->arg);
+	else
+		return false;
+
+	foreach(lc, args)
+	{
+		Node	   *arg = (Node *) lfirst(lc);
+
+		if (IsA(arg, RelabelType))
+			arg = (Node *) ((RelabelType *) arg)->arg;
+
+		if (IsA(arg, Var) && !IS_SPECIAL_VARNO(((Var *) arg)->varno) &&
+			((Var *) arg)->varlevelsup == 0 && ((Var *) arg)->varattno > 0)
+			nvars++;
+		else if (!IsA(arg, Const))
+			return false;
+	}
+
+	return nvars == 1 && !contain_mutable_functions(qual);
+}
+
+/*
+ * The simple quals of the scan as an SQL boolean expression over the columns
+ * of the table, NULL if there are none.  The scan checks every row against
+ * all of its quals anyway, so the source may use it to leave out rows early.
+ */
+static char *
+ExternalFilterString(ExternalScan *node, Relation rel)
+{
+	List	   *context;
+	StringInfoData buf;
+	ListCell   *lc;
+
+	context = deparse_context_for(RelationGetRelationName(rel),
+								  RelationGetRelid(rel));
+	initStringInfo(&buf);
+	foreach(lc, node->scan.plan.qual)
+	{
+		Node	   *qual = (Node *) lfirst(lc);
+		char	   *str;
+
+		if (!IsSimpleExternalQual(qual))
+			continue;
+
+		/* the deparse context has the table as its only range table entry */
+		qual = copyObject(qual);
+		ChangeVarNodes(qual, node->scan.scanrelid, 1, 0);
+		str = deparse_expression(qual, context, false, false);
+
+		/* it goes into an HTTP header */
+		if (strpbrk(str, "\r\n") != NULL)
+			continue;
+
+		if (buf.len > 0)
+			appendStringInfoString(&buf, " AND ");
+		appendStringInfoString(&buf, str);
+	}
+
+	if (buf.len == 0)
+	{
+		pfree(buf.data);
+		return NULL;
+	}
+	return buf.data;
+}
+
+/*
+ * ExecExternalScanExplainEnd
+ *		Called before ExecutorEnd to finish EXPLAIN ANALYZE reporting.
+ */
+static void
+ExecExternalScanExplainEnd(PlanState *planstate, struct StringInfoData *buf)
+{
+	ExternalScanState *node = (ExternalScanState *) planstate;
+
+	if (node->ess_ScanDesc)
+		external_explain(node->ess_ScanDesc, planstate->cdbexplainbuf);
+}
+
 /* ----------------------------------------------------------------
 *		ExecEndExternalScan
 *
@@ -36,6 +36,16 @@ CMemoryPoolPallocManager::NewMemoryPool()
 	return GPOS_NEW(GetInternalMemoryPool()) CMemoryPoolPalloc();
 }
 
+// Memory contexts already allocate in blocks and release them in bulk when
+// the context is deleted, and since frees are routed by the manager rather
+// than by the pool, a pool here cannot skip them; so an arena is a plain
+// memory context
+CMemoryPool *
+CMemoryPoolPallocManager::NewArenaMemoryPool()
+{
+	return NewMemoryPool();
+}
+
 void
 CMemoryPoolPallocManager::DeleteImpl(void *ptr,
 									 CMemoryPool::EAllocationType eat)
@@ -15,6 +15,8 @@
 
 #include "gpopt/utils/COptTasks.h"
 
+#include <sys/stat.h>
+
 #include "gpos/base.h"
 #include "gpos/error/CException.h"
 
@@ -89,6 +91,20 @@ using namespace gpdbcost;
 // default id for the source system
 const CSystemId default_sysid(IMDId::EmdidGeneral, GPOS_WSZ_STR_LENGTH("GPDB"));
 
+// cost model parameters file last looked at by LoadCostModelParams; the
+// file is only parsed again when its path or modification time changes,
+// and a file that cannot be loaded is only warned about once
+static struct
+{
+	char path[MAXPGPATH];
+	time_t mtime;
+	off_t size;
+	bool valid;
+	double value[CCostModelParamsGPDB::EcpSentinel];
+	double lower_bound[CCostModelParamsGPDB::EcpSentinel];
+	double upper_bound[CCostModelParamsGPDB::EcpSentinel];
+} cost_params_cache;
+
 
 //---------------------------------------------------------------------------
 //	@function:
@@ -357,6 +373,115 @@ COptTasks::LoadSearchStrategy(CMemoryPool *mp, char *path)
 	return search_strategy_arr;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::LoadCostModelParams
+//
+//	@doc:
+//		Load cost model parameters from given file, as written by
+//		gpcostcalibrate; on failure, the built-in parameters are kept
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::LoadCostModelParams(CMemoryPool *mp, ICostModel *cost_model,
+							   char *path)
+{
+	if (NULL == path || '\0' == path[0])
+	{
+		return;
+	}
+
+	struct stat st;
+	if (0 != stat(path, &st))
+	{
+		st.st_mtime = 0;
+		st.st_size = -1;
+	}
+
+	if (0 != strcmp(path, cost_params_cache.path) ||
+		st.st_mtime != cost_params_cache.mtime ||
+		st.st_size != cost_params_cache.size)
+	{
+		strlcpy(cost_params_cache.path, path, sizeof(cost_params_cache.path));
+		cost_params_cache.mtime = st.st_mtime;
+		cost_params_cache.size = st.st_size;
+		cost_params_cache.valid = false;
+		cost_params_cache.valid = ParseCostModelParams(mp, path);
+
+		if (!cost_params_cache.valid)
+		{
+			elog(WARNING,
+				 "could not load cost model parameters from \"%s\", using defaults",
+				 path);
+		}
+	}
+
+	if (!cost_params_cache.valid)
+	{
+		return;
+	}
+
+	elog(DEBUG2, "\n[OPT]: Using cost model parameters in (%s)", path);
+
+	for (ULONG ul = 0; ul < CCostModelParamsGPDB::EcpSentinel; ul++)
+	{
+		cost_model->GetCostModelParams()->SetParam(
+			ul, cost_params_cache.value[ul], cost_params_cache.lower_bound[ul],
+			cost_params_cache.upper_bound[ul]);
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::ParseCostModelParams
+//
+//	@doc:
+//		Parse cost model parameters from given file into the cache;
+//		return false if the file cannot be parsed
+//
+//---------------------------------------------------------------------------
+BOOL
+COptTasks::ParseCostModelParams(CMemoryPool *mp, char *path)
+{
+	CParseHandlerDXL *dxl_parse_handler = NULL;
+	BOOL parsed = false;
+
+	GPOS_TRY
+	{
+		dxl_parse_handler =
+			CDXLUtils::GetParseHandlerForDXLFile(mp, path, NULL);
+		ICostModelParams *cost_model_params =
+			dxl_parse_handler->GetCostModelParams();
+		if (NULL != cost_model_params)
+		{
+			for (ULONG ul = 0; ul < CCostModelParamsGPDB::EcpSentinel; ul++)
+			{
+				ICostModelParams::SCostParam *cost_param =
+					cost_model_params->PcpLookup(ul);
+				cost_params_cache.value[ul] = cost_param->Get().Get();
+				cost_params_cache.lower_bound[ul] =
+					cost_param->GetLowerBoundVal().Get();
+				cost_params_cache.upper_bound[ul] =
+					cost_param->GetUpperBoundVal().Get();
+			}
+			parsed = true;
+		}
+	}
+	GPOS_CATCH_EX(ex)
+	{
+		if (GPOS_MATCH_EX(ex, gpdxl::ExmaGPDB, gpdxl::ExmiGPDBError))
+		{
+			GPOS_RETHROW(ex);
+		}
+		GPOS_RESET_EX;
+	}
+	GPOS_CATCH_END;
+
+	GPOS_DELETE(dxl_parse_handler);
+
+	return parsed;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::CreateOptimizerConfig
@@ -460,6 +585,9 @@ COptTasks::GetCostModel(CMemoryPool *mp, ULONG num_segments)
 {
 	ICostModel *cost_model = GPOS_NEW(mp) CCostModelGPDB(mp, num_segments);
 
+	// calibrated parameters first, so that the cost factor GUCs still
+	// apply on top of them
+	LoadCostModelParams(mp, cost_model, optimizer_cost_model_params_path);
 	SetCostModelParams(cost_model);
 
 	return cost_model;
@@ -483,7 +611,9 @@ COptTasks::OptimizeTask(void *ptr)
 	GPOS_ASSERT(NULL == opt_ctxt->m_plan_dxl);
 	GPOS_ASSERT(NULL == opt_ctxt->m_plan_stmt);
 
-	AUTO_MEM_POOL(amp);
+	// the memo and nearly everything else allocated while optimizing lives
+	// until the end of the task, so it may come from an arena
+	CAutoMemoryPool amp(CAutoMemoryPool::ElcExc, optimizer_use_arena_allocator);
 	CMemoryPool *mp = amp.Pmp();
 
 	// Does the metadatacache need to be reset?
@@ -610,6 +740,8 @@ COptTasks::OptimizeTask(void *ptr)
 						mp, &mda, opt_ctxt->m_query, plan_dxl,
 						opt_ctxt->m_query->canSetTag,
 						query_to_dxl_translator->GetDistributionHashOpsKind()));
+				opt_ctxt->m_plan_stmt->optimizer_peak_memory =
+					mp->PeakAllocatedSize();
 			}
 
 			CStatisticsConfig *stats_conf = optimizer_config->GetStatsConf();
@@ -6,7 +6,7 @@
 //		CBitSet.h
 //
 //	@doc:
-//		Implementation of bitset as linked list of bitvectors
+//		Implementation of bitset as a flat array of words
 //---------------------------------------------------------------------------
 #ifndef GPOS_CBitSet_H
 #define GPOS_CBitSet_H
@@ -17,6 +17,8 @@
 #include "gpos/common/CList.h"
 #include "gpos/common/DbgPrintMixin.h"
 
+// number of words kept inside the set itself before spilling to the pool
+#define GPOS_BITSET_INLINE_UNITS (4)
 
 namespace gpos
 {
@@ -25,7 +27,14 @@ namespace gpos
 //		CBitSet
 //
 //	@doc:
-//		Linked list of CBitSetLink's
+//		Bit set stored as one contiguous array of ULLONG words covering
+//		the words from m_offset on; words outside the array are implicitly
+//		zero. The offset keeps a set of a few high column ids as small as
+//		a set of low ones.
+//
+//		Small sets live in inline storage, so they need no allocation at
+//		all; larger ones grow the array geometrically. Set operations are
+//		straight loops over the word arrays.
 //
 //---------------------------------------------------------------------------
 class CBitSet : public CRefCount, public DbgPrintMixin<CBitSet>
@@ -34,81 +43,55 @@ class CBitSet : public CRefCount, public DbgPrintMixin<CBitSet>
 	friend class CBitSetIter;
 
 protected:
-	//---------------------------------------------------------------------------
-	//	@class:
-	//		CBitSetLink
-	//
-	//	@doc:
-	//		bit vector + offset + link
-	//
-	//---------------------------------------------------------------------------
-	class CBitSetLink
-	{
-	private:
-		// private copy ctor
-		CBitSetLink(const CBitSetLink &);
-
-		// offset
-		ULONG m_offset;
-
-		// bitvector
-		CBitVector *m_vec;
-
-	public:
-		// ctor
-		explicit CBitSetLink(CMemoryPool *, ULONG offset, ULONG vector_size);
-
-		explicit CBitSetLink(CMemoryPool *, const CBitSetLink &);
-
-		// dtor
-		~CBitSetLink();
-
-		// accessor
-		ULONG
-		GetOffset() const
-		{
-			return m_offset;
-		}
-
-		// accessor
-		CBitVector *
-		GetVec() const
-		{
-			return m_vec;
-		}
-
-		// list link
-		SLink m_link;
-
-	};	// class CBitSetLink
-
-	// list of bit set links
-	CList<CBitSetLink> m_bsllist;
-
-	// pool to allocate links from
+	// pool to allocate the word array from once it outgrows inline storage
 	CMemoryPool *m_mp;
 
-	// size of individual bitvectors
+	// size of blocks the set is hashed in
 	ULONG m_vector_size;
 
 	// number of elements
 	ULONG m_size;
 
+private:
+	// index of the word held in m_vec[0]
+	ULONG m_offset;
+
+	// number of words in m_vec
+	ULONG m_len;
+
+	// words of the set; points to m_inline_vec or a pool allocation
+	ULLONG *m_vec;
+
+	// inline storage for small sets
+	ULLONG m_inline_vec[GPOS_BITSET_INLINE_UNITS];
+
 	// private copy ctor
 	CBitSet(const CBitSet &);
 
-	// find link with offset less or equal to given value
-	CBitSetLink *FindLinkByOffset(ULONG, CBitSetLink * = NULL) const;
+	// make room for the words in the given range
+	void EnsureCapacity(ULONG first, ULONG end);
 
-	// reset set
-	void Clear();
+	// word at given index; zero outside the array
+	ULLONG
+	Word(ULONG idx) const
+	{
+		return (idx >= m_offset && idx - m_offset < m_len)
+				   ? m_vec[idx - m_offset]
+				   : 0;
+	}
 
-	// compute target offset
-	ULONG ComputeOffset(ULONG) const;
+	// range of this set's words that the other set has words for too
+	const ULLONG *Overlap(const CBitSet *bs, ULONG &first, ULONG &end) const;
 
 	// re-compute size of set
 	void RecomputeSize();
 
+	// find next set bit at or after given position
+	BOOL GetNextSetBit(ULONG start_pos, ULONG &next_pos) const;
+
+	// hash one block of m_vector_size bits
+	ULONG HashBlock(ULONG block) const;
+
 public:
 	// ctor
 	CBitSet(CMemoryPool *mp, ULONG vector_size = 256);
@@ -31,12 +31,9 @@ private:
 	// bitset
 	const CBitSet &m_bs;
 
-	// current cursor position (in current link)
+	// current cursor position
 	ULONG m_cursor;
 
-	// current cursor link
-	CBitSet::CBitSetLink *m_bsl;
-
 	// is iterator active or exhausted
 	BOOL m_active;
 
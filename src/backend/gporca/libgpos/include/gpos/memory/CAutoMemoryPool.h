@@ -60,7 +60,8 @@ private:
 
 public:
 	// ctor
-	CAutoMemoryPool(ELeakCheck leak_check_type = ElcExc);
+	CAutoMemoryPool(ELeakCheck leak_check_type = ElcExc,
+					BOOL is_arena = false);
 
 	// dtor
 	~CAutoMemoryPool();
@@ -154,6 +154,14 @@ public:
 		return 0;
 	}
 
+	// return the high-water mark of the total allocated size
+	virtual ULLONG
+	PeakAllocatedSize() const
+	{
+		GPOS_ASSERT(!"not supported");
+		return 0;
+	}
+
 	// requested size of allocation
 	static ULONG UserSizeOfAlloc(const void *ptr);
 
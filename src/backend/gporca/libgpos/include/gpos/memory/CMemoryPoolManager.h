@@ -65,6 +65,9 @@ private:
 	// create new pool of given type
 	virtual CMemoryPool *NewMemoryPool();
 
+	// create new arena pool, i.e. one that frees its memory only in bulk
+	virtual CMemoryPool *NewArenaMemoryPool();
+
 	// no copy ctor
 	CMemoryPoolManager(const CMemoryPoolManager &);
 
@@ -120,7 +123,7 @@ protected:
 
 public:
 	// create new memory pool
-	CMemoryPool *CreateMemoryPool();
+	CMemoryPool *CreateMemoryPool(BOOL is_arena = false);
 
 	// release memory pool
 	void Destroy(CMemoryPool *);
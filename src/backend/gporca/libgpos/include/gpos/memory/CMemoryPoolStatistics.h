@@ -38,6 +38,8 @@ private:
 
 	ULLONG m_live_obj_total_size;
 
+	ULLONG m_peak_live_obj_total_size;
+
 	// private copy ctor
 	CMemoryPoolStatistics(CMemoryPoolStatistics &);
 
@@ -49,7 +51,8 @@ public:
 		  m_num_free(0),
 		  m_num_live_obj(0),
 		  m_live_obj_user_size(0),
-		  m_live_obj_total_size(0)
+		  m_live_obj_total_size(0),
+		  m_peak_live_obj_total_size(0)
 	{
 	}
 
@@ -101,6 +104,13 @@ public:
 		return m_live_obj_total_size;
 	}
 
+	// get the high-water mark of the total data size of live objects
+	ULLONG
+	PeakLiveObjTotalSize() const
+	{
+		return m_peak_live_obj_total_size;
+	}
+
 	// record a successful allocation
 	void
 	RecordAllocation(ULONG user_data_size, ULONG total_data_size)
@@ -109,6 +119,11 @@ public:
 		++m_num_live_obj;
 		m_live_obj_user_size += user_data_size;
 		m_live_obj_total_size += total_data_size;
+
+		if (m_live_obj_total_size > m_peak_live_obj_total_size)
+		{
+			m_peak_live_obj_total_size = m_live_obj_total_size;
+		}
 	}
 
 	// record a successful free call (of a valid, non-NULL pointer)
@@ -8,7 +8,9 @@
 //
 //	@doc:
 //		Memory pool that allocates from malloc() and adds on
-//		statistics and debugging
+//		statistics and debugging;
+//		in arena mode, allocations are carved out of large chunks and
+//		the memory is only given back when the pool is torn down
 //
 //	@owner:
 //
@@ -63,6 +65,16 @@ private:
 		SLink m_link;
 	};
 
+	// header of a chunk that arena allocations are carved from
+	struct SArenaChunk
+	{
+		// next chunk owned by the pool
+		SArenaChunk *m_next;
+
+		// chunk size (including this header)
+		ULONG m_size;
+	};
+
 	// statistics
 	CMemoryPoolStatistics m_memory_pool_statistics;
 
@@ -72,9 +84,28 @@ private:
 	// list of allocated (live) objects
 	CList<SAllocHeader> m_allocations_list;
 
+	// are frees deferred until the pool is torn down?
+	BOOL m_is_arena;
+
+	// chunks owned by an arena pool, most recent first
+	SArenaChunk *m_arena_chunks;
+
+	// next free byte of the current arena chunk and bytes left in it
+	BYTE *m_arena_cursor;
+	ULONG m_arena_remaining;
+
+	// total size of all arena chunks
+	ULLONG m_arena_reserved;
+
 	// private copy ctor
 	CMemoryPoolTracker(CMemoryPoolTracker &);
 
+	// carve an allocation out of the current arena chunk
+	void *ArenaAlloc(ULONG alloc_size);
+
+	// release all arena chunks
+	void ArenaRelease();
+
 	// record a successful allocation
 	void RecordAllocation(SAllocHeader *header);
 
@@ -87,7 +118,7 @@ protected:
 
 public:
 	// ctor
-	CMemoryPoolTracker();
+	explicit CMemoryPoolTracker(BOOL is_arena = false);
 
 	// prepare the memory pool to be deleted
 	virtual void TearDown();
@@ -106,9 +137,34 @@ public:
 	virtual ULLONG
 	TotalAllocatedSize() const
 	{
+		if (m_is_arena)
+		{
+			return m_arena_reserved;
+		}
+
 		return m_memory_pool_statistics.TotalAllocatedSize();
 	}
 
+	// return the high-water mark of the total allocated size
+	virtual ULLONG
+	PeakAllocatedSize() const
+	{
+		if (m_is_arena)
+		{
+			// arena chunks are never given back before tear down
+			return m_arena_reserved;
+		}
+
+		return m_memory_pool_statistics.PeakLiveObjTotalSize();
+	}
+
+	// is this an arena pool?
+	BOOL
+	IsArena() const
+	{
+		return m_is_arena;
+	}
+
 #ifdef GPOS_DEBUG
 
 	// check if the memory pool keeps track of live objects
@@ -32,6 +32,8 @@ public:
 	static GPOS_RESULT EresUnittest_Removal();
 	static GPOS_RESULT EresUnittest_SetOps();
 	static GPOS_RESULT EresUnittest_Performance();
+	static GPOS_RESULT EresUnittest_WideSets();
+	static GPOS_RESULT EresUnittest_WidePerformance();
 
 };	// class CBitSetTest
 }  // namespace gpos
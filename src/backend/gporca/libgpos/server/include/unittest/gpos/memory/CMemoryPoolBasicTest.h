@@ -30,6 +30,7 @@ private:
 											 ULONG minor);
 
 	static GPOS_RESULT EresNewDelete();
+	static GPOS_RESULT EresArenaNewDelete();
 	static GPOS_RESULT EresThrowingCtor();
 #ifdef GPOS_DEBUG
 	static GPOS_RESULT EresLeak();
@@ -45,6 +46,7 @@ public:
 	static GPOS_RESULT EresUnittest_Print();
 #endif	// GPOS_DEBUG
 	static GPOS_RESULT EresUnittest_TestTracker();
+	static GPOS_RESULT EresUnittest_TestArena();
 	static GPOS_RESULT EresUnittest_TestSlab();
 
 };	// class CMemoryPoolBasicTest
@@ -12,7 +12,10 @@
 #include "unittest/gpos/common/CBitSetTest.h"
 
 #include "gpos/base.h"
+#include "gpos/common/CAutoTimer.h"
 #include "gpos/common/CBitSet.h"
+#include "gpos/common/CBitSetIter.h"
+#include "gpos/common/CRandom.h"
 #include "gpos/io/COstreamString.h"
 #include "gpos/memory/CAutoMemoryPool.h"
 #include "gpos/string/CWStringDynamic.h"
@@ -35,7 +38,9 @@ CBitSetTest::EresUnittest()
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Basics),
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Removal),
 		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_SetOps),
-		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Performance)};
+		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_Performance),
+		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_WideSets),
+		GPOS_UNITTEST_FUNC(CBitSetTest::EresUnittest_WidePerformance)};
 
 	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
 }
@@ -61,14 +66,14 @@ CBitSetTest::EresUnittest_Basics()
 	ULONG cInserts = 10;
 	for (ULONG i = 0; i < cInserts; i += 2)
 	{
-		// forces addition of new link
+		// forces growth beyond inline storage
 		pbs->ExchangeSet(i * vector_size);
 	}
 	GPOS_ASSERT(cInserts / 2 == pbs->Size());
 
 	for (ULONG i = 1; i < cInserts; i += 2)
 	{
-		// new link between existing links
+		// bits between existing ones
 		pbs->ExchangeSet(i * vector_size);
 	}
 	GPOS_ASSERT(cInserts == pbs->Size());
@@ -129,7 +134,6 @@ CBitSetTest::EresUnittest_Removal()
 
 	for (ULONG i = 0; i < cInserts; i++)
 	{
-		// cleans up empty links
 		pbs->ExchangeClear(i * vector_size);
 
 		GPOS_ASSERT(cInserts - i - 1 == pbs->Size());
@@ -262,4 +266,192 @@ CBitSetTest::EresUnittest_Performance()
 	return GPOS_OK;
 }
 
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSetTest::EresUnittest_WideSets
+//
+//	@doc:
+//		Random set operations on sets spanning thousands of bits, checked
+//		against a plain array of flags
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CBitSetTest::EresUnittest_WideSets()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	const ULONG ulBits = 5000;
+	const ULONG ulRounds = 200;
+	CRandom rand;
+
+	BOOL rgf1[ulBits];
+	BOOL rgf2[ulBits];
+
+	for (ULONG ulRound = 0; ulRound < ulRounds; ulRound++)
+	{
+		// vary both the density and the range of the sets
+		ULONG ulRange = 1 + rand.Next() % ulBits;
+		ULONG ulDensity = 1 + rand.Next() % 16;
+
+		CBitSet *pbs1 = GPOS_NEW(mp) CBitSet(mp);
+		CBitSet *pbs2 = GPOS_NEW(mp) CBitSet(mp);
+		for (ULONG ul = 0; ul < ulBits; ul++)
+		{
+			rgf1[ul] = (ul < ulRange && 0 == rand.Next() % ulDensity);
+			rgf2[ul] = (0 == rand.Next() % ulDensity);
+			if (rgf1[ul])
+			{
+				(void) pbs1->ExchangeSet(ul);
+			}
+			if (rgf2[ul])
+			{
+				(void) pbs2->ExchangeSet(ul);
+			}
+		}
+
+		CBitSet *pbsUnion = GPOS_NEW(mp) CBitSet(mp, *pbs1);
+		pbsUnion->Union(pbs2);
+		CBitSet *pbsInter = GPOS_NEW(mp) CBitSet(mp, *pbs1);
+		pbsInter->Intersection(pbs2);
+		CBitSet *pbsDiff = GPOS_NEW(mp) CBitSet(mp, *pbs1);
+		pbsDiff->Difference(pbs2);
+
+		ULONG ulSizeUnion = 0;
+		BOOL fDisjoint = true;
+		for (ULONG ul = 0; ul < ulBits; ul++)
+		{
+			GPOS_RTL_ASSERT(pbsUnion->Get(ul) == (rgf1[ul] || rgf2[ul]));
+			GPOS_RTL_ASSERT(pbsInter->Get(ul) == (rgf1[ul] && rgf2[ul]));
+			GPOS_RTL_ASSERT(pbsDiff->Get(ul) == (rgf1[ul] && !rgf2[ul]));
+
+			ulSizeUnion += (rgf1[ul] || rgf2[ul]) ? 1 : 0;
+			fDisjoint = fDisjoint && !(rgf1[ul] && rgf2[ul]);
+		}
+
+		GPOS_RTL_ASSERT(ulSizeUnion == pbsUnion->Size());
+		GPOS_RTL_ASSERT(fDisjoint == pbs1->IsDisjoint(pbs2));
+		GPOS_RTL_ASSERT(pbsUnion->ContainsAll(pbs1));
+		GPOS_RTL_ASSERT(pbsUnion->ContainsAll(pbs2));
+		GPOS_RTL_ASSERT(pbs1->ContainsAll(pbsInter));
+		GPOS_RTL_ASSERT(pbsDiff->IsDisjoint(pbs2));
+
+		// iteration visits exactly the set bits, in order
+		CBitSetIter bsi(*pbsUnion);
+		ULONG ulPrev = 0;
+		ULONG ulVisited = 0;
+		while (bsi.Advance())
+		{
+			GPOS_RTL_ASSERT(0 == ulVisited || ulPrev < bsi.Bit());
+			GPOS_RTL_ASSERT(rgf1[bsi.Bit()] || rgf2[bsi.Bit()]);
+			ulPrev = bsi.Bit();
+			ulVisited++;
+		}
+		GPOS_RTL_ASSERT(ulVisited == pbsUnion->Size());
+
+		// equal sets are equal and hash alike, no matter how large their
+		// arrays have grown
+		pbsDiff->Union(pbsInter);
+		GPOS_RTL_ASSERT(pbsDiff->Equals(pbs1) && pbs1->Equals(pbsDiff));
+		GPOS_RTL_ASSERT(pbsDiff->HashValue() == pbs1->HashValue());
+
+		CBitSet *pbsEmpty = GPOS_NEW(mp) CBitSet(mp);
+		pbsUnion->Difference(pbsUnion);
+		GPOS_RTL_ASSERT(0 == pbsUnion->Size());
+		GPOS_RTL_ASSERT(pbsUnion->Equals(pbsEmpty));
+		GPOS_RTL_ASSERT(pbsUnion->HashValue() == pbsEmpty->HashValue());
+		pbsEmpty->Release();
+
+		pbs1->Release();
+		pbs2->Release();
+		pbsUnion->Release();
+		pbsInter->Release();
+		pbsDiff->Release();
+	}
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSetTest::EresUnittest_WidePerformance
+//
+//	@doc:
+//		Micro-benchmark of the set operations property derivation uses
+//		on wide tables: output columns of the children are unioned, and
+//		the result is checked against required and excluded columns
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CBitSetTest::EresUnittest_WidePerformance()
+{
+	// create memory pool
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	const ULONG ulColumns = 4096;
+	const ULONG ulChildren = 8;
+	const ULONG ulIterations = 2000;
+
+	// each child produces a contiguous slice of the columns
+	CBitSet *rgpbsChild[ulChildren];
+	for (ULONG ulChild = 0; ulChild < ulChildren; ulChild++)
+	{
+		rgpbsChild[ulChild] = GPOS_NEW(mp) CBitSet(mp, 1024);
+		for (ULONG ul = ulChild * (ulColumns / ulChildren);
+			 ul < (ulChild + 1) * (ulColumns / ulChildren); ul++)
+		{
+			(void) rgpbsChild[ulChild]->ExchangeSet(ul);
+		}
+	}
+
+	// columns referenced by a predicate, spread over the whole table
+	CBitSet *pbsRequired = GPOS_NEW(mp) CBitSet(mp, 1024);
+	for (ULONG ul = 0; ul < ulColumns; ul += 97)
+	{
+		(void) pbsRequired->ExchangeSet(ul);
+	}
+
+	ULONG ulMatches = 0;
+	{
+		CAutoTimer at("WidePerformance test", true /*fPrint*/);
+
+		for (ULONG ulIter = 0; ulIter < ulIterations; ulIter++)
+		{
+			CBitSet *pbsOutput = GPOS_NEW(mp) CBitSet(mp, 1024);
+			for (ULONG ulChild = 0; ulChild < ulChildren; ulChild++)
+			{
+				pbsOutput->Union(rgpbsChild[ulChild]);
+			}
+
+			if (pbsOutput->ContainsAll(pbsRequired) &&
+				!pbsOutput->IsDisjoint(rgpbsChild[ulIter % ulChildren]))
+			{
+				ulMatches++;
+			}
+
+			CBitSet *pbsUsed = GPOS_NEW(mp) CBitSet(mp, *pbsOutput);
+			pbsUsed->Intersection(pbsRequired);
+			ulMatches += pbsUsed->Equals(pbsRequired) ? 0 : 1;
+			(void) pbsUsed->HashValue();
+
+			pbsUsed->Release();
+			pbsOutput->Release();
+		}
+	}
+
+	GPOS_RTL_ASSERT(ulIterations == ulMatches);
+
+	for (ULONG ulChild = 0; ulChild < ulChildren; ulChild++)
+	{
+		rgpbsChild[ulChild]->Release();
+	}
+	pbsRequired->Release();
+
+	return GPOS_OK;
+}
+
 // EOF
@@ -45,7 +45,8 @@ CMemoryPoolBasicTest::EresUnittest()
 #ifdef GPOS_DEBUG
 		GPOS_UNITTEST_FUNC(CMemoryPoolBasicTest::EresUnittest_Print),
 #endif	// GPOS_DEBUG
-		GPOS_UNITTEST_FUNC(CMemoryPoolBasicTest::EresUnittest_TestTracker)};
+		GPOS_UNITTEST_FUNC(CMemoryPoolBasicTest::EresUnittest_TestTracker),
+		GPOS_UNITTEST_FUNC(CMemoryPoolBasicTest::EresUnittest_TestArena)};
 
 	CAutoTraceFlag atf(EtraceTestMemoryPools, true /*value*/);
 
@@ -97,6 +98,21 @@ CMemoryPoolBasicTest::EresUnittest_TestTracker()
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMemoryPoolBasicTest::EresUnittest_TestArena
+//
+//	@doc:
+//		Run tests for arena pools
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CMemoryPoolBasicTest::EresUnittest_TestArena()
+{
+	return EresArenaNewDelete();
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CMemoryPoolBasicTest::EresTestType
@@ -212,6 +228,57 @@ CMemoryPoolBasicTest::EresNewDelete()
 	return GPOS_OK;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMemoryPoolBasicTest::EresArenaNewDelete
+//
+//	@doc:
+//		Allocate and free from an arena pool; frees are deferred until
+//		the pool is torn down, so its size can only grow
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CMemoryPoolBasicTest::EresArenaNewDelete()
+{
+	CAutoTimer at("ArenaNewDelete test", true /*fPrint*/);
+	CAutoMemoryPool amp(CAutoMemoryPool::ElcExc, true /*is_arena*/);
+	CMemoryPool *mp = amp.Pmp();
+
+	const ULONG num_allocs = 1024;
+	BYTE *rgpb[num_allocs];
+
+	for (ULONG i = 0; i < num_allocs; i++)
+	{
+		// every 64th allocation is too large to be carved from a chunk
+		ULONG size = (0 == i % 64) ? 64 * 1024 : Size(i);
+		rgpb[i] = GPOS_NEW_ARRAY(mp, BYTE, size);
+		clib::Memset(rgpb[i], (BYTE) i, size);
+	}
+
+	// allocations do not overlap
+	for (ULONG i = 0; i < num_allocs; i++)
+	{
+		ULONG size = CMemoryPool::UserSizeOfAlloc(rgpb[i]);
+		GPOS_RTL_ASSERT(size == ((0 == i % 64) ? 64 * 1024 : Size(i)));
+		GPOS_RTL_ASSERT(rgpb[i][0] == (BYTE) i);
+		GPOS_RTL_ASSERT(rgpb[i][size - 1] == (BYTE) i);
+	}
+
+	ULLONG size_before_free = mp->TotalAllocatedSize();
+	GPOS_RTL_ASSERT(0 < size_before_free);
+
+	for (ULONG i = 0; i < num_allocs; i++)
+	{
+		GPOS_DELETE_ARRAY(rgpb[i]);
+	}
+
+	GPOS_RTL_ASSERT(size_before_free == mp->TotalAllocatedSize());
+	GPOS_RTL_ASSERT(size_before_free == mp->PeakAllocatedSize());
+
+	return GPOS_OK;
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CMemoryPoolBasicTest::EresThrowingCtor
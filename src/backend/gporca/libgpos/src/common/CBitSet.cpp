@@ -8,14 +8,17 @@
 //	@doc:
 //		Implementation of bit sets
 //
-//		Underlying assumption: a set contains only a few links of bitvectors
-//		hence, keeping them in a linked list is efficient;
+//		The set is a single array of words starting at a base word, so
+//		that the set operations are tight loops over the overlapping parts
+//		of two arrays which the compiler can vectorize; sets of column
+//		references are dense in practice, since column ids are handed out
+//		sequentially per query, but they need not start anywhere near zero
 //---------------------------------------------------------------------------
 
 #include "gpos/common/CBitSet.h"
 
 #include "gpos/base.h"
-#include "gpos/common/CAutoRef.h"
+#include "gpos/common/CAutoRg.h"
 #include "gpos/common/CBitSetIter.h"
 
 #ifdef GPOS_DEBUG
@@ -24,98 +27,142 @@
 
 using namespace gpos;
 
-FORCE_GENERATE_DBGSTR(CBitSet);
+#define BYTES_PER_UNIT GPOS_SIZEOF(ULLONG)
+#define BITS_PER_UNIT (8 * BYTES_PER_UNIT)
 
-//---------------------------------------------------------------------------
-//	@function:
-//		CBitSetLink
-//
-//	@doc:
-//		ctor
-//
-//---------------------------------------------------------------------------
-CBitSet::CBitSetLink::CBitSetLink(CMemoryPool *mp, ULONG offset,
-								  ULONG vector_size)
-	: m_offset(offset)
-{
-	m_vec = GPOS_NEW(mp) CBitVector(mp, vector_size);
-}
+// number of words needed to hold the given number of bits
+#define UNITS_FOR_BITS(nbits) (((nbits) + BITS_PER_UNIT - 1) / BITS_PER_UNIT)
 
+FORCE_GENERATE_DBGSTR(CBitSet);
 
-//---------------------------------------------------------------------------
-//	@function:
-//		CBitSetLink
-//
-//	@doc:
-//		copy ctor
-//
-//---------------------------------------------------------------------------
-CBitSet::CBitSetLink::CBitSetLink(CMemoryPool *mp, const CBitSetLink &bsl)
-	: m_offset(bsl.m_offset)
+// number of set bits in a word
+static inline ULONG
+CountBits(ULLONG ull)
 {
-	m_vec = GPOS_NEW(mp) CBitVector(mp, *bsl.GetVec());
-}
+#if defined(__GNUC__)
+	return (ULONG) __builtin_popcountll(ull);
+#else
+	ULONG nbits = 0;
+	for (; ull != 0; nbits++)
+	{
+		ull &= (ull - 1);
+	}
 
+	return nbits;
+#endif
+}
 
-//---------------------------------------------------------------------------
-//	@function:
-//		~CBitSetLink
-//
-//	@doc:
-//		ctor
-//
-//---------------------------------------------------------------------------
-CBitSet::CBitSetLink::~CBitSetLink()
+// position of the lowest set bit in a non-zero word
+static inline ULONG
+LowestBit(ULLONG ull)
 {
-	GPOS_DELETE(m_vec);
+	GPOS_ASSERT(0 != ull);
+#if defined(__GNUC__)
+	return (ULONG) __builtin_ctzll(ull);
+#else
+	ULONG bit = 0;
+	while (0 == (ull & (ULLONG) 1))
+	{
+		ull >>= 1;
+		bit++;
+	}
+
+	return bit;
+#endif
 }
 
 
 //---------------------------------------------------------------------------
 //	@function:
-//		CBitSet::FindLinkByOffset
+//		CBitSet::EnsureCapacity
 //
 //	@doc:
-//		Find bit set link for a given offset; if non-existent return previous
-//		link (may be NULL);
-//		By providing a starting link we can implement a number of operations
-//		in one sweep, ie O(N)
+//		Grow the word array to cover the words from first up to, but not
+//		including, end; grows geometrically towards the side being
+//		extended so that setting ascending or descending bits one by one
+//		stays linear. An empty set is simply moved to the new range.
 //
 //---------------------------------------------------------------------------
-CBitSet::CBitSetLink *
-CBitSet::FindLinkByOffset(ULONG offset, CBitSetLink *bsl) const
+void
+CBitSet::EnsureCapacity(ULONG first, ULONG end)
 {
-	CBitSetLink *found = NULL;
-	CBitSetLink *cursor = bsl;
+	GPOS_ASSERT(first < end);
 
-	if (NULL == bsl)
+	ULONG new_first = first;
+	ULONG new_len = end - first;
+	if (0 == m_size)
 	{
-		// if no cursor provided start with first element
-		cursor = m_bsllist.First();
+		// all words are zero, so the array can simply be moved
+		if (new_len <= m_len)
+		{
+			m_offset = first;
+			return;
+		}
+		new_len = std::max(new_len, 2 * m_len);
 	}
 	else
 	{
-		GPOS_ASSERT(bsl->GetOffset() <= offset && "invalid start cursor");
-		found = bsl;
-	}
+		ULONG cur_end = m_offset + m_len;
+		if (first >= m_offset && end <= cur_end)
+		{
+			return;
+		}
 
-	GPOS_ASSERT_IMP(NULL != cursor,
-					GPOS_OK == m_bsllist.Find(cursor) && "cursor not in list");
+		ULONG new_end = std::max(end, cur_end);
+		new_first = std::min(first, m_offset);
+		new_len = std::max(new_end - new_first, 2 * m_len);
 
-	while (1)
-	{
-		// no more links or we've overshot the target
-		if (NULL == cursor || cursor->GetOffset() > offset)
+		// put the slack on the side that is growing
+		if (first < m_offset)
 		{
-			break;
+			new_first = (new_end > new_len) ? new_end - new_len : 0;
 		}
+	}
+
+	ULLONG *new_vec = GPOS_NEW_ARRAY(m_mp, ULLONG, new_len);
+	clib::Memset(new_vec, 0, new_len * BYTES_PER_UNIT);
+	if (0 < m_size)
+	{
+		clib::Memcpy(new_vec + (m_offset - new_first), m_vec,
+					 m_len * BYTES_PER_UNIT);
+	}
+
+	if (m_vec != m_inline_vec)
+	{
+		GPOS_DELETE_ARRAY(m_vec);
+	}
+
+	m_vec = new_vec;
+	m_offset = new_first;
+	m_len = new_len;
+}
 
-		found = cursor;
-		cursor = m_bsllist.Next(cursor);
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CBitSet::Overlap
+//
+//	@doc:
+//		Find the range [first, end) of indexes into this set's array whose
+//		words the other set's array holds too; returns the other set's
+//		array from the word at first on, and an empty range if the arrays
+//		do not overlap
+//
+//---------------------------------------------------------------------------
+const ULLONG *
+CBitSet::Overlap(const CBitSet *bs, ULONG &first, ULONG &end) const
+{
+	ULONG lo = std::max(m_offset, bs->m_offset);
+	ULONG hi = std::min(m_offset + m_len, bs->m_offset + bs->m_len);
+	if (hi <= lo)
+	{
+		first = end = 0;
+		return bs->m_vec;
 	}
 
-	GPOS_ASSERT_IMP(found, found->GetOffset() <= offset);
-	return found;
+	first = lo - m_offset;
+	end = hi - m_offset;
+	return bs->m_vec + (lo - bs->m_offset);
 }
 
 
@@ -124,62 +171,112 @@ CBitSet::FindLinkByOffset(ULONG offset, CBitSetLink *bsl) const
 //		CBitSet::RecomputeSize
 //
 //	@doc:
-//		Compute size of set by adding up sizes of links
+//		Compute size of set by counting bits of all words
 //
 //---------------------------------------------------------------------------
 void
 CBitSet::RecomputeSize()
 {
 	m_size = 0;
-	CBitSetLink *bsl = NULL;
-
-	for (bsl = m_bsllist.First(); bsl != NULL; bsl = m_bsllist.Next(bsl))
+	for (ULONG i = 0; i < m_len; i++)
 	{
-		m_size += bsl->GetVec()->CountSetBits();
+		m_size += CountBits(m_vec[i]);
 	}
 }
 
 
 //---------------------------------------------------------------------------
 //	@function:
-//		CBitSet::Clear
+//		CBitSet::GetNextSetBit
 //
 //	@doc:
-//		release all links
+//		Find the first set bit at or after the given position
 //
 //---------------------------------------------------------------------------
-void
-CBitSet::Clear()
+BOOL
+CBitSet::GetNextSetBit(ULONG start_pos, ULONG &next_pos) const
 {
-	CBitSetLink *bsl = NULL;
-
-	while (NULL != (bsl = m_bsllist.First()))
+	ULONG idx = start_pos / BITS_PER_UNIT;
+	ULLONG ull;
+	if (idx < m_offset)
+	{
+		idx = 0;
+		ull = m_vec[0];
+	}
+	else
 	{
-		CBitSetLink *bsl_to_remove = bsl;
-		bsl = m_bsllist.Next(bsl);
+		idx -= m_offset;
+		if (idx >= m_len)
+		{
+			return false;
+		}
 
-		m_bsllist.Remove(bsl_to_remove);
-		GPOS_DELETE(bsl_to_remove);
+		// mask out bits below the start position in the first word
+		ull = m_vec[idx] & (~(ULLONG) 0 << (start_pos % BITS_PER_UNIT));
 	}
 
-	RecomputeSize();
+	while (0 == ull)
+	{
+		if (++idx == m_len)
+		{
+			return false;
+		}
+		ull = m_vec[idx];
+	}
+
+	next_pos = (m_offset + idx) * BITS_PER_UNIT + LowestBit(ull);
+	return true;
 }
 
 
 //---------------------------------------------------------------------------
 //	@function:
-//		CBitSet::GetOffset
+//		CBitSet::HashBlock
 //
 //	@doc:
-//		Compute offset
+//		Hash the given block of m_vector_size bits as a bit vector of that
+//		size; this is how sets used to be hashed when they were kept as a
+//		list of bit vectors, and keeping the hash values stable keeps the
+//		optimizer's search order, and hence its plans, unchanged
 //
 //---------------------------------------------------------------------------
 ULONG
-CBitSet::ComputeOffset(ULONG ul) const
+CBitSet::HashBlock(ULONG block) const
 {
-	return (ul / m_vector_size) * m_vector_size;
-}
+	const ULONG block_units = UNITS_FOR_BITS(m_vector_size);
+	const ULLONG start_pos = (ULLONG) block * m_vector_size;
+
+	// block lines up with the word array: hash in place
+	const ULLONG start_idx = start_pos / BITS_PER_UNIT;
+	if (0 == m_vector_size % BITS_PER_UNIT && start_idx >= m_offset &&
+		start_idx - m_offset + block_units <= m_len)
+	{
+		return gpos::HashByteArray((BYTE *) &m_vec[start_idx - m_offset],
+								   block_units * BYTES_PER_UNIT);
+	}
+
+	// otherwise copy the block's bits aside first
+	ULLONG inline_units[GPOS_BITSET_INLINE_UNITS];
+	ULLONG *units = inline_units;
+	CAutoRg<ULLONG> a_units;
+	if (block_units > GPOS_BITSET_INLINE_UNITS)
+	{
+		units = GPOS_NEW_ARRAY(m_mp, ULLONG, block_units);
+		a_units = units;
+	}
+	clib::Memset(units, 0, block_units * BYTES_PER_UNIT);
 
+	ULONG pos = (ULONG) start_pos;
+	while (GetNextSetBit(pos, pos) && pos - start_pos < m_vector_size)
+	{
+		ULONG offset = (ULONG) (pos - start_pos);
+		units[offset / BITS_PER_UNIT] |= ((ULLONG) 1)
+										 << (offset % BITS_PER_UNIT);
+		pos++;
+	}
+
+	return gpos::HashByteArray((BYTE *) units, block_units * BYTES_PER_UNIT);
+}
 
 
 //---------------------------------------------------------------------------
@@ -191,9 +288,16 @@ CBitSet::ComputeOffset(ULONG ul) const
 //
 //---------------------------------------------------------------------------
 CBitSet::CBitSet(CMemoryPool *mp, ULONG vector_size)
-	: m_mp(mp), m_vector_size(vector_size), m_size(0)
+	: m_mp(mp),
+	  m_vector_size(vector_size),
+	  m_size(0),
+	  m_offset(0),
+	  m_len(GPOS_BITSET_INLINE_UNITS),
+	  m_vec(m_inline_vec)
 {
-	m_bsllist.Init(GPOS_OFFSET(CBitSetLink, m_link));
+	GPOS_ASSERT(0 < vector_size);
+
+	clib::Memset(m_inline_vec, 0, GPOS_SIZEOF(m_inline_vec));
 }
 
 
@@ -206,9 +310,14 @@ CBitSet::CBitSet(CMemoryPool *mp, ULONG vector_size)
 //
 //---------------------------------------------------------------------------
 CBitSet::CBitSet(CMemoryPool *mp, const CBitSet &bs)
-	: m_mp(mp), m_vector_size(bs.m_vector_size), m_size(0)
+	: m_mp(mp),
+	  m_vector_size(bs.m_vector_size),
+	  m_size(0),
+	  m_offset(0),
+	  m_len(GPOS_BITSET_INLINE_UNITS),
+	  m_vec(m_inline_vec)
 {
-	m_bsllist.Init(GPOS_OFFSET(CBitSetLink, m_link));
+	clib::Memset(m_inline_vec, 0, GPOS_SIZEOF(m_inline_vec));
 	Union(&bs);
 }
 
@@ -223,7 +332,10 @@ CBitSet::CBitSet(CMemoryPool *mp, const CBitSet &bs)
 //---------------------------------------------------------------------------
 CBitSet::~CBitSet()
 {
-	Clear();
+	if (m_vec != m_inline_vec)
+	{
+		GPOS_DELETE_ARRAY(m_vec);
+	}
 }
 
 
@@ -238,15 +350,8 @@ CBitSet::~CBitSet()
 BOOL
 CBitSet::Get(ULONG pos) const
 {
-	ULONG offset = ComputeOffset(pos);
-
-	CBitSetLink *bsl = FindLinkByOffset(offset);
-	if (NULL != bsl && bsl->GetOffset() == offset)
-	{
-		return bsl->GetVec()->Get(pos - offset);
-	}
-
-	return false;
+	return 0 != (Word(pos / BITS_PER_UNIT) &
+				 (((ULLONG) 1) << (pos % BITS_PER_UNIT)));
 }
 
 
@@ -255,37 +360,22 @@ CBitSet::Get(ULONG pos) const
 //		CBitSet::ExchangeSet
 //
 //	@doc:
-//		Set given bit; return previous value; allocate new link if necessary
+//		Set given bit; return previous value; grow array if necessary
 //
 //---------------------------------------------------------------------------
 BOOL
 CBitSet::ExchangeSet(ULONG pos)
 {
-	ULONG offset = ComputeOffset(pos);
+	ULONG idx = pos / BITS_PER_UNIT;
+	ULLONG mask = ((ULLONG) 1) << (pos % BITS_PER_UNIT);
 
-	CBitSetLink *bsl = FindLinkByOffset(offset);
-	if (NULL == bsl || bsl->GetOffset() != offset)
-	{
-		CBitSetLink *pbsl_new =
-			GPOS_NEW(m_mp) CBitSetLink(m_mp, offset, m_vector_size);
-		if (NULL == bsl)
-		{
-			m_bsllist.Prepend(pbsl_new);
-		}
-		else
-		{
-			// insert after found link
-			m_bsllist.Append(pbsl_new, bsl);
-		}
-
-		bsl = pbsl_new;
-	}
+	EnsureCapacity(idx, idx + 1);
 
-	GPOS_ASSERT(bsl->GetOffset() == offset);
-
-	BOOL bit = bsl->GetVec()->ExchangeSet(pos - offset);
+	ULLONG *word = &m_vec[idx - m_offset];
+	BOOL bit = (0 != (*word & mask));
 	if (!bit)
 	{
+		*word |= mask;
 		m_size++;
 	}
 
@@ -304,29 +394,18 @@ CBitSet::ExchangeSet(ULONG pos)
 BOOL
 CBitSet::ExchangeClear(ULONG pos)
 {
-	ULONG offset = ComputeOffset(pos);
+	ULONG idx = pos / BITS_PER_UNIT;
+	ULLONG mask = ((ULLONG) 1) << (pos % BITS_PER_UNIT);
 
-	CBitSetLink *bsl = FindLinkByOffset(offset);
-	if (NULL != bsl && bsl->GetOffset() == offset)
+	if (0 == (Word(idx) & mask))
 	{
-		BOOL bit = bsl->GetVec()->ExchangeClear(pos - offset);
-
-		// remove empty link
-		if (bsl->GetVec()->IsEmpty())
-		{
-			m_bsllist.Remove(bsl);
-			GPOS_DELETE(bsl);
-		}
-
-		if (bit)
-		{
-			m_size--;
-		}
-
-		return bit;
+		return false;
 	}
 
-	return false;
+	m_vec[idx - m_offset] &= ~mask;
+	m_size--;
+
+	return true;
 }
 
 
@@ -335,74 +414,37 @@ CBitSet::ExchangeClear(ULONG pos)
 //		CBitSet::Union
 //
 //	@doc:
-//		Union with given other set;
-//		(1) determine which links need to be allocated before(!) modifying
-//			the set allocate and copy missing links aside
-//		(2) insert the new links into the list
-//		(3) union all links, old and new, on a per-bitvector basis
-//
-//		For clarity step (2) and (3) are separated;
+//		Union with given other set; only the other set's words between
+//		its first and last non-empty ones are looked at
 //
 //---------------------------------------------------------------------------
 void
 CBitSet::Union(const CBitSet *pbsOther)
 {
-	CBitSetLink *bsl = NULL;
-	CBitSetLink *bsl_other = NULL;
-
-	// dynamic array of CBitSetLink
-	typedef CDynamicPtrArray<CBitSetLink, CleanupNULL> CBitSetLinkArray;
-
-	CAutoRef<CBitSetLinkArray> a_drgpbsl;
-	a_drgpbsl = GPOS_NEW(m_mp) CBitSetLinkArray(m_mp);
-
-	// iterate through other's links and copy missing links to array
-	for (bsl_other = pbsOther->m_bsllist.First(); bsl_other != NULL;
-		 bsl_other = pbsOther->m_bsllist.Next(bsl_other))
+	if (0 == pbsOther->Size())
 	{
-		bsl = FindLinkByOffset(bsl_other->GetOffset(), bsl);
-		if (NULL == bsl || bsl->GetOffset() != bsl_other->GetOffset())
-		{
-			// need to copy this link
-			CAutoP<CBitSetLink> a_pbsl;
-			a_pbsl = GPOS_NEW(m_mp) CBitSetLink(m_mp, *bsl_other);
-			a_drgpbsl->Append(a_pbsl.Value());
-
-			a_pbsl.Reset();
-		}
+		return;
 	}
 
-	// insert all new links
-	bsl = NULL;
-	for (ULONG i = 0; i < a_drgpbsl->Size(); i++)
+	const ULLONG *vec_other = pbsOther->m_vec;
+	ULONG first = 0;
+	ULONG end = pbsOther->m_len;
+	while (0 == vec_other[first])
 	{
-		CBitSetLink *pbslInsert = (*a_drgpbsl)[i];
-		bsl = FindLinkByOffset(pbslInsert->GetOffset(), bsl);
-
-		GPOS_ASSERT_IMP(NULL != bsl,
-						bsl->GetOffset() < pbslInsert->GetOffset());
-		if (NULL == bsl)
-		{
-			m_bsllist.Prepend(pbslInsert);
-		}
-		else
-		{
-			m_bsllist.Append(pbslInsert, bsl);
-		}
+		first++;
 	}
-
-	// iterate through all links and union them up
-	bsl_other = NULL;
-	bsl = m_bsllist.First();
-	while (NULL != bsl)
+	while (0 == vec_other[end - 1])
 	{
-		bsl_other = pbsOther->FindLinkByOffset(bsl->GetOffset(), bsl_other);
-		if (NULL != bsl_other && bsl_other->GetOffset() == bsl->GetOffset())
-		{
-			bsl->GetVec()->Or(bsl_other->GetVec());
-		}
+		end--;
+	}
+
+	EnsureCapacity(pbsOther->m_offset + first, pbsOther->m_offset + end);
 
-		bsl = m_bsllist.Next(bsl);
+	ULLONG *vec = m_vec + (pbsOther->m_offset + first - m_offset);
+	vec_other += first;
+	for (ULONG i = 0; i < end - first; i++)
+	{
+		vec[i] |= vec_other[i];
 	}
 
 	RecomputeSize();
@@ -414,7 +456,8 @@ CBitSet::Union(const CBitSet *pbsOther)
 //		CBitSet::Intersection
 //
 //	@doc:
-//		Iterate through all links and intersect them; release unused links
+//		Intersect with given other set; words outside the other set are
+//		cleared
 //
 //---------------------------------------------------------------------------
 void
@@ -425,37 +468,21 @@ CBitSet::Intersection(const CBitSet *pbsOther)
 		return;
 	}
 
-	CBitSetLink *bsl_other = NULL;
-	CBitSetLink *bsl = m_bsllist.First();
+	ULONG first = 0;
+	ULONG end = 0;
+	const ULLONG *vec_other = Overlap(pbsOther, first, end);
 
-	while (NULL != bsl)
+	for (ULONG i = 0; i < first; i++)
 	{
-		CBitSetLink *bsl_to_remove = NULL;
-
-		bsl_other = pbsOther->FindLinkByOffset(bsl->GetOffset(), bsl_other);
-		if (NULL != bsl_other && bsl_other->GetOffset() == bsl->GetOffset())
-		{
-			bsl->GetVec()->And(bsl_other->GetVec());
-			CBitSetLink *bsl_prev = bsl;
-
-			bsl = m_bsllist.Next(bsl);
-			// If vector is empty after "ANDing", remove the vector, otherwise
-			// we can get into a situation where an empty vector exists
-			// and causes wrong results for equals/contains operations later
-			if (bsl_prev->GetVec()->IsEmpty())
-			{
-				m_bsllist.Remove(bsl_prev);
-				GPOS_DELETE(bsl_prev);
-			}
-		}
-		else
-		{
-			bsl_to_remove = bsl;
-			bsl = m_bsllist.Next(bsl);
-
-			m_bsllist.Remove(bsl_to_remove);
-			GPOS_DELETE(bsl_to_remove);
-		}
+		m_vec[i] = 0;
+	}
+	for (ULONG i = first; i < end; i++)
+	{
+		m_vec[i] &= vec_other[i - first];
+	}
+	for (ULONG i = end; i < m_len; i++)
+	{
+		m_vec[i] = 0;
 	}
 
 	RecomputeSize();
@@ -467,23 +494,22 @@ CBitSet::Intersection(const CBitSet *pbsOther)
 //		CBitSet::Difference
 //
 //	@doc:
-//		Substract other set from this by iterating through other set and
-//		explicit removal of elements;
+//		Substract other set from this
 //
 //---------------------------------------------------------------------------
 void
 CBitSet::Difference(const CBitSet *pbs)
 {
-	if (IsDisjoint(pbs))
-	{
-		return;
-	}
+	ULONG first = 0;
+	ULONG end = 0;
+	const ULLONG *vec_other = Overlap(pbs, first, end);
 
-	CBitSetIter bsiter(*pbs);
-	while (bsiter.Advance())
+	for (ULONG i = first; i < end; i++)
 	{
-		(void) ExchangeClear(bsiter.Bit());
+		m_vec[i] &= ~vec_other[i - first];
 	}
+
+	RecomputeSize();
 }
 
 
@@ -504,17 +530,11 @@ CBitSet::ContainsAll(const CBitSet *bs) const
 		return false;
 	}
 
-	CBitSetLink *bsl = NULL;
-	CBitSetLink *bsl_other = NULL;
-
-	// iterate through other's links and check for subsets
-	for (bsl_other = bs->m_bsllist.First(); bsl_other != NULL;
-		 bsl_other = bs->m_bsllist.Next(bsl_other))
+	// every word of the other set must be covered by this one
+	for (ULONG i = 0; i < bs->m_len; i++)
 	{
-		bsl = FindLinkByOffset(bsl_other->GetOffset(), bsl);
-
-		if (NULL == bsl || bsl->GetOffset() != bsl_other->GetOffset() ||
-			!bsl->GetVec()->ContainsAll(bsl_other->GetVec()))
+		ULLONG ull = bs->m_vec[i];
+		if (0 != ull && 0 != (ull & ~Word(bs->m_offset + i)))
 		{
 			return false;
 		}
@@ -547,23 +567,16 @@ CBitSet::Equals(const CBitSet *bs) const
 		return false;
 	}
 
-	CBitSetLink *bsl = m_bsllist.First();
-	CBitSetLink *bsl_other = bs->m_bsllist.First();
-
-	while (NULL != bsl)
+	// with equal sizes, containing all of the other set's bits is enough
+	for (ULONG i = 0; i < bs->m_len; i++)
 	{
-		if (NULL == bsl_other || bsl->GetOffset() != bsl_other->GetOffset() ||
-			!bsl->GetVec()->Equals(bsl_other->GetVec()))
+		if (bs->m_vec[i] != (bs->m_vec[i] & Word(bs->m_offset + i)))
 		{
 			return false;
 		}
-
-		bsl = m_bsllist.Next(bsl);
-		bsl_other = bs->m_bsllist.Next(bsl_other);
 	}
 
-	// same length implies bsl_other must have reached end as well
-	return bsl_other == NULL;
+	return true;
 }
 
 
@@ -579,17 +592,13 @@ CBitSet::Equals(const CBitSet *bs) const
 BOOL
 CBitSet::IsDisjoint(const CBitSet *bs) const
 {
-	CBitSetLink *bsl = NULL;
-	CBitSetLink *bsl_other = NULL;
+	ULONG first = 0;
+	ULONG end = 0;
+	const ULLONG *vec_other = Overlap(bs, first, end);
 
-	// iterate through other's links an check if disjoint
-	for (bsl_other = bs->m_bsllist.First(); bsl_other != NULL;
-		 bsl_other = bs->m_bsllist.Next(bsl_other))
+	for (ULONG i = first; i < end; i++)
 	{
-		bsl = FindLinkByOffset(bsl_other->GetOffset(), bsl);
-
-		if (NULL != bsl && bsl->GetOffset() == bsl_other->GetOffset() &&
-			!bsl->GetVec()->IsDisjoint(bsl_other->GetVec()))
+		if (0 != (m_vec[i] & vec_other[i - first]))
 		{
 			return false;
 		}
@@ -604,7 +613,8 @@ CBitSet::IsDisjoint(const CBitSet *bs) const
 //		CBitSet::HashValue
 //
 //	@doc:
-//		Compute hash value for set
+//		Compute hash value for set by combining the hashes of all
+//		non-empty blocks
 //
 //---------------------------------------------------------------------------
 ULONG
@@ -612,11 +622,19 @@ CBitSet::HashValue() const
 {
 	ULONG ulHash = 0;
 
-	CBitSetLink *bsl = m_bsllist.First();
-	while (NULL != bsl)
+	ULONG pos = 0;
+	while (GetNextSetBit(pos, pos))
 	{
-		ulHash = gpos::CombineHashes(ulHash, bsl->GetVec()->HashValue());
-		bsl = m_bsllist.Next(bsl);
+		ULONG block = pos / m_vector_size;
+		ulHash = gpos::CombineHashes(ulHash, HashBlock(block));
+
+		// continue with the next block
+		ULLONG next_pos = (ULLONG)(block + 1) * m_vector_size;
+		if (next_pos >= (ULLONG)(m_offset + m_len) * BITS_PER_UNIT)
+		{
+			break;
+		}
+		pos = (ULONG) next_pos;
 	}
 
 	return ulHash;
@@ -39,10 +39,10 @@ using namespace gpos;
 //  	the CMemoryPoolManager global instance
 //
 //---------------------------------------------------------------------------
-CAutoMemoryPool::CAutoMemoryPool(ELeakCheck leak_check_type)
+CAutoMemoryPool::CAutoMemoryPool(ELeakCheck leak_check_type, BOOL is_arena)
 	: m_leak_check_type(leak_check_type)
 {
-	m_mp = CMemoryPoolManager::GetMemoryPoolMgr()->CreateMemoryPool();
+	m_mp = CMemoryPoolManager::GetMemoryPoolMgr()->CreateMemoryPool(is_arena);
 }
 
 
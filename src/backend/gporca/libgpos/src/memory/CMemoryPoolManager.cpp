@@ -77,9 +77,9 @@ CMemoryPoolManager::Init()
 
 
 CMemoryPool *
-CMemoryPoolManager::CreateMemoryPool()
+CMemoryPoolManager::CreateMemoryPool(BOOL is_arena)
 {
-	CMemoryPool *mp = NewMemoryPool();
+	CMemoryPool *mp = is_arena ? NewArenaMemoryPool() : NewMemoryPool();
 
 	// accessor scope
 	{
@@ -102,6 +102,15 @@ CMemoryPoolManager::NewMemoryPool()
 }
 
 
+// Allocate a new arena memory pool
+CMemoryPool *
+CMemoryPoolManager::NewArenaMemoryPool()
+{
+	return GPOS_NEW(m_internal_memory_pool)
+		CMemoryPoolTracker(true /*is_arena*/);
+}
+
+
 // Release given memory pool
 void
 CMemoryPoolManager::Destroy(CMemoryPool *mp)
@@ -9,7 +9,8 @@
 //	@doc:
 //		Implementation for memory pool that allocates from Malloc
 //		and adds synchronization, statistics, debugging information
-//		and memory tracing.
+//		and memory tracing; optionally works as an arena that bump-allocates
+//		out of large chunks and releases them in bulk.
 //
 //---------------------------------------------------------------------------
 
@@ -33,9 +34,26 @@ using namespace gpos;
 	(GPOS_MEM_ALLOC_HEADER_SIZE +        \
 	 GPOS_MEM_ALIGNED_SIZE((ulNumBytes) + GPOS_MEM_GUARD_SIZE))
 
+// size of the chunks an arena pool carves allocations from
+#define GPOS_MEM_ARENA_CHUNK_SIZE (256 * 1024)
+
+// allocations larger than this get a dedicated arena chunk, so that
+// the tail of the current chunk is not wasted on them
+#define GPOS_MEM_ARENA_LARGE_ALLOC (GPOS_MEM_ARENA_CHUNK_SIZE / 8)
+
+#define GPOS_MEM_ARENA_CHUNK_HEADER_SIZE \
+	GPOS_MEM_ALIGNED_STRUCT_SIZE(SArenaChunk)
+
 
 // ctor
-CMemoryPoolTracker::CMemoryPoolTracker() : CMemoryPool(), m_alloc_sequence(0)
+CMemoryPoolTracker::CMemoryPoolTracker(BOOL is_arena)
+	: CMemoryPool(),
+	  m_alloc_sequence(0),
+	  m_is_arena(is_arena),
+	  m_arena_chunks(NULL),
+	  m_arena_cursor(NULL),
+	  m_arena_remaining(0),
+	  m_arena_reserved(0)
 {
 	m_allocations_list.Init(GPOS_OFFSET(SAllocHeader, m_link));
 }
@@ -45,6 +63,7 @@ CMemoryPoolTracker::CMemoryPoolTracker() : CMemoryPool(), m_alloc_sequence(0)
 CMemoryPoolTracker::~CMemoryPoolTracker()
 {
 	GPOS_ASSERT(m_allocations_list.IsEmpty());
+	GPOS_ASSERT(NULL == m_arena_chunks);
 }
 
 void
@@ -52,6 +71,14 @@ CMemoryPoolTracker::RecordAllocation(SAllocHeader *header)
 {
 	m_memory_pool_statistics.RecordAllocation(header->m_user_size,
 											  header->m_alloc_size);
+#ifndef GPOS_DEBUG
+	// objects in an arena are released in bulk, only debug builds need to
+	// know about them individually for leak checking
+	if (m_is_arena)
+	{
+		return;
+	}
+#endif	// !GPOS_DEBUG
 	m_allocations_list.Prepend(header);
 }
 
@@ -60,10 +87,85 @@ CMemoryPoolTracker::RecordFree(SAllocHeader *header)
 {
 	m_memory_pool_statistics.RecordFree(header->m_user_size,
 										header->m_alloc_size);
+#ifndef GPOS_DEBUG
+	if (m_is_arena)
+	{
+		return;
+	}
+#endif	// !GPOS_DEBUG
 	m_allocations_list.Remove(header);
 }
 
 
+// Carve an allocation out of the current arena chunk, starting a new chunk
+// when it does not fit; large allocations get a chunk of their own and leave
+// the current one alone
+void *
+CMemoryPoolTracker::ArenaAlloc(ULONG alloc_size)
+{
+	GPOS_ASSERT(m_is_arena);
+	GPOS_ASSERT(alloc_size == GPOS_MEM_ALIGNED_SIZE(alloc_size));
+
+	if (alloc_size <= m_arena_remaining)
+	{
+		void *ptr = m_arena_cursor;
+		m_arena_cursor += alloc_size;
+		m_arena_remaining -= alloc_size;
+
+		return ptr;
+	}
+
+	BOOL is_large = (alloc_size > GPOS_MEM_ARENA_LARGE_ALLOC);
+	ULONG chunk_size = GPOS_MEM_ARENA_CHUNK_HEADER_SIZE +
+					   (is_large ? alloc_size : GPOS_MEM_ARENA_CHUNK_SIZE);
+
+	SArenaChunk *chunk = static_cast<SArenaChunk *>(clib::Malloc(chunk_size));
+
+	GPOS_OOM_CHECK(chunk);
+
+	chunk->m_size = chunk_size;
+	m_arena_reserved += chunk_size;
+
+	BYTE *ptr = reinterpret_cast<BYTE *>(chunk) +
+				GPOS_MEM_ARENA_CHUNK_HEADER_SIZE;
+
+	if (is_large && NULL != m_arena_chunks)
+	{
+		// keep carving from the current chunk, which stays at the head
+		chunk->m_next = m_arena_chunks->m_next;
+		m_arena_chunks->m_next = chunk;
+
+		return ptr;
+	}
+
+	chunk->m_next = m_arena_chunks;
+	m_arena_chunks = chunk;
+
+	m_arena_cursor = ptr + alloc_size;
+	m_arena_remaining =
+		chunk_size - GPOS_MEM_ARENA_CHUNK_HEADER_SIZE - alloc_size;
+
+	return ptr;
+}
+
+
+// release all arena chunks
+void
+CMemoryPoolTracker::ArenaRelease()
+{
+	while (NULL != m_arena_chunks)
+	{
+		SArenaChunk *next = m_arena_chunks->m_next;
+		clib::Free(m_arena_chunks);
+		m_arena_chunks = next;
+	}
+
+	m_arena_cursor = NULL;
+	m_arena_remaining = 0;
+	m_arena_reserved = 0;
+}
+
+
 void *
 CMemoryPoolTracker::NewImpl(const ULONG bytes, const CHAR *file,
 							const ULONG line, CMemoryPool::EAllocationType eat)
@@ -79,7 +181,7 @@ CMemoryPoolTracker::NewImpl(const ULONG bytes, const CHAR *file,
 
 	ULONG alloc_size = GPOS_MEM_BYTES_TOTAL(bytes);
 
-	void *ptr = clib::Malloc(alloc_size);
+	void *ptr = m_is_arena ? ArenaAlloc(alloc_size) : clib::Malloc(alloc_size);
 
 	GPOS_OOM_CHECK(ptr);
 
@@ -125,6 +227,7 @@ CMemoryPoolTracker::DeleteImpl(void *ptr, EAllocationType eat)
 
 	// update stats and allocation list
 	GPOS_ASSERT(NULL != header->m_mp);
+	BOOL is_arena = header->m_mp->m_is_arena;
 	header->m_mp->RecordFree(header);
 
 #ifdef GPOS_DEBUG
@@ -132,7 +235,11 @@ CMemoryPoolTracker::DeleteImpl(void *ptr, EAllocationType eat)
 	clib::Memset(ptr, GPOS_MEM_FREED_PATTERN_CHAR, user_size);
 #endif	// GPOS_DEBUG
 
-	clib::Free(header);
+	// arena memory is given back when the pool is torn down
+	if (!is_arena)
+	{
+		clib::Free(header);
+	}
 }
 
 // get user requested size of allocation
@@ -155,6 +262,11 @@ CMemoryPoolTracker::TearDown()
 		void *user_data = header + 1;
 		DeleteImpl(user_data, EatUnknown);
 	}
+
+	if (m_is_arena)
+	{
+		ArenaRelease();
+	}
 }
 
 
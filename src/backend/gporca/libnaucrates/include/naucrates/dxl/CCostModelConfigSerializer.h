@@ -18,6 +18,9 @@ class CCostModelConfigSerializer
 private:
 	const gpopt::ICostModel *m_cost_model;
 
+	// serialize a single cost param
+	void SerializeParam(CXMLSerializer &xml_serializer, ULONG id) const;
+
 public:
 	CCostModelConfigSerializer(const gpopt::ICostModel *cost_model);
 
@@ -53,6 +53,7 @@ enum EDxlParseHandlerType
 	EdxlphSearchStrategy,
 	EdxlphCostParams,
 	EdxlphCostParam,
+	EdxlphCostModelConfig,
 	EdxlphScalarExpr,
 	EdxlphOther
 };
@@ -70,6 +70,12 @@ public:
 
 	// cost model
 	ICostModel *GetCostModel() const;
+
+	EDxlParseHandlerType
+	GetParseHandlerType() const
+	{
+		return EdxlphCostModelConfig;
+	}
 };
 }  // namespace gpdxl
 
@@ -147,6 +147,9 @@ private:
 	// extract cost params
 	void ExtractCostParams(CParseHandlerBase *parse_handler_base);
 
+	// extract cost params from a cost model config
+	void ExtractCostModelConfig(CParseHandlerBase *parse_handler_base);
+
 	// extract a top level scalar expression
 	void ExtractScalarExpr(CParseHandlerBase *parse_handler_base);
 
@@ -29,40 +29,65 @@ CCostModelConfigSerializer::Serialize(CXMLSerializer &xml_serializer) const
 		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
 		CDXLTokens::GetDXLTokenStr(EdxltokenCostParams));
 
+	// the NLJ factor is always written; any other parameter only when it
+	// was changed from its default, e.g. by a calibrated parameter file
+	SerializeParam(xml_serializer, CCostModelParamsGPDB::EcpNLJFactor);
+
+	ICostModelParams *cost_model_params = m_cost_model->GetCostModelParams();
+	if (NULL != dynamic_cast<CCostModelParamsGPDB *>(cost_model_params))
+	{
+		CAutoRef<CCostModelParamsGPDB> default_params(
+			GPOS_NEW(xml_serializer.Pmp())
+				CCostModelParamsGPDB(xml_serializer.Pmp()));
+
+		// most cost units are tiny, so print them in full
+		xml_serializer.SetFullPrecision(true);
+		for (ULONG ul = 0; ul < CCostModelParamsGPDB::EcpSentinel; ul++)
+		{
+			if (CCostModelParamsGPDB::EcpNLJFactor != ul &&
+				!cost_model_params->PcpLookup(ul)->Equals(
+					default_params->PcpLookup(ul)))
+			{
+				SerializeParam(xml_serializer, ul);
+			}
+		}
+		xml_serializer.SetFullPrecision(false);
+	}
+
+	xml_serializer.CloseElement(
+		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
+		CDXLTokens::GetDXLTokenStr(EdxltokenCostParams));
+
+	xml_serializer.CloseElement(
+		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
+		CDXLTokens::GetDXLTokenStr(EdxltokenCostModelConfig));
+}
+
+void
+CCostModelConfigSerializer::SerializeParam(CXMLSerializer &xml_serializer,
+										   ULONG id) const
+{
+	ICostModelParams::SCostParam *param =
+		m_cost_model->GetCostModelParams()->PcpLookup(id);
+
 	xml_serializer.OpenElement(
 		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
 		CDXLTokens::GetDXLTokenStr(EdxltokenCostParam));
 
 	xml_serializer.AddAttribute(
 		CDXLTokens::GetDXLTokenStr(EdxltokenName),
-		m_cost_model->GetCostModelParams()->SzNameLookup(
-			CCostModelParamsGPDB::EcpNLJFactor));
-	xml_serializer.AddAttribute(
-		CDXLTokens::GetDXLTokenStr(EdxltokenValue),
-		m_cost_model->GetCostModelParams()
-			->PcpLookup(CCostModelParamsGPDB::EcpNLJFactor)
-			->Get());
+		m_cost_model->GetCostModelParams()->SzNameLookup(id));
+	xml_serializer.AddAttribute(CDXLTokens::GetDXLTokenStr(EdxltokenValue),
+								param->Get());
 	xml_serializer.AddAttribute(
 		CDXLTokens::GetDXLTokenStr(EdxltokenCostParamLowerBound),
-		m_cost_model->GetCostModelParams()
-			->PcpLookup(CCostModelParamsGPDB::EcpNLJFactor)
-			->GetLowerBoundVal());
+		param->GetLowerBoundVal());
 	xml_serializer.AddAttribute(
 		CDXLTokens::GetDXLTokenStr(EdxltokenCostParamUpperBound),
-		m_cost_model->GetCostModelParams()
-			->PcpLookup(CCostModelParamsGPDB::EcpNLJFactor)
-			->GetUpperBoundVal());
+		param->GetUpperBoundVal());
 	xml_serializer.CloseElement(
 		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
 		CDXLTokens::GetDXLTokenStr(EdxltokenCostParam));
-
-	xml_serializer.CloseElement(
-		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
-		CDXLTokens::GetDXLTokenStr(EdxltokenCostParams));
-
-	xml_serializer.CloseElement(
-		CDXLTokens::GetDXLTokenStr(EdxltokenNamespacePrefix),
-		CDXLTokens::GetDXLTokenStr(EdxltokenCostModelConfig));
 }
 
 CCostModelConfigSerializer::CCostModelConfigSerializer(
@@ -15,6 +15,7 @@
 
 #include "gpopt/optimizer/COptimizerConfig.h"
 #include "naucrates/dxl/operators/CDXLOperatorFactory.h"
+#include "naucrates/dxl/parser/CParseHandlerCostModel.h"
 #include "naucrates/dxl/parser/CParseHandlerCostParams.h"
 #include "naucrates/dxl/parser/CParseHandlerFactory.h"
 #include "naucrates/dxl/parser/CParseHandlerMDRequest.h"
@@ -343,6 +344,7 @@ CParseHandlerDXL::IsValidStartElement(const XMLCh *const element_name)
 		CDXLTokens::XmlstrToken(EdxltokenStackTrace),
 		CDXLTokens::XmlstrToken(EdxltokenSearchStrategy),
 		CDXLTokens::XmlstrToken(EdxltokenCostParams),
+		CDXLTokens::XmlstrToken(EdxltokenCostModelConfig),
 		CDXLTokens::XmlstrToken(EdxltokenScalarExpr),
 	};
 
@@ -467,6 +469,7 @@ CParseHandlerDXL::FindParseHandler(EDxlParseHandlerType parse_handler_type)
 		{EdxlphMetadataRequest, &CParseHandlerDXL::ExtractMDRequest},
 		{EdxlphSearchStrategy, &CParseHandlerDXL::ExtractSearchStrategy},
 		{EdxlphCostParams, &CParseHandlerDXL::ExtractCostParams},
+		{EdxlphCostModelConfig, &CParseHandlerDXL::ExtractCostModelConfig},
 		{EdxlphScalarExpr, &CParseHandlerDXL::ExtractScalarExpr},
 	};
 
@@ -714,6 +717,31 @@ CParseHandlerDXL::ExtractCostParams(CParseHandlerBase *parse_handler_base)
 	m_cost_model_params = cost_model_params;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CParseHandlerDXL::ExtractCostModelConfig
+//
+//	@doc:
+//		Extract cost params from a cost model config, as written by
+//		CCostModelConfigSerializer
+//
+//---------------------------------------------------------------------------
+void
+CParseHandlerDXL::ExtractCostModelConfig(CParseHandlerBase *parse_handler_base)
+{
+	CParseHandlerCostModel *parse_handler_cost_model =
+		dynamic_cast<CParseHandlerCostModel *>(parse_handler_base);
+	GPOS_ASSERT(NULL != parse_handler_cost_model &&
+				NULL != parse_handler_cost_model->GetCostModel());
+
+	ICostModelParams *cost_model_params =
+		parse_handler_cost_model->GetCostModel()->GetCostModelParams();
+
+	cost_model_params->AddRef();
+	CRefCount::SafeRelease(m_cost_model_params);
+	m_cost_model_params = cost_model_params;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CParseHandlerDXL::ExtractScalarExpr
@@ -39,6 +39,7 @@ public:
 	static GPOS_RESULT EresUnittest_Bool();
 	static GPOS_RESULT EresUnittest_Params();
 	static GPOS_RESULT EresUnittest_Parsing();
+	static GPOS_RESULT EresUnittest_ParsingCostModelConfig();
 	static GPOS_RESULT EresUnittest_ParsingWithException();
 	static GPOS_RESULT EresUnittest_SetParams();
 
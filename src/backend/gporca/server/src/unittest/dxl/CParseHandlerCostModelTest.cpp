@@ -161,11 +161,47 @@ Eres_SerializeCalibratedCostModel()
 	return gpos::GPOS_OK;
 }
 
+static gpos::GPOS_RESULT
+Eres_SerializeChangedCostParams()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	// parameters changed from their defaults follow the NLJ factor
+	const WCHAR *const wszExpectedString =
+		L"<dxl:CostModelConfig CostModelType=\"1\" SegmentsForCosting=\"3\">"
+		"<dxl:CostParams>"
+		"<dxl:CostParam Name=\"NLJFactor\" Value=\"1.000000\" LowerBound=\"0.500000\" UpperBound=\"1.500000\"/>"
+		"<dxl:CostParam Name=\"SortTupWidthCostUnit\" Value=\"0.00000150000000000\" LowerBound=\"0.00000150000000000\" UpperBound=\"0.00000150000000000\"/>"
+		"</dxl:CostParams>"
+		"</dxl:CostModelConfig>";
+	gpos::CAutoP<CWStringDynamic> apwsExpected(
+		GPOS_NEW(mp) CWStringDynamic(mp, wszExpectedString));
+
+	const ULONG ulSegments = 3;
+	CCostModelParamsGPDB *pcp = GPOS_NEW(mp) CCostModelParamsGPDB(mp);
+	pcp->SetParam(CCostModelParamsGPDB::EcpSortTupWidthCostUnit, 1.5e-06,
+				  1.5e-06, 1.5e-06);
+	gpos::CAutoRef<CCostModelGPDB> apcm(
+		GPOS_NEW(mp) CCostModelGPDB(mp, ulSegments, pcp));
+
+	CWStringDynamic wsActual(mp);
+	COstreamString os(&wsActual);
+	CXMLSerializer xml_serializer(mp, os, false);
+	CCostModelConfigSerializer cmcSerializer(apcm.Value());
+	cmcSerializer.Serialize(xml_serializer);
+
+	GPOS_RTL_ASSERT(apwsExpected->Equals(&wsActual));
+
+	return gpos::GPOS_OK;
+}
+
 gpos::GPOS_RESULT
 CParseHandlerCostModelTest::EresUnittest()
 {
 	CUnittest rgut[] = {GPOS_UNITTEST_FUNC(Eres_ParseCalibratedCostModel),
-						GPOS_UNITTEST_FUNC(Eres_SerializeCalibratedCostModel)};
+						GPOS_UNITTEST_FUNC(Eres_SerializeCalibratedCostModel),
+						GPOS_UNITTEST_FUNC(Eres_SerializeChangedCostParams)};
 
 	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
 }
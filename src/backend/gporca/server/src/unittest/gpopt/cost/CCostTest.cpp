@@ -43,6 +43,7 @@ CCostTest::EresUnittest()
 		GPOS_UNITTEST_FUNC(CCostTest::EresUnittest_Arithmetic),
 		GPOS_UNITTEST_FUNC(CCostTest::EresUnittest_Params),
 		GPOS_UNITTEST_FUNC(CCostTest::EresUnittest_Parsing),
+		GPOS_UNITTEST_FUNC(CCostTest::EresUnittest_ParsingCostModelConfig),
 		GPOS_UNITTEST_FUNC(EresUnittest_SetParams),
 
 		// TODO: : re-enable test after resolving exception throwing problem on OSX
@@ -256,6 +257,38 @@ CCostTest::EresUnittest_Parsing()
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CCostTest::EresUnittest_ParsingCostModelConfig
+//
+//	@doc:
+//		Test parsing cost params from a cost model config file, as written
+//		by cost model calibration
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CCostTest::EresUnittest_ParsingCostModelConfig()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+	CParseHandlerDXL *pphDXL = CDXLUtils::GetParseHandlerForDXLFile(
+		mp, "../data/dxl/cost/cost-model-config.xml", NULL);
+	ICostModelParams *pcp = pphDXL->GetCostModelParams();
+	GPOS_RTL_ASSERT(NULL != pcp);
+
+	// parameters not listed in the file keep their defaults
+	CCostModelParamsGPDB *pcpExpected = GPOS_NEW(mp) CCostModelParamsGPDB(mp);
+	pcpExpected->SetParam(CCostModelParamsGPDB::EcpSortTupWidthCostUnit,
+						  1.5e-06, 1.5e-06, 1.5e-06);
+	GPOS_RTL_ASSERT(pcpExpected->Equals(pcp));
+
+	pcpExpected->Release();
+	GPOS_DELETE(pphDXL);
+
+	return GPOS_OK;
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CSearchStrategyTest::EresUnittest_ParsingWithException
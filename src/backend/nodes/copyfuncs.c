@@ -137,6 +137,7 @@ _copyPlannedStmt(const PlannedStmt *from)
 
 	COPY_SCALAR_FIELD(total_memory_master);
 	COPY_SCALAR_FIELD(nsegments_master);
+	COPY_SCALAR_FIELD(optimizer_peak_memory);
 
 	return newnode;
 }
@@ -3866,6 +3867,7 @@ _copyRetrieveStmt(const RetrieveStmt *from)
 	COPY_STRING_FIELD(endpoint_name);
 	COPY_SCALAR_FIELD(count);
 	COPY_SCALAR_FIELD(is_all);
+	COPY_NODE_FIELD(options);
 
 	return newnode;
 }
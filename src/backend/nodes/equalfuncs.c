@@ -1376,6 +1376,7 @@ _equalRetrieveStmt(const RetrieveStmt *a, const RetrieveStmt *b)
 	COMPARE_STRING_FIELD(endpoint_name);
 	COMPARE_SCALAR_FIELD(count);
 	COMPARE_SCALAR_FIELD(is_all);
+	COMPARE_NODE_FIELD(options);
 
 	return true;
 }
@@ -385,6 +385,7 @@ _outPlannedStmt(StringInfo str, PlannedStmt *node)
 
 	WRITE_INT_FIELD(total_memory_master);
 	WRITE_INT_FIELD(nsegments_master);
+	WRITE_UINT64_FIELD(optimizer_peak_memory);
 }
 
 static void
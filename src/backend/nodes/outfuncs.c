@@ -332,6 +332,7 @@ _outPlannedStmt(StringInfo str, const PlannedStmt *node)
 
 	WRITE_INT_FIELD(total_memory_master);
 	WRITE_INT_FIELD(nsegments_master);
+	WRITE_UINT64_FIELD(optimizer_peak_memory);
 }
 #endif /* COMPILING_BINARY_FUNCS */
 
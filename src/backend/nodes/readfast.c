@@ -1387,6 +1387,7 @@ _readPlannedStmt(void)
 
 	READ_INT_FIELD(total_memory_master);
 	READ_INT_FIELD(nsegments_master);
+	READ_UINT64_FIELD(optimizer_peak_memory);
 
 	READ_DONE();
 }
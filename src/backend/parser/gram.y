@@ -495,6 +495,7 @@ static Node *makeIsNotDistinctFromNode(Node *expr, int position);
 %type <node>	copy_generic_opt_arg copy_generic_opt_arg_list_item
 %type <defelt>	copy_generic_opt_elem
 %type <list>	copy_generic_opt_list copy_generic_opt_arg_list
+%type <list>	opt_retrieve_options
 %type <list>	copy_options
 
 %type <typnam>	Typename SimpleTypename ConstTypename
@@ -3955,6 +3956,10 @@ copy_file_name:
 
 copy_options: copy_opt_list							{ $$ = $1; }
 			| '(' copy_generic_opt_list ')'			{ $$ = $2; }
+			| '(' copy_generic_opt_list ')' ON SEGMENT
+				{
+					$$ = lappend($2, makeDefElem("on_segment", (Node *)makeInteger(TRUE)));
+				}
 		;
 
 /* old COPY option syntax */
@@ -11976,23 +11981,30 @@ SelectStmt: select_no_parens			%prec UMINUS
 		;
 
 RetrieveStmt:
-			RETRIEVE SignedIconst FROM ENDPOINT name
+			RETRIEVE SignedIconst FROM ENDPOINT name opt_retrieve_options
 				{
 					RetrieveStmt *n = makeNode(RetrieveStmt);
 					n->endpoint_name = $5;
 					n->count = $2;
+					n->options = $6;
 					$$ = (Node *)n;
 				}
-			| RETRIEVE ALL FROM ENDPOINT name
+			| RETRIEVE ALL FROM ENDPOINT name opt_retrieve_options
 				{
 					RetrieveStmt *n = makeNode(RetrieveStmt);
 					n->endpoint_name = $5;
 					n->count = -1;
 					n->is_all = true;
+					n->options = $6;
 					$$ = (Node *)n;
 				}
 		;
 
+opt_retrieve_options:
+			WITH '(' copy_generic_opt_list ')'		{ $$ = $3; }
+			| /*EMPTY*/								{ $$ = NIL; }
+		;
+
 select_with_parens:
 			'(' select_no_parens ')'				{ $$ = $2; }
 			| '(' select_with_parens ')'			{ $$ = $2; }
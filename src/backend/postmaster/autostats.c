@@ -252,6 +252,34 @@ autostats_get_cmdtype(QueryDesc *queryDesc, AutoStatsCmdType * pcmdType, Oid *pr
 	*prelationOid = relationOid;
 }
 
+/*
+ * Could auto_stats() issue an ANALYZE after the command, however many tuples
+ * it ends up modifying?
+ */
+bool
+auto_stats_may_analyze(AutoStatsCmdType cmdType, Oid relationOid, bool inFunction)
+{
+	GpAutoStatsModeValue actual_gp_autostats_mode;
+
+	if (cmdType == AUTOSTATS_CMDTYPE_SENTINEL)
+		return false;
+
+	if (inFunction)
+		actual_gp_autostats_mode = gp_autostats_mode_in_functions;
+	else
+		actual_gp_autostats_mode = gp_autostats_mode;
+
+	switch (actual_gp_autostats_mode)
+	{
+		case GP_AUTOSTATS_ON_CHANGE:
+			return autostats_on_change_check(cmdType, PG_UINT64_MAX);
+		case GP_AUTOSTATS_ON_NO_STATS:
+			return autostats_on_no_stats_check(cmdType, relationOid);
+		default:
+			return false;
+	}
+}
+
 /*
  * This method takes a decision to run analyze based on the query and the number of modified tuples based
  * on the policy set via gp_autostats_mode. The following modes are currently supported:
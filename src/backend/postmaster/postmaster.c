@@ -146,6 +146,7 @@
 #include "cdb/cdbvars.h"
 #include "cdb/cdbendpoint.h"
 #include "cdb/ic_proxy_bgworker.h"
+#include "cdb/ml_ipc.h"
 
 /*
  * This is set in backends that are handling a GPDB specific message (FTS or
@@ -210,6 +211,24 @@ static dlist_head BackendList = DLIST_STATIC_INIT(BackendList);
 static Backend *ShmemBackendArray;
 #endif
 
+#ifndef EXEC_BACKEND
+/*
+ * The pool of pre-forked backends on a segment, see MaintainBackendPool().
+ *
+ * A pooled backend is a regular entry in BackendList, that waits for the
+ * postmaster to pass it an accepted connection through a socket pair.  "sock"
+ * is the postmaster's end of it.
+ */
+typedef struct PooledBackend
+{
+	pid_t		pid;
+	pgsocket	sock;
+} PooledBackend;
+
+static PooledBackend BackendPool[MAX_QE_BACKEND_POOL_SIZE];
+static int	nBackendPool = 0;
+#endif   /* EXEC_BACKEND */
+
 BackgroundWorker *MyBgworkerEntry = NULL;
 
 /* The socket number we are listening for connections on */
@@ -495,6 +514,13 @@ static void BackendRun(Port *port) __attribute__((noreturn));
 static void ExitPostmaster(int status) __attribute__((noreturn));
 static int	ServerLoop(void);
 static int	BackendStartup(Port *port);
+#ifndef EXEC_BACKEND
+static void MaintainBackendPool(void);
+static bool StartPooledBackend(void);
+static void PooledBackendMain(pgsocket sock) __attribute__((noreturn));
+static bool BackendPoolStartup(Port *port);
+static void BackendPoolForget(int pid);
+#endif   /* EXEC_BACKEND */
 static int	ProcessStartupPacket(Port *port, bool SSLdone);
 static void SendNegotiateProtocolVersion(List *unrecognized_protocol_options);
 static void processCancelRequest(Port *port, void *pkt, MsgType code);
@@ -1413,6 +1439,12 @@ PostmasterMain(int argc, char *argv[])
 	 */
 	RemovePgTempFiles();
 
+	/*
+	 * Likewise remove the interconnect's shared-memory rings of backends that
+	 * exited without removing them, e.g. in a crash.
+	 */
+	RemoveStaleInterconnectShmRings();
+
 	/*
 	 * Forcibly remove the files signaling a standby promotion
 	 * request. Otherwise, the existence of those files triggers
@@ -1957,7 +1989,10 @@ ServerLoop(void)
 					port = ConnCreate(ListenSocket[i]);
 					if (port)
 					{
-						BackendStartup(port);
+#ifndef EXEC_BACKEND
+						if (!BackendPoolStartup(port))
+#endif
+							BackendStartup(port);
 
 						/*
 						 * We no longer need the open socket or port structure
@@ -2076,6 +2111,11 @@ ServerLoop(void)
 		if (WalReceiverRequested)
 			MaybeStartWalReceiver();
 
+#ifndef EXEC_BACKEND
+		/* Top up the pool of pre-forked backends, or drain it */
+		MaintainBackendPool();
+#endif
+
 		/* Get other worker processes running, if needed */
 		if (StartWorkerNeeded || HaveCrashedWorker)
 			maybe_start_bgworker();
@@ -2971,6 +3011,13 @@ ClosePostmasterPorts(bool am_syslogger)
 	postmaster_alive_fds[POSTMASTER_FD_OWN] = -1;
 #endif
 
+#ifndef EXEC_BACKEND
+	/* Close our ends of the pooled backends' socket pairs */
+	for (i = 0; i < nBackendPool; i++)
+		closesocket(BackendPool[i].sock);
+	nBackendPool = 0;
+#endif
+
 	/* Close the listen sockets */
 	for (i = 0; i < MAXLISTEN; i++)
 	{
@@ -3068,6 +3115,16 @@ SIGHUP_handler(SIGNAL_ARGS)
 #ifdef EXEC_BACKEND
 		/* Update the starting-point file for future children */
 		write_nondefault_variables(PGC_SIGHUP);
+#else
+		/*
+		 * The pooled backends were forked with the old authentication config,
+		 * replace them.
+		 */
+		while (nBackendPool > 0)
+		{
+			nBackendPool--;
+			closesocket(BackendPool[nBackendPool].sock);
+		}
 #endif
 	}
 
@@ -3698,6 +3755,11 @@ CleanupBackend(int pid,
 
 	LogChildExit(DEBUG2, _("server process"), pid, exitstatus);
 
+#ifndef EXEC_BACKEND
+	/* It may have died while waiting in the pool */
+	BackendPoolForget(pid);
+#endif
+
 	/*
 	 * If a backend dies in an ugly way then we must signal all other backends
 	 * to quickdie.  If exit status is zero (normal) or one (FATAL exit), we
@@ -4642,6 +4704,331 @@ report_fork_failure_to_client(Port *port, int errnum)
 	} while (rc < 0 && errno == EINTR);
 }
 
+#ifndef EXEC_BACKEND
+/*
+ * MaintainBackendPool -- keep the pool of pre-forked backends at its size
+ *
+ * A QD session that needs a gang connects to every segment at once, and each
+ * of these connections waits for the segment postmaster to fork and set up
+ * a backend for it.  With gp_qe_backend_pool_size > 0 a segment postmaster
+ * forks the backends ahead of time, and hands each new connection to one of
+ * them; see BackendPoolStartup().  The pooled backends have done everything
+ * up to reading the startup packet, everything past it depends on the
+ * database, role and options of the connection and happens as usual.
+ *
+ * The pool is drained whenever new connections can't be accepted, so that a
+ * smart shutdown does not wait for the pooled backends.
+ */
+static void
+MaintainBackendPool(void)
+{
+	int			size = 0;
+
+	if (!IS_QUERY_DISPATCHER() && pmState == PM_RUN && !FatalError)
+		size = Min(gp_qe_backend_pool_size, MAX_QE_BACKEND_POOL_SIZE);
+
+	/*
+	 * Closing our end of the socket pair is enough to make a pooled backend
+	 * exit, see PooledBackendMain().
+	 */
+	while (nBackendPool > size)
+	{
+		nBackendPool--;
+		closesocket(BackendPool[nBackendPool].sock);
+	}
+
+	while (nBackendPool < size && canAcceptConnections() == CAC_OK)
+	{
+		if (!StartPooledBackend())
+			break;
+	}
+}
+
+/*
+ * StartPooledBackend -- fork a backend into the pool
+ *
+ * Like BackendStartup(), but the child has no connection yet.
+ */
+static bool
+StartPooledBackend(void)
+{
+	Backend    *bn;
+	pgsocket	socks[2];
+	pid_t		pid;
+
+	/*
+	 * A connection-oriented socket pair, so that the pooled backend sees
+	 * end-of-file when we close our end; a datagram socket would leave it
+	 * waiting forever.  SOCK_SEQPACKET also keeps the Port in one message.
+	 */
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, socks) < 0)
+	{
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not create socket pair for pooled backend: %m")));
+		return false;
+	}
+
+	bn = (Backend *) malloc(sizeof(Backend));
+	if (!bn)
+	{
+		ereport(LOG,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory")));
+		closesocket(socks[0]);
+		closesocket(socks[1]);
+		return false;
+	}
+
+	if (!RandomCancelKey(&MyCancelKey))
+	{
+		ereport(LOG,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("could not acquire random number")));
+		free(bn);
+		closesocket(socks[0]);
+		closesocket(socks[1]);
+		return false;
+	}
+
+	bn->cancel_key = MyCancelKey;
+	bn->dead_end = false;
+	bn->child_slot = MyPMChildSlot = AssignPostmasterChildSlot();
+	bn->bgworker_notify = false;
+
+	pid = fork_process();
+	if (pid == 0)				/* child */
+	{
+		free(bn);
+		closesocket(socks[0]);
+
+		IsUnderPostmaster = true;		/* we are a postmaster subprocess now */
+
+		MyProcPid = getpid();	/* reset MyProcPid */
+
+		MyStartTime = time(NULL);
+
+		/* We don't want the postmaster's proc_exit() handlers */
+		on_exit_reset();
+
+		/* Close the postmaster's sockets */
+		ClosePostmasterPorts(false);
+
+		/* Wait for a connection, and run the backend for it */
+		PooledBackendMain(socks[1]);
+	}
+
+	closesocket(socks[1]);
+
+	if (pid < 0)
+	{
+		/* in parent, fork failed */
+		(void) ReleasePostmasterChildSlot(bn->child_slot);
+		free(bn);
+		closesocket(socks[0]);
+		ereport(LOG,
+				(errmsg("could not fork pooled backend: %m")));
+		return false;
+	}
+
+	/* in parent, successful fork */
+	ereport(DEBUG2,
+			(errmsg_internal("forked pooled backend, pid=%d", (int) pid)));
+
+	bn->pid = pid;
+	bn->bkend_type = BACKEND_TYPE_NORMAL;
+	dlist_push_head(&BackendList, &bn->elem);
+
+	BackendPool[nBackendPool].pid = pid;
+	BackendPool[nBackendPool].sock = socks[0];
+	nBackendPool++;
+
+	return true;
+}
+
+/*
+ * PooledBackendMain -- main of a pooled backend
+ *
+ * Wait for the postmaster to pass us a connection, then carry on like a
+ * backend that BackendStartup() forked for it.  Exit if the postmaster closes
+ * its end of the socket pair instead.
+ */
+static void
+PooledBackendMain(pgsocket sock)
+{
+	Port	   *port;
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	union
+	{
+		struct cmsghdr cmsg;
+		char		buf[CMSG_SPACE(sizeof(pgsocket))];
+	}			cmsgbuf;
+	ssize_t		rc;
+
+	/* Same as while collecting the startup packet, see BackendInitialize() */
+	pqsignal(SIGTERM, startup_die);
+	pqsignal(SIGQUIT, startup_die);
+	PG_SETMASK(&StartupBlockSig);
+
+	init_ps_display("pooled backend", "", "", "");
+
+	if (!(port = (Port *) calloc(1, sizeof(Port))))
+	{
+		ereport(LOG,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory")));
+		proc_exit(1);
+	}
+
+	iov.iov_base = port;
+	iov.iov_len = sizeof(Port);
+
+	MemSet(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cmsgbuf.buf;
+	msg.msg_controllen = sizeof(cmsgbuf.buf);
+
+	do
+	{
+		rc = recvmsg(sock, &msg, 0);
+	} while (rc < 0 && errno == EINTR);
+
+	/* the postmaster has dropped us from the pool, or is gone */
+	if (rc != sizeof(Port))
+		proc_exit(0);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg == NULL ||
+		cmsg->cmsg_level != SOL_SOCKET ||
+		cmsg->cmsg_type != SCM_RIGHTS)
+		proc_exit(0);
+
+	closesocket(sock);
+	PG_SETMASK(&BlockSig);
+
+	/*
+	 * The Port is the one ConnCreate() made in the postmaster, but the socket
+	 * and the private state are our own.
+	 */
+	memcpy(&port->sock, CMSG_DATA(cmsg), sizeof(pgsocket));
+	port->gss = NULL;
+#if defined(ENABLE_GSS) || defined(ENABLE_SSPI)
+	port->gss = (pg_gssinfo *) calloc(1, sizeof(pg_gssinfo));
+	if (!port->gss)
+	{
+		ereport(LOG,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory")));
+		proc_exit(1);
+	}
+#endif
+
+	/* Perform additional initialization and collect startup packet */
+	BackendInitialize(port);
+
+	SIMPLE_FAULT_INJECTOR("qe_backend_pool_connection");
+
+	/* And run the backend */
+	BackendRun(port);
+}
+
+/*
+ * BackendPoolStartup -- hand a new connection to a pooled backend
+ *
+ * returns: true if a pooled backend took the connection, false if the caller
+ * must start a backend for it with BackendStartup().
+ *
+ * Only connections that BackendStartup() would let in without conditions go
+ * to the pool, everything else is left to it.
+ */
+static bool
+BackendPoolStartup(Port *port)
+{
+	if (nBackendPool == 0 || canAcceptConnections() != CAC_OK)
+		return false;
+
+	port->canAcceptConnections = CAC_OK;
+
+	while (nBackendPool > 0)
+	{
+		PooledBackend *pb = &BackendPool[--nBackendPool];
+		struct msghdr msg;
+		struct iovec iov;
+		struct cmsghdr *cmsg;
+		union
+		{
+			struct cmsghdr cmsg;
+			char		buf[CMSG_SPACE(sizeof(pgsocket))];
+		}			cmsgbuf;
+		ssize_t		rc;
+
+		iov.iov_base = port;
+		iov.iov_len = sizeof(Port);
+
+		MemSet(&msg, 0, sizeof(msg));
+		MemSet(&cmsgbuf, 0, sizeof(cmsgbuf));
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = cmsgbuf.buf;
+		msg.msg_controllen = sizeof(cmsgbuf.buf);
+
+		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(pgsocket));
+		memcpy(CMSG_DATA(cmsg), &port->sock, sizeof(pgsocket));
+
+		/*
+		 * The pooled backend has never been sent anything, so this does not
+		 * block.  It fails if the pooled backend is gone.
+		 */
+		do
+		{
+			rc = sendmsg(pb->sock, &msg, MSG_DONTWAIT);
+		} while (rc < 0 && errno == EINTR);
+
+		closesocket(pb->sock);
+
+		if (rc == sizeof(Port))
+		{
+			ereport(DEBUG2,
+					(errmsg_internal("passed connection to pooled backend, pid=%d socket=%d",
+									 (int) pb->pid, (int) port->sock)));
+			return true;
+		}
+
+		ereport(LOG,
+				(errcode_for_socket_access(),
+				 errmsg("could not pass connection to pooled backend %d: %m",
+						(int) pb->pid)));
+	}
+
+	return false;
+}
+
+/*
+ * BackendPoolForget -- drop an exited backend from the pool, if it is there
+ */
+static void
+BackendPoolForget(int pid)
+{
+	int			i;
+
+	for (i = 0; i < nBackendPool; i++)
+	{
+		if (BackendPool[i].pid == pid)
+		{
+			closesocket(BackendPool[i].sock);
+			BackendPool[i] = BackendPool[--nBackendPool];
+			break;
+		}
+	}
+}
+#endif   /* EXEC_BACKEND */
+
 
 /*
  * BackendInitialize -- initialize an interactive (postmaster-child)
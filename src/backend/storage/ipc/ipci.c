@@ -57,6 +57,7 @@
 #include "libpq-fe.h"
 #include "libpq-int.h"
 #include "cdb/cdbfts.h"
+#include "cdb/cdbdtxgroupcommit.h"
 #include "cdb/cdbtm.h"
 #include "utils/tqual.h"
 #include "postmaster/backoff.h"
@@ -68,6 +69,7 @@
 #include "cdb/cdbendpoint.h"
 #include "replication/gp_replication.h"
 #include "cdb/ic_proxy_bgworker.h"
+#include "cdb/ic_conn_stats.h"
 
 shmem_startup_hook_type shmem_startup_hook = NULL;
 
@@ -190,6 +192,9 @@ CreateSharedMemoryAndSemaphores(int port)
 		size = add_size(size, ICProxyShmemSize());
 #endif
 
+		size = add_size(size, ICConnStatsShmemSize());
+		size = add_size(size, DtxGroupCommitShmemSize());
+
 		/* This elog happens before we know the name of the log file we are supposed to use */
 		elog(DEBUG1, "Size not including the buffer pool %lu",
 			 (unsigned long) size);
@@ -346,6 +351,9 @@ CreateSharedMemoryAndSemaphores(int port)
 	ICProxyShmemInit();
 #endif
 
+	ICConnStatsShmemInit();
+	DtxGroupCommitShmemInit();
+
 	/*
 	 * Set up other modules that need some shared memory space
 	 */
@@ -1049,6 +1049,9 @@ pg_plan_queries(List *querytrees, int cursorOptions, ParamListInfo boundParams)
  * serializedPlantree[len] -- PlannedStmt node, or (NULL,0) if query provided.
  * serializedParams[len] -- optional parameters
  * serializedQueryDispatchDesc[len] -- QueryDispatchDesc node, or (NULL,0) if query provided.
+ * planId, planSlot -- plan cache id and slot of the PlannedStmt, or 0.  If
+ *		the PlannedStmt is provided, it is kept in the slot, otherwise the
+ *		one kept there is used.
  *
  * Caller may supply either a Query (representing utility command) or
  * a PlannedStmt (representing a planned DML command), but not both.
@@ -1057,6 +1060,7 @@ static void
 exec_mpp_query(const char *query_string,
 			   const char * serializedQuerytree, int serializedQuerytreelen,
 			   const char * serializedPlantree, int serializedPlantreelen,
+			   uint32 planId, int planSlot,
 			   const char * serializedParams, int serializedParamslen,
 			   const char * serializedQueryDispatchDesc, int serializedQueryDispatchDesclen)
 {
@@ -1139,7 +1143,16 @@ exec_mpp_query(const char *query_string,
 		plan = (PlannedStmt *) deserializeNode(serializedPlantree,serializedPlantreelen);
 		if (!plan || !IsA(plan, PlannedStmt))
 			elog(ERROR, "MPPEXEC: receive invalid planned statement");
+
+		if (planId != 0)
+			storeReceivedPlan(planId, planSlot, (Node *) plan);
     }
+	else if (planId != 0)
+	{
+		plan = (PlannedStmt *) lookupReceivedPlan(planId, planSlot);
+
+		SIMPLE_FAULT_INJECTOR("exec_mpp_query_cached_plan");
+	}
 
 	/*
      * Deserialize the extra execution information (a QueryDispatchDesc node), if there is one.
@@ -1417,6 +1430,22 @@ exec_mpp_query(const char *query_string,
 							Debug_dtm_action, commandTag)));
 		}
 
+		/*
+		 * This was the last statement of the distributed transaction, and
+		 * the QD asked us to prepare right away instead of waiting for its
+		 * PREPARE.  The command-complete below then answers for both.
+		 */
+		if (isMppTxOptions_PrepareWithStatement(QEDtxContextInfo.distributedTxnOptions) &&
+			DistributedTransactionContext == DTX_CONTEXT_QE_TWO_PHASE_IMPLICIT_WRITER)
+		{
+			char		gid[TMGIDSIZE];
+
+			dtxFormGID(gid, QEDtxContextInfo.distributedTimeStamp,
+					   QEDtxContextInfo.distributedXid);
+			performDtxProtocolCommand(DTX_PROTOCOL_COMMAND_PREPARE, gid,
+									  &QEDtxContextInfo);
+		}
+
 		/*
 		 * Tell client that we're done with this query.  Note we emit exactly
 		 * one EndCommand report for each raw parsetree, thus one for each SQL
@@ -1517,6 +1546,11 @@ exec_mpp_dtx_protocol_command(DtxProtocolCommand dtxProtocolCommand,
 
 	performDtxProtocolCommand(dtxProtocolCommand, gid, contextInfo);
 
+	/* tell the QD that we have committed rather than prepared */
+	if (dtxProtocolCommand == DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY &&
+		DistributedTransactionContext != DTX_CONTEXT_QE_PREPARED)
+		commandTag = DTX_READONLY_COMMIT_TAG;
+
 	elogif(Debug_print_full_dtm, LOG, "exec_mpp_dtx_protocol_command calling EndCommand for dtxProtocolCommand = %d (%s) gid = %s",
 		   dtxProtocolCommand, loggingStr, gid);
 
@@ -1863,6 +1897,18 @@ exec_simple_query(const char *query_string)
 		 */
 		MemoryContextSwitchTo(oldcontext);
 
+		/*
+		 * GPDB: the last statement of a query string that runs in an implicit
+		 * transaction may have the QEs prepare the transaction right after
+		 * running it, see isDtxFinalStatement().
+		 */
+		if (Gp_role == GP_ROLE_DISPATCH &&
+			lnext(parsetree_item) == NULL &&
+			list_length(plantree_list) == 1 &&
+			IsA(linitial(plantree_list), PlannedStmt) &&
+			!IsTransactionBlock())
+			setDtxFinalStatement((PlannedStmt *) linitial(plantree_list));
+
 		/*
 		 * Run the portal to completion, and then drop it (and the receiver).
 		 */
@@ -1873,6 +1919,8 @@ exec_simple_query(const char *query_string)
 						 receiver,
 						 completionTag);
 
+		setDtxFinalStatement(NULL);
+
 		(*receiver->rDestroy) (receiver);
 
 		PortalDrop(portal, false);
@@ -5087,6 +5135,7 @@ PostgresMain(int argc, char *argv[],
 		/*
 		 * Abort the current transaction in order to recover.
 		 */
+		setDtxFinalStatement(NULL);
 		AbortCurrentTransaction();
 
 		if (am_walsender)
@@ -5402,6 +5451,8 @@ PostgresMain(int argc, char *argv[],
 					const char *serializedParams = NULL;
 					const char *serializedQueryDispatchDesc = NULL;
 					const char *resgroupInfoBuf = NULL;
+					uint32 planId;
+					int planSlot;
 
 					int query_string_len = 0;
 					int serializedDtxContextInfolen = 0;
@@ -5487,6 +5538,10 @@ PostgresMain(int argc, char *argv[],
 						SetTempNamespaceStateAfterBoot(tempNamespaceId, tempToastNamespaceId);
 					}
 
+					/* plan cache id and slot, if the plan is cached */
+					planId = pq_getmsgint(&input_message, 4);
+					planSlot = (int) pq_getmsgint(&input_message, 4);
+
 					pq_getmsgend(&input_message);
 
 					elogif(Debug_print_full_dtm, LOG, "MPP dispatched stmt from QD: %s.",query_string);
@@ -5514,7 +5569,7 @@ PostgresMain(int argc, char *argv[],
 					if (isMppTxOptions_SynchronizationSet(TempDtxContextInfo.distributedTxnOptions))
 						elogif(Debug_print_full_dtm, LOG, "Received a synchronization SET from QD");
 
-					if (serializedQuerytreelen==0 && serializedPlantreelen==0)
+					if (serializedQuerytreelen==0 && serializedPlantreelen==0 && planId==0)
 					{
 						if (strncmp(query_string, "BEGIN", 5) == 0)
 						{
@@ -5545,6 +5600,7 @@ PostgresMain(int argc, char *argv[],
 						exec_mpp_query(query_string,
 									   serializedQuerytree, serializedQuerytreelen,
 									   serializedPlantree, serializedPlantreelen,
+									   planId, planSlot,
 									   serializedParams, serializedParamslen,
 									   serializedQueryDispatchDesc, serializedQueryDispatchDesclen);
 
@@ -11,6 +11,7 @@
 #include <ws2tcpip.h>
 #endif
 #include <postgres.h>
+#include <access/extcolumnar.h>
 #include <commands/copy.h>
 #include <fstream/fstream.h>
 #include <assert.h>
@@ -19,6 +20,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#ifndef WIN32
+#include <unistd.h>
+#endif
 
 #ifdef GPFXDIST
 #include <gpfxdist.h>
@@ -43,6 +47,7 @@ struct fstream_t
 	int64_t 		compressed_size;
 	int64_t 		compressed_position;
 	int 			skip_header_line;
+	int64_t			range_position;	 /* end of the ranges of ffd[fidx] handed out by fstream_read_range() */
 	char* 			buffer;			 /* buffer to store data read from file */
 	int 			buffer_cur_size; /* number of bytes in buffer currently */
 	const char*		ferror; 		 /* error string */
@@ -609,6 +614,9 @@ fstream_open(const char *path, const struct fstream_options *options,
 		fs->compressed_size += gfile_get_compressed_size(&fs->fd);
 	}
 
+	if (!options->forwrite)
+		gfile_prefetch(&fs->fd, options->read_threads);
+
 	fs->line_number = 1;
 	fs->skip_header_line = options->header;
 
@@ -648,6 +656,7 @@ static int nextFile(fstream_t*fs)
 	fs->compressed_position += gfile_get_compressed_size(&fs->fd);
 	gfile_close(&fs->fd);
 	fs->foff = 0;
+	fs->range_position = 0;
 	fs->line_number = 1;
 	fs->fidx++;
 
@@ -663,6 +672,7 @@ static int nextFile(fstream_t*fs)
 			fs->ferror = "unable to open file";
 			return 1;
 		}
+		gfile_prefetch(&fs->fd, fs->options.read_threads);
 	}
 
 	return 0;
@@ -872,7 +882,14 @@ int fstream_read(fstream_t *fs,
 			 * chunk of whole rows and copy it into our dest buffer to be sent
 			 * out later.
 			 */
-			if (fs->options.is_csv)
+			if (fs->options.is_columnar)
+			{
+				/* COLUMNAR: hop from block header to block header */
+				p = extcolumnar_last_block_end((char*)dest, (char*)dest + size);
+				p = (char*)dest < p ? p : 0;
+				fs->line_number = 0;
+			}
+			else if (fs->options.is_csv)
 			{
 				/* CSV: go slow, scan byte-by-byte for record boundary */
 				p = scan_csv_records(dest, (char*)dest + size, 0, fs);
@@ -903,6 +920,22 @@ int fstream_read(fstream_t *fs,
 			 */
 			if (!p || (char*)dest + size >= p + buffer_capacity)
 			{
+				ExtColumnarBlockHeader hdr;
+				char   *block = p ? p : (char*)dest;
+
+				/* a columnar block gets a hint, its size is up to the writer */
+				if (fs->options.is_columnar &&
+					(char*)dest + size - block >= EXTCOLUMNAR_HEADER_SIZE &&
+					extcolumnar_read_header(block, &hdr))
+				{
+					snprintf(err_buf, sizeof(err_buf)-1, "columnar block of %lld bytes is larger than the gpfdist buffer of %d bytes (-m) "
+							 "in file %s near (%lld bytes)",
+							 (long long) EXTCOLUMNAR_HEADER_SIZE + hdr.datalen, buffer_capacity,
+							 fs->glob.gl_pathv[fs->fidx], (long long) fs->foff + (block - (char*)dest));
+					fs->ferror = err_buf;
+					gfile_printf_then_putc_newline("%s", err_buf);
+					return -1;
+				}
 #ifdef WIN32
 				snprintf(err_buf, sizeof(err_buf)-1, "line too long in file %s near (%ld bytes)",
 						 fs->glob.gl_pathv[fs->fidx], (long) fs->foff);
@@ -971,6 +1004,125 @@ int fstream_read(fstream_t *fs,
 	}
 }
 
+/*
+ * fstream_read_range
+ *
+ * Like fstream_read() with read_whole_lines for TEXT data, except that the
+ * rows are not copied out: return the descriptor of the current file in
+ * *filefd and the offset of the next chunk of at most 'size' bytes of whole
+ * rows in *offset, for the caller to send with sendfile().  Only the last
+ * buffer of the chunk is read, to find the end of its last row.
+ *
+ * Return the length of the chunk, 0 at the end of the data and -1 on error.
+ * If the current file is not a plain file, or its header line has not been
+ * skipped yet, return FSTREAM_RANGE_UNAVAILABLE without doing anything; the
+ * caller should get its next chunk with fstream_read() instead.  Once a
+ * chunk of a file has been handed out this way, the rest of that file must
+ * be read with fstream_read_range() as well.
+ */
+int fstream_read_range(fstream_t *fs,
+					   int size,
+					   struct fstream_filename_and_offset *fo,
+					   const char *line_delim_str,
+					   const int line_delim_length,
+					   int *filefd,
+					   int64_t *offset)
+{
+#ifdef WIN32
+	return FSTREAM_RANGE_UNAVAILABLE;
+#else
+	int		buffer_capacity = fs->options.bufsize;
+	static char err_buf[FILE_ERROR_SZ] = {0};
+
+	if (fs->ferror)
+		return -1;
+
+	assert(size >= buffer_capacity);
+	assert(!fs->options.is_csv && !fs->options.is_columnar);
+
+	for (;;)
+	{
+		off_t	filesize;
+		int64_t	remaining;
+		int64_t	window;
+		ssize_t	bytesread;
+		char   *p;
+		int		fd;
+
+		if (fs->fidx == fs->glob.gl_pathc)
+			return 0;
+
+		if (fs->skip_header_line)
+			return FSTREAM_RANGE_UNAVAILABLE;
+
+		fd = gfile_get_plain_fd(&fs->fd, &filesize);
+		if (fd < 0)
+			return FSTREAM_RANGE_UNAVAILABLE;
+
+		/*
+		 * Rows read by fstream_read() but not handed out yet are left in the
+		 * buffer.  They start at foff, so take them from the file again.
+		 */
+		fs->buffer_cur_size = 0;
+
+		remaining = filesize - fs->foff;
+		if (remaining <= 0)
+		{
+			if (nextFile(fs))
+				return -1;
+			continue;
+		}
+
+		updateCurFileState(fs, fo);
+		fs->line_number = 0;
+		*filefd = fd;
+		*offset = fs->foff;
+
+		/* the rest of the file, the last row may lack its end of line */
+		if (remaining <= size)
+		{
+			fs->foff += remaining;
+			fs->range_position = fs->foff;
+			return (int) remaining;
+		}
+
+		/* find the last end of line in the last buffer of the chunk */
+		window = fs->foff + size - buffer_capacity;
+		do
+			bytesread = pread(fd, fs->buffer, buffer_capacity, window);
+		while (bytesread < 0 && errno == EINTR);
+
+		if (bytesread < 0)
+		{
+			fs->ferror = format_error("cannot read file - ", fs->glob.gl_pathv[fs->fidx]);
+			return -1;
+		}
+
+		if (line_delim_length > 0)
+			p = find_last_eol_delim(fs->buffer, bytesread, line_delim_str, line_delim_length);
+		else
+		{
+			for (p = fs->buffer + bytesread; fs->buffer <= --p && *p != '\n';)
+				;
+		}
+
+		if (p < fs->buffer)
+		{
+			snprintf(err_buf, sizeof(err_buf)-1, "line too long in file %s near (%lld bytes)",
+					 fs->glob.gl_pathv[fs->fidx], (long long) fs->foff);
+			fs->ferror = err_buf;
+			gfile_printf_then_putc_newline("%s", err_buf);
+			return -1;
+		}
+
+		size = window + (p + 1 - fs->buffer) - fs->foff;
+		fs->foff += size;
+		fs->range_position = fs->foff;
+		return size;
+	}
+#endif
+}
+
 int fstream_write(fstream_t *fs,
 				  void *buf,
 				  int size,
@@ -998,16 +1150,25 @@ int fstream_write(fstream_t *fs,
 		* scan for EOL Delimiter (\n by default) for record boundary
 		* find the last EOL Delimiter from the back
 		*/
-		if (line_delim_length > 0)
+		if (fs->options.is_columnar)
 		{
-			last_delim = find_last_eol_delim(buf, size, line_delim_str, line_delim_length);
+			/* columnar: the end of the last whole block instead */
+			last_delim = extcolumnar_last_block_end(buf, (char*)buf + size);
+			last_delim = (char*)buf < last_delim ? last_delim : 0;
 		}
 		else
 		{
-			for (last_delim = (char*)buf + size; (char*)buf <= --last_delim && *last_delim != '\n';)
-				;
+			if (line_delim_length > 0)
+			{
+				last_delim = find_last_eol_delim(buf, size, line_delim_str, line_delim_length);
+			}
+			else
+			{
+				for (last_delim = (char*)buf + size; (char*)buf <= --last_delim && *last_delim != '\n';)
+					;
+			}
+			last_delim = (char*)buf <= last_delim ? last_delim + 1 : 0;
 		}
-		last_delim = (char*)buf <= last_delim ? last_delim + 1 : 0;
 
 		if (last_delim == 0)
 		{
@@ -1049,7 +1210,7 @@ int64_t fstream_get_compressed_position(fstream_t *fs)
 {
 	int64_t p = fs->compressed_position;
 	if (fs->fidx != fs->glob.gl_pathc)
-		p += gfile_get_compressed_position(&fs->fd);
+		p += Max(gfile_get_compressed_position(&fs->fd), fs->range_position);
 	return p;
 }
 
@@ -41,6 +41,12 @@
 #define O_BINARY 0
 #endif
 
+/* parallel reads are only used by gpfdist, never in the backend */
+#if defined(FRONTEND) && !defined(WIN32)
+#define GFILE_PREFETCH
+#include <pthread.h>
+#endif
+
 #ifndef S_IRUSR					/* XXX [TRH] should be in a header */
 #define S_IRUSR		 S_IREAD
 #define S_IWUSR		 S_IWRITE
@@ -818,13 +824,20 @@ subprocess_open(gfile_t* fd, const char* fpath, int for_write, int* rcode, const
 		return subprocess_open_failed(rcode, rstring, "subprocess_open: apr_tokenize_to_argv failed");
 	}
 
-	/* replace %FILENAME% with path to input or output file */
+	/*
+	 * replace %FILENAME% with path to input or output file, and %COLUMNS% and
+	 * %FILTER% with what the scan tells of the columns and rows it needs
+	 */
 	{
 		char** p;
 		for (p = tokens; *p; p++) 
 		{
 			if (0 == strcasecmp(*p, "%FILENAME%"))
 				*p = (char*) fpath;
+			else if (0 == strcasecmp(*p, "%COLUMNS%"))
+				*p = (char*) (fd->transform->columns ? fd->transform->columns : "");
+			else if (0 == strcasecmp(*p, "%FILTER%"))
+				*p = (char*) (fd->transform->filter ? fd->transform->filter : "");
 		}
 	}
 
@@ -942,6 +955,185 @@ close_subprocess(gfile_t *fd)
 }
 #endif
 
+#ifdef GFILE_PREFETCH
+/*
+ * Parallel reads of plain files.
+ *
+ * A handful of threads pread() the chunks following the current read
+ * position into a ring of buffers, and read calls copy them out in order.
+ * Chunks are cut at fixed offsets, not at line boundaries: the callers
+ * already carry a partial row over from one read to the next, so they see
+ * exactly the stream they would get from read().  The file is read ahead by
+ * at most two chunks per thread.
+ */
+#define PREFETCH_CHUNK_SIZE		(1 << 20)
+#define PREFETCH_MAX_THREADS	16
+
+#define CHUNK_FREE		0
+#define CHUNK_READING	1
+#define CHUNK_READY		2
+
+struct prefetch_chunk
+{
+	char	   *buf;
+	int64		seq;			/* chunk number, from the start offset */
+	ssize_t		len;			/* bytes read, -1 on error */
+	int			err;			/* errno of a failed read */
+	int			state;
+};
+
+struct prefetch_stuff
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	pthread_t	threads[PREFETCH_MAX_THREADS];
+	int			nthreads;
+	int			nchunks;
+	struct prefetch_chunk *chunks;
+	off_t		start;			/* file offset of chunk 0 */
+	int64		next_read;		/* next chunk to hand to a thread */
+	int64		next_consume;	/* chunk being copied out */
+	int64		eof_seq;		/* first chunk past EOF, -1 if unknown */
+	ssize_t		consumed;		/* bytes of next_consume copied out */
+	bool_t		stop;
+};
+
+static void *
+prefetch_thread(void *arg)
+{
+	gfile_t    *fd = (gfile_t *) arg;
+	struct prefetch_stuff *pf = fd->prefetch;
+
+	pthread_mutex_lock(&pf->mutex);
+	for (;;)
+	{
+		struct prefetch_chunk *c;
+		int64		seq;
+		ssize_t		len = 0;
+		int			err = 0;
+
+		/* wait for a free buffer and a chunk that is not past EOF */
+		while (!pf->stop &&
+			   (pf->next_read >= pf->next_consume + pf->nchunks ||
+				(pf->eof_seq >= 0 && pf->next_read >= pf->eof_seq)))
+			pthread_cond_wait(&pf->cond, &pf->mutex);
+		if (pf->stop)
+			break;
+
+		seq = pf->next_read++;
+		c = &pf->chunks[seq % pf->nchunks];
+		c->seq = seq;
+		c->state = CHUNK_READING;
+		pthread_mutex_unlock(&pf->mutex);
+
+		while (len < PREFETCH_CHUNK_SIZE)
+		{
+			ssize_t		i = pread(fd->fd.filefd, c->buf + len,
+								  PREFETCH_CHUNK_SIZE - len,
+								  pf->start + seq * PREFETCH_CHUNK_SIZE + len);
+
+			if (i < 0 && errno == EINTR)
+				continue;
+			if (i < 0)
+			{
+				err = errno;
+				len = -1;
+				break;
+			}
+			if (i == 0)
+				break;
+			len += i;
+		}
+
+		pthread_mutex_lock(&pf->mutex);
+		c->len = len;
+		c->err = err;
+		c->state = CHUNK_READY;
+		/* a short chunk is the last one */
+		if (len < PREFETCH_CHUNK_SIZE && (pf->eof_seq < 0 || seq + 1 < pf->eof_seq))
+			pf->eof_seq = seq + 1;
+		pthread_cond_broadcast(&pf->cond);
+	}
+	pthread_mutex_unlock(&pf->mutex);
+
+	return NULL;
+}
+
+static ssize_t
+prefetch_read(gfile_t *fd, void *ptr, size_t size)
+{
+	struct prefetch_stuff *pf = fd->prefetch;
+	struct prefetch_chunk *c;
+	ssize_t		n;
+
+	pthread_mutex_lock(&pf->mutex);
+	c = &pf->chunks[pf->next_consume % pf->nchunks];
+	for (;;)
+	{
+		if (pf->eof_seq >= 0 && pf->next_consume >= pf->eof_seq)
+		{
+			pthread_mutex_unlock(&pf->mutex);
+			return 0;
+		}
+		if (c->state == CHUNK_READY && c->seq == pf->next_consume)
+			break;
+		pthread_cond_wait(&pf->cond, &pf->mutex);
+	}
+	pthread_mutex_unlock(&pf->mutex);
+
+	if (c->len < 0)
+	{
+		errno = c->err;
+		return -1;
+	}
+
+	/* the buffer is ours until next_consume moves on */
+	n = Min((ssize_t) size, c->len - pf->consumed);
+	memcpy(ptr, c->buf + pf->consumed, n);
+	pf->consumed += n;
+	fd->compressed_position += n;
+
+	if (pf->consumed == c->len)
+	{
+		pthread_mutex_lock(&pf->mutex);
+		c->state = CHUNK_FREE;
+		pf->next_consume++;
+		pf->consumed = 0;
+		pthread_cond_broadcast(&pf->cond);
+		pthread_mutex_unlock(&pf->mutex);
+
+		/* an empty chunk at EOF, let the next call say so */
+		if (n == 0)
+			return prefetch_read(fd, ptr, size);
+	}
+
+	return n;
+}
+
+static void
+prefetch_stop(gfile_t *fd)
+{
+	struct prefetch_stuff *pf = fd->prefetch;
+	int			i;
+
+	pthread_mutex_lock(&pf->mutex);
+	pf->stop = TRUE;
+	pthread_cond_broadcast(&pf->cond);
+	pthread_mutex_unlock(&pf->mutex);
+
+	for (i = 0; i < pf->nthreads; i++)
+		pthread_join(pf->threads[i], NULL);
+
+	for (i = 0; i < pf->nchunks; i++)
+		gfile_free(pf->chunks[i].buf);
+	gfile_free(pf->chunks);
+	pthread_cond_destroy(&pf->cond);
+	pthread_mutex_destroy(&pf->mutex);
+	gfile_free(pf);
+	fd->prefetch = NULL;
+}
+#endif   /* GFILE_PREFETCH */
+
 static int close_filefd(int fd)
 {
 	int ret = 0;
@@ -1278,11 +1470,87 @@ int gfile_open(gfile_t* fd, const char* fpath, int flags, int* response_code, co
 	return 1;
 }
 
+/*
+ * Read a plain file opened for reading with nthreads parallel preads.  Files
+ * that are compressed, piped, transformed or too small to gain from it are
+ * read as before.  Returns true if parallel reads were set up.
+ */
+bool_t
+gfile_prefetch(gfile_t *fd, int nthreads)
+{
+#ifdef GFILE_PREFETCH
+	struct prefetch_stuff *pf;
+	struct stat sta;
+	int			i;
+
+	if (nthreads <= 0 || fd->read != read_and_retry ||
+		fd->compression != NO_COMPRESSION || fd->transform || fd->prefetch)
+		return FALSE;
+	if (fstat(fd->fd.filefd, &sta) != 0 || !S_ISREG(sta.st_mode) ||
+		sta.st_size < 2 * PREFETCH_CHUNK_SIZE)
+		return FALSE;
+
+	nthreads = Min(nthreads, PREFETCH_MAX_THREADS);
+
+	if (!(pf = gfile_malloc(sizeof *pf)))
+		return FALSE;
+	memset(pf, 0, sizeof *pf);
+	pf->nchunks = 2 * nthreads;
+	if (!(pf->chunks = gfile_malloc(sizeof(struct prefetch_chunk) * pf->nchunks)))
+	{
+		gfile_free(pf);
+		return FALSE;
+	}
+	memset(pf->chunks, 0, sizeof(struct prefetch_chunk) * pf->nchunks);
+	for (i = 0; i < pf->nchunks; i++)
+	{
+		if (!(pf->chunks[i].buf = gfile_malloc(PREFETCH_CHUNK_SIZE)))
+		{
+			while (--i >= 0)
+				gfile_free(pf->chunks[i].buf);
+			gfile_free(pf->chunks);
+			gfile_free(pf);
+			return FALSE;
+		}
+	}
+
+	pf->start = lseek(fd->fd.filefd, 0, SEEK_CUR);
+	if (pf->start < 0)
+		pf->start = 0;
+	pf->eof_seq = -1;
+	pthread_mutex_init(&pf->mutex, NULL);
+	pthread_cond_init(&pf->cond, NULL);
+	fd->prefetch = pf;
+
+	for (i = 0; i < nthreads; i++)
+	{
+		if (pthread_create(&pf->threads[i], NULL, prefetch_thread, fd) != 0)
+			break;
+		pf->nthreads++;
+	}
+	if (pf->nthreads == 0)
+	{
+		prefetch_stop(fd);
+		return FALSE;
+	}
+
+	fd->read = prefetch_read;
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
 int
 gfile_close(gfile_t*fd)
 {
 	int ret = 1;
 
+#ifdef GFILE_PREFETCH
+	if (fd->prefetch)
+		prefetch_stop(fd);
+#endif
+
 	if (fd->close)
 	{
 #ifdef GPFXDIST
@@ -1365,6 +1633,26 @@ gfile_write(gfile_t *fd, void *ptr, size_t len)
 	return olen - len;
 }
 
+/*
+ * Return the descriptor of a plain file opened for reading and its current
+ * size in *size, for callers that read parts of it with pread() or send
+ * them with sendfile() instead of gfile_read().  Returns -1 if the data does
+ * not come straight from a regular file.
+ */
+int gfile_get_plain_fd(gfile_t *fd, off_t *size)
+{
+	struct stat sta;
+
+	if (fd->read != read_and_retry || fd->compression != NO_COMPRESSION ||
+		fd->transform || fd->is_write)
+		return -1;
+	if (fstat(fd->fd.filefd, &sta) != 0 || !S_ISREG(sta.st_mode))
+		return -1;
+
+	*size = sta.st_size;
+	return fd->fd.filefd;
+}
+
 off_t gfile_get_compressed_size(gfile_t *fd)
 {
 	return fd->compressed_size;
@@ -29,6 +29,7 @@
 #include "cdb/cdbdisp_query.h"
 #include "cdb/cdbhash.h"
 #include "cdb/cdbsreh.h"
+#include "cdb/cdbsrlz.h"
 #include "cdb/cdbvars.h"
 #include "cdb/memquota.h"
 #include "commands/vacuum.h"
@@ -158,6 +159,10 @@ bool		gp_allow_non_uniform_partitioning_ddl = true;
 bool		gp_print_create_gang_time = false;
 bool		gp_enable_exchange_default_partition = false;
 int			dtx_phase2_retry_count = 0;
+bool		gp_dtx_prepare_with_statement = false;
+bool		gp_dtx_skip_readonly_segments = false;
+int			gp_dtx_commit_delay = 0;
+int			gp_dtx_commit_siblings = 5;
 bool		gp_log_suboverflow_statement = false;
 bool        gp_use_synchronize_seqscans_catalog_vacuum_full = false;
 
@@ -310,6 +315,7 @@ int			optimizer_cost_model;
 bool		optimizer_metadata_caching;
 int			optimizer_mdcache_size;
 bool		optimizer_use_gpdb_allocators;
+bool		optimizer_use_arena_allocator;
 bool		optimizer_enable_table_alias;
 
 /* Optimizer debugging GUCs */
@@ -329,6 +335,7 @@ bool		optimizer_print_xform_results;
 /* array of xforms disable flags */
 bool		optimizer_xforms[OPTIMIZER_XFORMS_COUNT] = {[0 ... OPTIMIZER_XFORMS_COUNT - 1] = false};
 char	   *optimizer_search_strategy_path = NULL;
+char	   *optimizer_cost_model_params_path = NULL;
 
 /* GUCs to tell Optimizer to enable a physical operator */
 bool		optimizer_enable_indexjoin;
@@ -433,6 +440,7 @@ bool		optimizer_enable_orderedagg;
 bool		optimizer_analyze_root_partition;
 bool		optimizer_analyze_midlevel_partition;
 bool		optimizer_analyze_enable_merge_of_leaf_stats;
+bool		gp_analyze_skip_unchanged_ao = false;
 
 /* GUCs for replicated table */
 bool		optimizer_replicated_table_insert;
@@ -475,6 +483,7 @@ bool		gp_enable_motion_mk_sort = true;
 bool		gp_enable_global_deadlock_detector = false;
 
 bool		gp_log_endpoints = false;
+int			gp_endpoint_queue_size = 1024;
 
 /* optional reject to  parse ambigous 5-digits date in YYYMMDD format */
 bool		gp_allow_date_field_width_5digits = false;
@@ -503,6 +512,7 @@ static const struct config_enum_entry debug_dtm_action_protocol_options[] = {
 	{"subtransaction_begin", DTX_PROTOCOL_COMMAND_SUBTRANSACTION_BEGIN_INTERNAL},
 	{"subtransaction_release", DTX_PROTOCOL_COMMAND_SUBTRANSACTION_RELEASE_INTERNAL},
 	{"subtransaction_rollback", DTX_PROTOCOL_COMMAND_SUBTRANSACTION_ROLLBACK_INTERNAL},
+	{"prepare_skip_readonly", DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY},
 	{NULL, 0}
 };
 
@@ -561,6 +571,7 @@ static const struct config_enum_entry gp_autostats_modes[] = {
 static const struct config_enum_entry gp_interconnect_fc_methods[] = {
 	{"loss", INTERCONNECT_FC_METHOD_LOSS},
 	{"capacity", INTERCONNECT_FC_METHOD_CAPACITY},
+	{"delay", INTERCONNECT_FC_METHOD_DELAY},
 	{NULL, 0}
 };
 
@@ -1221,6 +1232,26 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_shm", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Use shared memory instead of the network between interconnect peers on the same host."),
+			gettext_noop("Only used by the UDP interconnect.")
+		},
+		&gp_interconnect_shm,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_udp_gso", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Let the kernel segment batches of equally sized interconnect packets."),
+			gettext_noop("Only used by the UDP interconnect, and only if the platform supports UDP segmentation offload.")
+		},
+		&gp_interconnect_udp_gso,
+		true,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_log_stats", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Emit statistics from the UDP-IC at the end of every statement."),
@@ -2830,6 +2861,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_analyze_skip_unchanged_ao", PGC_USERSET, STATS_ANALYZE,
+			gettext_noop("Skip sampling append-optimized tables and partitions that have not been modified since their last ANALYZE."),
+			gettext_noop("Modification is detected by comparing the append-optimized modcount on the master "
+						 "with the value recorded by the previous ANALYZE; existing statistics are kept as is.")
+		},
+		&gp_analyze_skip_unchanged_ao,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_enable_constant_expression_evaluation", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Enable constant expression evaluation in the optimizer"),
@@ -3028,6 +3070,17 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_use_arena_allocator", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Allocate GPORCA optimization memory from an arena that is released in bulk."),
+			gettext_noop("Only takes effect when optimizer_use_gpdb_allocators is off."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_use_arena_allocator,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_enable_table_alias", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Enable using table aliases to make plan explain more descriptive"),
@@ -3188,6 +3241,31 @@ struct config_bool ConfigureNamesBool_gp[] =
 		false, NULL, NULL
 	},
 
+	{
+		{"gp_dtx_prepare_with_statement", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Prepares a distributed transaction along with its last statement."),
+			gettext_noop("When the last statement of an implicit transaction runs on the"
+						 " writer gang only, the segments prepare the transaction as soon"
+						 " as they finish it, saving the separate PREPARE round trip."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_dtx_prepare_with_statement,
+		false, NULL, NULL
+	},
+
+	{
+		{"gp_dtx_skip_readonly_segments", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Leaves segments that wrote nothing out of the two-phase commit."),
+			gettext_noop("A distributed transaction that wrote xlog on one segment only"
+						 " commits in one phase. Otherwise the segments that have not"
+						 " written anything commit when asked to prepare, and get no"
+						 " COMMIT PREPARED."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_dtx_skip_readonly_segments,
+		false, NULL, NULL
+	},
+
 	{
 		{"create_restartpoint_on_ckpt_record_replay", PGC_SIGHUP, DEVELOPER_OPTIONS,
 			gettext_noop("create a restartpoint only on mirror immediately after replaying a checkpoint record."),
@@ -3505,6 +3583,17 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_endpoint_queue_size", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the size of the shared memory queue between an endpoint and its retrieve session."),
+			gettext_noop("A larger queue lets the endpoint run further ahead of a retrieve session that reads in bursts."),
+			GUC_UNIT_KB
+		},
+		&gp_endpoint_queue_size,
+		1024, 64, 1024 * 1024,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"statement_mem", PGC_USERSET, RESOURCES_MEM,
 			gettext_noop("Sets the memory to be reserved for a statement."),
@@ -3574,6 +3663,17 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_dispatch_plan_cache_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of recently dispatched plans that are kept on the master and the segments."),
+			gettext_noop("A plan dispatched again is neither compressed again on the master nor sent again to segments that still have it. "
+						 "Use 0 to dispatch every plan in full.")
+		},
+		&gp_dispatch_plan_cache_size,
+		0, 0, MAX_DISPATCHED_PLANS,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_max_partition_level", PGC_SUSET, PRESET_OPTIONS,
 			gettext_noop("Sets the maximum number of levels allowed when creating a partitioned table."),
@@ -3792,6 +3892,26 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_shm_queue_depth", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of packets in the shared-memory ring between interconnect peers on the same host."),
+			NULL
+		},
+		&Gp_interconnect_shm_queue_depth,
+		32, 1, 4096,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_batch_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the maximum number of packets the UDP interconnect sends or receives in one system call."),
+			gettext_noop("1 sends and receives one packet per system call.")
+		},
+		&Gp_interconnect_batch_size,
+		32, 1, 64,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_cursor_ic_table_size", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Sets the size of Cursor Table in the UDP interconnect"),
@@ -3988,6 +4108,17 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_qe_backend_pool_size", PGC_SIGHUP, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of backends a segment keeps pre-forked for new QE connections."),
+			gettext_noop("0 forks a backend when a connection arrives."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_qe_backend_pool_size,
+		0, 0, MAX_QE_BACKEND_POOL_SIZE,
+		NULL, NULL, NULL
+	},
+
 
 	{
 #ifdef USE_ASSERT_CHECKING
@@ -4726,6 +4857,32 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_dtx_commit_delay", PGC_SUSET, WAL_SETTINGS,
+			gettext_noop("Sets the delay in microseconds between writing a distributed "
+						 "commit record and flushing WAL to disk."),
+			gettext_noop("Lets concurrent distributed transactions share the flush of "
+						 "their commit records on the master."),
+			GUC_NOT_IN_SAMPLE
+			/* we have no microseconds designation, so can't supply units here */
+		},
+		&gp_dtx_commit_delay,
+		0, 0, 100000,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_dtx_commit_siblings", PGC_USERSET, WAL_SETTINGS,
+			gettext_noop("Sets the minimum concurrent open transactions before performing "
+						 "gp_dtx_commit_delay."),
+			NULL,
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_dtx_commit_siblings,
+		5, 0, 1000,
+		NULL, NULL, NULL
+	},
+
 	{
 		/* Can't be set in postgresql.conf */
 		{"gp_server_version_num", PGC_INTERNAL, PRESET_OPTIONS,
@@ -5102,6 +5259,18 @@ struct config_string ConfigureNamesString_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_cost_model_params_path", PGC_SUSET, QUERY_TUNING_COST,
+			gettext_noop("Sets the file to load GPORCA cost model parameters from."),
+			gettext_noop("The file is written by gpcostcalibrate. An empty string "
+						 "uses the built-in parameters."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&optimizer_cost_model_params_path,
+		"",
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_default_storage_options", PGC_USERSET, APPENDONLY_TABLES,
 			gettext_noop("default options for appendonly storage."),
@@ -5292,7 +5461,7 @@ struct config_enum ConfigureNamesEnum_gp[] =
 	{
 		{"gp_interconnect_fc_method", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Sets the flow control method used for UDP interconnect."),
-			gettext_noop("Valid values are \"capacity\" and \"loss\".")
+			gettext_noop("Valid values are \"capacity\", \"loss\" and \"delay\".")
 		},
 		&Gp_interconnect_fc_method,
 		INTERCONNECT_FC_METHOD_LOSS, gp_interconnect_fc_methods,
@@ -36,6 +36,10 @@
 #include <arpa/inet.h>
 #include <pthread.h>
 #include <semaphore.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#define GPFDIST_SENDFILE
+#endif
 #define SOCKET int
 #ifndef closesocket
 #define closesocket(x)   close(x)
@@ -67,6 +71,7 @@
 #define DEFAULT_COMPRESS_LEVEL 1
 #define MAX_FRAME_SIZE 65536
 #define MAX_THREAD_NUM 256
+#define SENDFILE_CHUNK_SIZE (1 << 20) /* largest block sent with sendfile() */
 
 #define ERROR_CODE_SUCCESS 0
 #define ERROR_CODE_GENERIC 1
@@ -89,6 +94,8 @@ struct block_t
 	int 		bot, cbot, top, ctop;
 	char*      	data;
 	char*		cdata;
+	int			filefd;		/* if not -1, the data is in this file at foff, not in data */
+	apr_int64_t	foff;
 };
 
 /*  Get session id for this request */
@@ -98,6 +105,8 @@ static long REQUEST_SEQ = 0;		/*  sequence number for request */
 static long SESSION_SEQ = 0;		/*  sequence number for session */
 #ifndef WIN32
 static sem_t THREAD_NUM;			/* limit total thread number */
+static pthread_mutex_t STATS_MUTEX = PTHREAD_MUTEX_INITIALIZER; /* protects gcb.read_bytes */
+static pthread_mutex_t LOG_MUTEX = PTHREAD_MUTEX_INITIALIZER; /* keeps log lines of different threads apart */
 #endif
 #ifdef HAVE_LIBZSTD
 static long OUT_BUFFER_SIZE = 0;	/* zstd out buffer size */
@@ -205,7 +214,9 @@ static struct
 	int			multi_thread; /* The number of working threads for compression transmission */
 	const char* I; /* default input transformation */
 	const char* O; /* default output transformation */
-} opt = { 8080, 8080, 0, 0, 0, ".", 0, 0, -1, 5, 0, 32768, 0, 256, 0, 0, 0, 0, 300, 0, 0, 0, 0};
+	int			serve_threads; /* The number of threads serving GET requests, 0 to serve them in the main thread */
+	int			read_threads; /* The number of threads reading each file in parallel */
+} opt = { 8080, 8080, 0, 0, 0, ".", 0, 0, -1, 5, 0, 32768, 0, 256, 0, 0, 0, 0, 300, 0, 0, 0, 0, 0, 0};
 
 #define START_BUFFER_SIZE (1 << 20) /* 1M as start size */
 #define MAXIMUM_BUFFER_SIZE (1 << 30) /* 1G as Maximum size */
@@ -269,6 +280,10 @@ struct session_t
 	struct timeval 	tm;             /* timeout for struct event */
 	struct event   	ev;             /* event we are watching for this session*/
 	apr_hash_t		*requests;
+	int				zero_copy;		/* send TEXT data of plain files with sendfile() */
+#ifndef WIN32
+	pthread_mutex_t	lock;			/* serializes reads by the serving threads, recursive */
+#endif
 };
 
 /*  An http request */
@@ -299,6 +314,8 @@ struct request_t
 		int			paths;		/* 1 if filename passed to transform should contain paths to data files */
 		const char* errfilename; /* name of temporary file holding stderr to send to server */
 		apr_file_t* errfile;	/* temporary file holding stderr to send to server */
+		const char* columns;	/* columns the scan needs, from X-GP-COLUMNS */
+		const char* filter;		/* quals of the scan, from X-GP-FILTER */
 	} trans;
 #endif
 
@@ -344,6 +361,12 @@ struct request_t
 #endif
 	int				send_size;		/* record number of sent bytes in multi-thread or compression mode. */
 	bool			session_end;	/* mark whether the session should be ended . */
+#ifndef WIN32
+	int				serve_state;	/* SERVE_IDLE, SERVE_QUEUED, ... see serve_write() */
+	int				serve_status;	/* result of serve_blocks() for the main thread */
+	const char*		serve_error;	/* error message if serve_status is SERVE_ERROR */
+	request_t*		serve_next;		/* next request in the serve queue or done list */
+#endif
 
 #ifdef USE_SSL
 	/* SSL related */
@@ -354,7 +377,52 @@ struct request_t
 #endif
 };
 
+#ifndef WIN32
+#define SESSION_LOCK(s)		pthread_mutex_lock(&(s)->lock)
+#define SESSION_UNLOCK(s)	pthread_mutex_unlock(&(s)->lock)
+#define STATS_LOCK()		pthread_mutex_lock(&STATS_MUTEX)
+#define STATS_UNLOCK()		pthread_mutex_unlock(&STATS_MUTEX)
+#define LOG_LOCK()			pthread_mutex_lock(&LOG_MUTEX)
+#define LOG_UNLOCK()		pthread_mutex_unlock(&LOG_MUTEX)
 
+/*
+ * With --serve_threads, GET requests without compression are served by a
+ * pool of threads.  When its socket is writable, the main thread queues a
+ * request, a serving thread reads and sends the next few blocks of it, and
+ * hands it back to the main thread through a pipe.  Requests on the same
+ * session take turns on the session lock to read from the file, everything
+ * else runs in parallel.  The main thread never waits for a serving thread,
+ * except to clean up a request that is still being served.
+ */
+#define SERVE_IDLE		0	/* owned by the main thread */
+#define SERVE_QUEUED	1	/* waiting for a serving thread */
+#define SERVE_RUNNING	2	/* being served */
+#define SERVE_DONE		3	/* served, waiting for the main thread */
+
+/* results of serve_blocks() */
+#define SERVE_MORE		0	/* wait for the socket to be writable and go on */
+#define SERVE_EOF		1	/* all data sent */
+#define SERVE_ERROR		2	/* failed with serve_error */
+
+static struct
+{
+	pthread_mutex_t	mutex;
+	pthread_cond_t	queued;		/* signalled when a request is queued */
+	pthread_cond_t	done;		/* signalled when a request has been served */
+	request_t*		head;		/* queued requests, oldest first */
+	request_t*		tail;
+	request_t*		finished;	/* served requests, for the main thread */
+	int				pipefd[2];	/* wakes up the main thread */
+	struct event	ev;
+} serve_pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
+#else
+#define SESSION_LOCK(s)
+#define SESSION_UNLOCK(s)
+#define STATS_LOCK()
+#define STATS_UNLOCK()
+#define LOG_LOCK()
+#define LOG_UNLOCK()
+#endif
 
 #if APR_IS_BIGENDIAN
 #define local_htonll(n)  (n)
@@ -391,8 +459,11 @@ static void gp1_send_errmsg(request_t* r, const char* msg);
 static void gp1_send_errfile(request_t* r, apr_file_t* errfile);
 #endif
 
-static char* datetime_now(void);
-static char* datetime(apr_time_t t);
+/* room for the "YYYY-MM-DD HH:MM:SS" of datetime() */
+#define DATETIME_LEN 100
+
+static char* datetime_now(char *buf);
+static char* datetime(apr_time_t t, char *buf);
 static int setup_read(request_t* r);
 static int setup_write(request_t* r);
 static void setup_do_close(request_t* r);
@@ -422,6 +493,11 @@ static int request_set_transform(request_t *r);
 static void handle_post_request(request_t *r, int header_end);
 static void handle_get_request(request_t *r);
 static int send_proto_head(request_t *r);
+#ifndef WIN32
+static void serve_start(void);
+static void serve_write(request_t *r);
+static void serve_wait(request_t *r);
+#endif
 
 static int gpfdist_socket_send(const request_t *r, const void *buf, const size_t buflen);
 static int (*gpfdist_send)(const request_t *r, const void *buf, const size_t buflen); /* function pointer */
@@ -630,6 +706,10 @@ static void usage_error(const char* msg, int print_usage)
 #ifdef HAVE_LIBZSTD
 						"        --compress : open compression transmission\n"
 						"        --multi_thread num : the max number of working thread for compression transmission\n"
+#endif
+#ifndef WIN32
+						"        --serve_threads num : serve requests for uncompressed data with num threads\n"
+						"        --read_threads num  : read each file with num threads in parallel (at most 16)\n"
 #endif
 						"        --version  : print version information\n"
 						"        -w timeout : timeout in seconds before close target file\n"
@@ -703,6 +783,8 @@ static void parse_command_line(int argc, const char* const argv[],
 	{"compress", 258, 0, "turn on compressed transmission"},
 	{"multi_thread", 259, 1, "turn on multi-thread and compressed transmission"},
 #endif
+	{"serve_threads", 260, 1, "serve requests with a pool of threads"},
+	{"read_threads", 261, 1, "read each file with parallel threads"},
 	{ 0 } };
 
 	status = apr_getopt_init(&os, pool, argc, argv);
@@ -810,6 +892,29 @@ static void parse_command_line(int argc, const char* const argv[],
 		case 259:
 			usage_error("Multi-thread transmission relies on zstd, but zstd is not supported by this build", 0);
 			break;
+#endif
+#ifndef WIN32
+		case 260:
+			if (atoi(arg) <= 0)
+			{
+				usage_error("The number of serving threads must be more than zero!", 0);
+				break;
+			}
+			opt.serve_threads = atoi(arg);
+			break;
+		case 261:
+			if (atoi(arg) <= 0)
+			{
+				usage_error("The number of reading threads must be more than zero!", 0);
+				break;
+			}
+			opt.read_threads = atoi(arg);
+			break;
+#else
+		case 260:
+		case 261:
+			usage_error("Threads are not supported by this build", 0);
+			break;
 #endif
 		case 'I':
 			opt.I = arg;
@@ -897,6 +1002,12 @@ static void parse_command_line(int argc, const char* const argv[],
 
 		sem_init(&THREAD_NUM, 0, num_thread);
 	}
+
+	if (opt.serve_threads > MAX_THREAD_NUM)
+	{
+		gwarning(NULL, "%s", "The number of serving threads exceeds the restricted number! Gpfdist will use the restricted number.");
+		opt.serve_threads = MAX_THREAD_NUM;
+	}
 #endif
 
 	/* validate opt.l */
@@ -1093,6 +1204,7 @@ static apr_status_t http_ok(request_t* r)
 static void log_gpfdist_status()
 {
 	char buf[1024];
+	char timebuf[DATETIME_LEN];
 	int  i;
 
 	int num_sessions = apr_hash_count(gcb.session.tab);
@@ -1167,7 +1279,7 @@ static void log_gpfdist_status()
 						r->id,
 						r->bytes,
 						get_unsent_bytes(r),
-						datetime(r->last),
+						datetime(r->last, timebuf),
 #ifdef WIN32
 						(long) r->seq,
 #else
@@ -1231,7 +1343,8 @@ static apr_status_t send_gpfdist_status(request_t* r)
 	 * }
 	 */
 	char buf[1024];
-	char *time = datetime_now();
+	char timebuf[DATETIME_LEN];
+	char *time = datetime_now(timebuf);
 	int n = apr_snprintf(buf, sizeof(buf),	"HTTP/1.0 200 ok\r\n"
 										"Content-type: text/plain\r\n"
 										"Expires: 0\r\n"
@@ -1282,7 +1395,12 @@ static apr_status_t send_gpfdist_status(request_t* r)
  */
 static void request_end(request_t* r, int error, const char* errmsg)
 {
-	session_t* s = r->session;
+	session_t* s;
+
+#ifndef WIN32
+	serve_wait(r);
+#endif
+	s = r->session;
 
 #ifdef GPFXDIST
 	if (r->trans.errfile)
@@ -1350,52 +1468,91 @@ static void request_end(request_t* r, int error, const char* errmsg)
 #endif
 }
 
-static int local_send(request_t *r, const char* buf, int buflen)
+/*
+ * Handle a failed send on the socket of r.  Returns 0 if it should be
+ * tried again, -1 otherwise.
+ */
+static int local_send_failed(request_t *r)
 {
-	int n = gpfdist_send(r, buf, buflen);
-
-	if (n < 0)
-	{
 #ifdef WIN32
-		int e = WSAGetLastError();
-		int ok = (e == WSAEINTR || e == WSAEWOULDBLOCK);
+	int e = WSAGetLastError();
+	int ok = (e == WSAEINTR || e == WSAEWOULDBLOCK);
 #else
-		int e = errno;
-		int ok = (e == EINTR || e == EAGAIN);
+	int e = errno;
+	int ok = (e == EINTR || e == EAGAIN);
 #endif
-		if ( e == EPIPE || e == ECONNRESET )
+	if ( e == EPIPE || e == ECONNRESET )
+	{
+		gwarning(r, "gpfdist_send failed - the connection was terminated by the client (%d: %s)", e, strerror(e));
+		/* close stream and release fd & flock on pipe file*/
+		if (r->session && r->is_get)
 		{
-			gwarning(r, "gpfdist_send failed - the connection was terminated by the client (%d: %s)", e, strerror(e));
-			/* close stream and release fd & flock on pipe file*/
-			if (r->session && r->is_get)
-			{
 #ifndef WIN32
-				if (opt.multi_thread)
-				{
-					session_mark_end(r);
-				}
-				else
-#endif
-				{
-					session_end(r->session, ERROR_CODE_SUCCESS, NULL);
-				}
-			}
-		/* For POST request, we did not send response successfully, so allow peer retry */
-		} else {
-			if (!ok) 
+			if (opt.multi_thread)
 			{
-				gwarning(r, "gpfdist_send failed - due to (%d: %s)", e, strerror(e));
-			} 
-			else 
+				session_mark_end(r);
+			}
+			else
+#endif
 			{
-				gdebug(r, "gpfdist_send failed - due to (%d: %s), should try again", e, strerror(e));
+				session_end(r->session, ERROR_CODE_SUCCESS, NULL);
 			}
 		}
-		return ok ? 0 : -1;
+	/* For POST request, we did not send response successfully, so allow peer retry */
+	} else {
+		if (!ok) 
+		{
+			gwarning(r, "gpfdist_send failed - due to (%d: %s)", e, strerror(e));
+		} 
+		else 
+		{
+			gdebug(r, "gpfdist_send failed - due to (%d: %s), should try again", e, strerror(e));
+		}
+	}
+	return ok ? 0 : -1;
+}
+
+static int local_send(request_t *r, const char* buf, int buflen)
+{
+	int n = gpfdist_send(r, buf, buflen);
+
+	if (n < 0)
+		return local_send_failed(r);
+
+	return n;
+}
+
+#ifdef GPFDIST_SENDFILE
+/* Send buflen bytes of a block that is in a file, see session_get_block() */
+static int local_sendfile(request_t *r, block_t *block, int buflen)
+{
+	off_t		off = block->foff + block->bot;
+	ssize_t		n;
+
+	n = sendfile(r->sock, block->filefd, &off, buflen);
+	if (n < 0)
+		return local_send_failed(r);
+	if (n == 0)
+	{
+		/* the file got shorter than when we found the rows in it */
+		gwarning(r, "sendfile failed - file truncated at %lld bytes", (long long) off);
+		errno = EIO;
+		return -1;
 	}
 
 	return n;
 }
+#endif
+
+/* Send the data of a block, from wherever it is */
+static int send_block_data(request_t *r, block_t *block, int buflen)
+{
+#ifdef GPFDIST_SENDFILE
+	if (block->filefd >= 0)
+		return local_sendfile(r, block, buflen);
+#endif
+	return local_send(r, block->data + block->bot, buflen);
+}
 
 #ifdef HAVE_LIBZSTD
 static
@@ -1657,43 +1814,97 @@ session_get_block(const request_t* r, block_t* retblock, char* line_delim_str, i
 
 	retblock->bot = retblock->top = 0;
 
+	if (retblock->filefd >= 0)
+	{
+		close(retblock->filefd);
+		retblock->filefd = -1;
+	}
+
 	if (retblock->cbot != retblock->ctop)
 		return 0;
 
 	session_t *session = r->session;
 
+	SESSION_LOCK(session);
+
 	if (session->is_error || 0 == session->fstream)
 	{
 		gprintln(NULL, "session_get_block: end session is_error: %d", session->is_error);
 		session_end(session, ERROR_CODE_SUCCESS, NULL);
+		SESSION_UNLOCK(session);
 		return 0;
 	}
 
+	STATS_LOCK();
 	gcb.read_bytes -= fstream_get_compressed_position(session->fstream);
+	STATS_UNLOCK();
 
 	/* read data from our filestream as a chunk with whole data rows */
 
-	size = fstream_read(session->fstream, retblock->data, opt.m, &fos, whole_rows, line_delim_str, line_delim_length);
+	size = FSTREAM_RANGE_UNAVAILABLE;
+#ifdef GPFDIST_SENDFILE
+	if (session->zero_copy && !r->zstd)
+	{
+		int			filefd;
+		int64_t		foff;
+
+		/*
+		 * Only find where the rows of the chunk are in the file, to send them
+		 * straight from there.  The descriptor is duplicated as the session
+		 * may move on to the next file before this request has sent them.
+		 */
+		size = fstream_read_range(session->fstream,
+								  opt.m > SENDFILE_CHUNK_SIZE ? opt.m : SENDFILE_CHUNK_SIZE,
+								  &fos, line_delim_str, line_delim_length, &filefd, &foff);
+		if (size > 0)
+		{
+			retblock->filefd = dup(filefd);
+			retblock->foff = foff;
+			if (retblock->filefd < 0)
+			{
+				const char* ferror = "cannot duplicate file descriptor";
+
+				gwarning(NULL, "session_get_block end session due to %s: %s", ferror, strerror(errno));
+				STATS_LOCK();
+				gcb.read_bytes += fstream_get_compressed_position(session->fstream);
+				STATS_UNLOCK();
+				session_end(session, ERROR_CODE_GENERIC, ferror);
+				SESSION_UNLOCK(session);
+				return ferror;
+			}
+		}
+	}
+	if (size == FSTREAM_RANGE_UNAVAILABLE)
+#endif
+		size = fstream_read(session->fstream, retblock->data, opt.m, &fos, whole_rows, line_delim_str, line_delim_length);
 	delay_watchdog_timer();
 
 	if (size == 0)
 	{
 		gprintln(NULL, "session_get_block: end session due to EOF");
+		STATS_LOCK();
 		gcb.read_bytes += fstream_get_compressed_size(session->fstream);
+		STATS_UNLOCK();
 		session_end(session, ERROR_CODE_SUCCESS, NULL);
+		SESSION_UNLOCK(session);
 		return 0;
 	}
 
+	STATS_LOCK();
 	gcb.read_bytes += fstream_get_compressed_position(session->fstream);
+	STATS_UNLOCK();
 
 	if (size < 0)
 	{
 		const char* ferror = fstream_get_error(session->fstream);
 		gwarning(NULL, "session_get_block end session due to %s", ferror);
 		session_end(session, ERROR_CODE_GENERIC, ferror);
+		SESSION_UNLOCK(session);
 		return ferror;
 	}
 
+	SESSION_UNLOCK(session);
+
 	retblock->top = size;
 	/* fill the block header with meta data for the client to parse and use */
 	block_fill_header(r, retblock, &fos);
@@ -1706,6 +1917,8 @@ static void session_end(session_t* session, int error, const char *errmsg)
 {
 	gprintln(NULL, "session end. id = %ld, is_error = %d, error = %d", session->id, session->is_error, error);
 
+	SESSION_LOCK(session);
+
 	if (error) 
 	{
 		session->is_error = error;
@@ -1718,6 +1931,8 @@ static void session_end(session_t* session, int error, const char *errmsg)
 		fstream_close(session->fstream);
 		session->fstream = 0;
 	}
+
+	SESSION_UNLOCK(session);
 }
 
 /* finish the session - close the file */
@@ -1745,6 +1960,10 @@ static void session_free(session_t* session)
 
 	event_del(&session->ev);
 
+#ifndef WIN32
+	pthread_mutex_destroy(&session->lock);
+#endif
+
 	apr_hash_set(gcb.session.tab, session->key, APR_HASH_KEY_STRING, 0);
 	apr_pool_destroy(session->pool);
 }
@@ -1921,6 +2140,7 @@ static int session_attach(request_t* r)
 		memset(&fstream_options, 0, sizeof fstream_options);
 		fstream_options.verbose = opt.v;
 		fstream_options.bufsize = opt.m;
+		fstream_options.read_threads = opt.read_threads;
 
 		{
 			int quote = 0;
@@ -1932,7 +2152,7 @@ static int session_attach(request_t* r)
 			 * we check the number of successful match here to make sure eol_type and header are right
 			 */
 			if ( strcmp(r->csvopt, "") != 0 )
-			{  /* writable external table doesn't have csvopt */
+			{  /* writable external table doesn't have csvopt, unless columnar */
 				int n = sscanf(r->csvopt, "m%dx%dq%dn%dh%d", &fstream_options.is_csv, &escape,
 						&quote, &eol_type, &fstream_options.header);
 				if (n != 5)
@@ -1945,6 +2165,13 @@ static int session_attach(request_t* r)
 					fstream_options.quote = quote;
 					fstream_options.escape = escape;
 					fstream_options.eol_type = eol_type;
+
+					/* m2 is the columnar format, sent in whole blocks */
+					if (fstream_options.is_csv == 2)
+					{
+						fstream_options.is_csv = 0;
+						fstream_options.is_columnar = 1;
+					}
 				}
 				else
 				{
@@ -1976,6 +2203,9 @@ static int session_attach(request_t* r)
             fstream_options.transform->for_write  = fstream_options.forwrite;
             fstream_options.transform->mp         = pool;
 			fstream_options.transform->errfile    = r->trans.errfile;
+			/* the transform may be started again for the next file */
+			fstream_options.transform->columns    = apr_pstrdup(pool, r->trans.columns ? r->trans.columns : "");
+			fstream_options.transform->filter     = apr_pstrdup(pool, r->trans.filter ? r->trans.filter : "");
         }
 		gprintlnif(r, "r->path %s", r->path);
 #endif
@@ -2020,6 +2250,27 @@ static int session_attach(request_t* r)
 		session->maxsegs = r->totalsegs;
 		session->requests = apr_hash_make(pool);
 		event_set(&session->ev, 0, 0, 0, 0);
+#ifdef GPFDIST_SENDFILE
+		/*
+		 * The end of the last row of a TEXT chunk can be found by looking at
+		 * the end of the chunk only.  CSV must be scanned from the start, for
+		 * quoted newlines.
+		 */
+		session->zero_copy = (r->is_get && !opt.ssl &&
+							  !fstream_options.is_csv &&
+							  !fstream_options.is_columnar &&
+							  !fstream_options.transform);
+#endif
+#ifndef WIN32
+		{
+			pthread_mutexattr_t attr;
+
+			pthread_mutexattr_init(&attr);
+			pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+			pthread_mutex_init(&session->lock, &attr);
+			pthread_mutexattr_destroy(&attr);
+		}
+#endif
 
 		if (session->tid == 0 || session->path == 0 || session->key == 0)
 			gfatal(r, "out of memory in session_attach");
@@ -2179,6 +2430,14 @@ static void do_write(int fd, short event, void* arg)
 		gfatal(r, "internal error - non matching fd (%d) "
 					  "and socket (%d)", fd, r->sock);
 
+#ifndef WIN32
+	if (opt.serve_threads && !r->zstd)
+	{
+		serve_write(r);
+		return;
+	}
+#endif
+
 #ifdef HAVE_LIBZSTD
 	/* 
 	 * It is essential to recycle threads before we read file.
@@ -2240,7 +2499,7 @@ static void do_write(int fd, short event, void* arg)
 			else if (left_hbytes > 0) 
 				break;
 			
-			n = local_send(r, datablock->data + datablock->bot, n);
+			n = send_block_data(r, datablock, n);
 		}
 		if (n < 0)
 		{
@@ -2293,6 +2552,228 @@ static void do_write(int fd, short event, void* arg)
 		request_end(r, ERROR_CODE_GENERIC, 0);
 }
 
+#ifndef WIN32
+/*
+ * serve_blocks
+ *
+ * Send at most 3 blocks of a request or until we choke on the socket, like
+ * do_write() does.  Runs in a serving thread, so it must not end the request
+ * but tell the main thread what to do with it.
+ */
+static int serve_blocks(request_t *r)
+{
+	block_t*	datablock = &r->outblock;
+	int			n, i;
+
+	for (i = 0; i < 3; i++)
+	{
+		/* get a block (or find a remaining block) */
+		if (datablock->top == datablock->bot)
+		{
+			const char* ferror = session_get_block(r, datablock, r->line_delim_str, r->line_delim_length);
+
+			if (ferror)
+			{
+				r->serve_error = ferror;
+				return SERVE_ERROR;
+			}
+			if (!datablock->top && datablock->ctop == datablock->cbot)
+				return SERVE_EOF;
+		}
+
+		/* is_running keeps send_proto_head() from ending the request */
+		n = send_proto_head(r);
+		if (n < 0)
+		{
+			r->serve_error = "gpfdist send block header failure";
+			return SERVE_ERROR;
+		}
+		else if (n > 0)
+			break;
+
+		n = send_block_data(r, datablock, datablock->top - datablock->bot);
+		if (n < 0)
+		{
+			/* see do_write() */
+			if (errno == EPIPE || errno == ECONNRESET)
+				datablock->bot = datablock->top;
+			r->serve_error = "gpfdist send data failure";
+			return SERVE_ERROR;
+		}
+
+		gdebug(r, "send data bytes off buf %d .. %d (top %d)",
+			   datablock->bot, datablock->bot + n, datablock->top);
+
+		r->bytes += n;
+		r->last = apr_time_now();
+		datablock->bot += n;
+
+		if (datablock->top != datablock->bot)
+		{ /* network chocked */
+			gdebug(r, "network full");
+			break;
+		}
+	}
+
+	return SERVE_MORE;
+}
+
+static void* serve_thread(void* arg)
+{
+	pthread_mutex_lock(&serve_pool.mutex);
+	for (;;)
+	{
+		request_t*	r;
+		int			status;
+
+		while (!serve_pool.head)
+			pthread_cond_wait(&serve_pool.queued, &serve_pool.mutex);
+
+		r = serve_pool.head;
+		serve_pool.head = r->serve_next;
+		if (!serve_pool.head)
+			serve_pool.tail = NULL;
+		r->serve_state = SERVE_RUNNING;
+		r->is_running = 1;
+		pthread_mutex_unlock(&serve_pool.mutex);
+
+		status = serve_blocks(r);
+
+		pthread_mutex_lock(&serve_pool.mutex);
+		r->is_running = 0;
+		r->serve_status = status;
+		r->serve_state = SERVE_DONE;
+		r->serve_next = serve_pool.finished;
+		/* the main thread empties the pipe when it takes the list */
+		if (!serve_pool.finished && write(serve_pool.pipefd[1], "", 1) != 1)
+			gwarning(r, "failed to wake up the main thread: %s", strerror(errno));
+		serve_pool.finished = r;
+		pthread_cond_broadcast(&serve_pool.done);
+	}
+
+	return NULL;
+}
+
+/*
+ * Take the requests served by the serving threads back into the main
+ * thread, and end them or wait for their socket to be writable again.
+ */
+static void serve_done(int fd, short event, void* arg)
+{
+	request_t*	r;
+	request_t*	next;
+	char		buf[64];
+
+	pthread_mutex_lock(&serve_pool.mutex);
+	while (read(fd, buf, sizeof buf) > 0)
+		;
+	r = serve_pool.finished;
+	serve_pool.finished = NULL;
+	for (next = r; next; next = next->serve_next)
+		next->serve_state = SERVE_IDLE;
+	pthread_mutex_unlock(&serve_pool.mutex);
+
+	for (; r; r = next)
+	{
+		next = r->serve_next;
+		r->serve_next = NULL;
+
+		if (r->serve_status == SERVE_EOF)
+			request_end(r, ERROR_CODE_SUCCESS, 0);
+		else if (r->serve_status == SERVE_ERROR)
+		{
+			request_end(r, ERROR_CODE_GENERIC, r->serve_error);
+			gfile_printf_then_putc_newline("ERROR: %s", r->serve_error);
+		}
+		else if (setup_write(r))
+			request_end(r, ERROR_CODE_GENERIC, 0);
+	}
+}
+
+/* Start the serving threads, see --serve_threads */
+static void serve_start(void)
+{
+	pthread_t	thread;
+	int			i;
+
+	if (pipe(serve_pool.pipefd) != 0)
+		gfatal(NULL, "cannot create pipe for serving threads: %s", strerror(errno));
+	if (fcntl(serve_pool.pipefd[0], F_SETFL, O_NONBLOCK) != 0 ||
+		fcntl(serve_pool.pipefd[1], F_SETFL, O_NONBLOCK) != 0)
+		gfatal(NULL, "cannot set up pipe for serving threads: %s", strerror(errno));
+
+	event_set(&serve_pool.ev, serve_pool.pipefd[0], EV_READ | EV_PERSIST, serve_done, 0);
+	if (event_add(&serve_pool.ev, 0))
+		gfatal(NULL, "cannot set up event for serving threads: %s", strerror(errno));
+
+	for (i = 0; i < opt.serve_threads; i++)
+	{
+		int err = pthread_create(&thread, 0, serve_thread, 0);
+
+		if (err)
+			gfatal(NULL, "pthread_create failed with error code %d", err);
+		pthread_detach(thread);
+	}
+
+	gprintln(NULL, "serving requests with %d threads", opt.serve_threads);
+}
+
+/* The socket of r is writable, queue it for the serving threads */
+static void serve_write(request_t *r)
+{
+	pthread_mutex_lock(&serve_pool.mutex);
+	r->serve_state = SERVE_QUEUED;
+	r->serve_next = NULL;
+	if (serve_pool.tail)
+		serve_pool.tail->serve_next = r;
+	else
+		serve_pool.head = r;
+	serve_pool.tail = r;
+	pthread_cond_signal(&serve_pool.queued);
+	pthread_mutex_unlock(&serve_pool.mutex);
+}
+
+static void serve_unlink(request_t **list, request_t **tail, request_t *r)
+{
+	request_t *prev = NULL;
+	request_t *p;
+
+	for (p = *list; p; prev = p, p = p->serve_next)
+	{
+		if (p != r)
+			continue;
+		if (prev)
+			prev->serve_next = r->serve_next;
+		else
+			*list = r->serve_next;
+		if (tail && *tail == r)
+			*tail = prev;
+		break;
+	}
+	r->serve_next = NULL;
+}
+
+/*
+ * Take r back from the serving threads before it is ended, waiting for it
+ * to be served if a thread is working on it.
+ */
+static void serve_wait(request_t *r)
+{
+	if (!opt.serve_threads)
+		return;
+
+	pthread_mutex_lock(&serve_pool.mutex);
+	while (r->serve_state == SERVE_RUNNING)
+		pthread_cond_wait(&serve_pool.done, &serve_pool.mutex);
+	if (r->serve_state == SERVE_QUEUED)
+		serve_unlink(&serve_pool.head, &serve_pool.tail, r);
+	else if (r->serve_state == SERVE_DONE)
+		serve_unlink(&serve_pool.finished, NULL, r);
+	r->serve_state = SERVE_IDLE;
+	pthread_mutex_unlock(&serve_pool.mutex);
+}
+#endif
+
 /*
  * Log request header
  */
@@ -2311,9 +2792,11 @@ static void log_request_header(const request_t *r)
 
 	/* print the complete request to the log if in verbose mode */
 	gprintln(r, "got a request at port %d:", r->port);
+	LOG_LOCK();
 	for (i = 0; i < r->in.req->argc; i++)
 		printf(" %s", r->in.req->argv[i]);
 	printf("\n");
+	LOG_UNLOCK();
 
 	gprintln(r, "request headers:");
 	for (i = 0; i < r->in.req->hc; i++)
@@ -2621,6 +3104,7 @@ static void do_accept(int fd, short event, void* arg)
 
 	/* use the block size specified by -m option */
 	r->outblock.data = palloc_safe(r, pool, opt.m, "out of memory when allocating buffer: %d bytes", opt.m);
+	r->outblock.filefd = -1;
 
 	r->line_delim_str = "";
 	r->line_delim_length = -1;
@@ -3198,22 +3682,25 @@ static char *gstring_trim(char* s)
 	return s;
 }
 
-static char *datetime(apr_time_t t)
+/*
+ * Format t into buf, of DATETIME_LEN bytes.  The serving threads log too, so
+ * this must not use a static buffer.
+ */
+static char *datetime(apr_time_t t, char *buf)
 {
-	static char 	buf[100];
 	apr_time_exp_t 	texp;
 
 	apr_time_exp_lt(&texp, t);
 
-	sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d", 1900 + texp.tm_year, 1
+	snprintf(buf, DATETIME_LEN, "%04d-%02d-%02d %02d:%02d:%02d", 1900 + texp.tm_year, 1
 			+ texp.tm_mon, texp.tm_mday, texp.tm_hour, texp.tm_min, texp.tm_sec);
 
 	return buf;
 }
 
-static char* datetime_now(void)
+static char* datetime_now(char *buf)
 {
-	return datetime(apr_time_now());
+	return datetime(apr_time_now(), buf);
 }
 
 /*
@@ -3237,9 +3724,15 @@ static int ggetpid()
 static void _gprint(const request_t *r, const char *level, const char *fmt, va_list args)
 __attribute__((format(PG_PRINTF_ATTRIBUTE, 3, 0)));
 
+/*
+ * The callers hold LOG_LOCK() until their line is complete, so that lines
+ * logged by the serving threads don't get mixed up.
+ */
 static void _gprint(const request_t *r, const char *level, const char *fmt, va_list args)
 {
-	printf("%s %d %s ", datetime_now(), ggetpid(), level);
+	char		timebuf[DATETIME_LEN];
+
+	printf("%s %d %s ", datetime_now(timebuf), ggetpid(), level);
 	if (r != NULL)
 	{
 		printf("[%ld:%ld:%d:%d] ", GET_SID(r), r->id, r->segid, r->sock);
@@ -3251,7 +3744,9 @@ void gprint(const request_t *r, const char *fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
+	LOG_LOCK();
 	_gprint(r, "INFO", fmt, args);
+	LOG_UNLOCK();
 	va_end(args);
 }
 
@@ -3264,9 +3759,11 @@ void gprintln(const request_t *r, const char *fmt, ...)
 
 	va_list args;
 	va_start(args, fmt);
+	LOG_LOCK();
 	_gprint(r, "INFO", fmt, args);
 	va_end(args);
 	printf("\n");
+	LOG_UNLOCK();
 }
 
 /*
@@ -3284,19 +3781,23 @@ void gprintlnif(const request_t *r, const char *fmt, ...)
 
 	va_list args;
 	va_start(args, fmt);
+	LOG_LOCK();
 	_gprint(r, "INFO", fmt, args);
 	va_end(args);
 	printf("\n");
+	LOG_UNLOCK();
 }
 
 void gfatal(const request_t *r, const char *fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
+	LOG_LOCK();
 	_gprint(r, "FATAL", fmt, args);
 	va_end(args);
 
 	printf("\n          ... exiting\n");
+	LOG_UNLOCK();
 	exit(1);
 }
 
@@ -3304,9 +3805,11 @@ void gwarning(const request_t *r, const char *fmt, ...)
 {
 	va_list args;
 	va_start(args, fmt);
+	LOG_LOCK();
 	_gprint(r, "WARN", fmt, args);
 	va_end(args);
 	printf("\n");
+	LOG_UNLOCK();
 }
 
 void gdebug(const request_t *r, const char *fmt, ...)
@@ -3316,9 +3819,11 @@ void gdebug(const request_t *r, const char *fmt, ...)
 
 	va_list args;
 	va_start(args, fmt);
+	LOG_LOCK();
 	_gprint(r, "DEBUG", fmt, args);
 	va_end(args);
 	printf("\n");
+	LOG_UNLOCK();
 }
 
 
@@ -3327,9 +3832,11 @@ void gfile_printf_then_putc_newline(const char *format, ...)
 	va_list va;
 
 	va_start(va,format);
+	LOG_LOCK();
 	vprintf(format, va);
 	va_end(va);
 	putchar('\n');
+	LOG_UNLOCK();
 }
 
 void *gfile_malloc(size_t size)
@@ -3902,6 +4409,10 @@ static int request_parse_gp_headers(request_t *r, int opt_g)
 #ifdef GPFXDIST
 		else if (0 == strcmp("X-GP-TRANSFORM", r->in.req->hname[i]))
 			r->trans.name = r->in.req->hvalue[i];
+		else if (0 == strcmp("X-GP-COLUMNS", r->in.req->hname[i]))
+			r->trans.columns = r->in.req->hvalue[i];
+		else if (0 == strcmp("X-GP-FILTER", r->in.req->hname[i]))
+			r->trans.filter = r->in.req->hvalue[i];
 #endif
 		else if (0 == strcmp("X-GP-SEQ", r->in.req->hname[i]))
 		{
@@ -4067,6 +4578,10 @@ static int request_set_transform(request_t *r)
     }
 
 	gprintln(r, "transform: %s", r->trans.name);
+	if (r->trans.columns)
+		gdebug(r, "transform columns: %s", r->trans.columns);
+	if (r->trans.filter)
+		gdebug(r, "transform filter: %s", r->trans.filter);
 
 	/*
 	 * propagate details for this transformation
@@ -4186,6 +4701,10 @@ int gpfdist_init(int argc, const char* const argv[])
 
     signal_register();
 	http_setup();
+#ifndef WIN32
+	if (opt.serve_threads)
+		serve_start();
+#endif
 
 #ifdef USE_SSL
 	if (opt.ssl)
@@ -4939,7 +5458,15 @@ static void do_close(int fd, short event, void *arg)
  */
 static void request_cleanup(request_t *r)
 {
+#ifndef WIN32
+	serve_wait(r);
+#endif
 	request_shutdown_sock(r);
+	if (r->outblock.filefd >= 0)
+	{
+		close(r->outblock.filefd);
+		r->outblock.filefd = -1;
+	}
 	setup_do_close(r);
 #ifdef HAVE_LIBZSTD
 	if (r->is_running)
@@ -21,6 +21,8 @@ struct gpfxdist_t
 	char*		cmd;		/* transformation command */
 	int			for_write;	/* 1 if writing to subprocess, 0 if reading from subprocess */
 	int			pass_paths; /* 1 if subprocess expects filename to contain paths to data files, 0 otherwise */
+	const char*	columns;	/* replaces %COLUMNS%, the columns the scan needs, or "" */
+	const char*	filter;		/* replaces %FILTER%, the quals of the scan, or "" */
 
 	apr_pool_t* mp;			/* apache portable runtime memory pool */
 	apr_proc_t	proc;		/* apache portable runtime child process structure */
@@ -0,0 +1,82 @@
+#!/bin/bash
+DBNAME="stressdb"
+PORT=8081
+ROWS=${ROWS:-20000000}
+QUERIES=${QUERIES:-4}
+
+EX_RT="r_big"
+STRUCTURE="(ID_INT int,NAME varchar(255),City varchar(255))"
+FILE="big.txt"
+
+function create_data() {
+    if [ -f ./$FILE ]; then
+        return
+    fi
+
+    echo "generating $ROWS rows into $FILE"
+    awk -v rows=$ROWS 'BEGIN {
+        for (i = 1; i <= rows; i++)
+            printf "%d\tname_%d_abcdefghijklmnopqrstuvwxyz\tcity_%d\n", i, i, i % 1000
+    }' > ./$FILE
+}
+
+function create_database() {
+    if ! psql -lqt | cut -d\| -f 1 | grep -qw $DBNAME; then
+        createdb $DBNAME
+    fi
+
+    psql -c "drop external table if exists $EX_RT;" $DBNAME
+    psql -c "create external table $EX_RT $STRUCTURE location ('gpfdist://127.0.0.1:$PORT/$FILE') format 'text';" $DBNAME
+}
+
+fdist_Pid=
+function run_gpfdist() {
+  gpfdist -p $PORT "$@" >> /dev/null &
+  fdist_Pid=$!
+  sleep 1
+}
+
+# Run $QUERIES scans of the external table at once, every segment of every
+# query pulls its share of the file from gpfdist.
+function run_queries() {
+  local pids=()
+  local start=`date +%s.%N`
+
+  for i in `seq $QUERIES`
+  do
+      psql -qAt -c "select count(*) from $EX_RT;" $DBNAME > /dev/null &
+      pids+=($!)
+  done
+  wait ${pids[@]}
+
+  local end=`date +%s.%N`
+  echo "$end $start" | awk '{ printf "%.2f\n", $1 - $2 }'
+}
+
+function bench() {
+  local label=$1
+  shift
+
+  run_gpfdist "$@"
+  # once to warm up the page cache, then measure
+  run_queries > /dev/null
+  local elapsed=`run_queries`
+  kill -15 $fdist_Pid
+  wait $fdist_Pid 2> /dev/null
+
+  printf "%-40s %8s sec\n" "$label" "$elapsed"
+}
+
+function _main() {
+  create_data
+  create_database
+
+  bench "single thread"
+  bench "--serve_threads 8" --serve_threads 8
+  bench "--read_threads 4" --read_threads 4
+  bench "--serve_threads 8 --read_threads 4" --serve_threads 8 --read_threads 4
+
+  psql -c "drop external table $EX_RT;" $DBNAME
+}
+
+_main
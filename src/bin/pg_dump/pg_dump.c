@@ -13318,6 +13318,10 @@ dumpExternal(Archive *fout, TableInfo *tbinfo, PQExpBuffer q, PQExpBuffer delq)
 				tabfmt = "parquet";
 				customfmt = custom_fmtopts_string(tmpstring);
 				break;
+			case 'o':
+				tabfmt = "columnar";
+				customfmt = custom_fmtopts_string(tmpstring);
+				break;
 			default:
 				tabfmt = "csv";
 		}
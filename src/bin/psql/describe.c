@@ -2166,6 +2166,11 @@ describeOneTableDetails(const char *schemaname,
 					format = "custom";
 				}
 				break;
+				case 'o':
+				{
+					format = "columnar";
+				}
+				break;
 				default:
 				{
 					format = "";
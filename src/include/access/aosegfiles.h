@@ -125,6 +125,7 @@ typedef struct FileSegTotals
 	int64		totalvarblocks; /* the sum of all 'varblockcount' values */
 	int64		totalbytesuncompressed; /* the sum of all 'eofuncompressed'
 										 * values */
+	int64		totalmodcount;	/* the sum of all 'modcount' values */
 } FileSegTotals;
 
 extern FileSegInfo *NewFileSegInfo(int segno);
@@ -0,0 +1,166 @@
+/*-------------------------------------------------------------------------
+ *
+ * extcolumnar.h
+ *	  Declarations for the columnar external table format.
+ *
+ * Data in the columnar format is a sequence of self-contained blocks, each
+ * holding a batch of rows stored column by column.  A block starts with a
+ * fixed size header, all integers in network byte order:
+ *
+ *		magic		4 bytes, "GPCB"
+ *		flags		uint16, see EXTCOLUMNAR_FLAG_*
+ *		ncolumns	uint16
+ *		nrows		uint32
+ *		rawlen		uint32, length of the payload
+ *		datalen		uint32, length of the payload as stored (compressed)
+ *
+ * followed by datalen bytes of payload.  The payload has one section per
+ * column:
+ *
+ *		typid		uint32, type OID of the column
+ *		len			uint32, length of the values that follow
+ *		values		for each row, int32 length (-1 for NULL) followed by
+ *					the value in the binary send/receive format of the type
+ *
+ * With EXTCOLUMNAR_FLAG_STATS, the datalen bytes start with the minimum and
+ * maximum value of each column in the block, kept apart from the payload so
+ * that a reader can tell whether a block can hold any rows it wants without
+ * decompressing it:
+ *
+ *		statslen	uint32, length of the statistics that follow
+ *		for each column, int32 length (-1 if there are no statistics for the
+ *		column) of the minimum, the minimum, and if there is one, int32 length
+ *		and value of the maximum, both in the binary send/receive format
+ *
+ * and the payload, rawlen bytes once decompressed, takes the rest.
+ *
+ * Since every block can be decoded on its own, blocks from several writers
+ * can be interleaved in one file, and gpfdist can hand out any run of whole
+ * blocks to any segment.  This header is also used by gpfdist to find the
+ * block boundaries.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/access/extcolumnar.h
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef EXTCOLUMNAR_H
+#define EXTCOLUMNAR_H
+
+#define EXTCOLUMNAR_MAGIC			"GPCB"
+#define EXTCOLUMNAR_HEADER_SIZE		20
+
+/* the payload is compressed with zstd */
+#define EXTCOLUMNAR_FLAG_ZSTD		0x0001
+/* the payload is preceded by per column statistics */
+#define EXTCOLUMNAR_FLAG_STATS		0x0002
+#define EXTCOLUMNAR_KNOWN_FLAGS		(EXTCOLUMNAR_FLAG_ZSTD | EXTCOLUMNAR_FLAG_STATS)
+
+/* defaults of the format options */
+#define EXTCOLUMNAR_DEFAULT_BLOCK_SIZE	(16 * 1024)
+#define EXTCOLUMNAR_MAX_BLOCK_SIZE		(256 * 1024 * 1024)
+
+typedef struct ExtColumnarBlockHeader
+{
+	uint16		flags;
+	uint16		ncolumns;
+	uint32		nrows;
+	uint32		rawlen;
+	uint32		datalen;
+} ExtColumnarBlockHeader;
+
+static inline uint32
+extcolumnar_get_uint32(const char *p)
+{
+	const unsigned char *u = (const unsigned char *) p;
+
+	return ((uint32) u[0] << 24) | ((uint32) u[1] << 16) |
+		((uint32) u[2] << 8) | (uint32) u[3];
+}
+
+static inline uint16
+extcolumnar_get_uint16(const char *p)
+{
+	const unsigned char *u = (const unsigned char *) p;
+
+	return (uint16) ((u[0] << 8) | u[1]);
+}
+
+/*
+ * Decode the block header at p, which must have EXTCOLUMNAR_HEADER_SIZE bytes
+ * available.  Returns false if it does not look like a block header.
+ */
+static inline bool
+extcolumnar_read_header(const char *p, ExtColumnarBlockHeader *hdr)
+{
+	if (memcmp(p, EXTCOLUMNAR_MAGIC, 4) != 0)
+		return false;
+
+	hdr->flags = extcolumnar_get_uint16(p + 4);
+	hdr->ncolumns = extcolumnar_get_uint16(p + 6);
+	hdr->nrows = extcolumnar_get_uint32(p + 8);
+	hdr->rawlen = extcolumnar_get_uint32(p + 12);
+	hdr->datalen = extcolumnar_get_uint32(p + 16);
+
+	return true;
+}
+
+/*
+ * Return the end of the last complete block in [start, end), start if there
+ * is none.  Stops early at anything that is not a block header, the reader
+ * will complain about it.
+ */
+static inline char *
+extcolumnar_last_block_end(char *start, char *end)
+{
+	char	   *p = start;
+	ExtColumnarBlockHeader hdr;
+
+	while (end - p >= EXTCOLUMNAR_HEADER_SIZE &&
+		   extcolumnar_read_header(p, &hdr) &&
+		   end - p - EXTCOLUMNAR_HEADER_SIZE >= (int64) hdr.datalen)
+		p += EXTCOLUMNAR_HEADER_SIZE + hdr.datalen;
+
+	return p;
+}
+
+#ifndef FRONTEND
+
+#include "access/tupdesc.h"
+#include "lib/stringinfo.h"
+#include "nodes/pg_list.h"
+
+typedef struct ExtColumnarReader ExtColumnarReader;
+typedef struct ExtColumnarWriter ExtColumnarWriter;
+
+extern void extcolumnar_parse_options(List *options, int *block_size,
+						  bool *compress, bool *statistics);
+
+extern ExtColumnarReader *extcolumnar_begin_read(TupleDesc tupdesc);
+extern void extcolumnar_set_projection(ExtColumnarReader *reader, bool *proj);
+extern void extcolumnar_set_filter(ExtColumnarReader *reader, List *quals);
+extern void extcolumnar_add_data(ExtColumnarReader *reader,
+					 const char *data, int len);
+extern bool extcolumnar_next_row(ExtColumnarReader *reader,
+					 Datum *values, bool *nulls);
+extern void extcolumnar_end_of_data(ExtColumnarReader *reader);
+extern uint64 extcolumnar_rows_read(ExtColumnarReader *reader);
+extern void extcolumnar_blocks_read(ExtColumnarReader *reader, uint64 *blocks,
+						uint64 *skipped, uint64 *skippedbytes);
+extern const char *extcolumnar_current_column(ExtColumnarReader *reader);
+extern void extcolumnar_end_read(ExtColumnarReader *reader);
+
+extern ExtColumnarWriter *extcolumnar_begin_write(TupleDesc tupdesc,
+						List *options);
+extern bool extcolumnar_add_row(ExtColumnarWriter *writer,
+					Datum *values, bool *nulls);
+extern void extcolumnar_flush(ExtColumnarWriter *writer, StringInfo out);
+extern void extcolumnar_end_write(ExtColumnarWriter *writer);
+
+#endif   /* !FRONTEND */
+
+#endif   /* EXTCOLUMNAR_H */
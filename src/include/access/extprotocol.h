@@ -40,6 +40,8 @@ typedef struct ExtProtocolData
 	void               *prot_user_ctx;
 	bool               prot_last_call;
 	ExternalSelectDesc desc;
+	char               *prot_columns;         /* see GP_COLUMNS in url.h */
+	char               *prot_filter;          /* see GP_FILTER in url.h */
 } ExtProtocolData;
 
 typedef ExtProtocolData *ExtProtocol;
@@ -54,6 +56,8 @@ typedef ExtProtocolData *ExtProtocol;
 #define EXTPROTOCOL_GET_USER_CTX(fcinfo)   (((ExtProtocolData*) fcinfo->context)->prot_user_ctx)
 #define EXTPROTOCOL_GET_EXTERNAL_SELECT_DESC(fcinfo) (((ExtProtocolData*) fcinfo->context)->desc)
 #define EXTPROTOCOL_IS_LAST_CALL(fcinfo)   (((ExtProtocolData*) fcinfo->context)->prot_last_call)
+#define EXTPROTOCOL_GET_COLUMNS(fcinfo)    (((ExtProtocolData*) fcinfo->context)->prot_columns)
+#define EXTPROTOCOL_GET_FILTER(fcinfo)     (((ExtProtocolData*) fcinfo->context)->prot_filter)
 
 #define EXTPROTOCOL_SET_LAST_CALL(fcinfo)  (((ExtProtocolData*) fcinfo->context)->prot_last_call = true)
 #define EXTPROTOCOL_SET_USER_CTX(fcinfo, p) \
@@ -42,6 +42,9 @@ typedef struct ExternalInsertDescData
 
 	FormatterData *ext_formatter_data;
 
+	/* columnar format encoder, NULL for other formats */
+	struct ExtColumnarWriter *ext_columnar;
+
 	struct CopyStateData *ext_pstate;	/* data parser control chars and state */
 
 } ExternalInsertDescData;
@@ -73,6 +76,9 @@ extern FileScanDesc external_beginscan(Relation relation,
 				   int rejLimit, bool rejLimitInRows,
 				   bool logErrors, int encoding);
 extern void external_rescan(FileScanDesc scan);
+extern void external_set_projection(FileScanDesc scan, bool *proj);
+extern void external_set_filter(FileScanDesc scan, char *filter);
+extern void external_explain(FileScanDesc scan, StringInfo buf);
 extern void external_endscan(FileScanDesc scan);
 extern void external_stopscan(FileScanDesc scan);
 extern ExternalSelectDesc
@@ -127,6 +127,19 @@ typedef struct FileScanDescData
 	List	   *fs_custom_formatter_params; /* list of defelems that hold user's format parameters */
 	FormatterData *fs_formatter;
 
+	/* columnar format decoder, NULL for other formats */
+	struct ExtColumnarReader *fs_columnar;
+	bool	   *fs_proj;		/* columns the scan needs, NULL for all */
+	char	   *fs_filter;		/* quals to pass to the source, or NULL */
+
+	/* for EXPLAIN ANALYZE */
+	uint64		fs_bytesread;	/* bytes received from the source */
+	uint64		fs_blocks;		/* columnar blocks of the readers ended */
+	uint64		fs_blocksskipped;	/* ... and how many were passed over */
+	uint64		fs_bytesskipped;	/* ... of how many bytes */
+	char	   *fs_columns_passed;	/* columns the source was told of */
+	char	   *fs_filter_passed;	/* filter the source was told of */
+
 	/* external partition */
 	bool		fs_hasConstraints;
 	List		**fs_constraintExprs;	
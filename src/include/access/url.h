@@ -62,11 +62,23 @@ typedef struct extvar_t
 	char GP_SESSION_ID[11];  /* session id */
 	char GP_SEGMENT_COUNT[11]; /* total number of (primary) segs in the system */
 	char GP_CSVOPT[15]; /* "m.x...q...h." former -q, -h and -x options for gpfdist.*/
+	bool columnar;		/* data is in the columnar format */
 
  	/* EOL vars */
  	char* GP_LINE_DELIM_STR;
 	char GP_LINE_DELIM_LENGTH[11];
 	char *GP_QUERY_STRING;
+
+	/*
+	 * What a read needs of the source, NULL if not known: the columns in use,
+	 * as a comma-separated list of quoted names, and the quals that it can
+	 * check early, as an SQL boolean expression.  The source may leave the
+	 * other columns NULL and leave out rows that fail the quals, the scan
+	 * checks the rows it gets anyway.  Opening the source sets them to NULL
+	 * if they were not passed on to it.
+	 */
+	char *GP_COLUMNS;
+	char *GP_FILTER;
 } extvar_t;
 
 
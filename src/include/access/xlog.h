@@ -312,6 +312,7 @@ extern XLogRecPtr XLogLastInsertBeginLoc(void);
 extern bool XLogCheckBufferNeedsBackup(Buffer buffer);
 
 extern void XLogFlush(XLogRecPtr RecPtr);
+extern void XLogFlushWithDelay(XLogRecPtr RecPtr, int delay, int siblings);
 extern bool XLogBackgroundFlush(void);
 extern bool XLogNeedsFlush(XLogRecPtr RecPtr);
 extern int	XLogFileInit(XLogSegNo segno, bool *use_existent, bool use_lock);
@@ -37,6 +37,9 @@ CATALOG(pg_appendonly,6105) BKI_WITHOUT_OIDS
     Oid             blkdiridxid;        /* if aoblkdir table, OID of aoblkdir index */
 	Oid             visimaprelid;		/* OID of the aovisimap table */
 	Oid             visimapidxid;		/* OID of aovisimap index */
+	int64			analyzemodcount;	/* master aoseg modcount as of the last
+										 * ANALYZE; -1 if not analyzed since
+										 * creation or TRUNCATE */
 } FormData_pg_appendonly;
 
 /* GPDB added foreign key definitions for gpcheckcat. */
@@ -47,7 +50,7 @@ FOREIGN_KEY(relid REFERENCES pg_class(oid));
  * (there are no var-length fields currentl.)
 */
 #define APPENDONLY_TUPLE_SIZE \
-	 (offsetof(FormData_pg_appendonly,visimapidxid) + sizeof(Oid))
+	 (offsetof(FormData_pg_appendonly,analyzemodcount) + sizeof(int64))
 
 /* ----------------
 *		Form_pg_appendonly corresponds to a pointer to a tuple with
@@ -56,7 +59,7 @@ FOREIGN_KEY(relid REFERENCES pg_class(oid));
 */
 typedef FormData_pg_appendonly *Form_pg_appendonly;
 
-#define Natts_pg_appendonly					12
+#define Natts_pg_appendonly					13
 #define Anum_pg_appendonly_relid			1
 #define Anum_pg_appendonly_blocksize		2
 #define Anum_pg_appendonly_safefswritesize	3
@@ -69,6 +72,7 @@ typedef FormData_pg_appendonly *Form_pg_appendonly;
 #define Anum_pg_appendonly_blkdiridxid      10
 #define Anum_pg_appendonly_visimaprelid     11
 #define Anum_pg_appendonly_visimapidxid     12
+#define Anum_pg_appendonly_analyzemodcount  13
 
 
 /* No initial contents. */
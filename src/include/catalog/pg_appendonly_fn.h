@@ -61,6 +61,12 @@ UpdateAppendOnlyEntryAuxOids(Oid relid,
 							 Oid newVisimaprelid,
 							 Oid newVisimapidxid);
 
+extern int64
+GetAppendOnlyEntryAnalyzeModcount(Oid relid);
+
+extern void
+UpdateAppendOnlyEntryAnalyzeModcount(Oid relid, int64 modcount);
+
 extern void
 RemoveAppendonlyEntry(Oid relid);
 
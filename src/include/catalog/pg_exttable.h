@@ -35,7 +35,7 @@ CATALOG(pg_exttable,6040) BKI_WITHOUT_OIDS
 	Oid		reloid;				/* refers to this relation's oid in pg_class  */
 	text	urilocation[1];		/* array of URI strings */
 	text	execlocation[1];	/* array of ON locations */
-	char	fmttype;			/* 't' (text) or 'c' (csv) */
+	char	fmttype;			/* 't' (text), 'c' (csv), 'b' (custom) or 'o' (columnar) */
 	text	fmtopts;			/* the data format options */
 	text	options[1];			/* the array of external table options */
 	text	command;			/* the command string to EXECUTE */
@@ -124,5 +124,6 @@ extern void RemoveExtTableEntry(Oid relid);
 #define fmttype_is_custom(c) (c == 'b')
 #define fmttype_is_text(c)   (c == 't')
 #define fmttype_is_csv(c)    (c == 'c')
+#define fmttype_is_columnar(c) (c == 'o')
 
 #endif /* PG_EXTTABLE_H */
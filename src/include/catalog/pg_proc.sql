@@ -193,6 +193,7 @@
 
 -- Analyze related
  CREATE FUNCTION gp_acquire_sample_rows(oid, int4, bool) RETURNS SETOF record LANGUAGE internal VOLATILE STRICT EXECUTE ON ALL SEGMENTS AS 'gp_acquire_sample_rows' WITH (OID=6038, DESCRIPTION="Collect a random sample of rows from table" );
+ CREATE FUNCTION gp_acquire_sample_rows(oid, int4, bool, _int2) RETURNS SETOF record LANGUAGE internal VOLATILE STRICT EXECUTE ON ALL SEGMENTS AS 'gp_acquire_sample_rows' WITH (OID=6024, DESCRIPTION="Collect a random sample of the given columns from table" );
 
 -- Backoff related
  CREATE FUNCTION gp_adjust_priority(int4, int4, int4) RETURNS int4 LANGUAGE internal VOLATILE STRICT AS 'gp_adjust_priority_int' WITH (OID=5040, DESCRIPTION="change weight of all the backends for a given session id");
@@ -234,6 +235,10 @@
 
  CREATE FUNCTION gp_request_fts_probe_scan() RETURNS bool LANGUAGE internal VOLATILE AS 'gp_request_fts_probe_scan' EXECUTE ON MASTER WITH (OID=5035, DESCRIPTION="Request a FTS probe scan and wait for response");
 
+ CREATE FUNCTION gp_dtx_commit_batches(OUT batch_size_from int4, OUT batch_size_to int4, OUT batches int8) RETURNS SETOF record LANGUAGE internal VOLATILE AS 'gp_dtx_commit_batches' EXECUTE ON MASTER WITH (OID=7201, DESCRIPTION="number of distributed commit records made durable by each WAL flush on the master");
+
+ CREATE FUNCTION gp_interconnect_get_conn_stats(OUT sess_id int4, OUT command_count int4, OUT pid int4, OUT motion_id int4, OUT dst_content int4, OUT dst_pid int4, OUT fc_method text, OUT packets_sent int8, OUT packets_resent int8, OUT acks int8, OUT srtt int8, OUT rtt_dev int8, OUT min_rtt int8, OUT max_ack_time int8, OUT cwnd float8, OUT ssthresh float8, OUT end_time timestamptz) RETURNS SETOF record LANGUAGE internal VOLATILE AS 'gp_interconnect_get_conn_stats' WITH (OID=7200, DESCRIPTION="statistics of recently closed UDP interconnect connections of this segment");
+
 
  CREATE FUNCTION cosh(float8) RETURNS float8 LANGUAGE internal IMMUTABLE AS 'dcosh' WITH (OID=7539, DESCRIPTION="Hyperbolic cosine function");
 
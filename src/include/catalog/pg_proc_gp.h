@@ -22,7 +22,7 @@
 
    WARNING: DO NOT MODIFY THE FOLLOWING SECTION: 
    Generated by catullus.pl version 8
-   on Wed May 29 10:02:27 2019
+   on Mon Oct 19 04:00:11 2026
 
    Please make your changes in pg_proc.sql
 */
@@ -150,7 +150,6 @@ DESCR("get replication error");
 DATA(insert OID = 7154 ( pg_terminate_backend  PGNSP PGUID 12 1 0 0 0 f f f f t f v 2 0 16 "23 25" _null_ _null_ _null_ _null_ pg_terminate_backend_msg _null_ _null_ _null_ n a ));
 DESCR("terminate a server process");
 
-
 /* pg_resgroup_get_status_kv(IN prop_in text, OUT rsgid oid, OUT prop text, OUT value text) => SETOF pg_catalog.record */
 DATA(insert OID = 6065 ( pg_resgroup_get_status_kv  PGNSP PGUID 12 1 1000 0 0 f f f f f t v 1 0 2249 "25" "{25,26,25,25}" "{i,o,o,o}" "{prop_in,rsgid,prop,value}" _null_ pg_resgroup_get_status_kv _null_ _null_ _null_ n a ));
 DESCR("statistics: information about resource groups in key-value style");
@@ -400,6 +399,10 @@ DESCR("Greenplum fault testing only");
 DATA(insert OID = 6038 ( gp_acquire_sample_rows  PGNSP PGUID 12 1 1000 0 0 f f f f t t v 3 0 2249 "26 23 16" _null_ _null_ _null_ _null_ gp_acquire_sample_rows _null_ _null_ _null_ n s ));
 DESCR("Collect a random sample of rows from table");
 
+/* gp_acquire_sample_rows(oid, int4, bool, _int2) => SETOF record */
+DATA(insert OID = 6024 ( gp_acquire_sample_rows  PGNSP PGUID 12 1 1000 0 0 f f f f t t v 4 0 2249 "26 23 16 1005" _null_ _null_ _null_ _null_ gp_acquire_sample_rows _null_ _null_ _null_ n s ));
+DESCR("Collect a random sample of the given columns from table");
+
 
 /* Backoff related */
 /* gp_adjust_priority(int4, int4, int4) => int4 */
@@ -480,6 +483,14 @@ DESCR("Remove a primary segment from the system catalog");
 DATA(insert OID = 5035 ( gp_request_fts_probe_scan  PGNSP PGUID 12 1 0 0 0 f f f f f f v 0 0 16 "" _null_ _null_ _null_ _null_ gp_request_fts_probe_scan _null_ _null_ _null_ n m ));
 DESCR("Request a FTS probe scan and wait for response");
 
+/* gp_dtx_commit_batches(OUT batch_size_from int4, OUT batch_size_to int4, OUT batches int8) => SETOF record */
+DATA(insert OID = 7201 ( gp_dtx_commit_batches  PGNSP PGUID 12 1 1000 0 0 f f f f f t v 0 0 2249 "" "{23,23,20}" "{o,o,o}" "{batch_size_from,batch_size_to,batches}" _null_ gp_dtx_commit_batches _null_ _null_ _null_ n m ));
+DESCR("number of distributed commit records made durable by each WAL flush on the master");
+
+/* gp_interconnect_get_conn_stats(OUT sess_id int4, OUT command_count int4, OUT pid int4, OUT motion_id int4, OUT dst_content int4, OUT dst_pid int4, OUT fc_method text, OUT packets_sent int8, OUT packets_resent int8, OUT acks int8, OUT srtt int8, OUT rtt_dev int8, OUT min_rtt int8, OUT max_ack_time int8, OUT cwnd float8, OUT ssthresh float8, OUT end_time timestamptz) => SETOF record */
+DATA(insert OID = 7200 ( gp_interconnect_get_conn_stats  PGNSP PGUID 12 1 1000 0 0 f f f f f t v 0 0 2249 "" "{23,23,23,23,23,23,25,20,20,20,20,20,20,20,701,701,1184}" "{o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o}" "{sess_id,command_count,pid,motion_id,dst_content,dst_pid,fc_method,packets_sent,packets_resent,acks,srtt,rtt_dev,min_rtt,max_ack_time,cwnd,ssthresh,end_time}" _null_ gp_interconnect_get_conn_stats _null_ _null_ _null_ n a ));
+DESCR("statistics of recently closed UDP interconnect connections of this segment");
+
 /* cosh(float8) => float8 */
 DATA(insert OID = 7539 ( cosh  PGNSP PGUID 12 1 0 0 0 f f f f f f i 1 0 701 "701" _null_ _null_ _null_ _null_ dcosh _null_ _null_ _null_ n a ));
 DESCR("Hyperbolic cosine function");
@@ -16,6 +16,7 @@
 #ifndef CDBCONN_H
 #define CDBCONN_H
 
+#include "cdb/cdbsrlz.h"
 
 /* --------------------------------------------------------------------------------------------------
  * Structure for segment database definition and working values
@@ -55,6 +56,15 @@ typedef struct SegmentDatabaseDescriptor
 	int						identifier;		/* unique identifier in the cdbcomponent segment pool */
 	double					establishConnTime; /* the time of establish connection to the segment,
 												* -1 means this connection is cached */
+
+	/*
+	 * Ids of the plans the QE keeps in each of its plan cache slots, or 0.
+	 * A plan sent in full is only entered once its command succeeded, until
+	 * then it is the pending plan.
+	 */
+	uint32					dispatchedPlans[MAX_DISPATCHED_PLANS];
+	uint32					pendingPlanId;
+	int						pendingPlanSlot;	/* -1 if none */
 } SegmentDatabaseDescriptor;
 
 SegmentDatabaseDescriptor *
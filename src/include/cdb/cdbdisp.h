@@ -47,6 +47,16 @@ typedef struct CdbDispatcherState
 	int rootGangSize;
 	bool forceDestroyGang;
 	bool isExtendedQuery;
+
+	/*
+	 * For a plan dispatched with a plan id, the query text to send to QEs
+	 * that already keep the plan in planSlot.  It refers to the plan instead
+	 * of carrying it.
+	 */
+	uint32 planId;
+	int planSlot;
+	char *planRefText;
+	int planRefTextLen;
 #ifdef USE_ASSERT_CHECKING
 	bool isGangDestroying;
 #endif
@@ -0,0 +1,28 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbdtxgroupcommit.h
+ *	  Group commit of distributed commit records on the QD.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/cdb/cdbdtxgroupcommit.h
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef CDBDTXGROUPCOMMIT_H
+#define CDBDTXGROUPCOMMIT_H
+
+#include "fmgr.h"
+#include "access/xlogdefs.h"
+
+extern Size DtxGroupCommitShmemSize(void);
+extern void DtxGroupCommitShmemInit(void);
+
+extern void DtxGroupCommitFlush(XLogRecPtr recptr);
+
+extern Datum gp_dtx_commit_batches(PG_FUNCTION_ARGS);
+
+#endif   /* CDBDTXGROUPCOMMIT_H */
@@ -216,6 +216,18 @@ struct MotionConn
 	uint64 dev;
 	uint64 deadlockCheckBeginTime;
 
+	/*
+	 * Congestion window of the delay based flow control, in packets, and
+	 * its slow start threshold.  minRtt is the smallest RTT measured on the
+	 * connection, roundRtt the smallest one of the current round trip, which
+	 * ends once a packet with seq roundEndSeq or later is acked.
+	 */
+	float cwnd;
+	float ssthresh;
+	uint64 minRtt;
+	uint64 roundRtt;
+	uint32 roundEndSeq;
+
 
 	ICBuffer *curBuff;
 
@@ -283,6 +295,12 @@ struct MotionConn
 	int			pkt_q_tail;
 	uint8		**pkt_q;
 
+	/*
+	 * UDPIFC only: shared-memory ring carrying the data packets when the peer
+	 * runs on the same host, NULL if they go over the network.
+	 */
+	struct ICShmRing *shmRing;
+
 	uint64 stat_total_ack_time;
 	uint64 stat_count_acks;
 	uint64 stat_max_ack_time;
@@ -353,6 +371,10 @@ typedef struct ChunkTransportStateEntry
 	uint64 stat_max_resent;
 	uint64 stat_count_dropped;
 
+	/* Bytes of data packets sent through shared memory and the network */
+	uint64 stat_shm_bytes_sent;
+	uint64 stat_udp_bytes_sent;
+
 }	ChunkTransportStateEntry;
 
 /* ChunkTransportState array initial size */
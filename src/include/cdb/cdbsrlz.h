@@ -23,4 +23,16 @@
 extern char *serializeNode(Node *node, int *size, int *uncompressed_size);
 extern Node *deserializeNode(const char *strNode, int size);
 
+/*
+ * Plans dispatched repeatedly can be cached, on the QD in serialized form
+ * and on the QEs in deserialized form.  A QE keeps each plan it receives
+ * with a plan id in one of MAX_DISPATCHED_PLANS slots, chosen by the QD.
+ */
+#define MAX_DISPATCHED_PLANS 64
+
+extern char *serializePlanCached(Node *node, int *size, int *uncompressed_size,
+								 uint32 *planId);
+extern void storeReceivedPlan(uint32 planId, int slot, Node *plan);
+extern Node *lookupReceivedPlan(uint32 planId, int slot);
+
 #endif   /* CDBSRLZ_H */
@@ -110,9 +110,18 @@ typedef enum
 	DTX_PROTOCOL_COMMAND_SUBTRANSACTION_ROLLBACK_INTERNAL,
 	DTX_PROTOCOL_COMMAND_SUBTRANSACTION_RELEASE_INTERNAL,
 
-	DTX_PROTOCOL_COMMAND_LAST = DTX_PROTOCOL_COMMAND_SUBTRANSACTION_RELEASE_INTERNAL
+	/*
+	 * Like PREPARE, but a QE that has not written anything commits right
+	 * away and replies with DTX_READONLY_COMMIT_TAG instead.
+	 */
+	DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY,
+
+	DTX_PROTOCOL_COMMAND_LAST = DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY
 } DtxProtocolCommand;
 
+/* command tag of a QE that committed on DTX_PROTOCOL_COMMAND_PREPARE_SKIP_READONLY */
+#define DTX_READONLY_COMMIT_TAG "Distributed Commit (read-only)"
+
 /* DTX Context above xact.c */
 typedef enum
 {
@@ -235,8 +244,19 @@ typedef struct TMGXACTLOCAL
 
 	bool						writerGangLost;
 
+	/*
+	 * Used on QD, the writer QEs were told to prepare the transaction right
+	 * after running its last statement, and (once the statement finished)
+	 * all of them reported success.
+	 */
+	bool						prepareWithStatement;
+	bool						preparedWithStatement;
+
 	Bitmapset					*dtxSegmentsMap;
 	List						*dtxSegments;
+
+	/* Used on QD, the segments whose QEs reported writing xlog */
+	Bitmapset					*xlogSegmentsMap;
 	List						*waitGxids;
 }	TMGXACTLOCAL;
 
@@ -308,6 +328,12 @@ extern bool isCurrentDtxActivated(void);
 extern void sendDtxExplicitBegin(void);
 extern bool isDtxExplicitBegin(void);
 
+extern void setDtxFinalStatement(PlannedStmt *stmt);
+extern bool isDtxFinalStatement(PlannedStmt *stmt);
+extern void dtxPrepareWithStatement(void);
+extern void dtxPreparedWithStatement(void);
+extern bool isDtxPreparingWithStatement(void);
+
 extern bool dispatchDtxCommand(const char *cmd);
 
 extern void tmShmemInit(void);
@@ -322,6 +348,7 @@ bool		isMppTxOptions_ReadOnly(int txnOptions);
 bool		isMppTxOptions_NeedDtx(int txnOptions);
 bool		isMppTxOptions_ExplicitBegin(int txnOptions);
 bool		isMppTxOptions_SynchronizationSet(int txnOptions);
+bool		isMppTxOptions_PrepareWithStatement(int txnOptions);
 
 extern void getAllDistributedXactStatus(TMGALLXACTSTATUS **allDistributedXactStatus);
 extern bool getNextDistributedXactStatus(TMGALLXACTSTATUS *allDistributedXactStatus, TMGXACTSTATUS **distributedXactStatus);
@@ -345,6 +372,8 @@ extern void markCurrentGxactWriterGangLost(void);
 extern bool currentGxactWriterGangLost(void);
 
 extern void addToGxactDtxSegments(struct Gang* gp);
+extern void removeFromGxactDtxSegments(int segindex);
+extern void addToGxactXLogSegments(int segindex);
 
 extern void ClearTransactionState(TransactionId latestXid);
 
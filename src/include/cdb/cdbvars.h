@@ -163,6 +163,13 @@ extern int qdPostmasterPort;
 /*How many gangs to keep around from stmt to stmt.*/
 extern int			gp_cached_gang_threshold;
 
+/*
+ * How many backends a segment postmaster keeps pre-forked, waiting for QE
+ * connections.  See MaintainBackendPool().
+ */
+extern int			gp_qe_backend_pool_size;
+#define MAX_QE_BACKEND_POOL_SIZE	(128)
+
 /*
  * gp_reject_percent_threshold
  *
@@ -395,6 +402,7 @@ typedef enum GpVars_Interconnect_Method
 {
 	INTERCONNECT_FC_METHOD_CAPACITY = 0,
 	INTERCONNECT_FC_METHOD_LOSS = 2,
+	INTERCONNECT_FC_METHOD_DELAY = 3,
 } GpVars_Interconnect_Method;
 
 extern int Gp_interconnect_fc_method;
@@ -467,6 +475,35 @@ extern bool gp_interconnect_log_stats;
 
 extern bool gp_interconnect_cache_future_packets;
 
+/*
+ * Parameter gp_interconnect_shm
+ *
+ * Let the UDP-interconnect move the data packets between a sender and a
+ * receiver on the same host through shared memory instead of the network.
+ *
+ * Parameter Gp_interconnect_shm_queue_depth
+ *
+ * The number of packets the shared-memory ring of such a pair can hold
+ * before the sender has to wait for the receiver.
+ */
+extern bool gp_interconnect_shm;
+extern int	Gp_interconnect_shm_queue_depth;
+
+/*
+ * Parameter Gp_interconnect_batch_size
+ *
+ * The most packets the UDP-interconnect hands to the kernel in one system
+ * call, when sending the queue of a connection and when reading from its
+ * socket.  1 sends and receives every packet with a call of its own.
+ *
+ * Parameter gp_interconnect_udp_gso
+ *
+ * Let the kernel split runs of equally sized packets to the same peer into
+ * datagrams (UDP generic segmentation offload), where it supports it.
+ */
+extern int	Gp_interconnect_batch_size;
+extern bool gp_interconnect_udp_gso;
+
 #define UNDEF_SEGMENT -2
 
 /*
@@ -809,6 +846,9 @@ extern int gp_segworker_relative_priority;
 /*  Max size of dispatched plans; 0 if no limit */
 extern int gp_max_plan_size;
 
+/* Number of dispatched plans kept for repeated dispatch; 0 if none */
+extern int gp_dispatch_plan_cache_size;
+
 /* If we use two stage hashagg, we can stream the bottom half */
 extern bool gp_hashagg_streambottom;
 
@@ -0,0 +1,28 @@
+/*-------------------------------------------------------------------------
+ *
+ * ic_conn_stats.h
+ *	  Statistics of recently closed UDP interconnect connections.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/cdb/ic_conn_stats.h
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef IC_CONN_STATS_H
+#define IC_CONN_STATS_H
+
+#include "fmgr.h"
+#include "cdb/cdbinterconnect.h"
+
+extern Size ICConnStatsShmemSize(void);
+extern void ICConnStatsShmemInit(void);
+
+extern void ICConnStatsReport(MotionConn *conn, int motNodeId);
+
+extern Datum gp_interconnect_get_conn_stats(PG_FUNCTION_ARGS);
+
+#endif   /* IC_CONN_STATS_H */
@@ -76,6 +76,12 @@ extern void CleanUpMotionLayerIPC(void);
  */
 extern void WaitInterconnectQuit(void);
 
+/*
+ * Remove the shared-memory rings of the UDP interconnect that belong to
+ * processes that are gone.  Called once at postmaster start.
+ */
+extern void RemoveStaleInterconnectShmRings(void);
+
 /*
  * checkForCancelFromQD
  * 		Check for cancel from QD.
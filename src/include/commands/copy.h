@@ -74,6 +74,9 @@ typedef struct ProgramPipes
  *    or vice versa.
  * 3. Executor mode. We are receiving pre-processed data from QD, and inserting to table.
  *
+ * With SEGMENT_PARSE, the QD runs neither of these, see CopyFromSegmentParse(),
+ * and the QEs run in direct mode, reading the raw lines that the QD forwards.
+ *
  * COPY TO modes (table/query to file/client)
  *
  * 1. Direct. This can mean ON SEGMENT running on segment, or utility mode, or
@@ -248,8 +251,14 @@ typedef struct CopyStateData
 	bool          skip_ext_partition;  /* skip external partition */
 
 	bool		on_segment; /* QE save data files locally */
+	bool		compress;	/* gzip the data files of ON SEGMENT */
+	struct CopyCompressState *compress_state;	/* QE: zlib stream, if compress */
+	char	   *manifest;	/* QD: manifest to write for COPY TO ON SEGMENT */
 	bool		ignore_extra_line; /* Don't count CSV header or binary trailer in
 									  "processed" line number for on_segment mode*/
+	bool		segment_parse;	/* QEs parse the data, QD only splits it */
+	Oid			segment_parse_stage;	/* QE: staging table for the rows of
+										 * other segments, in SEGMENT_PARSE */
 	ProgramPipes	*program_pipes; /* COPY PROGRAM pipes for data and stderr */
 
 
@@ -234,6 +234,7 @@ extern int acquire_sample_rows(Relation onerel, int elevel,
 extern int acquire_inherited_sample_rows(Relation onerel, int elevel,
 							  HeapTuple *rows, int targrows,
 							  double *totalrows, double *totaldeadrows);
+extern Bitmapset *acquire_func_colsToSample;
 
 /* in commands/analyzefuncs.c */
 extern Datum gp_acquire_sample_rows(PG_FUNCTION_ARGS);
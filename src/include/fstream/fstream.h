@@ -16,6 +16,7 @@ typedef struct fstream_t fstream_t;
 struct fstream_options{
     int header;
     int is_csv;
+    int is_columnar;	/* data is in blocks of the columnar format */
     int verbose;
     char quote;		/* quote char */
     char escape;	/* escape char */
@@ -23,6 +24,7 @@ struct fstream_options{
     int bufsize;
     int forwrite;   /* true for write, false for read */
 	int usesync;    /* true if writes use O_SYNC */
+    int read_threads;	/* threads reading each file in parallel, 0 for none */
     struct gpfxdist_t* transform;	/* for gpfxdist transformations */
 };
 
@@ -48,6 +50,13 @@ int fstream_eof(fstream_t* fs);
 int64_t fstream_get_compressed_size(fstream_t* fs);
 int64_t fstream_get_compressed_position(fstream_t* fs);
 const char* fstream_get_error(fstream_t* fs);
+/* fstream_read_range() cannot hand out the next chunk, use fstream_read() */
+#define FSTREAM_RANGE_UNAVAILABLE (-2)
+
+int fstream_read_range(fstream_t* fs, int size,
+					   struct fstream_filename_and_offset* fo,
+					   const char* line_delim_str, const int line_delim_length,
+					   int* filefd, int64_t* offset);
 fstream_t* fstream_open(const char* path, const struct fstream_options* options,
 						int* response_code, const char** response_string);
 void fstream_close(fstream_t* fs);
@@ -84,6 +84,7 @@ typedef struct gfile_t
 	compression_type compression;
 
 	struct gpfxdist_t* transform;
+	struct prefetch_stuff* prefetch; /* parallel reads, see gfile_prefetch() */
 }gfile_t;
 
 /*
@@ -96,6 +97,8 @@ int gfile_open_flags(int writing, int usesync);
 
 int gfile_open(gfile_t* fd, const char* fpath, int flags, int* response_code, const char** response_string, struct gpfxdist_t* transform);
 int gfile_close(gfile_t*fd);
+bool_t gfile_prefetch(gfile_t* fd, int nthreads);
+int gfile_get_plain_fd(gfile_t* fd, off_t* size);
 off_t gfile_get_compressed_size(gfile_t*fd);
 off_t gfile_get_compressed_position(gfile_t*fd);
 ssize_t gfile_read(gfile_t* fd, void* ptr, size_t len); /* gfile_read reads as much as it can--short read indicates error. */
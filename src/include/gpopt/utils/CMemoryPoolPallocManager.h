@@ -34,6 +34,9 @@ public:
 	// allocate new memorypool
 	virtual CMemoryPool *NewMemoryPool();
 
+	// allocate new arena memorypool
+	virtual CMemoryPool *NewArenaMemoryPool();
+
 	// free allocation
 	void DeleteImpl(void *ptr, CMemoryPool::EAllocationType eat);
 
@@ -142,6 +142,13 @@ private:
 	// helper for converting wide character string to regular string
 	static CHAR *CreateMultiByteCharStringFromWCString(const WCHAR *wcstr);
 
+	// load cost model parameters from given path
+	static void LoadCostModelParams(CMemoryPool *mp, ICostModel *cost_model,
+									char *path);
+
+	// parse cost model parameters from given path into the cache
+	static BOOL ParseCostModelParams(CMemoryPool *mp, char *path);
+
 	// set cost model parameters
 	static void SetCostModelParams(ICostModel *cost_model);
 
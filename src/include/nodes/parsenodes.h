@@ -3397,6 +3397,7 @@ typedef struct RetrieveStmt
 	char		*endpoint_name;
 	int64		count;
 	bool		is_all;
+	List		*options;		/* WITH options, a list of DefElem */
 } RetrieveStmt;
 
 #endif   /* PARSENODES_H */
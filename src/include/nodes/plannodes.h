@@ -153,6 +153,9 @@ typedef struct PlannedStmt
 
 	int			total_memory_master;	/* GPDB: The total usable virtual memory on master node in MB */
 	int			nsegments_master;		/* GPDB: The number of primary segments on master node  */
+
+	/* GPDB: peak memory used by GPORCA to produce this plan, in bytes */
+	uint64		optimizer_peak_memory;
 } PlannedStmt;
 
 /*
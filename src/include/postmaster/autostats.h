@@ -44,5 +44,7 @@ extern void autostats_get_cmdtype(QueryDesc *queryDesc,
 					  AutoStatsCmdType *pcmdType, Oid *prelationOid);
 extern void auto_stats(AutoStatsCmdType cmdType, Oid relationOid,
 		   uint64 ntuples, bool inFunction);
+extern bool auto_stats_may_analyze(AutoStatsCmdType cmdType, Oid relationOid,
+					   bool inFunction);
 
 #endif   /* AUTOSTATS_H */
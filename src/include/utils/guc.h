@@ -298,6 +298,10 @@ extern bool gp_create_table_random_default_distribution;
 extern bool gp_allow_non_uniform_partitioning_ddl;
 extern bool gp_enable_exchange_default_partition;
 extern int  dtx_phase2_retry_count;
+extern bool gp_dtx_prepare_with_statement;
+extern bool gp_dtx_skip_readonly_segments;
+extern int	gp_dtx_commit_delay;
+extern int	gp_dtx_commit_siblings;
 extern bool gp_log_suboverflow_statement;
 extern bool gp_use_synchronize_seqscans_catalog_vacuum_full;
 
@@ -456,6 +460,7 @@ extern bool optimizer_print_xform_results;
 /* array of xforms disable flags */
 extern bool optimizer_xforms[OPTIMIZER_XFORMS_COUNT];
 extern char *optimizer_search_strategy_path;
+extern char *optimizer_cost_model_params_path;
 
 /* GUCs to tell Optimizer to enable a physical operator */
 extern bool optimizer_enable_indexjoin;
@@ -559,8 +564,10 @@ extern bool optimizer_enable_range_predicate_dpe;
 extern bool optimizer_analyze_root_partition;
 extern bool optimizer_analyze_midlevel_partition;
 extern bool optimizer_analyze_enable_merge_of_leaf_stats;
+extern bool gp_analyze_skip_unchanged_ao;
 
 extern bool optimizer_use_gpdb_allocators;
+extern bool optimizer_use_arena_allocator;
 extern bool optimizer_enable_table_alias;
 
 /* optimizer GUCs for replicated table */
@@ -598,6 +605,7 @@ extern bool gp_external_enable_filter_pushdown;
 extern bool gp_enable_global_deadlock_detector;
 
 extern bool gp_log_endpoints;
+extern int	gp_endpoint_queue_size;
 
 extern bool gp_allow_date_field_width_5digits;
 
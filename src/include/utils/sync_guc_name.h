@@ -23,6 +23,7 @@
 		"gp_enable_mk_sort",
 		"gp_enable_motion_mk_sort",
 		"gp_enable_segment_copy_checking",
+		"gp_endpoint_queue_size",
 		"gp_external_enable_filter_pushdown",
 		"gp_gpperfmon_send_interval",
 		"gp_hashagg_default_nbatches",
@@ -32,6 +33,7 @@
 		"gp_indexcheck_insert",
 		"gp_indexcheck_vacuum",
 		"gp_initial_bad_row_limit",
+		"gp_interconnect_batch_size",
 		"gp_interconnect_cursor_ic_table_size",
 		"gp_interconnect_debug_retry_interval",
 		"gp_interconnect_default_rtt",
@@ -43,12 +45,15 @@
 		"gp_interconnect_proxy_addresses",
 		"gp_interconnect_queue_depth",
 		"gp_interconnect_setup_timeout",
+		"gp_interconnect_shm",
+		"gp_interconnect_shm_queue_depth",
 		"gp_interconnect_snd_queue_depth",
 		"gp_interconnect_tcp_listener_backlog",
 		"gp_interconnect_timer_checking_period",
 		"gp_interconnect_timer_period",
 		"gp_interconnect_transmit_timeout",
 		"gp_interconnect_type",
+		"gp_interconnect_udp_gso",
 		"gp_interconnect_address_type",
 		"gp_log_endpoints",
 		"gp_log_interconnect",
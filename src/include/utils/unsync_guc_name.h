@@ -139,6 +139,7 @@
 		"gp_adjust_selectivity_for_outerjoins",
 		"gp_allow_non_uniform_partitioning_ddl",
 		"gp_allow_rename_relation_without_lock",
+		"gp_analyze_skip_unchanged_ao",
 		"gp_appendonly_compaction",
 		"gp_appendonly_compaction_threshold",
 		"gp_appendonly_verify_block_checksums",
@@ -162,9 +163,14 @@
 		"gp_dispatch_keepalives_idle",
 		"gp_dispatch_keepalives_interval",
 		"gp_dispatch_keepalives_count",
+		"gp_dispatch_plan_cache_size",
 		"gp_distinct_grouping_sets_threshold",
+		"gp_dtx_commit_delay",
+		"gp_dtx_commit_siblings",
+		"gp_dtx_prepare_with_statement",
 		"gp_dtx_recovery_interval",
 		"gp_dtx_recovery_prepared_period",
+		"gp_dtx_skip_readonly_segments",
 		"gp_dynamic_partition_pruning",
 		"gp_eager_agg_distinct_pruning",
 		"gp_eager_one_phase_agg",
@@ -232,6 +238,7 @@
 		"gp_print_create_gang_time",
 		"gp_qd_hostname",
 		"gp_qd_port",
+		"gp_qe_backend_pool_size",
 		"gp_recursive_cte",
 		"gp_recursive_cte_prototype",
 		"gp_reject_internal_tcp_connection",
@@ -355,6 +362,7 @@
 		"optimizer_array_expansion_threshold",
 		"optimizer_control",
 		"optimizer_cost_model",
+		"optimizer_cost_model_params_path",
 		"optimizer_cost_threshold",
 		"optimizer_cte_inlining",
 		"optimizer_damping_factor_filter",
@@ -455,6 +463,7 @@
 		"optimizer_sort_factor",
 		"optimizer_trace_fallback",
 		"optimizer_skew_factor",
+		"optimizer_use_arena_allocator",
 		"optimizer_use_external_constant_expression_evaluation_for_ints",
 		"optimizer_use_gpdb_allocators",
 		"optimizer_enable_table_alias",
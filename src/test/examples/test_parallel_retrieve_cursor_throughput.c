@@ -0,0 +1,309 @@
+/*
+ * src/test/examples/test_parallel_retrieve_cursor_throughput.c
+ *
+ * this program only supports gpdb with the PARALLEL RETRIEVE CURSOR feature.
+ * It measures how fast RETRIEVE ALL moves the rows of a PARALLEL RETRIEVE
+ * CURSOR to the client, retrieving from all endpoints in parallel, once for
+ * each way a retrieve session can get the rows:
+ *
+ *		text		one protocol row per tuple, values in text
+ *		binary		one protocol row per tuple, values in binary
+ *		batch		RETRIEVE ... WITH (format 'batch'), many tuples per row
+ *		columnar	RETRIEVE ... WITH (format 'columnar'), many tuples per row
+ *
+ * Try it with different gp_endpoint_queue_size settings, in PGOPTIONS.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include "libpq-fe.h"
+
+#define DEFAULT_ROWS 10000000
+
+typedef struct RetrieveMode
+{
+	const char *name;
+	const char *options;		/* appended to the RETRIEVE statement */
+	int			resultFormat;
+	int			batched;		/* 1: batch, 2: columnar */
+} RetrieveMode;
+
+static const RetrieveMode modes[] = {
+	{"text", "", 0, 0},
+	{"binary", "", 1, 0},
+	{"batch", " WITH (format 'batch')", 1, 1},
+	{"columnar", " WITH (format 'columnar')", 1, 2},
+};
+
+typedef struct Endpoint
+{
+	char	   *host;
+	char	   *port;
+	char	   *token;
+	char	   *name;
+	const RetrieveMode *mode;
+	const char *dbName;
+	const char *dbUser;
+	pthread_t	thread;
+	long long	rows;
+	long long	bytes;
+	int			failed;
+} Endpoint;
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static int
+exec_command(PGconn *conn, const char *sql)
+{
+	PGresult   *res = PQexec(conn, sql);
+
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+	{
+		fprintf(stderr, "\"%s\" failed: %s", sql, PQerrorMessage(conn));
+		PQclear(res);
+		return 1;
+	}
+	PQclear(res);
+	return 0;
+}
+
+/* number of tuples in a row of RETRIEVE ... WITH (format 'batch') */
+static long long
+count_batch_tuples(const char *p, int len)
+{
+	const char *end = p + len;
+	long long	ntuples = 0;
+
+	while (p < end)
+	{
+		uint16_t	natts;
+
+		memcpy(&natts, p, 2);
+		p += 2;
+		for (int i = 0; i < ntohs(natts); i++)
+		{
+			int32_t		vlen;
+
+			memcpy(&vlen, p, 4);
+			p += 4;
+			vlen = ntohl(vlen);
+			if (vlen > 0)
+				p += vlen;
+		}
+		ntuples++;
+	}
+	return ntuples;
+}
+
+/* number of tuples in a row of RETRIEVE ... WITH (format 'columnar') */
+static long long
+count_columnar_tuples(const char *p, int len)
+{
+	const char *end = p + len;
+	long long	ntuples = 0;
+
+	/* see src/include/access/extcolumnar.h for the block header */
+	while (end - p >= 20)
+	{
+		uint32_t	nrows;
+		uint32_t	datalen;
+
+		memcpy(&nrows, p + 8, 4);
+		memcpy(&datalen, p + 16, 4);
+		ntuples += ntohl(nrows);
+		p += 20 + ntohl(datalen);
+	}
+	return ntuples;
+}
+
+/* this function is run by one thread per endpoint */
+static void *
+retrieve_threadfunc(void *arg)
+{
+	Endpoint   *ep = (Endpoint *) arg;
+	PGconn	   *conn;
+	PGresult   *res;
+	char		sql[256];
+
+	conn = PQsetdbLogin(ep->host, ep->port, "-c gp_retrieve_conn=true", NULL,
+						ep->dbName, ep->dbUser, ep->token);
+	if (PQstatus(conn) != CONNECTION_OK)
+	{
+		fprintf(stderr, "Connection to endpoint \"%s\" failed: %s",
+				ep->name, PQerrorMessage(conn));
+		ep->failed = 1;
+		PQfinish(conn);
+		return NULL;
+	}
+
+	snprintf(sql, sizeof(sql), "RETRIEVE ALL FROM ENDPOINT %s%s;",
+			 ep->name, ep->mode->options);
+	res = PQexecParams(conn, sql, 0, NULL, NULL, NULL, NULL,
+					   ep->mode->resultFormat);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+	{
+		fprintf(stderr, "\"%s\" failed: %s", sql, PQerrorMessage(conn));
+		ep->failed = 1;
+	}
+	else
+	{
+		int			nrows = PQntuples(res);
+		int			nfields = PQnfields(res);
+
+		for (int i = 0; i < nrows; i++)
+		{
+			for (int j = 0; j < nfields; j++)
+				ep->bytes += PQgetlength(res, i, j);
+
+			if (ep->mode->batched == 1)
+				ep->rows += count_batch_tuples(PQgetvalue(res, i, 0),
+											   PQgetlength(res, i, 0));
+			else if (ep->mode->batched == 2)
+				ep->rows += count_columnar_tuples(PQgetvalue(res, i, 0),
+												  PQgetlength(res, i, 0));
+			else
+				ep->rows++;
+		}
+	}
+
+	PQclear(res);
+	PQfinish(conn);
+	return NULL;
+}
+
+static int
+run_mode(PGconn *master_conn, const RetrieveMode *mode,
+		 const char *dbName, const char *dbUser)
+{
+	PGresult   *res;
+	Endpoint   *endpoints;
+	int			nendpoints;
+	long long	rows = 0;
+	long long	bytes = 0;
+	int			failed = 0;
+	double		start;
+	double		elapsed;
+
+	if (exec_command(master_conn, "BEGIN;") != 0 ||
+		exec_command(master_conn, "DECLARE myportal PARALLEL RETRIEVE CURSOR FOR SELECT * FROM public.tab_parallel_cursor_throughput;") != 0)
+		return 1;
+
+	res = PQexec(master_conn, "select hostname,port,auth_token,endpointname from pg_catalog.gp_get_endpoints() where cursorname='myportal';");
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+	{
+		fprintf(stderr, "gp_get_endpoints() failed: %s", PQerrorMessage(master_conn));
+		PQclear(res);
+		return 1;
+	}
+
+	nendpoints = PQntuples(res);
+	endpoints = calloc(nendpoints, sizeof(Endpoint));
+	for (int i = 0; i < nendpoints; i++)
+	{
+		endpoints[i].host = strdup(PQgetvalue(res, i, 0));
+		endpoints[i].port = strdup(PQgetvalue(res, i, 1));
+		endpoints[i].token = strdup(PQgetvalue(res, i, 2));
+		endpoints[i].name = strdup(PQgetvalue(res, i, 3));
+		endpoints[i].mode = mode;
+		endpoints[i].dbName = dbName;
+		endpoints[i].dbUser = dbUser;
+	}
+	PQclear(res);
+
+	start = now();
+	for (int i = 0; i < nendpoints; i++)
+		pthread_create(&endpoints[i].thread, NULL, retrieve_threadfunc, &endpoints[i]);
+	for (int i = 0; i < nendpoints; i++)
+	{
+		pthread_join(endpoints[i].thread, NULL);
+		rows += endpoints[i].rows;
+		bytes += endpoints[i].bytes;
+		failed |= endpoints[i].failed;
+	}
+	elapsed = now() - start;
+
+	if (!failed)
+		printf("%-10s %12lld rows %8.2f sec %10.0f rows/s %8.2f MB/s\n",
+			   mode->name, rows, elapsed, rows / elapsed,
+			   bytes / elapsed / (1024 * 1024));
+
+	for (int i = 0; i < nendpoints; i++)
+	{
+		free(endpoints[i].host);
+		free(endpoints[i].port);
+		free(endpoints[i].token);
+		free(endpoints[i].name);
+	}
+	free(endpoints);
+
+	if (exec_command(master_conn, failed ? "ROLLBACK;" : "COMMIT;") != 0)
+		return 1;
+	return failed;
+}
+
+int
+main(int argc, char **argv)
+{
+	char	   *dbName,
+			   *dbUser;
+	long		rows = DEFAULT_ROWS;
+	char		sql[512];
+	PGconn	   *master_conn;
+	int			retVal = 0;
+
+	if (argc != 3 && argc != 4)
+	{
+		fprintf(stderr, "usage: %s dbUser dbName [rows]\n", argv[0]);
+		fprintf(stderr, "      measure the throughput of RETRIEVE ALL from all endpoints of a PARALLEL RETRIEVE CURSOR.\n");
+		exit(1);
+	}
+	dbUser = argv[1];
+	dbName = argv[2];
+	if (argc == 4)
+		rows = atol(argv[3]);
+
+	master_conn = PQsetdb(NULL, NULL, NULL, NULL, dbName);
+	if (PQstatus(master_conn) != CONNECTION_OK)
+	{
+		fprintf(stderr, "Connection to database \"%s\" failed: %s",
+				dbName, PQerrorMessage(master_conn));
+		PQfinish(master_conn);
+		exit(1);
+	}
+
+	printf("generating %ld rows\n", rows);
+	snprintf(sql, sizeof(sql),
+			 "CREATE TABLE public.tab_parallel_cursor_throughput AS "
+			 "SELECT id, id * 2 AS b, 'name_' || id AS c, now() AS d "
+			 "FROM pg_catalog.generate_series(1, %ld) id;", rows);
+	if (exec_command(master_conn, "DROP TABLE IF EXISTS public.tab_parallel_cursor_throughput;") != 0 ||
+		exec_command(master_conn, sql) != 0)
+	{
+		PQfinish(master_conn);
+		exit(1);
+	}
+
+	for (int i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+	{
+		if (run_mode(master_conn, &modes[i], dbName, dbUser) != 0)
+		{
+			retVal = 1;
+			break;
+		}
+	}
+
+	exec_command(master_conn, "DROP TABLE IF EXISTS public.tab_parallel_cursor_throughput;");
+	PQfinish(master_conn);
+	return retVal;
+}
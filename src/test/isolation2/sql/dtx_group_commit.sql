@@ -0,0 +1,64 @@
+-- Concurrent distributed commits share the WAL flush of their commit
+-- records on the master when gp_dtx_commit_delay is set: the backend that
+-- flushes waits, and the commit records written meanwhile are made durable
+-- by the same flush.
+--
+-- The wait is replaced by a fault that holds the first commit in the flush,
+-- with the WAL write lock, until the other three have written their commit
+-- records, so that all four end up in one batch.
+CREATE EXTENSION IF NOT EXISTS gp_inject_fault;
+CREATE TABLE dtx_group_commit (a int) DISTRIBUTED BY (a);
+
+1: SET gp_dtx_commit_delay = 1000;
+1: SET gp_dtx_commit_siblings = 0;
+2: SET gp_dtx_commit_delay = 1000;
+2: SET gp_dtx_commit_siblings = 0;
+3: SET gp_dtx_commit_delay = 1000;
+3: SET gp_dtx_commit_siblings = 0;
+4: SET gp_dtx_commit_delay = 1000;
+4: SET gp_dtx_commit_siblings = 0;
+
+1: BEGIN;
+2: BEGIN;
+3: BEGIN;
+4: BEGIN;
+1: INSERT INTO dtx_group_commit SELECT generate_series(1, 100);
+2: INSERT INTO dtx_group_commit SELECT generate_series(1, 100);
+3: INSERT INTO dtx_group_commit SELECT generate_series(1, 100);
+4: INSERT INTO dtx_group_commit SELECT generate_series(1, 100);
+
+CREATE TABLE dtx_group_commit_before AS SELECT * FROM gp_dtx_commit_batches() DISTRIBUTED RANDOMLY;
+
+SELECT gp_inject_fault('xlog_flush_with_delay', 'suspend', 1);
+SELECT gp_inject_fault_infinite('dtx_group_commit_flush', 'skip', 1);
+
+1>: COMMIT;
+SELECT gp_wait_until_triggered_fault('xlog_flush_with_delay', 1, 1);
+2>: COMMIT;
+3>: COMMIT;
+4>: COMMIT;
+-- the first commit and the three that queued up behind it
+SELECT gp_wait_until_triggered_fault('dtx_group_commit_flush', 4, 1);
+SELECT gp_inject_fault('xlog_flush_with_delay', 'resume', 1);
+1<:
+2<:
+3<:
+4<:
+
+SELECT gp_inject_fault('xlog_flush_with_delay', 'reset', 1);
+SELECT gp_inject_fault('dtx_group_commit_flush', 'reset', 1);
+
+-- The commit of the table above was a batch of its own, the four commits
+-- were made durable by one flush
+SELECT n.batch_size_from, n.batch_size_to, n.batches - o.batches AS batches
+  FROM gp_dtx_commit_batches() n JOIN dtx_group_commit_before o USING (batch_size_from)
+  ORDER BY 1;
+SELECT count(*) FROM dtx_group_commit;
+
+1q:
+2q:
+3q:
+4q:
+
+DROP TABLE dtx_group_commit_before;
+DROP TABLE dtx_group_commit;
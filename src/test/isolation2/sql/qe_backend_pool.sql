@@ -0,0 +1,47 @@
+-- Segments hand new QE connections to pre-forked backends when
+-- gp_qe_backend_pool_size is set.
+!\retcode gpconfig -c gp_qe_backend_pool_size -v 2;
+!\retcode gpstop -u;
+
+SELECT DISTINCT current_setting('gp_qe_backend_pool_size') FROM gp_dist_random('gp_id');
+
+CREATE TABLE qe_backend_pool (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO qe_backend_pool SELECT i, i FROM generate_series(1, 100) i;
+
+-- QEs come from the pool
+SELECT gp_inject_fault_infinite('qe_backend_pool_connection', 'skip', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+
+-- More sessions than pooled backends, the rest of the QEs are forked
+-- as usual
+1: SELECT count(*) FROM qe_backend_pool t1 JOIN qe_backend_pool t2 ON t1.a = t2.b;
+2: SELECT count(*) FROM qe_backend_pool t1 JOIN qe_backend_pool t2 ON t1.a = t2.b;
+3: SELECT count(*) FROM qe_backend_pool t1 JOIN qe_backend_pool t2 ON t1.a = t2.b;
+4: SELECT count(*) FROM qe_backend_pool t1 JOIN qe_backend_pool t2 ON t1.a = t2.b;
+
+SELECT gp_wait_until_triggered_fault('qe_backend_pool_connection', 1, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+SELECT gp_inject_fault('qe_backend_pool_connection', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+
+-- Options of the session reach the QEs that came from the pool
+5: SET statement_mem = '10MB';
+5: SELECT DISTINCT current_setting('statement_mem') FROM gp_dist_random('gp_id');
+
+1q:
+2q:
+3q:
+4q:
+5q:
+
+-- A reload replaces the pooled backends: the ones forked before it exit
+!\retcode for i in $(seq 60); do pgrep -f 'pooled[ ]backend' > /tmp/qe_backend_pool.pids && exit 0; sleep 1; done; exit 1;
+!\retcode gpstop -u;
+!\retcode for i in $(seq 60); do alive=0; for pid in $(cat /tmp/qe_backend_pool.pids); do kill -0 $pid 2>/dev/null && alive=1; done; [ $alive = 0 ] && exit 0; sleep 1; done; exit 1;
+6: SELECT count(*) FROM qe_backend_pool t1 JOIN qe_backend_pool t2 ON t1.a = t2.b;
+6q:
+
+!\retcode gpconfig -r gp_qe_backend_pool_size;
+!\retcode gpstop -u;
+
+7: SELECT count(*) FROM qe_backend_pool t1 JOIN qe_backend_pool t2 ON t1.a = t2.b;
+7q:
+
+DROP TABLE qe_backend_pool;
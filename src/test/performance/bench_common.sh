@@ -0,0 +1,63 @@
+## Sourced by the *_bench.sh scripts.
+##
+## Each of them sets up a table with bench_psql, then either times a command
+## over a few rounds and keeps the best time, or runs pgbench with a GUC at
+## different values, and prints one line of results per run.
+
+# Temporary files made by bench_tmpfile, removed when the script exits.
+BENCH_TMPFILES=
+trap 'rm -f ${BENCH_TMPFILES}' EXIT
+
+# bench_tmpfile VAR: make a temporary file and store its name in VAR.
+bench_tmpfile() {
+  local file
+  file=$(mktemp) || exit 1
+  BENCH_TMPFILES="${BENCH_TMPFILES} ${file}"
+  eval "$1=${file}"
+}
+
+# bench_psql ARGS...: run psql quietly, and stop the benchmark on an error.
+bench_psql() {
+  psql -X -q -v ON_ERROR_STOP=1 "$@" || exit 1
+}
+
+# bench_now: the wall clock time in seconds.
+bench_now() {
+  date +%s.%N
+}
+
+# bench_since START: the seconds elapsed since START.
+bench_since() {
+  echo "$(bench_now) - $1" | bc
+}
+
+# bench_copy_best ROUNDS TABLE DATAFILE [OPTIONS]: load DATAFILE into the
+# emptied TABLE with COPY FROM STDIN ROUNDS times, and print the best time.
+# Call it as best=$(bench_copy_best ...) || exit 1.
+bench_copy_best() {
+  local rounds=$1 table=$2 datafile=$3 opts=$4
+  local best= start elapsed
+
+  for round in $(seq 1 ${rounds}); do
+    psql -X -q -c "TRUNCATE ${table}" || return 1
+    start=$(bench_now)
+    psql -X -q -v ON_ERROR_STOP=1 -c "COPY ${table} FROM STDIN ${opts}" < ${datafile} || return 1
+    elapsed=$(bench_since ${start})
+    if [ -z "${best}" ] || [ $(echo "${elapsed} < ${best}" | bc) -eq 1 ]; then
+      best=${elapsed}
+    fi
+  done
+  echo ${best}
+}
+
+# bench_pgbench CLIENTS DURATION GUC VALUE PGBENCH_ARGS...: run pgbench with
+# CLIENTS clients for DURATION seconds and GUC set to VALUE, and print the
+# transactions per second and the average latency.
+bench_pgbench() {
+  local clients=$1 duration=$2 guc=$3 value=$4
+  shift 4
+
+  PGOPTIONS="-c ${guc}=${value}" \
+    pgbench -n -c ${clients} -j ${clients} -T ${duration} "$@" | \
+    grep -E "^(tps|latency)"
+}
@@ -0,0 +1,51 @@
+#! /bin/bash
+## Takes args $1 (ROWS), $2 (COLUMNS) and $3 (ROUNDS)
+##
+## Generates a file of ROWS rows of COLUMNS columns each, a mix of numbers,
+## dates, short text and text with embedded delimiters and quotes, in text
+## and in CSV format.  Loads each of them with COPY FROM STDIN ROUNDS times
+## and reports the best time, and the rows and megabytes per second.  Most
+## of the time goes into finding the line ends and the field boundaries, so
+## this is the number to compare between builds of the COPY parser.
+
+. $(dirname $0)/bench_common.sh
+
+ROWS=${1:-2000000}
+COLUMNS=${2:-40}
+ROUNDS=${3:-3}
+bench_tmpfile TEXTFILE
+bench_tmpfile CSVFILE
+
+columns="id int"
+exprs="g"
+for i in $(seq 2 ${COLUMNS}); do
+  case $((i % 4)) in
+    0) columns="${columns}, c${i} int";  exprs="${exprs}, g * ${i}" ;;
+    1) columns="${columns}, c${i} date"; exprs="${exprs}, date '2020-01-01' + (g + ${i}) % 1000" ;;
+    2) columns="${columns}, c${i} text"; exprs="${exprs}, 'customer ' || g || ' account ${i}'" ;;
+    3) columns="${columns}, c${i} text"; exprs="${exprs}, 'street ' || g % 997 || ', apt \"' || ${i} || '\", city of somewhere'" ;;
+  esac
+done
+
+bench_psql <<SQL
+DROP TABLE IF EXISTS copy_parse_perf;
+CREATE TABLE copy_parse_perf (${columns}) DISTRIBUTED BY (id);
+SQL
+
+bench_psql -c "COPY (SELECT ${exprs} FROM generate_series(1, ${ROWS}) g) TO STDOUT" > ${TEXTFILE}
+bench_psql -c "COPY (SELECT ${exprs} FROM generate_series(1, ${ROWS}) g) TO STDOUT CSV" > ${CSVFILE}
+
+for format in text csv; do
+  if [ ${format} = text ]; then
+    datafile=${TEXTFILE}
+    opts=
+  else
+    datafile=${CSVFILE}
+    opts=CSV
+  fi
+  megabytes=$(echo "$(stat -c %s ${datafile}) / 1048576" | bc)
+  best=$(bench_copy_best ${ROUNDS} copy_parse_perf ${datafile} "${opts}") || exit 1
+  echo "${format}, ${COLUMNS} columns, ${megabytes} MB: ${best} s, $(echo "${ROWS} / ${best}" | bc) rows/s, $(echo "${megabytes} / ${best}" | bc) MB/s"
+done
+
+psql -X -q -c "DROP TABLE copy_parse_perf;"
@@ -0,0 +1,31 @@
+#! /bin/bash
+## Takes args $1 (ROWS) and $2 (ROUNDS)
+##
+## Loads a text file of ROWS rows from the client with COPY FROM STDIN into
+## a hash distributed and a randomly distributed table, with the master
+## parsing every line and with SEGMENT_PARSE, ROUNDS times each.  Reports the
+## best time and the rows per second of each.
+
+. $(dirname $0)/bench_common.sh
+
+ROWS=${1:-10000000}
+ROUNDS=${2:-3}
+bench_tmpfile DATAFILE
+
+bench_psql <<SQL
+DROP TABLE IF EXISTS copy_perf_hash;
+DROP TABLE IF EXISTS copy_perf_random;
+CREATE TABLE copy_perf_hash (id int, name text, amount numeric, created date) DISTRIBUTED BY (id);
+CREATE TABLE copy_perf_random (id int, name text, amount numeric, created date) DISTRIBUTED RANDOMLY;
+SQL
+
+bench_psql -c "COPY (SELECT g, 'customer ' || g, g * 1.25, date '2020-01-01' + g % 1000 FROM generate_series(1, ${ROWS}) g) TO STDOUT" > ${DATAFILE}
+
+for table in copy_perf_hash copy_perf_random; do
+  for opts in "" "WITH (segment_parse)"; do
+    best=$(bench_copy_best ${ROUNDS} ${table} ${DATAFILE} "${opts}") || exit 1
+    echo "${table} ${opts:-(master parses)}: ${best} s, $(echo "${ROWS} / ${best}" | bc) rows/s"
+  done
+done
+
+psql -X -q -c "DROP TABLE copy_perf_hash; DROP TABLE copy_perf_random;"
@@ -0,0 +1,30 @@
+#! /bin/bash
+## Takes args $1 (CLIENTS) and $2 (DURATION in seconds)
+##
+## Short distributed transactions: every transaction is a single UPDATE that
+## touches all segments, so it needs two-phase commit.  pgbench runs the same
+## script with gp_dtx_prepare_with_statement off and on, and reports the
+## transactions per second and the average latency of each run.
+
+. $(dirname $0)/bench_common.sh
+
+CLIENTS=${1:-16}
+DURATION=${2:-60}
+bench_tmpfile SCRIPT
+
+bench_psql <<SQL
+DROP TABLE IF EXISTS dtx_perf;
+CREATE TABLE dtx_perf (id int, grp int, val int) DISTRIBUTED BY (id);
+INSERT INTO dtx_perf SELECT g, g % 1000, 0 FROM generate_series(1, 100000) g;
+ANALYZE dtx_perf;
+SQL
+
+cat > ${SCRIPT} <<SQL
+\\setrandom grp 0 999
+UPDATE dtx_perf SET val = val + 1 WHERE grp = :grp;
+SQL
+
+for setting in off on; do
+  echo "gp_dtx_prepare_with_statement = ${setting}:"
+  bench_pgbench ${CLIENTS} ${DURATION} gp_dtx_prepare_with_statement ${setting} -f ${SCRIPT}
+done
@@ -0,0 +1,32 @@
+#! /bin/bash
+## Takes args $1 (CLIENTS) and $2 (DURATION in seconds)
+##
+## Distributed transactions that write to a few segments: every transaction
+## inserts two or three rows, and the insert runs on all segments.  pgbench
+## runs the same script with gp_dtx_skip_readonly_segments off and on, and
+## reports the transactions per second and the average latency of each run,
+## first with a single client, then with CLIENTS of them.
+
+. $(dirname $0)/bench_common.sh
+
+CLIENTS=${1:-16}
+DURATION=${2:-60}
+bench_tmpfile SCRIPT
+
+bench_psql <<SQL
+DROP TABLE IF EXISTS dtx_few_perf;
+CREATE TABLE dtx_few_perf (id int, val int) DISTRIBUTED BY (id);
+SQL
+
+cat > ${SCRIPT} <<SQL
+\\setrandom id 1 1000000
+\\setrandom rows 2 3
+INSERT INTO dtx_few_perf SELECT :id + g, g FROM generate_series(1, :rows) g;
+SQL
+
+for clients in 1 ${CLIENTS}; do
+  for setting in off on; do
+    echo "${clients} clients, gp_dtx_skip_readonly_segments = ${setting}:"
+    bench_pgbench ${clients} ${DURATION} gp_dtx_skip_readonly_segments ${setting} -f ${SCRIPT}
+  done
+done
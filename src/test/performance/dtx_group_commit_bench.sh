@@ -0,0 +1,43 @@
+#! /bin/bash
+## Takes args $1 (CLIENTS), $2 (DURATION in seconds) and $3 (DELAYS, a list
+## of gp_dtx_commit_delay values in microseconds)
+##
+## Many short distributed transactions committing at once: every transaction
+## is a single UPDATE that touches all segments, so the master writes and
+## flushes a distributed commit record for each.  pgbench runs the same
+## script with each gp_dtx_commit_delay, and reports the transactions per
+## second and the average latency of each run, followed by the number of
+## WAL flushes by the number of commit records they made durable.
+
+. $(dirname $0)/bench_common.sh
+
+CLIENTS=${1:-64}
+DURATION=${2:-60}
+DELAYS=${3:-"0 100 500"}
+bench_tmpfile SCRIPT
+
+bench_psql <<SQL
+DROP TABLE IF EXISTS dtx_group_perf;
+CREATE TABLE dtx_group_perf (id int, grp int, val int) DISTRIBUTED BY (id);
+INSERT INTO dtx_group_perf SELECT g, g % 1000, 0 FROM generate_series(1, 100000) g;
+ANALYZE dtx_group_perf;
+SQL
+
+cat > ${SCRIPT} <<SQL
+\\setrandom grp 0 999
+UPDATE dtx_group_perf SET val = val + 1 WHERE grp = :grp;
+SQL
+
+for delay in ${DELAYS}; do
+  echo "gp_dtx_commit_delay = ${delay}:"
+  bench_psql <<SQL
+DROP TABLE IF EXISTS dtx_group_batches;
+CREATE TABLE dtx_group_batches AS SELECT * FROM gp_dtx_commit_batches() DISTRIBUTED RANDOMLY;
+SQL
+  bench_pgbench ${CLIENTS} ${DURATION} gp_dtx_commit_delay ${delay} -f ${SCRIPT}
+  psql -X -v ON_ERROR_STOP=1 <<SQL || exit 1
+SELECT n.batch_size_from, n.batch_size_to, n.batches - o.batches AS batches
+  FROM gp_dtx_commit_batches() n JOIN dtx_group_batches o USING (batch_size_from)
+  ORDER BY 1;
+SQL
+done
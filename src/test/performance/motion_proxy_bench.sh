@@ -0,0 +1,27 @@
+#! /bin/bash
+## Takes args $1 (CONCURRENCY) and $2 (ROUNDS)
+##
+## Run many concurrent sessions that redistribute the motion_perf table
+## through the ic-proxy interconnect, and report the wall clock time of each
+## round.  The motion_setup test of motion_schedule creates the table; the
+## cluster must have gp_interconnect_proxy_addresses set.
+
+. $(dirname $0)/bench_common.sh
+
+CONCURRENCY=${1:-32}
+ROUNDS=${2:-3}
+QUERY="SELECT count(*), sum(length(t2.c)) FROM motion_perf t1 JOIN motion_perf t2 ON t1.a = t2.b WHERE t1.a % ${CONCURRENCY} ="
+
+export PGOPTIONS="-c gp_interconnect_type=proxy"
+
+for round in $(seq ${ROUNDS}); do
+  start=$(bench_now)
+  for i in $(seq 0 $((CONCURRENCY - 1))); do
+    psql -X -A -t -q -v ON_ERROR_STOP=1 -c "${QUERY} ${i}" > /dev/null &
+  done
+  failed=0
+  for job in $(jobs -p); do
+    wait ${job} || failed=$((failed + 1))
+  done
+  echo "round ${round}: ${CONCURRENCY} sessions, ${failed} failed, $(bench_since ${start}) s"
+done
@@ -0,0 +1,37 @@
+#! /bin/bash
+## Takes args $1 (CLIENTS) and $2 (DURATION in seconds)
+##
+## Short queries with large plans, run again and again as prepared
+## statements: a UNION ALL of many small aggregates over a distributed table,
+## each picking a few rows by a parameter.  pgbench runs the same script with
+## gp_dispatch_plan_cache_size 0 and 16, and reports the transactions per
+## second and the average latency of each run.
+
+. $(dirname $0)/bench_common.sh
+
+CLIENTS=${1:-16}
+DURATION=${2:-60}
+BRANCHES=20
+bench_tmpfile SCRIPT
+
+bench_psql <<SQL
+DROP TABLE IF EXISTS plan_cache_perf;
+CREATE TABLE plan_cache_perf (id int, grp int, val int) DISTRIBUTED BY (id);
+INSERT INTO plan_cache_perf SELECT g, g % 1000, g FROM generate_series(1, 100000) g;
+CREATE INDEX ON plan_cache_perf (grp);
+ANALYZE plan_cache_perf;
+SQL
+
+{
+  echo "\\setrandom grp 0 999"
+  echo -n "SELECT sum(val) FROM plan_cache_perf WHERE grp = :grp"
+  for i in $(seq 2 ${BRANCHES}); do
+    echo -n " UNION ALL SELECT sum(val + ${i}) FROM plan_cache_perf WHERE grp = :grp"
+  done
+  echo ";"
+} > ${SCRIPT}
+
+for size in 0 16; do
+  echo "gp_dispatch_plan_cache_size = ${size}:"
+  bench_pgbench ${CLIENTS} ${DURATION} gp_dispatch_plan_cache_size ${size} -M prepared -f ${SCRIPT}
+done
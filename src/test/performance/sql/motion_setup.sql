@@ -0,0 +1,4 @@
+DROP TABLE IF EXISTS motion_perf;
+CREATE TABLE motion_perf (a int, b int, c text) DISTRIBUTED BY (a);
+INSERT INTO motion_perf SELECT i, i, repeat('x', 100) FROM generate_series(1, 2000000) i;
+ANALYZE motion_perf;
@@ -0,0 +1,4 @@
+-- Redistribute every row, peers on the same host use shared memory
+SET gp_interconnect_log_stats = on;
+SET gp_interconnect_shm = on;
+SELECT count(*), sum(length(t2.c)) FROM motion_perf t1 JOIN motion_perf t2 ON t1.a = t2.b;
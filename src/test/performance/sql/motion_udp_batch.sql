@@ -0,0 +1,6 @@
+-- Redistribute every row through UDP, sendmmsg()/recvmmsg() batches
+SET gp_interconnect_log_stats = on;
+SET gp_interconnect_shm = off;
+SET gp_interconnect_batch_size = 64;
+SET gp_interconnect_udp_gso = off;
+SELECT count(*), sum(length(t2.c)) FROM motion_perf t1 JOIN motion_perf t2 ON t1.a = t2.b;
@@ -0,0 +1,5 @@
+-- Redistribute every row through UDP, one packet per system call
+SET gp_interconnect_log_stats = on;
+SET gp_interconnect_shm = off;
+SET gp_interconnect_batch_size = 1;
+SELECT count(*), sum(length(t2.c)) FROM motion_perf t1 JOIN motion_perf t2 ON t1.a = t2.b;
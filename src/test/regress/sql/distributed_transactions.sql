@@ -641,3 +641,87 @@ set optimizer=false;
 select dtx_set_bug();
 
 reset Test_print_direct_dispatch_info;
+
+--
+-- With gp_dtx_prepare_with_statement, the segments prepare the last
+-- statement of an implicit transaction right after running it, and no
+-- separate 'Distributed Prepare' is broadcast.
+--
+CREATE TABLE distxact_pws (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO distxact_pws SELECT g, g FROM generate_series(1, 30) g;
+ANALYZE distxact_pws;
+SET gp_dtx_prepare_with_statement = on;
+
+SET Test_print_direct_dispatch_info = true;
+DELETE FROM distxact_pws WHERE b > 25;
+-- a direct dispatched statement still commits in one phase
+DELETE FROM distxact_pws WHERE a = 1;
+-- statements in an explicit transaction are prepared at COMMIT
+BEGIN;
+DELETE FROM distxact_pws WHERE b > 20;
+COMMIT;
+RESET Test_print_direct_dispatch_info;
+
+-- a PREPARE that fails on a segment no longer gets in the way
+SET debug_dtm_action_segment = 1;
+SET debug_dtm_action = "fail_begin_command";
+SET debug_dtm_action_target = "protocol";
+SET debug_dtm_action_protocol = "prepare";
+DELETE FROM distxact_pws WHERE b > 15;
+RESET debug_dtm_action_segment;
+RESET debug_dtm_action;
+RESET debug_dtm_action_target;
+RESET debug_dtm_action_protocol;
+
+SELECT count(*) FROM distxact_pws;
+
+RESET gp_dtx_prepare_with_statement;
+DROP TABLE distxact_pws;
+
+--
+-- With gp_dtx_skip_readonly_segments, the segments that wrote nothing are
+-- left out of the two-phase commit.
+--
+CREATE TABLE distxact_skip (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO distxact_skip SELECT g, g FROM generate_series(1, 30) g;
+SET gp_dtx_skip_readonly_segments = on;
+
+SET Test_print_direct_dispatch_info = true;
+-- written on one segment only, committed in one phase
+UPDATE distxact_skip SET b = b + 1 WHERE b = 1;
+-- the segment that wrote nothing gets no 'Distributed Commit Prepared'
+UPDATE distxact_skip SET b = b + 1 WHERE gp_segment_id < 2;
+BEGIN;
+UPDATE distxact_skip SET b = b + 1 WHERE gp_segment_id < 2;
+COMMIT;
+RESET Test_print_direct_dispatch_info;
+
+-- a failed PREPARE still aborts the transaction
+SET debug_dtm_action_segment = 1;
+SET debug_dtm_action = "fail_begin_command";
+SET debug_dtm_action_target = "protocol";
+SET debug_dtm_action_protocol = "prepare_skip_readonly";
+UPDATE distxact_skip SET b = b + 1 WHERE gp_segment_id < 2;
+RESET debug_dtm_action_segment;
+RESET debug_dtm_action;
+RESET debug_dtm_action_target;
+RESET debug_dtm_action_protocol;
+
+-- only the rows on segments 0 and 1 were updated, twice
+SELECT count(*) FROM distxact_skip
+  WHERE b - a <> 2 * (gp_segment_id < 2)::int + (a = 1)::int;
+
+RESET gp_dtx_skip_readonly_segments;
+DROP TABLE distxact_skip;
+
+--
+-- gp_dtx_commit_batches() counts the WAL flushes of distributed commit
+-- records on the master, by the number of records they made durable.
+--
+CREATE TABLE distxact_batches (a int) DISTRIBUTED BY (a);
+SET gp_dtx_commit_delay = 1000;
+INSERT INTO distxact_batches SELECT generate_series(1, 10);
+RESET gp_dtx_commit_delay;
+SELECT batch_size_from, batch_size_to FROM gp_dtx_commit_batches();
+SELECT sum(batches) > 0 AS flushed FROM gp_dtx_commit_batches();
+DROP TABLE distxact_batches;
@@ -55,6 +55,14 @@ WHERE et like '%Memory: %';
 
 reset explain_memory_verbosity;
 
+-- GPORCA reports the peak memory it used to plan the query, the Postgres
+-- planner does not.
+SELECT COUNT(*) from
+  get_explain_analyze_output($$
+    SELECT * FROM explaintest;
+  $$) as et
+WHERE et ~ '^ Optimizer peak memory: \d+kB$';
+
 EXPLAIN ANALYZE SELECT id FROM 
 ( SELECT id 
 	FROM explaintest
@@ -0,0 +1,85 @@
+--
+-- COPY FROM ... SEGMENT_PARSE. The QD only splits the input into lines, the
+-- segments parse them and move the rows that belong elsewhere to the right
+-- segment.
+--
+CREATE TABLE segparse (a int, b text, c int) DISTRIBUTED BY (a);
+-- rows of the same distribution key, loaded the normal way, to compare with
+CREATE TABLE segparse_ref (a int, b text, c int) DISTRIBUTED BY (a);
+
+COPY segparse FROM stdin WITH (segment_parse);
+1	one	10
+2	two	20
+3	three	30
+4	four	40
+5	five	50
+\.
+SELECT * FROM segparse ORDER BY a;
+
+-- Enough data to be split into many chunks.
+COPY (SELECT i, 'row ' || i, i * 10 FROM generate_series(1, 100000) i)
+  TO '/tmp/gpcopy_segment_parse.txt';
+TRUNCATE segparse;
+-- the command tag counts every row once
+\set QUIET off
+COPY segparse FROM '/tmp/gpcopy_segment_parse.txt' WITH (segment_parse);
+\set QUIET on
+COPY segparse_ref FROM '/tmp/gpcopy_segment_parse.txt';
+SELECT count(*), count(DISTINCT a), sum(c) FROM segparse;
+-- every row must be on the segment it belongs to
+SELECT count(*) FROM
+  (SELECT gp_segment_id, a FROM segparse
+   EXCEPT
+   SELECT gp_segment_id, a FROM segparse_ref) x;
+-- the staging table is gone
+SELECT count(*) FROM pg_class WHERE relname LIKE 'gp_copy_stage_%';
+
+-- CSV, with a header and quoted newlines that cross the chunk boundaries
+COPY (SELECT i, E'line\nbreak ' || i, i FROM generate_series(1, 20000) i)
+  TO '/tmp/gpcopy_segment_parse.csv' WITH (format csv, header);
+TRUNCATE segparse;
+COPY segparse FROM '/tmp/gpcopy_segment_parse.csv' WITH (format csv, header, segment_parse);
+SELECT count(*), count(CASE WHEN b = E'line\nbreak ' || a THEN 1 END) FROM segparse;
+
+-- The data ends at the end-of-copy marker
+TRUNCATE segparse;
+COPY segparse FROM stdin WITH (segment_parse);
+1	one	10
+2	two	20
+\.
+SELECT * FROM segparse ORDER BY a;
+
+-- Partitioned append-only table
+CREATE TABLE segparse_part (a int, b text, c int)
+  WITH (appendonly=true) DISTRIBUTED BY (a)
+  PARTITION BY RANGE (c) (START (0) END (1000010) EVERY (500005));
+COPY segparse_part FROM '/tmp/gpcopy_segment_parse.txt' WITH (segment_parse);
+SELECT count(*), sum(c) FROM segparse_part;
+SELECT count(*) FROM
+  (SELECT gp_segment_id, a FROM segparse_part
+   EXCEPT
+   SELECT gp_segment_id, a FROM segparse_ref) x;
+
+-- Replicated and randomly distributed tables need no staging
+CREATE TABLE segparse_repl (a int, b text, c int) DISTRIBUTED REPLICATED;
+\set QUIET off
+COPY segparse_repl FROM '/tmp/gpcopy_segment_parse.txt' WITH (segment_parse);
+\set QUIET on
+SELECT count(*), sum(c) FROM segparse_repl;
+CREATE TABLE segparse_rand (a int, b text, c int) DISTRIBUTED RANDOMLY;
+\set QUIET off
+COPY segparse_rand FROM '/tmp/gpcopy_segment_parse.txt' WITH (segment_parse);
+\set QUIET on
+SELECT count(*), sum(c) FROM segparse_rand;
+
+-- Not supported
+COPY segparse FROM stdin WITH (format binary, segment_parse);
+COPY segparse FROM '/tmp/gpcopy_segment_parse<SEGID>.txt' WITH (segment_parse) ON SEGMENT;
+COPY segparse TO stdout WITH (segment_parse);
+COPY segparse FROM '/tmp/gpcopy_segment_parse.txt' WITH (segment_parse) LOG ERRORS SEGMENT REJECT LIMIT 10;
+
+DROP TABLE segparse;
+DROP TABLE segparse_ref;
+DROP TABLE segparse_part;
+DROP TABLE segparse_repl;
+DROP TABLE segparse_rand;
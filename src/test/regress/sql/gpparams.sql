@@ -604,3 +604,62 @@ SELECT cte."userId" FROM ( SELECT 7 as "userId" ) cte WHERE (
 ) IS NOT NULL;
 
 DROP TABLE users_unmasked;
+
+--
+-- With gp_dispatch_plan_cache_size, a plan dispatched again is only referred
+-- to, while its parameters are sent with every execution.  The first
+-- executions of a prepared statement use custom plans, the later ones the
+-- same generic plan.
+--
+CREATE TABLE plan_cache_t (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO plan_cache_t SELECT i, i % 10 FROM generate_series(1, 100) i;
+SET gp_dispatch_plan_cache_size = 4;
+PREPARE plan_cache_q(int) AS
+  SELECT count(*), sum(b) FROM plan_cache_t WHERE b < $1;
+EXECUTE plan_cache_q(3);
+EXECUTE plan_cache_q(3);
+EXECUTE plan_cache_q(2);
+EXECUTE plan_cache_q(4);
+EXECUTE plan_cache_q(5);
+EXECUTE plan_cache_q(1);
+EXECUTE plan_cache_q(3);
+EXECUTE plan_cache_q(2);
+
+-- a plan whose dispatch failed is sent in full again
+PREPARE plan_cache_div(int) AS
+  SELECT sum(a / $1) FROM plan_cache_t;
+EXECUTE plan_cache_div(1);
+EXECUTE plan_cache_div(0);
+EXECUTE plan_cache_div(0);
+EXECUTE plan_cache_div(2);
+EXECUTE plan_cache_div(2);
+
+-- plans move to other slots when the cache size changes
+SET gp_dispatch_plan_cache_size = 1;
+EXECUTE plan_cache_q(4);
+EXECUTE plan_cache_div(5);
+EXECUTE plan_cache_q(4);
+RESET gp_dispatch_plan_cache_size;
+EXECUTE plan_cache_q(4);
+
+-- the segments run the plan they keep when it is only referred to; count
+-- on one segment how often that happened
+CREATE EXTENSION IF NOT EXISTS gp_inject_fault;
+SET gp_dispatch_plan_cache_size = 4;
+EXECUTE plan_cache_q(6);
+SELECT gp_inject_fault_infinite('exec_mpp_query_cached_plan', 'skip', dbid)
+  FROM gp_segment_configuration WHERE content = 0 AND role = 'p';
+EXECUTE plan_cache_q(7);
+EXECUTE plan_cache_q(8);
+SET gp_dispatch_plan_cache_size = 0;
+EXECUTE plan_cache_q(7);
+SELECT substring(gp_inject_fault('exec_mpp_query_cached_plan', 'status', dbid)
+                 from 'num times hit:''(\d+)''') AS cached_plan_runs
+  FROM gp_segment_configuration WHERE content = 0 AND role = 'p';
+SELECT gp_inject_fault('exec_mpp_query_cached_plan', 'reset', dbid)
+  FROM gp_segment_configuration WHERE content = 0 AND role = 'p';
+RESET gp_dispatch_plan_cache_size;
+
+DEALLOCATE plan_cache_q;
+DEALLOCATE plan_cache_div;
+DROP TABLE plan_cache_t;
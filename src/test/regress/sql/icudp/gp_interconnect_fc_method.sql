@@ -27,3 +27,20 @@ SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(len
     JOIN small_table USING(jkey)
   GROUP BY rval2
   ORDER BY rval2;
+
+-- Delay based flow control; keep the packets off shared memory, so that the
+-- connections show up in gp_interconnect_conn_stats
+SET gp_interconnect_fc_method = "delay";
+SHOW gp_interconnect_fc_method;
+SET gp_interconnect_shm = off;
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+SELECT COUNT(*) > 0 AS has_conns, bool_and(packets_sent > 0) AS sent, bool_and(cwnd >= 2) AS cwnd_ok,
+       bool_and(min_rtt IS NOT NULL AND min_rtt <= max_ack_time) AS rtt_ok
+  FROM gp_interconnect_conn_stats
+  WHERE sess_id = current_setting('gp_session_id')::int AND fc_method = 'delay';
+RESET gp_interconnect_shm;
+RESET gp_interconnect_fc_method;
@@ -0,0 +1,54 @@
+--
+-- @description Interconnect test case: same-host peers exchange data packets
+-- through shared memory
+-- @tags executor
+
+-- Create a table
+CREATE TEMP TABLE small_table(dkey INT, jkey INT, rval REAL, tval TEXT default 'abcdefghijklmnopqrstuvwxyz') DISTRIBUTED BY (dkey);
+
+-- Generate some data
+INSERT INTO small_table VALUES(generate_series(1, 5000), generate_series(5001, 10000), sqrt(generate_series(5001, 10000)));
+
+CREATE EXTENSION IF NOT EXISTS gp_inject_fault;
+
+-- The shared-memory path is off by default
+SHOW gp_interconnect_shm;
+SET gp_interconnect_shm = on;
+SELECT gp_inject_fault_infinite('interconnect_shm_ring_attached', 'skip', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+
+-- Functional tests
+-- Skew with gather+redistribute
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+
+-- seg0 exchanged packets with its same-host peers through shared memory
+SELECT gp_wait_until_triggered_fault('interconnect_shm_ring_attached', 1, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+SELECT gp_inject_fault('interconnect_shm_ring_attached', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = 0;
+
+-- Receivers stop their senders early
+SELECT COUNT(*) FROM (SELECT * FROM small_table s1 JOIN small_table s2 ON s1.dkey = s2.jkey - 5000 LIMIT 10) foo;
+
+-- A single slot per ring
+SET gp_interconnect_shm_queue_depth = 1;
+SHOW gp_interconnect_shm_queue_depth;
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+SELECT COUNT(*) FROM (SELECT * FROM small_table s1 JOIN small_table s2 ON s1.dkey = s2.jkey - 5000 LIMIT 10) foo;
+RESET gp_interconnect_shm_queue_depth;
+
+-- Same results with every packet going through UDP
+SET gp_interconnect_shm = off;
+SHOW gp_interconnect_shm;
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+SELECT COUNT(*) FROM (SELECT * FROM small_table s1 JOIN small_table s2 ON s1.dkey = s2.jkey - 5000 LIMIT 10) foo;
+RESET gp_interconnect_shm;
@@ -926,3 +926,37 @@ alter table hll_part_def set (analyze_hll_non_part_table=true);
 select reloptions from pg_class where relname='hll_part_def';
 select reloptions from pg_class where relname='hll_part_def_1_prt_2';
 
+
+-- Test that ANALYZE skips append-optimized partitions that have not been
+-- modified since they were last analyzed, when gp_analyze_skip_unchanged_ao
+-- is enabled.
+set client_min_messages to 'warning';
+set gp_analyze_skip_unchanged_ao = on;
+create table skip_unchanged_ao (a int, b int) with (appendonly=true) distributed by (a)
+partition by range (b) (start (1) end (3) every (1));
+insert into skip_unchanged_ao select i, 1 from generate_series(1, 100) i;
+insert into skip_unchanged_ao select i, 2 from generate_series(1, 100) i;
+analyze skip_unchanged_ao;
+select relid::regclass, analyzemodcount >= 0 as recorded from pg_appendonly
+where relid in ('skip_unchanged_ao_1_prt_1'::regclass, 'skip_unchanged_ao_1_prt_2'::regclass)
+order by 1;
+create temp table skip_unchanged_ao_stats as
+select starelid, staattnum, xmin::text as stats_xmin from pg_statistic
+where starelid in ('skip_unchanged_ao_1_prt_1'::regclass, 'skip_unchanged_ao_1_prt_2'::regclass)
+distributed randomly;
+-- Only the second partition is modified, so only it gets re-sampled
+insert into skip_unchanged_ao select i, 2 from generate_series(101, 200) i;
+analyze skip_unchanged_ao;
+select s.starelid::regclass, s.staattnum, s.xmin::text = p.stats_xmin as unchanged
+from pg_statistic s join skip_unchanged_ao_stats p using (starelid, staattnum)
+order by 1, 2;
+select reltuples from pg_class where oid = 'skip_unchanged_ao_1_prt_2'::regclass;
+-- TRUNCATE restarts the modcount, so the recorded value is forgotten
+truncate skip_unchanged_ao_1_prt_1;
+select analyzemodcount from pg_appendonly where relid = 'skip_unchanged_ao_1_prt_1'::regclass;
+reset gp_analyze_skip_unchanged_ao;
+-- With the GUC off, ANALYZE does not record the modcount
+insert into skip_unchanged_ao select i, 1 from generate_series(1, 100) i;
+analyze skip_unchanged_ao_1_prt_1;
+select analyzemodcount from pg_appendonly where relid = 'skip_unchanged_ao_1_prt_1'::regclass;
+reset client_min_messages;